@@ -0,0 +1,102 @@
+// Arrangement of synthetic part sets, serial, parallel and parallel with a limited number of candidate positions
+// refined for each part: Time, number of beds used and the bounding box of the first bed.
+//
+// Usage: bench_arrange [--count N] [--candidates C] [--rotations]
+// Three sets of N parts (200 by default) are arranged on a 250 x 210 mm bed: Instances of a few shapes,
+// random convex parts all different and a mix of both.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include <libslic3r/Arrange.hpp>
+#include <libslic3r/BoundingBox.hpp>
+#include <libslic3r/Geometry/ConvexHull.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+namespace Slic3r {
+
+// Convex hull of random points in an ellipse of random size and aspect ratio.
+static Polygon random_part(std::mt19937 &rng)
+{
+    std::uniform_real_distribution<double> size(3., 10.), aspect(0.3, 1.), angle(0., 2. * PI), radius(0., 1.);
+    double rx = size(rng), ry = rx * aspect(rng);
+    Points pts;
+    for (int i = 0; i < 24; ++ i) {
+        double a = angle(rng), r = std::sqrt(radius(rng));
+        pts.emplace_back(scaled(rx * r * std::cos(a)), scaled(ry * r * std::sin(a)));
+    }
+    return Geometry::convex_hull(std::move(pts));
+}
+
+// Instances of four shapes, all parts different or every other part an instance of four shapes.
+static arrangement::ArrangePolygons make_parts(const std::string &set, size_t count, std::mt19937 &rng)
+{
+    std::vector<Polygon> shapes;
+    for (int i = 0; i < 4; ++ i)
+        shapes.emplace_back(random_part(rng));
+
+    arrangement::ArrangePolygons parts(count);
+    for (size_t i = 0; i < count; ++ i) {
+        bool instance = set == "instances" || (set == "mixed" && i % 2 == 1);
+        parts[i].poly.contour = instance ? shapes[i % shapes.size()] : random_part(rng);
+    }
+    return parts;
+}
+
+static void measure(const std::string &set, size_t count, bool rotations, unsigned max_candidates)
+{
+    BoundingBox bed({ 0, 0 }, { scaled(250.), scaled(210.) });
+    for (int mode = 0; mode < 3; ++ mode) {
+        std::mt19937 rng(0);
+        arrangement::ArrangePolygons parts = make_parts(set, count, rng);
+        arrangement::ArrangeParams   params(scaled(6.));
+        params.parallel        = mode > 0;
+        params.allow_rotations = rotations;
+        params.max_candidates  = mode == 2 ? max_candidates : 0;
+
+        Benchmark b;
+        b.start();
+        arrangement::arrange(parts, bed, params);
+        b.stop();
+
+        int         beds = 0;
+        BoundingBox first_bed;
+        for (const arrangement::ArrangePolygon &ap : parts) {
+            beds = std::max(beds, ap.bed_idx + 1);
+            if (ap.bed_idx == 0)
+                first_bed.merge(get_extents(ap.transformed_poly()));
+        }
+        static const char *modes[] = { "serial", "parallel", "fast" };
+        printf("%-10s %-8s %5zu parts %8.2f s  %d beds, first bed %.1f x %.1f mm\n",
+            set.c_str(), modes[mode], count, b.getElapsedSec(), beds,
+            unscaled(first_bed.size().x()), unscaled(first_bed.size().y()));
+    }
+}
+
+} // namespace Slic3r
+
+int main(int argc, char **argv)
+{
+    using namespace Slic3r;
+
+    size_t   count          = 200;
+    unsigned max_candidates = 32;
+    bool     rotations      = false;
+    for (int i = 1; i < argc; ++ i)
+        if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            count = size_t(atoi(argv[++ i]));
+        else if (strcmp(argv[i], "--candidates") == 0 && i + 1 < argc)
+            max_candidates = unsigned(atoi(argv[++ i]));
+        else if (strcmp(argv[i], "--rotations") == 0)
+            rotations = true;
+
+    for (const char *set : { "instances", "unique", "mixed" })
+        measure(set, count, rotations, max_candidates);
+
+    return EXIT_SUCCESS;
+}
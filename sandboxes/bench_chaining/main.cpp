@@ -0,0 +1,154 @@
+// Chaining of polylines by chain_polylines(): Run time and the total length of the travel moves between the polylines,
+// after the greedy phase only, with the exchanges of connections tried for all pairs of connections
+// and with the exchanges restricted to the neighbors.
+//
+// Usage: bench_chaining [--count N] [--time-budget S] [file...]
+// Without input files, two synthetic layers of about N polylines (20000 by default) are chained: Short gap fill like segments
+// scattered randomly and rectilinear infill lines interrupted by round holes.
+// An input file contains a recorded layer, one polyline per line as a sequence of "x y" coordinates in millimeters.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <libslic3r/ShortestPath.hpp>
+#include <libslic3r/Polyline.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+namespace Slic3r {
+
+// Short segments of random length and direction scattered over a 200 x 200 mm square.
+static Polylines make_gap_fill(size_t count, std::mt19937 &rng)
+{
+    std::uniform_real_distribution<double> pos(0., 200.), length(0.5, 3.), angle(0., 2. * PI);
+    Polylines out;
+    out.reserve(count);
+    for (size_t i = 0; i < count; ++ i) {
+        double x = pos(rng), y = pos(rng), l = length(rng), a = angle(rng);
+        out.push_back({ Point(scaled(x), scaled(y)), Point(scaled(x + l * std::cos(a)), scaled(y + l * std::sin(a))) });
+    }
+    return out;
+}
+
+// Horizontal lines 0.5 mm apart over a square split by round holes, one hole per 20 x 20 mm on average.
+// The square is sized to produce about count pieces of lines.
+static Polylines make_infill(size_t count, std::mt19937 &rng)
+{
+    struct Hole { double x, y, r; };
+    const double spacing = 0.5;
+    // A line of length s is split by about s * 7 / 400 holes, solve count = (1 + s * 7 / 400) * s / spacing for s.
+    const double a    = 7. / (400. * spacing);
+    const double b    = 1. / spacing;
+    const double side = (std::sqrt(b * b + 4. * a * double(count)) - b) / (2. * a);
+    std::uniform_real_distribution<double> pos(0., side), radius(1., 6.);
+    std::vector<Hole> holes(size_t(side * side / 400.) + 1);
+    for (Hole &h : holes)
+        h = { pos(rng), pos(rng), radius(rng) };
+
+    Polylines out;
+    for (double y = 0.5 * spacing; y < side; y += spacing) {
+        // Intervals of the line inside the holes.
+        std::vector<std::pair<double, double>> cuts;
+        for (const Hole &h : holes)
+            if (std::abs(h.y - y) < h.r) {
+                double dx = std::sqrt(h.r * h.r - (h.y - y) * (h.y - y));
+                cuts.emplace_back(h.x - dx, h.x + dx);
+            }
+        std::sort(cuts.begin(), cuts.end());
+        double x = 0.;
+        for (const std::pair<double, double> &cut : cuts) {
+            if (cut.first > x + spacing)
+                out.push_back({ Point(scaled(x), scaled(y)), Point(scaled(cut.first), scaled(y)) });
+            x = std::max(x, cut.second);
+        }
+        if (x + spacing < side)
+            out.push_back({ Point(scaled(x), scaled(y)), Point(scaled(side), scaled(y)) });
+    }
+    return out;
+}
+
+static Polylines load_layer(const char *path)
+{
+    Polylines     out;
+    std::ifstream file(path);
+    std::string   line;
+    while (std::getline(file, line)) {
+        std::istringstream ss(line);
+        Polyline pl;
+        double   x, y;
+        while (ss >> x >> y)
+            pl.points.emplace_back(scaled(x), scaled(y));
+        if (! pl.points.empty())
+            out.emplace_back(std::move(pl));
+    }
+    return out;
+}
+
+static double travel_length(const Polylines &polylines)
+{
+    double length = 0.;
+    for (size_t i = 1; i < polylines.size(); ++ i)
+        length += (polylines[i].first_point() - polylines[i - 1].last_point()).cast<double>().norm();
+    return unscaled(length);
+}
+
+static void measure(const std::string &name, const Polylines &polylines, double time_budget)
+{
+    for (int mode = 0; mode < 4; ++ mode) {
+        ChainingParams params;
+        if (mode > 0)
+            params.max_exchanges = 100;
+        if (mode == 1)
+            params.restrict_to_neighbors = false;
+        else if (mode == 3) {
+            if (time_budget <= 0.)
+                break;
+            params.time_budget = time_budget;
+        }
+
+        Benchmark b;
+        b.start();
+        Polylines chained = chain_polylines(Polylines(polylines), nullptr, params);
+        b.stop();
+
+        static const char *modes[] = { "greedy", "exhaustive", "neighbors", "budget" };
+        printf("%-12s %-10s %7zu polylines %8.3f s  travel %10.1f mm\n",
+            name.c_str(), modes[mode], polylines.size(), b.getElapsedSec(), travel_length(chained));
+    }
+}
+
+} // namespace Slic3r
+
+int main(int argc, char **argv)
+{
+    using namespace Slic3r;
+
+    size_t                   count       = 20000;
+    double                   time_budget = 0.;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++ i)
+        if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            count = size_t(atoi(argv[++ i]));
+        else if (strcmp(argv[i], "--time-budget") == 0 && i + 1 < argc)
+            time_budget = atof(argv[++ i]);
+        else
+            files.emplace_back(argv[i]);
+
+    if (files.empty()) {
+        std::mt19937 rng(0);
+        measure("gap_fill", make_gap_fill(count, rng), time_budget);
+        measure("infill",   make_infill(count, rng),   time_budget);
+    } else {
+        for (const std::string &file : files)
+            measure(file, load_layer(file.c_str()), time_budget);
+    }
+
+    return EXIT_SUCCESS;
+}
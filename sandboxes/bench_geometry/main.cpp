@@ -0,0 +1,226 @@
+// Micro benchmark of the ClipperUtils polygon operations.
+//
+// Usage: bench_geometry [--iterations N] [layer.bin ...]
+//
+// The layer files hold the subject and clip paths of a single Clipper call, as written by
+// export_clipper_input_polygons_bin(). To record them, build libslic3r with CLIPPER_UTILS_DEBUG defined
+// in ClipperUtils.cpp, set SLIC3R_CLIPPER_CAPTURE_DIR to an existing directory and slice: the input of each
+// Clipper boolean operation is stored there as clipper_<N>.bin. Without input files, a synthetic set of layers with many islands
+// is generated. For each family of operations the time per operation, the number of heap allocations
+// per operation and the peak resident set size of the process are reported.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <libslic3r/BoundingBox.hpp>
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/Polyline.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+static std::atomic<size_t> g_num_allocations { 0 };
+
+void* operator new(size_t size)
+{
+    ++ g_num_allocations;
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace Slic3r {
+
+struct Workload
+{
+    std::string name;
+    // Islands of a layer, possibly overlapping.
+    Polygons    subject;
+    // Clipping polygons (may be empty for union / offset).
+    Polygons    clip;
+    // Infill like hatching lines covering the bounding box of the subject.
+    Polylines   hatching;
+    Lines       hatching_lines;
+};
+
+// Reads a file written by export_clipper_input_polygons_bin().
+static bool load_clipper_input_polygons_bin(const char *path, Polygons &subject, Polygons &clip)
+{
+    FILE *pfile = ::fopen(path, "rb");
+    if (pfile == nullptr)
+        return false;
+    auto read_paths = [pfile](Polygons &out) {
+        uint32_t num_paths = 0;
+        if (::fread(&num_paths, sizeof(num_paths), 1, pfile) != 1)
+            return false;
+        out.assign(num_paths, Polygon());
+        for (Polygon &poly : out) {
+            uint32_t num_points = 0;
+            if (::fread(&num_points, sizeof(num_points), 1, pfile) != 1)
+                return false;
+            std::vector<ClipperLib::IntPoint> path(num_points);
+            if (::fread(path.data(), sizeof(ClipperLib::IntPoint), num_points, pfile) != num_points)
+                return false;
+            poly.points.reserve(num_points);
+            for (const ClipperLib::IntPoint &pt : path)
+                poly.points.emplace_back(coord_t(pt.x()), coord_t(pt.y()));
+        }
+        return true;
+    };
+    bool ok = read_paths(subject) && read_paths(clip);
+    ::fclose(pfile);
+    return ok;
+}
+
+static void make_hatching(Workload &workload)
+{
+    BoundingBox bbox    = get_extents(workload.subject);
+    coord_t     spacing = std::max<coord_t>(scaled<coord_t>(0.45), (bbox.max.y() - bbox.min.y()) / 2000);
+    for (coord_t y = bbox.min.y() + spacing / 2; y < bbox.max.y(); y += spacing) {
+        workload.hatching.push_back(Polyline(Point(bbox.min.x(), y), Point(bbox.max.x(), y)));
+        workload.hatching_lines.emplace_back(Point(bbox.min.x(), y), Point(bbox.max.x(), y));
+    }
+}
+
+// A layer of a plate full of parts: a grid of circular islands with holes, clipped by a shifted copy of itself.
+static Workload make_synthetic_layer(int idx, std::mt19937 &rng)
+{
+    Workload out;
+    out.name = "synthetic_" + std::to_string(idx);
+    std::uniform_real_distribution<double> radius(2., 8.);
+    std::uniform_int_distribution<int>     segments(16, 256);
+    for (int i = 0; i < 16; ++ i)
+        for (int j = 0; j < 16; ++ j) {
+            double  r = radius(rng);
+            int     n = segments(rng);
+            Polygon contour;
+            Polygon hole;
+            contour.points.reserve(n);
+            hole.points.reserve(n);
+            for (int k = 0; k < n; ++ k) {
+                double angle = 2. * M_PI * k / n;
+                Vec2d  c(12. * i, 12. * j);
+                contour.points.emplace_back(scaled<coord_t>(c.x() + r * cos(angle)), scaled<coord_t>(c.y() + r * sin(angle)));
+                hole.points.emplace_back(scaled<coord_t>(c.x() + 0.4 * r * cos(angle)), scaled<coord_t>(c.y() + 0.4 * r * sin(angle)));
+            }
+            hole.reverse();
+            out.subject.emplace_back(std::move(contour));
+            out.subject.emplace_back(std::move(hole));
+        }
+    out.clip = out.subject;
+    for (Polygon &poly : out.clip)
+        poly.translate(scaled<coord_t>(3.), scaled<coord_t>(3.));
+    return out;
+}
+
+static size_t peak_rss()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    return GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ? size_t(pmc.PeakWorkingSetSize) : 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    // ru_maxrss is in bytes on OSX.
+    return size_t(usage.ru_maxrss);
+#else
+    // ru_maxrss is in kilobytes on Linux.
+    return size_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// Runs op() over all workloads iterations times, reports time and allocations per operation.
+template<typename Op>
+static void measure(const char *family, const std::vector<Workload> &workloads, int iterations, Op op)
+{
+    Benchmark b;
+    size_t    num_ops         = 0;
+    // Prevent the optimizer from removing the operations.
+    size_t    result_size     = 0;
+    size_t    num_allocations = g_num_allocations;
+    b.start();
+    for (int i = 0; i < iterations; ++ i)
+        for (const Workload &workload : workloads) {
+            result_size += op(workload);
+            ++ num_ops;
+        }
+    b.stop();
+    num_allocations = g_num_allocations - num_allocations;
+    printf("%-24s %14.0f ns/op %12.1f allocs/op %10.1f MB peak RSS (%zu)\n", family,
+        num_ops == 0 ? 0. : b.getElapsedSec() * 1e9 / double(num_ops),
+        num_ops == 0 ? 0. : double(num_allocations) / double(num_ops),
+        double(peak_rss()) / (1024. * 1024.),
+        result_size);
+}
+
+} // namespace Slic3r
+
+int main(int argc, char **argv)
+{
+    using namespace Slic3r;
+
+    int                   iterations = 20;
+    std::vector<Workload> workloads;
+    for (int i = 1; i < argc; ++ i) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::max(1, atoi(argv[++ i]));
+            continue;
+        }
+        Workload workload;
+        workload.name = argv[i];
+        if (! load_clipper_input_polygons_bin(argv[i], workload.subject, workload.clip)) {
+            std::cerr << "Failed to load " << argv[i] << std::endl;
+            return EXIT_FAILURE;
+        }
+        workloads.emplace_back(std::move(workload));
+    }
+    if (workloads.empty()) {
+        std::mt19937 rng(0);
+        for (int i = 0; i < 8; ++ i)
+            workloads.emplace_back(make_synthetic_layer(i, rng));
+    }
+    for (Workload &workload : workloads) {
+        if (workload.clip.empty())
+            // Recorded union or offset: clip the layer by itself shifted, to exercise the two operand operations.
+            for (Polygon poly : workload.subject) {
+                poly.translate(scaled<coord_t>(1.), scaled<coord_t>(1.));
+                workload.clip.emplace_back(std::move(poly));
+            }
+        make_hatching(workload);
+    }
+
+    printf("%zu workloads, %d iterations\n", workloads.size(), iterations);
+    const float delta = scaled<float>(0.2);
+    measure("union_ex", workloads, iterations, [](const Workload &w) { return union_ex(w.subject).size(); });
+    measure("union_ex(subj + clip)", workloads, iterations, [](const Workload &w) { Polygons all = w.subject; append(all, w.clip); return union_ex(all).size(); });
+    measure("diff_ex", workloads, iterations, [](const Workload &w) { return diff_ex(w.subject, w.clip).size(); });
+    measure("intersection_ex", workloads, iterations, [](const Workload &w) { return intersection_ex(w.subject, w.clip).size(); });
+    measure("offset miter", workloads, iterations, [delta](const Workload &w) { return offset(w.subject, delta, ClipperLib::jtMiter, 3.).size(); });
+    measure("offset round", workloads, iterations, [delta](const Workload &w) { return offset(w.subject, delta, ClipperLib::jtRound, 0.005 * delta).size(); });
+    measure("offset2_ex miter", workloads, iterations, [delta](const Workload &w) { return offset2_ex(union_ex(w.subject), - delta, delta, ClipperLib::jtMiter, 3.).size(); });
+    measure("offset2_ex round", workloads, iterations, [delta](const Workload &w) { return offset2_ex(union_ex(w.subject), - delta, delta, ClipperLib::jtRound, 0.005 * delta).size(); });
+    measure("diff_pl", workloads, iterations, [](const Workload &w) { return diff_pl(w.hatching, w.subject).size(); });
+    measure("intersection_pl", workloads, iterations, [](const Workload &w) { return intersection_pl(w.hatching, w.subject).size(); });
+    measure("intersection_ln", workloads, iterations, [](const Workload &w) { return intersection_ln(w.hatching_lines, w.subject).size(); });
+    return EXIT_SUCCESS;
+}
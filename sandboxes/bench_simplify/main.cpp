@@ -0,0 +1,84 @@
+// Serial versus parallel quadric edge collapse: Time and the distance of the simplified mesh from the input mesh.
+//
+// Usage: bench_simplify [--ratio R] [mesh.stl]
+// Without an input mesh, spheres of 0.4M, 2.5M and 10M triangles are simplified.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <libslic3r/AABBTreeIndirect.hpp>
+#include <libslic3r/QuadricEdgeCollapse.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+namespace Slic3r {
+
+// Maximum and average distance of the vertices of the simplified mesh from the input mesh.
+static std::pair<float, float> distance(const indexed_triangle_set &from, const indexed_triangle_set &to)
+{
+    auto   tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(from.vertices, from.indices);
+    float  max  = 0.f;
+    double sum  = 0.;
+    for (const Vec3f &v : to.vertices) {
+        size_t hit_idx;
+        Vec3f  hit_point;
+        float  d = std::sqrt(AABBTreeIndirect::squared_distance_to_indexed_triangle_set(from.vertices, from.indices, tree, v, hit_idx, hit_point));
+        max  = std::max(max, d);
+        sum += d;
+    }
+    return { max, to.vertices.empty() ? 0.f : float(sum / double(to.vertices.size())) };
+}
+
+static void measure(const char *name, const indexed_triangle_set &input, double ratio)
+{
+    auto wanted_count = uint32_t(double(input.indices.size()) * ratio);
+    for (bool parallel : { false, true }) {
+        indexed_triangle_set its = input;
+        Benchmark b;
+        b.start();
+        if (parallel)
+            its_quadric_edge_collapse_parallel(its, wanted_count);
+        else
+            its_quadric_edge_collapse(its, wanted_count);
+        b.stop();
+        auto [max_distance, average_distance] = distance(input, its);
+        printf("%-16s %-8s %10zu -> %9zu triangles %8.2f s  max distance %.5f, average distance %.6f\n",
+            name, parallel ? "parallel" : "serial", input.indices.size(), its.indices.size(), b.getElapsedSec(), max_distance, average_distance);
+    }
+}
+
+} // namespace Slic3r
+
+int main(int argc, char **argv)
+{
+    using namespace Slic3r;
+
+    double      ratio = 0.05;
+    std::string path;
+    for (int i = 1; i < argc; ++ i)
+        if (strcmp(argv[i], "--ratio") == 0 && i + 1 < argc)
+            ratio = atof(argv[++ i]);
+        else
+            path = argv[i];
+
+    if (path.empty()) {
+        for (double angle_step : { 0.01, 0.004, 0.002 }) {
+            indexed_triangle_set sphere = its_make_sphere(10., angle_step);
+            measure("sphere", sphere, ratio);
+        }
+    } else {
+        TriangleMesh mesh;
+        if (! mesh.ReadSTLFile(path.c_str())) {
+            fprintf(stderr, "Failed to load %s\n", path.c_str());
+            return EXIT_FAILURE;
+        }
+        measure(path.c_str(), mesh.its, ratio);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+// Throughput of the SLA rasterizers: The AGG raster with a frame buffer versus the span raster
+// encoding row by row, at 4K, 8K and 12K display resolutions.
+//
+// Usage: bench_sla_raster [--layers N]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <libslic3r/ExPolygon.hpp>
+#include <libslic3r/SLA/AGGRaster.hpp>
+#include <libslic3r/SLA/SpanRaster.hpp>
+
+#include "libnest2d/tools/benchmark.h"
+
+namespace Slic3r {
+
+struct Display
+{
+    const char     *name;
+    sla::Resolution resolution;
+    double          width_mm, height_mm;
+};
+
+// A layer of a full build plate: circular parts with holes, some of them overlapping.
+static ExPolygons make_layer(const Display &display, std::mt19937 &rng)
+{
+    ExPolygons out;
+    std::uniform_real_distribution<double> x(0., display.width_mm), y(0., display.height_mm), radius(1., 10.);
+    for (int i = 0; i < 200; ++ i) {
+        double    r = radius(rng);
+        Vec2d     c(x(rng), y(rng));
+        ExPolygon expoly;
+        Polygon   hole;
+        const int n = 128;
+        for (int k = 0; k < n; ++ k) {
+            double angle = 2. * M_PI * k / n;
+            expoly.contour.points.emplace_back(scaled<coord_t>(c.x() + r * cos(angle)), scaled<coord_t>(c.y() + r * sin(angle)));
+            hole.points.emplace_back(scaled<coord_t>(c.x() + 0.5 * r * cos(angle)), scaled<coord_t>(c.y() + 0.5 * r * sin(angle)));
+        }
+        hole.reverse();
+        expoly.holes.emplace_back(std::move(hole));
+        out.emplace_back(std::move(expoly));
+    }
+    return out;
+}
+
+template<class RasterFactory, class EncodeFn>
+static void measure(const char *name, const Display &display, const std::vector<ExPolygons> &layers, RasterFactory factory, EncodeFn encode)
+{
+    Benchmark b;
+    size_t    encoded_size = 0;
+    b.start();
+    for (const ExPolygons &layer : layers) {
+        std::unique_ptr<sla::RasterBase> raster = factory();
+        for (const ExPolygon &expoly : layer)
+            raster->draw(expoly);
+        encoded_size += encode(*raster).size();
+    }
+    b.stop();
+    double seconds = b.getElapsedSec();
+    printf("%-4s %-28s %8.2f layers/s %10.1f Mpx/s (%zu bytes)\n", display.name, name,
+        double(layers.size()) / seconds,
+        double(layers.size()) * double(display.resolution.pixels()) / (seconds * 1e6),
+        encoded_size);
+}
+
+} // namespace Slic3r
+
+int main(int argc, char **argv)
+{
+    using namespace Slic3r;
+
+    int num_layers = 10;
+    for (int i = 1; i < argc; ++ i)
+        if (strcmp(argv[i], "--layers") == 0 && i + 1 < argc)
+            num_layers = std::max(1, atoi(argv[++ i]));
+
+    const Display displays[] = {
+        { "4K",  { 3840,  2160 }, 134.4,  75.6 },
+        { "8K",  { 7680,  4320 }, 165.1,  92.9 },
+        { "12K", { 11520, 5120 }, 218.88, 122.88 }
+    };
+
+    for (const Display &display : displays) {
+        std::mt19937            rng(0);
+        std::vector<ExPolygons> layers;
+        for (int i = 0; i < num_layers; ++ i)
+            layers.emplace_back(make_layer(display, rng));
+        const sla::PixelDim pxdim(display.width_mm / display.resolution.width_px, display.height_mm / display.resolution.height_px);
+        const double        gamma = 1.;
+
+        measure("AGG frame, PNG", display, layers,
+            [&]() { return sla::create_raster_grayscale_aa(display.resolution, pxdim, gamma); },
+            [](const sla::RasterBase &raster) { return raster.encode(sla::PNGRasterEncoder{}); });
+        measure("spans, PNG by rows", display, layers,
+            [&]() { return sla::create_raster_grayscale_aa_spans(display.resolution, pxdim, gamma); },
+            [](const sla::RasterBase &raster) { return raster.encode_rows(sla::PNGRasterEncoder{}); });
+        measure("AGG frame, draw only", display, layers,
+            [&]() { return sla::create_raster_grayscale_aa(display.resolution, pxdim, gamma); },
+            [](const sla::RasterBase &) { return sla::EncodedRaster(); });
+        measure("spans, draw only", display, layers,
+            [&]() { return sla::create_raster_grayscale_aa_spans(display.resolution, pxdim, gamma); },
+            [](const sla::RasterBase &) { return sla::EncodedRaster(); });
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -783,13 +783,15 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
   if ((Closed && highI < 2) || (!Closed && highI < 1))
     return false;
 
-  // Allocate a new edge array.
-  std::vector<TEdge> edges(highI + 1);
+  // Allocate a new edge array or reuse an edge array released by Clear().
+  std::vector<TEdge> edges = AllocateEdges(highI + 1);
   // Fill in the edge array.
   bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges.data());
   if (result)
     // Success, remember the edge array.
     m_edges.emplace_back(std::move(edges));
+  else
+    ReleaseEdges(std::move(edges));
   return result;
 }
 
@@ -975,9 +977,42 @@ bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, b
 }
 //------------------------------------------------------------------------------
 
+// Upper limit of the number of edges (about 0.5MB) and of the edge arrays retained by a ClipperBase for reuse after Clear().
+static constexpr const size_t MaxRetainedEdges      = 4096;
+static constexpr const size_t MaxRetainedEdgeArrays = 64;
+
+std::vector<TEdge> ClipperBase::AllocateEdges(size_t num_edges)
+{
+  std::vector<TEdge> edges;
+  if (! m_edgesFree.empty()) {
+    // Take the smallest array with enough capacity, or the largest one to be grown.
+    auto it = std::lower_bound(m_edgesFree.begin(), m_edgesFree.end(), num_edges,
+      [](const std::vector<TEdge> &e, size_t n){ return e.capacity() < n; });
+    if (it == m_edgesFree.end())
+      -- it;
+    edges = std::move(*it);
+    m_edgesFree.erase(it);
+    m_edgesFreeCapacity -= edges.capacity();
+  }
+  edges.assign(num_edges, TEdge());
+  return edges;
+}
+
+void ClipperBase::ReleaseEdges(std::vector<TEdge> &&edges)
+{
+  if (edges.capacity() > 0 && m_edgesFree.size() < MaxRetainedEdgeArrays && m_edgesFreeCapacity + edges.capacity() <= MaxRetainedEdges) {
+    m_edgesFreeCapacity += edges.capacity();
+    // Keep m_edgesFree sorted by capacity.
+    m_edgesFree.insert(std::upper_bound(m_edgesFree.begin(), m_edgesFree.end(), edges.capacity(),
+      [](size_t n, const std::vector<TEdge> &e){ return n < e.capacity(); }), std::move(edges));
+  }
+}
+
 void ClipperBase::Clear()
 {
   m_MinimaList.clear();
+  for (std::vector<TEdge> &edges : m_edges)
+    ReleaseEdges(std::move(edges));
   m_edges.clear();
 #ifndef CLIPPERLIB_INT32
   m_UseFullRange = false;
@@ -1060,6 +1095,9 @@ IntRect ClipperBase::GetBounds()
 
 Clipper::Clipper(int initOptions) : 
   ClipperBase(),
+  m_OutRecsChunksUsed(0),
+  m_OutRecsChunkLast(m_OutRecsChunkSize),
+  m_OutPtsChunksUsed(0),
   m_OutPtsFree(nullptr),
   m_OutPtsChunkSize(32),
   m_OutPtsChunkLast(32),
@@ -1079,7 +1117,7 @@ Clipper::Clipper(int initOptions) :
 void Clipper::Reset()
 {
   ClipperBase::Reset();
-  m_Scanbeam = std::priority_queue<cInt>();
+  m_Scanbeam.clear();
   m_Maxima.clear();
   m_ActiveEdges = 0;
   m_SortedEdges = 0;
@@ -1193,28 +1231,62 @@ OutPt* Clipper::AllocateOutPt()
     pt = m_OutPtsFree;
     m_OutPtsFree = pt->Next;
   } else if (m_OutPtsChunkLast < m_OutPtsChunkSize) {
-    // Get a point from the last chunk.
-    pt = m_OutPts.back() + (m_OutPtsChunkLast ++);
+    // Get a point from the current chunk.
+    pt = m_OutPts[m_OutPtsChunksUsed - 1] + (m_OutPtsChunkLast ++);
   } else {
-    // The last chunk is full. Allocate a new one.
-    m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
+    // The current chunk is full. Reuse a chunk retained from the previous operation or allocate a new one.
+    if (m_OutPtsChunksUsed == m_OutPts.size())
+      m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
+    pt = m_OutPts[m_OutPtsChunksUsed ++];
     m_OutPtsChunkLast = 1;
-    pt = m_OutPts.back();
   }
   return pt;
 }
 
+OutRec* Clipper::AllocateOutRec()
+{
+  if (m_OutRecsChunkLast == m_OutRecsChunkSize) {
+    // The current chunk is full. Reuse a chunk retained from the previous operation or allocate a new one.
+    if (m_OutRecsChunksUsed == m_OutRecs.size())
+      m_OutRecs.push_back(new OutRec[m_OutRecsChunkSize]);
+    ++ m_OutRecsChunksUsed;
+    m_OutRecsChunkLast = 0;
+  }
+  return m_OutRecs[m_OutRecsChunksUsed - 1] + (m_OutRecsChunkLast ++);
+}
+
+// Upper limit of the number of OutRec / OutPt chunks retained by DisposeAllOutRecs() for reuse.
+static constexpr const size_t MaxRetainedChunks = 256;
+
 void Clipper::DisposeAllOutRecs()
 {
-  for (OutPt *pts : m_OutPts)
-    delete[] pts;
-  for (OutRec *rec : m_PolyOuts)
-    delete rec;
-  m_OutPts.clear();
+  // Keep the chunks for the following operation up to a limit.
+  for (size_t i = MaxRetainedChunks; i < m_OutPts.size(); ++ i)
+    delete[] m_OutPts[i];
+  if (m_OutPts.size() > MaxRetainedChunks)
+    m_OutPts.resize(MaxRetainedChunks);
+  for (size_t i = MaxRetainedChunks; i < m_OutRecs.size(); ++ i)
+    delete[] m_OutRecs[i];
+  if (m_OutRecs.size() > MaxRetainedChunks)
+    m_OutRecs.resize(MaxRetainedChunks);
+  m_OutPtsChunksUsed = 0;
   m_OutPtsFree = nullptr;
   m_OutPtsChunkLast = m_OutPtsChunkSize;
+  m_OutRecsChunksUsed = 0;
+  m_OutRecsChunkLast = m_OutRecsChunkSize;
   m_PolyOuts.clear();
 }
+
+void Clipper::ReleaseOutRecs()
+{
+  DisposeAllOutRecs();
+  for (OutPt *pts : m_OutPts)
+    delete[] pts;
+  m_OutPts.clear();
+  for (OutRec *recs : m_OutRecs)
+    delete[] recs;
+  m_OutRecs.clear();
+}
 //------------------------------------------------------------------------------
 
 void Clipper::SetWindingCount(TEdge &edge) const
@@ -1991,7 +2063,7 @@ void Clipper::AppendPolygon(TEdge *e1, TEdge *e2) const
 
 OutRec* Clipper::CreateOutRec()
 {
-  OutRec* result = new OutRec;
+  OutRec* result = AllocateOutRec();
   result->IsHole = false;
   result->IsOpen = false;
   result->FirstLeft = 0;
@@ -3342,18 +3414,33 @@ DoublePoint GetUnitNormal(const IntPoint &pt1, const IntPoint &pt2)
 
 void ClipperOffset::Clear()
 {
-  for (int i = 0; i < m_polyNodes.ChildCount(); ++i)
-    delete m_polyNodes.Childs[i];
+  // The nodes are owned by m_polyNodesPool, they will be reused by the following AddPath() calls.
   m_polyNodes.Childs.clear();
+  m_polyNodesUsed = 0;
   m_lowest.x() = -1;
 }
 //------------------------------------------------------------------------------
 
+PolyNode* ClipperOffset::AllocatePolyNode()
+{
+  if (m_polyNodesUsed == m_polyNodesPool.size())
+    m_polyNodesPool.emplace_back();
+  PolyNode *node = &m_polyNodesPool[m_polyNodesUsed ++];
+  // Reset a recycled node, keep the capacity of its contour.
+  node->Contour.clear();
+  node->Childs.clear();
+  node->Parent   = nullptr;
+  node->Index    = 0;
+  node->m_IsOpen = false;
+  return node;
+}
+//------------------------------------------------------------------------------
+
 void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType)
 {
   int highI = (int)path.size() - 1;
   if (highI < 0) return;
-  PolyNode* newNode = new PolyNode();
+  PolyNode* newNode = AllocatePolyNode();
   newNode->m_jointype = joinType;
   newNode->m_endtype = endType;
 
@@ -3393,7 +3480,8 @@ void ClipperOffset::AddPath(const Path& path, JoinType joinType, EndType endType
   }
   if (endType == etClosedPolygon && j < 2)
   {
-    delete newNode;
+    // Return the node to the pool, it was the last one taken.
+    -- m_polyNodesUsed;
     return;
   }
   m_polyNodes.AddChild(*newNode);
@@ -3446,7 +3534,9 @@ void ClipperOffset::Execute(Paths& solution, double delta)
   DoOffset(delta);
   
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -3477,7 +3567,9 @@ void ClipperOffset::Execute(PolyTree& solution, double delta)
   DoOffset(delta);
 
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
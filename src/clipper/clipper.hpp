@@ -331,8 +331,8 @@ public:
     if (num_edges_total == 0)
       return false;
 
-    // Allocate a new edge array.
-    std::vector<TEdge> edges(num_edges_total);
+    // Allocate a new edge array or reuse an edge array released by Clear().
+    std::vector<TEdge> edges = AllocateEdges(num_edges_total);
     // Fill in the edge array.
     bool result = false;
     TEdge *p_edge = edges.data();
@@ -350,6 +350,8 @@ public:
     if (result)
       // At least some edges were generated. Remember the edge array.
       m_edges.emplace_back(std::move(edges));
+    else
+      ReleaseEdges(std::move(edges));
     return result;
   }
 
@@ -361,6 +363,10 @@ public:
   void PreserveCollinear(bool value) {m_PreserveCollinear = value;};
 protected:
   bool AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
+  // Allocate an array of num_edges default initialized edges, preferably reusing an array released by Clear().
+  std::vector<TEdge> AllocateEdges(size_t num_edges);
+  // Keep an edge array for reuse unless too much memory is retained already.
+  void ReleaseEdges(std::vector<TEdge> &&edges);
   TEdge* AddBoundsToLML(TEdge *e, bool IsClosed);
   void Reset();
   TEdge* ProcessBound(TEdge* E, bool IsClockwise);
@@ -380,6 +386,11 @@ protected:
 
   // A vector of edges per each input path.
   std::vector<std::vector<TEdge>> m_edges;
+  // Edge arrays released by Clear(), to be reused by the following AddPath() / AddPaths() calls
+  // when the Clipper object is reused for multiple operations. Sorted by ascending capacity.
+  std::vector<std::vector<TEdge>> m_edgesFree;
+  // Sum of capacities of m_edgesFree.
+  size_t           m_edgesFreeCapacity { 0 };
   // Don't remove intermediate vertices of a collinear sequence of points.
   bool             m_PreserveCollinear;
   // Is any of the paths inserted by AddPath() or AddPaths() open?
@@ -391,7 +402,10 @@ class Clipper : public ClipperBase
 {
 public:
   Clipper(int initOptions = 0);
-  ~Clipper() { Clear(); }
+  ~Clipper() { Clear(); ReleaseOutRecs(); }
+  // Clear the input paths. Memory allocated for the edges, output polygons and output points
+  // is retained for the following operations, so that a single Clipper object may be reused
+  // for multiple operations without reallocating its working memory.
   void Clear() { ClipperBase::Clear(); DisposeAllOutRecs(); }
   bool Execute(ClipType clipType,
       Paths &solution,
@@ -422,10 +436,24 @@ protected:
   virtual bool ExecuteInternal();
 private:
   
+  // A priority queue (a binary heap), which keeps its capacity when cleared.
+  class Scanbeam : public std::priority_queue<cInt> {
+  public:
+    void clear() { this->c.clear(); }
+  };
+
   // Output polygons.
   std::vector<OutRec*>  m_PolyOuts;
+  // Output polygons, allocated by a continuous sets of m_OutRecsChunkSize.
+  // Chunks are retained by DisposeAllOutRecs() up to MaxRetainedChunks to be reused by the next operation.
+  std::vector<OutRec*>  m_OutRecs;
+  static constexpr const size_t m_OutRecsChunkSize = 32;
+  size_t                m_OutRecsChunksUsed;
+  size_t                m_OutRecsChunkLast;
   // Output points, allocated by a continuous sets of m_OutPtsChunkSize.
+  // Chunks are retained by DisposeAllOutRecs() up to MaxRetainedChunks to be reused by the next operation.
   std::vector<OutPt*>   m_OutPts;
+  size_t                m_OutPtsChunksUsed;
   // List of free output points, to be used before taking a point from m_OutPts or allocating a new chunk.
   OutPt                *m_OutPtsFree;
   size_t                m_OutPtsChunkSize;
@@ -436,7 +464,7 @@ private:
   std::vector<IntersectNode> m_IntersectList;
   ClipType              m_ClipType;
   // A priority queue (a binary heap) of Y coordinates.
-  std::priority_queue<cInt> m_Scanbeam;
+  Scanbeam              m_Scanbeam;
   // Maxima are collected by ProcessEdgesAtTopOfScanbeam(), consumed by ProcessHorizontal().
   std::vector<cInt>     m_Maxima;
   TEdge                *m_ActiveEdges;
@@ -478,11 +506,14 @@ private:
   OutPt* AddOutPt(TEdge *e, const IntPoint &pt);
   OutPt* GetLastOutPt(TEdge *e);
   OutPt* AllocateOutPt();
+  OutRec* AllocateOutRec();
   OutPt* DupOutPt(OutPt* outPt, bool InsertAfter);
   // Add the point to a list of free points.
   void DisposeOutPt(OutPt *pt) { pt->Next = m_OutPtsFree; m_OutPtsFree = pt; }
   void DisposeOutPts(OutPt*& pp) { if (pp != nullptr) { pp->Prev->Next = m_OutPtsFree; m_OutPtsFree = pp; } }
   void DisposeAllOutRecs();
+  // Release all the memory retained by DisposeAllOutRecs().
+  void ReleaseOutRecs();
   bool ProcessIntersections(const cInt topY);
   void BuildIntersectList(const cInt topY);
   void ProcessEdgesAtTopOfScanbeam(const cInt topY);
@@ -520,12 +551,17 @@ public:
   }
   void Execute(Paths& solution, double delta);
   void Execute(PolyTree& solution, double delta);
+  // Clear the input paths. The input path nodes and the working memory of the internal Clipper
+  // are retained for the following operations.
   void Clear();
   double MiterLimit;
   double ArcTolerance;
   double ShortestEdgeLength;
 
 private:
+  // Take an input path node from m_polyNodesPool.
+  PolyNode* AllocatePolyNode();
+
   Paths m_destPolys;
   Path m_srcPoly;
   Path m_destPoly;
@@ -536,6 +572,11 @@ private:
   // y: index of the lowest point in the lowest contour
   IntPoint m_lowest;
   PolyNode m_polyNodes;
+  // Storage of the input path nodes referenced by m_polyNodes.Childs, the first m_polyNodesUsed are in use.
+  std::deque<PolyNode> m_polyNodesPool;
+  size_t   m_polyNodesUsed { 0 };
+  // Clipper to clean up the offsetted paths, reused by the Execute() calls.
+  Clipper  m_clipper;
 
   void FixOrientations();
   void DoOffset(double delta);
@@ -8,6 +8,8 @@
 #include <iterator>
 #include <future>
 #include <atomic>
+#include <numeric>
+#include <unordered_map>
 
 #ifndef NDEBUG
 #include <iostream>
@@ -89,6 +91,18 @@ struct NfpPConfig {
      */
     bool parallel = true;
 
+    /**
+     * @brief The maximum number of starting points of the local optimization
+     * when placing an item, zero for no limit.
+     *
+     * Every vertex of the nfp may be a starting point (depending on the
+     * accuracy), so with many items in the bin most of the time is spent
+     * optimizing. If limited, all the starting points are scored first and
+     * only the best ones are optimized. This is a lot faster for large piles
+     * while the placement is only slightly worse.
+     */
+    unsigned max_starting_points = 0;
+
     /**
      * @brief before_packing Callback that is called just before a search for
      * a new item's position is started. You can use this to create various
@@ -320,6 +334,128 @@ public:
 
 };
 
+/**
+ * A cache of no-fit polygons for items of identical shapes.
+ *
+ * The nfp moves with the fixed item and does not depend on the translation
+ * of the orbiting item, thus it is stored for the shapes of the items with
+ * zero translation. Items of identical shapes (e.g. instances of the same object)
+ * share their nfps: The nfp against several fixed items of the same shape is
+ * calculated only once and so are the nfps of an orbiting item of the same
+ * shape as the previous one. The selections place the items of identical
+ * shapes one after the other, so only the nfps of the orbiting items of a
+ * single shape (at all the tried rotations) are kept.
+ */
+template<class RawShape> class NfpCache {
+    using Vertex = TPoint<RawShape>;
+    using Coord = TCoord<Vertex>;
+    using Item = _Item<RawShape>;
+
+    struct Entry {
+        RawShape fixed;     // shape of the fixed item with zero translation
+        RawShape orbiter;   // shape of the orbiting item with zero translation
+        RawShape nfp;       // nfp around the fixed shape
+    };
+
+    std::unordered_multimap<size_t, Entry> entries_;
+
+    // The raw shape of the orbiting items of the cached nfps
+    RawShape orbiter_;
+    Coord orbiter_inflation_ = 0;
+
+    template<class It>
+    static bool equal(It from1, It to1, It from2, It to2)
+    {
+        return std::equal(from1, to1, from2, to2,
+                          [](const Vertex& v1, const Vertex& v2) {
+            return getX(v1) == getX(v2) && getY(v1) == getY(v2);
+        });
+    }
+
+public:
+
+    static bool equal(const RawShape& sh1, const RawShape& sh2)
+    {
+        if(!equal(shapelike::cbegin(sh1), shapelike::cend(sh1),
+                  shapelike::cbegin(sh2), shapelike::cend(sh2)) ||
+           shapelike::holeCount(sh1) != shapelike::holeCount(sh2))
+            return false;
+
+        auto& holes1 = shapelike::holes(sh1);
+        auto& holes2 = shapelike::holes(sh2);
+        for(size_t i = 0; i < shapelike::holeCount(sh1); ++i)
+            if(!equal(holes1[i].begin(), holes1[i].end(),
+                      holes2[i].begin(), holes2[i].end()))
+                return false;
+
+        return true;
+    }
+
+    static size_t hash(const RawShape& sh)
+    {
+        size_t seed = shapelike::contourVertexCount(sh);
+        auto combine = [&seed](Coord c) {
+            seed ^= std::hash<Coord>{}(c) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        };
+        for(auto it = shapelike::cbegin(sh); it != shapelike::cend(sh); ++it) {
+            combine(getX(*it));
+            combine(getY(*it));
+        }
+        return seed;
+    }
+
+    static size_t hash(const RawShape& fixed, const RawShape& orbiter)
+    {
+        size_t seed = hash(fixed);
+        return seed ^ (hash(orbiter) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+    }
+
+    /// The transformed shape of the item with zero translation.
+    static RawShape untranslated(const Item& item)
+    {
+        RawShape ret = item.transformedShape();
+        auto tr = item.translation();
+        shapelike::translate(ret, Vertex(-getX(tr), -getY(tr)));
+        return ret;
+    }
+
+    /// Drops the cached nfps if the orbiting item is of another shape than
+    /// the previous one.
+    void orbiter(const Item& item)
+    {
+        if(item.inflation() != orbiter_inflation_ ||
+           !equal(item.rawShape(), orbiter_)) {
+            entries_.clear();
+            orbiter_ = item.rawShape();
+            orbiter_inflation_ = item.inflation();
+        }
+    }
+
+    /// The nfp of untranslated shapes, nullptr if not cached.
+    const RawShape* find(size_t key,
+                         const RawShape& fixed,
+                         const RawShape& orbiter) const
+    {
+        auto range = entries_.equal_range(key);
+        for(auto it = range.first; it != range.second; ++it)
+            if(equal(it->second.fixed, fixed) &&
+               equal(it->second.orbiter, orbiter))
+                return &it->second.nfp;
+
+        return nullptr;
+    }
+
+    const RawShape& insert(size_t key,
+                           RawShape&& fixed,
+                           const RawShape& orbiter,
+                           RawShape&& nfp)
+    {
+        auto it = entries_.emplace(key, Entry{std::move(fixed), orbiter,
+                                              std::move(nfp)});
+        return it->second.nfp;
+    }
+};
+
 template<nfp::NfpLevel lvl>
 struct Lvl { static const nfp::NfpLevel value = lvl; };
 
@@ -440,6 +576,7 @@ private:
     // Norming factor for the optimization function
     const double norm_;
     Pile merged_pile_;
+    NfpCache<RawShape> nfp_cache_;
 
 public:
 
@@ -558,16 +695,63 @@ private:
         }
         // /////////////////////////////////////////////////////////////////////
 
-        __parallel::enumerate(items_.begin(), items_.end(),
-                              [&nfps, &trsh](const Item& sh, size_t n)
+        // Look up the nfps in the cache. The missing ones are calculated only
+        // once for each distinct shape of the fixed items.
+        using Cache = NfpCache<RawShape>;
+        nfp_cache_.orbiter(trsh);
+        RawShape orbsh = Cache::untranslated(trsh);
+
+        std::vector<const RawShape*> cached(items_.size(), nullptr);
+        std::vector<size_t> missing_idx(items_.size());
+        std::vector<size_t> missing;        // item to calculate the nfp with
+        std::vector<size_t> missing_keys;
+        Shapes missing_shapes;
+
+        for(size_t n = 0; n < items_.size(); ++n) {
+            RawShape fixedsh = Cache::untranslated(items_[n]);
+            size_t key = Cache::hash(fixedsh, orbsh);
+            if((cached[n] = nfp_cache_.find(key, fixedsh, orbsh)))
+                continue;
+
+            size_t m = 0;
+            while(m < missing.size() && (missing_keys[m] != key ||
+                  !Cache::equal(missing_shapes[m], fixedsh)))
+                ++m;
+
+            if(m == missing.size()) {
+                missing.emplace_back(n);
+                missing_keys.emplace_back(key);
+                missing_shapes.emplace_back(std::move(fixedsh));
+            }
+            missing_idx[n] = m;
+        }
+
+        Shapes missing_nfps(missing.size());
+        __parallel::enumerate(missing.begin(), missing.end(),
+                              [this, &missing_nfps, &trsh](size_t idx, size_t m)
         {
+            const Item& sh = items_[idx];
             auto& fixedp = sh.transformedShape();
             auto& orbp = trsh.transformedShape();
             auto subnfp_r = noFitPolygon<NfpLevel::CONVEX_ONLY>(fixedp, orbp);
             correctNfpPosition(subnfp_r, sh, trsh);
-            nfps[n] = subnfp_r.first;
+            auto tr = sh.translation();
+            sl::translate(subnfp_r.first, Vertex(-getX(tr), -getY(tr)));
+            missing_nfps[m] = std::move(subnfp_r.first);
         });
 
+        std::vector<const RawShape*> calculated(missing.size());
+        for(size_t m = 0; m < missing.size(); ++m)
+            calculated[m] = &nfp_cache_.insert(missing_keys[m],
+                                               std::move(missing_shapes[m]),
+                                               orbsh,
+                                               std::move(missing_nfps[m]));
+
+        for(size_t n = 0; n < items_.size(); ++n) {
+            nfps[n] = cached[n] ? *cached[n] : *calculated[missing_idx[n]];
+            sl::translate(nfps[n], items_[n].get().translation());
+        }
+
         return nfp::merge(nfps);
     }
 
@@ -692,6 +876,9 @@ public:
         } else {
 
             Pile merged_pile = merged_pile_;
+            RawShape pile_hull;
+            if constexpr (!std::is_same_v<TBin, Box>)
+                pile_hull = sl::convexHull(merged_pile);
 
             for(auto rot : config_.rotations) {
 
@@ -734,21 +921,33 @@ public:
 
                 auto alignment = config_.alignment;
 
-                auto boundaryCheck = [alignment, &merged_pile, &getNfpPoint,
+                // The convex hull of the pile with the candidate item has to
+                // fit into the bin. For a box shaped bin, only the bounding
+                // box of the hull matters, which is the bounding box of the
+                // pile extended by the item. Otherwise the hull is calculated
+                // from the hull of the pile, which is the same for all the
+                // candidates.
+                auto boundaryCheck = [alignment, &pile_hull, &pbb, &getNfpPoint,
                         &item, &bin, &iv, &startpos] (const Optimum& o)
                 {
                     auto v = getNfpPoint(o);
                     auto d = (v - iv) + startpos;
                     item.translation(d);
 
-                    merged_pile.emplace_back(item.transformedShape());
-                    auto chull = sl::convexHull(merged_pile);
-                    merged_pile.pop_back();
-
                     double miss = 0;
-                    if(alignment == Config::Alignment::DONT_ALIGN)
-                       miss = sl::isInside(chull, bin) ? -1.0 : 1.0;
-                    else miss = overfit(chull, bin);
+                    if constexpr (std::is_same_v<TBin, Box>) {
+                        auto fullbb = sl::boundingBox(pbb, item.boundingBox());
+                        if(alignment == Config::Alignment::DONT_ALIGN)
+                            miss = sl::isInside(fullbb, bin) ? -1.0 : 1.0;
+                        else miss = overfit(fullbb, bin);
+                    } else {
+                        auto chull = sl::convexHull(
+                            Shapes{pile_hull, item.transformedShape()});
+
+                        if(alignment == Config::Alignment::DONT_ALIGN)
+                            miss = sl::isInside(chull, bin) ? -1.0 : 1.0;
+                        else miss = overfit(chull, bin);
+                    }
 
                     return miss;
                 };
@@ -764,53 +963,106 @@ public:
                 using OptResult = opt::Result<double>;
                 using OptResults = std::vector<OptResult>;
 
-                // Local optimization with the four polygon corners as
-                // starting points
+                // Local optimization with the corners of each nfp contour and
+                // hole as starting points. All of them are optimized in a
+                // single parallel run, the best result of each contour is
+                // then checked against the bin in the original order.
+                struct Start { unsigned ch; int hidx; double pos; };
+                std::vector<Start> starts;
                 for(unsigned ch = 0; ch < ecache.size(); ch++) {
                     auto& cache = ecache[ch];
+                    for(double pos : cache.corners())
+                        starts.push_back({ch, -1, pos});
+                    for(unsigned hidx = 0; hidx < cache.holeCount(); ++hidx)
+                        for(double pos : cache.corners(hidx))
+                            starts.push_back({ch, int(hidx), pos});
+                }
 
-                    OptResults results(cache.corners().size());
-
-                    auto& rofn = rawobjfunc;
-                    auto& nfpoint = getNfpPoint;
-                    float accuracy = config_.accuracy;
-
+                if(config_.max_starting_points > 0 &&
+                   starts.size() > config_.max_starting_points)
+                {
+                    std::vector<double> scores(starts.size());
                     __parallel::enumerate(
-                                cache.corners().begin(),
-                                cache.corners().end(),
-                                [&results, &item, &rofn, &nfpoint, ch, accuracy]
-                                (double pos, size_t n)
+                                starts.begin(),
+                                starts.end(),
+                                [&scores, &item, &rawobjfunc, &getNfpPoint]
+                                (const Start& start, size_t n)
                     {
-                        Optimizer solver(accuracy);
-
                         Item itemcpy = item;
-                        auto contour_ofn = [&rofn, &nfpoint, ch, &itemcpy]
-                                (double relpos)
-                        {
-                            Optimum op(relpos, ch);
-                            return rofn(nfpoint(op), itemcpy);
-                        };
-
-                        try {
-                            results[n] = solver.optimize_min(contour_ofn,
-                                            opt::initvals<double>(pos),
-                                            opt::bound<double>(0, 1.0)
-                                            );
-                        } catch(std::exception& e) {
-                            derr() << "ERROR: " << e.what() << "\n";
-                        }
+                        Optimum op(start.pos, start.ch, start.hidx);
+                        scores[n] = rawobjfunc(getNfpPoint(op), itemcpy);
                     }, policy);
 
-                    auto resultcomp =
-                            []( const OptResult& r1, const OptResult& r2 ) {
-                        return r1.score < r2.score;
+                    std::vector<size_t> idx(starts.size());
+                    std::iota(idx.begin(), idx.end(), size_t(0));
+                    auto nth = idx.begin() + config_.max_starting_points;
+                    std::nth_element(idx.begin(), nth, idx.end(),
+                                     [&scores](size_t i, size_t j) {
+                        return scores[i] < scores[j];
+                    });
+
+                    // Keep the order of the contours for the checks below.
+                    idx.erase(nth, idx.end());
+                    std::sort(idx.begin(), idx.end());
+                    std::vector<Start> best;
+                    best.reserve(idx.size());
+                    for(size_t i : idx) best.emplace_back(starts[i]);
+                    starts = std::move(best);
+                }
+
+                OptResults results(starts.size());
+
+                auto& rofn = rawobjfunc;
+                auto& nfpoint = getNfpPoint;
+                float accuracy = config_.accuracy;
+
+                __parallel::enumerate(
+                            starts.begin(),
+                            starts.end(),
+                            [&results, &item, &rofn, &nfpoint, accuracy]
+                            (const Start& start, size_t n)
+                {
+                    Optimizer solver(accuracy);
+
+                    Item itemcpy = item;
+                    auto contour_ofn = [&rofn, &nfpoint, &start, &itemcpy]
+                            (double relpos)
+                    {
+                        Optimum op(relpos, start.ch, start.hidx);
+                        return rofn(nfpoint(op), itemcpy);
                     };
 
-                    auto mr = *std::min_element(results.begin(), results.end(),
+                    try {
+                        results[n] = solver.optimize_min(contour_ofn,
+                                        opt::initvals<double>(start.pos),
+                                        opt::bound<double>(0, 1.0)
+                                        );
+                    } catch(std::exception& e) {
+                        derr() << "ERROR: " << e.what() << "\n";
+                    }
+                }, policy);
+
+                auto resultcomp =
+                        []( const OptResult& r1, const OptResult& r2 ) {
+                    return r1.score < r2.score;
+                };
+
+                for(size_t first = 0, last = 0; first < starts.size();
+                    first = last)
+                {
+                    const Start& start = starts[first];
+                    while(last < starts.size() &&
+                          starts[last].ch == start.ch &&
+                          starts[last].hidx == start.hidx)
+                        ++last;
+
+                    auto mr = *std::min_element(results.begin() + first,
+                                                results.begin() + last,
                                                 resultcomp);
 
                     if(mr.score < best_score) {
-                        Optimum o(std::get<0>(mr.optimum), ch, -1);
+                        Optimum o(std::get<0>(mr.optimum), start.ch,
+                                  start.hidx);
                         double miss = boundaryCheck(o);
                         if(miss <= 0) {
                             best_score = mr.score;
@@ -819,56 +1071,6 @@ public:
                             best_overfit = std::min(miss, best_overfit);
                         }
                     }
-
-                    for(unsigned hidx = 0; hidx < cache.holeCount(); ++hidx) {
-                        results.clear();
-                        results.resize(cache.corners(hidx).size());
-
-                        // TODO : use parallel for
-                        __parallel::enumerate(cache.corners(hidx).begin(),
-                                      cache.corners(hidx).end(),
-                                      [&results, &item, &nfpoint,
-                                       &rofn, ch, hidx, accuracy]
-                                      (double pos, size_t n)
-                        {
-                            Optimizer solver(accuracy);
-
-                            Item itmcpy = item;
-                            auto hole_ofn =
-                                    [&rofn, &nfpoint, ch, hidx, &itmcpy]
-                                    (double pos)
-                            {
-                                Optimum opt(pos, ch, hidx);
-                                return rofn(nfpoint(opt), itmcpy);
-                            };
-
-                            try {
-                                results[n] = solver.optimize_min(hole_ofn,
-                                                opt::initvals<double>(pos),
-                                                opt::bound<double>(0, 1.0)
-                                                );
-
-                            } catch(std::exception& e) {
-                                derr() << "ERROR: " << e.what() << "\n";
-                            }
-                        }, policy);
-
-                        auto hmr = *std::min_element(results.begin(),
-                                                    results.end(),
-                                                    resultcomp);
-
-                        if(hmr.score < best_score) {
-                            Optimum o(std::get<0>(hmr.optimum),
-                                      ch, hidx);
-                            double miss = boundaryCheck(o);
-                            if(miss <= 0.0) {
-                                best_score = hmr.score;
-                                optimum = o;
-                            } else {
-                                best_overfit = std::min(miss, best_overfit);
-                            }
-                        }
-                    }
                 }
 
                 if( best_score < global_score ) {
@@ -103,6 +103,8 @@ void fill_config(PConf& pcfg, const ArrangeParams &params) {
     
     // Allow parallel execution.
     pcfg.parallel = params.parallel;
+
+    pcfg.max_starting_points = params.max_candidates;
 }
 
 // Apply penalty to object function result. This is used only when alignment
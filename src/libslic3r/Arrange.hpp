@@ -93,6 +93,11 @@ struct ArrangeParams {
 
     bool allow_rotations = false;
 
+    /// Fast arrangement of many items: The maximum number of candidate
+    /// positions of an item refined by the optimization, the best scored
+    /// ones are chosen. Zero refines all of them.
+    unsigned max_candidates = 0;
+
     /// Progress indicator callback called when an object gets packed. 
     /// The unsigned argument is the number of items remaining to pack.
     std::function<void(unsigned)> progressind;
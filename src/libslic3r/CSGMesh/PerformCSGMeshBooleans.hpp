@@ -1,6 +1,8 @@
 #ifndef PERFORMCSGMESHBOOLEANS_HPP
 #define PERFORMCSGMESHBOOLEANS_HPP
 
+#include <algorithm>
+#include <memory>
 #include <stack>
 #include <vector>
 
@@ -52,6 +54,19 @@ inline void perform_csg(CSGType op, CGALMeshPtr &dst, CGALMeshPtr &src)
     if (!dst || !src)
         return;
 
+    // Don't bother CGAL with empty operands.
+    if (MeshBoolean::cgal::empty(*dst)) {
+        if (op == CSGType::Union)
+            dst = std::move(src);
+        return;
+    }
+
+    if (MeshBoolean::cgal::empty(*src)) {
+        if (op == CSGType::Intersection)
+            dst = std::move(src);
+        return;
+    }
+
     switch (op) {
     case CSGType::Union:
         MeshBoolean::cgal::plus(*dst, *src);
@@ -65,6 +80,32 @@ inline void perform_csg(CSGType op, CGALMeshPtr &dst, CGALMeshPtr &src)
     }
 }
 
+// Merge the meshes with the given operation (Union or Intersection) pairwise,
+// the pairs of each level of the reduction tree being processed in parallel.
+// Null meshes are skipped, the result is null if all of them are null.
+template<class Ex>
+CGALMeshPtr perform_csg_reduce(Ex policy, CSGType op, std::vector<CGALMeshPtr> &&meshes)
+{
+    meshes.erase(std::remove(meshes.begin(), meshes.end(), nullptr), meshes.end());
+
+    while (meshes.size() > 1) {
+        size_t npairs = meshes.size() / 2;
+        execution::for_each(policy, size_t(0), npairs, [&meshes, op](size_t i) {
+            perform_csg(op, meshes[2 * i], meshes[2 * i + 1]);
+        });
+
+        for (size_t i = 0; i < npairs; ++i)
+            meshes[i] = std::move(meshes[2 * i]);
+
+        if (meshes.size() % 2)
+            meshes[npairs++] = std::move(meshes.back());
+
+        meshes.resize(npairs);
+    }
+
+    return meshes.empty() ? nullptr : std::move(meshes.front());
+}
+
 template<class Ex, class It>
 std::vector<CGALMeshPtr> get_cgalptrs(Ex policy, const Range<It> &csgrange)
 {
@@ -80,96 +121,136 @@ std::vector<CGALMeshPtr> get_cgalptrs(Ex policy, const Range<It> &csgrange)
     return ret;
 }
 
+// The CSG parts between a stack push and the corresponding pop form
+// a frame, which is an operand of the enclosing frame. Frames are
+// independent of each other up to the point where their result is used.
+struct CSGFrame;
+
+struct CSGOperand {
+    CSGType                   op;
+    CGALMeshPtr               cgalptr;
+    std::unique_ptr<CSGFrame> frame;
+};
+
+struct CSGFrame {
+    std::vector<CSGOperand> operands;
+};
+
+template<class Ex>
+CGALMeshPtr perform_csg_frame(Ex policy, CSGFrame &frame)
+{
+    std::vector<CSGOperand> &operands = frame.operands;
+
+    // Nested frames first, in parallel.
+    std::vector<size_t> nested;
+    for (size_t i = 0; i < operands.size(); ++i)
+        if (operands[i].frame)
+            nested.emplace_back(i);
+
+    execution::for_each(policy, size_t(0), nested.size(),
+                        [policy, &operands, &nested](size_t i) {
+        CSGOperand &operand = operands[nested[i]];
+        operand.cgalptr = perform_csg_frame(policy, *operand.frame);
+    });
+
+    auto ret = MeshBoolean::cgal::triangle_mesh_to_cgal(indexed_triangle_set{});
+
+    // A run of the same operation applied to the result is merged into
+    // a single operand first: A - B - C == A - (B + C)
+    for (size_t i = 0; i < operands.size();) {
+        CSGType op = operands[i].op;
+        std::vector<CGALMeshPtr> run;
+        for (; i < operands.size() && operands[i].op == op; ++i)
+            run.emplace_back(std::move(operands[i].cgalptr));
+
+        CSGType mergeop = op == CSGType::Intersection ? CSGType::Intersection :
+                                                        CSGType::Union;
+        CGALMeshPtr src = perform_csg_reduce(policy, mergeop, std::move(run));
+        perform_csg(op, ret, src);
+    }
+
+    return ret;
+}
+
 } // namespace detail
 
-// Process the sequence of CSG parts with CGAL.
+// Process the sequence of CSG parts with CGAL. The independent sub-trees of
+// the operations (stack frames, runs of the same operation) are evaluated
+// in parallel.
 template<class It>
 void perform_csgmesh_booleans(MeshBoolean::cgal::CGALMeshPtr &cgalm,
                               const Range<It>                &csgrange)
 {
-    using MeshBoolean::cgal::CGALMesh;
     using MeshBoolean::cgal::CGALMeshPtr;
     using namespace detail_cgal;
 
-    struct Frame {
-        CSGType op; CGALMeshPtr cgalptr;
-        explicit Frame(CSGType csgop = CSGType::Union)
-            : op{csgop}
-            , cgalptr{MeshBoolean::cgal::triangle_mesh_to_cgal(indexed_triangle_set{})}
-        {}
-    };
-
-    std::stack opstack{std::vector<Frame>{}};
-
-    opstack.push(Frame{});
-
     std::vector<CGALMeshPtr> cgalmeshes = get_cgalptrs(ex_tbb, csgrange);
 
+    CSGFrame root;
+    std::stack opstack{std::vector<CSGFrame *>{}};
+    opstack.push(&root);
+
     size_t csgidx = 0;
     for (auto &csgpart : csgrange) {
-
         auto op = get_operation(csgpart);
         CGALMeshPtr &cgalptr = cgalmeshes[csgidx++];
 
         if (get_stack_operation(csgpart) == CSGStackOp::Push) {
-            opstack.push(Frame{op});
-            op = CSGType::Union;
+            auto frame = std::make_unique<CSGFrame>();
+            CSGFrame *top = frame.get();
+            opstack.top()->operands.push_back({op, nullptr, std::move(frame)});
+            opstack.push(top);
         }
 
-        Frame *top = &opstack.top();
-
-        perform_csg(get_operation(csgpart), top->cgalptr, cgalptr);
+        opstack.top()->operands.push_back({op, std::move(cgalptr), nullptr});
 
-        if (get_stack_operation(csgpart) == CSGStackOp::Pop) {
-            CGALMeshPtr src = std::move(top->cgalptr);
-            auto popop = opstack.top().op;
+        if (get_stack_operation(csgpart) == CSGStackOp::Pop && opstack.size() > 1)
             opstack.pop();
-            CGALMeshPtr &dst = opstack.top().cgalptr;
-            perform_csg(popop, dst, src);
-        }
     }
 
-    cgalm = std::move(opstack.top().cgalptr);
+    cgalm = perform_csg_frame(ex_tbb, root);
+}
+
+// Returns true if the mesh is suitable for CGAL booleans.
+inline bool check_cgalmesh(const MeshBoolean::cgal::CGALMesh &m)
+{
+    try {
+        return !MeshBoolean::cgal::empty(m) &&
+               MeshBoolean::cgal::does_bound_a_volume(m) &&
+               !MeshBoolean::cgal::does_self_intersect(m);
+    }
+    catch (...) { return false; }
+}
+
+// This method can be overriden when a specific CSGPart type supports caching
+// of the result of the check, which is expensive for large meshes.
+template<class CSGPartT>
+bool is_cgalmesh_valid(const CSGPartT &csgpart)
+{
+    auto m = get_cgalmesh(csgpart);
+
+    return m && check_cgalmesh(*m);
 }
 
 template<class It, class Visitor>
 It check_csgmesh_booleans(const Range<It> &csgrange, Visitor &&vfn)
 {
-    using namespace detail_cgal;
-
-    std::vector<CGALMeshPtr> cgalmeshes(csgrange.size());
-    auto check_part = [&csgrange, &cgalmeshes](size_t i)
+    std::vector<char> valid(csgrange.size(), false);
+    auto check_part = [&csgrange, &valid](size_t i)
     {
         auto it = csgrange.begin();
         std::advance(it, i);
         auto &csgpart = *it;
-        auto m = get_cgalmesh(csgpart);
 
         // mesh can be nullptr if this is a stack push or pull
-        if (!get_mesh(csgpart) && get_stack_operation(csgpart) != CSGStackOp::Continue) {
-            cgalmeshes[i] = MeshBoolean::cgal::triangle_mesh_to_cgal(indexed_triangle_set{});
-            return;
-        }
-
-        try {
-            if (!m || MeshBoolean::cgal::empty(*m))
-                return;
-
-            if (!MeshBoolean::cgal::does_bound_a_volume(*m))
-                return;
-
-            if (MeshBoolean::cgal::does_self_intersect(*m))
-                return;
-        }
-        catch (...) { return; }
-
-        cgalmeshes[i] = std::move(m);
+        valid[i] = (!get_mesh(csgpart) && get_stack_operation(csgpart) != CSGStackOp::Continue) ||
+                   is_cgalmesh_valid(csgpart);
     };
     execution::for_each(ex_tbb, size_t(0), csgrange.size(), check_part);
 
     It ret = csgrange.end();
     for (size_t i = 0; i < csgrange.size(); ++i) {
-        if (!cgalmeshes[i]) {
+        if (!valid[i]) {
             auto it = csgrange.begin();
             std::advance(it, i);
             vfn(it);
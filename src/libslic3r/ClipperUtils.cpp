@@ -5,6 +5,9 @@
 // #define CLIPPER_UTILS_DEBUG
 
 #ifdef CLIPPER_UTILS_DEBUG
+#include <atomic>
+#include <cstdlib>
+#include <string>
 #include "SVG.hpp"
 #endif /* CLIPPER_UTILS_DEBUG */
 
@@ -14,6 +17,7 @@ namespace Slic3r {
 
 #ifdef CLIPPER_UTILS_DEBUG
 // For debugging the Clipper library, for providing bug reports to the Clipper author.
+// The recorded files may be replayed by the bench_geometry sandbox to benchmark the ClipperUtils operations.
 bool export_clipper_input_polygons_bin(const char *path, const ClipperLib::Paths &input_subject, const ClipperLib::Paths &input_clip)
 {
     FILE *pfile = fopen(path, "wb");
@@ -43,6 +47,36 @@ err:
     ::fclose(pfile);
     return false;
 }
+
+// Records the input of each Clipper boolean operation into the directory given by the SLIC3R_CLIPPER_CAPTURE_DIR
+// environment variable as clipper_<N>.bin. Nothing is recorded if the variable is not set.
+static const char* clipper_capture_dir()
+{
+    static const char *dir = ::getenv("SLIC3R_CLIPPER_CAPTURE_DIR");
+    return dir;
+}
+
+// Shared by all instances of capture_clipper_input().
+static std::string next_clipper_capture_path()
+{
+    static std::atomic<size_t> num_captured { 0 };
+    return std::string(clipper_capture_dir()) + "/clipper_" + std::to_string(num_captured ++) + ".bin";
+}
+
+template<class TSubj, class TClip>
+static void capture_clipper_input(const TSubj &subject, const TClip &clip)
+{
+    if (clipper_capture_dir() == nullptr)
+        return;
+    auto to_paths = [](const auto &paths_provider) {
+        ClipperLib::Paths out;
+        out.reserve(paths_provider.size());
+        for (const ClipperLib::Path &path : paths_provider)
+            out.emplace_back(path);
+        return out;
+    };
+    export_clipper_input_polygons_bin(next_clipper_capture_path().c_str(), to_paths(subject), to_paths(clip));
+}
 #endif /* CLIPPER_UTILS_DEBUG */
 
 namespace ClipperUtils {
@@ -254,12 +288,68 @@ bool has_duplicate_points(const ClipperLib::PolyTree &polytree)
 }
 #endif
 
+// Thread local pool of Clipper / ClipperOffset engines. A pooled engine keeps its working memory
+// (edges, output polygons and points, scan beam, offset path nodes) between the operations, saving
+// the heap allocations of constructing and destructing an engine for each ClipperUtils call.
+// An engine is leased for the duration of a single operation. A nested operation on the same thread
+// leases another engine, thus the leases are reentrant.
+template<typename Engine>
+class ClipperEngineLease
+{
+public:
+    ClipperEngineLease() {
+        std::vector<std::unique_ptr<Engine>> &pool = free_engines();
+        if (pool.empty())
+            m_engine = std::make_unique<Engine>();
+        else {
+            m_engine = std::move(pool.back());
+            pool.pop_back();
+        }
+        reset_options(*m_engine);
+    }
+    ~ClipperEngineLease() {
+        m_engine->Clear();
+        if (std::vector<std::unique_ptr<Engine>> &pool = free_engines(); pool.size() < MaxFreeEngines)
+            pool.emplace_back(std::move(m_engine));
+    }
+    ClipperEngineLease(const ClipperEngineLease &) = delete;
+    ClipperEngineLease& operator=(const ClipperEngineLease &) = delete;
+
+    Engine& operator*()  { return *m_engine; }
+    Engine* operator->() { return m_engine.get(); }
+
+private:
+    // Number of engines retained per thread. More engines are only needed by nested operations.
+    static constexpr const size_t MaxFreeEngines = 4;
+
+    static std::vector<std::unique_ptr<Engine>>& free_engines() {
+        static thread_local std::vector<std::unique_ptr<Engine>> engines;
+        return engines;
+    }
+    // Restore the options possibly modified by the previous user of the engine to the defaults of a new engine.
+    static void reset_options(ClipperLib::Clipper &clipper) {
+        clipper.ReverseSolution(false);
+        clipper.StrictlySimple(false);
+        clipper.PreserveCollinear(false);
+    }
+    static void reset_options(ClipperLib::ClipperOffset &co) {
+        co.MiterLimit         = 2.;
+        co.ArcTolerance       = 0.25;
+        co.ShortestEdgeLength = 0.;
+    }
+
+    std::unique_ptr<Engine> m_engine;
+};
+using ClipperLease       = ClipperEngineLease<ClipperLib::Clipper>;
+using ClipperOffsetLease = ClipperEngineLease<ClipperLib::ClipperOffset>;
+
 // Offset CCW contours outside, CW contours (holes) inside.
 // Don't calculate union of the output paths.
 template<typename PathsProvider, ClipperLib::EndType endType = ClipperLib::etClosedPolygon>
 static ClipperLib::Paths raw_offset(PathsProvider &&paths, float offset, ClipperLib::JoinType joinType, double miterLimit)
 {
-    ClipperLib::ClipperOffset co;
+    ClipperOffsetLease lease;
+    ClipperLib::ClipperOffset &co = *lease;
     ClipperLib::Paths out;
     out.reserve(paths.size());
     ClipperLib::Paths out_this;
@@ -300,7 +390,11 @@ TResult clipper_do(
     TClip &&                       clip,
     const ClipperLib::PolyFillType fillType)
 {
-    ClipperLib::Clipper clipper;
+#ifdef CLIPPER_UTILS_DEBUG
+    capture_clipper_input(subject, clip);
+#endif /* CLIPPER_UTILS_DEBUG */
+    ClipperLease lease;
+    ClipperLib::Clipper &clipper = *lease;
     clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
     clipper.AddPaths(std::forward<TClip>(clip),    ClipperLib::ptClip,    true);
     TResult retval;
@@ -329,7 +423,11 @@ TResult clipper_union(
     // fillType pftNonZero and pftPositive "should" produce the same result for "normalized with implicit union" set of polygons
     const ClipperLib::PolyFillType fillType = ClipperLib::pftNonZero)
 {
-    ClipperLib::Clipper clipper;
+#ifdef CLIPPER_UTILS_DEBUG
+    capture_clipper_input(subject, ClipperUtils::EmptyPathsProvider());
+#endif /* CLIPPER_UTILS_DEBUG */
+    ClipperLease lease;
+    ClipperLib::Clipper &clipper = *lease;
     clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
     TResult retval;
     clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
@@ -370,7 +468,8 @@ static TResult shrink_paths(PathsProvider &&paths, float offset, ClipperLib::Joi
     assert(offset > 0);
     TResult out;
     if (auto raw = raw_offset(std::forward<PathsProvider>(paths), - offset, joinType, miterLimit); ! raw.empty()) {
-        ClipperLib::Clipper clipper;
+        ClipperLease lease;
+        ClipperLib::Clipper &clipper = *lease;
         clipper.AddPaths(raw, ClipperLib::ptSubject, true);
         ClipperLib::IntRect r = clipper.GetBounds();
         clipper.AddPath({ { r.left - 10, r.bottom + 10 }, { r.right + 10, r.bottom + 10 }, { r.right + 10, r.top - 10 }, { r.left - 10, r.top - 10 } }, ClipperLib::ptSubject, true);
@@ -409,7 +508,8 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
     // 1) Offset the outer contour.
     ClipperLib::Paths contours;
     {
-        ClipperLib::ClipperOffset co;
+        ClipperOffsetLease lease;
+        ClipperLib::ClipperOffset &co = *lease;
         if (joinType == jtRound)
             co.ArcTolerance = miterLimit;
         else
@@ -429,8 +529,10 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
         // 2) Offset the holes one by one, collect the offsetted holes.
         ClipperLib::Paths holes;
         {
+            ClipperOffsetLease lease;
+            ClipperLib::ClipperOffset &co = *lease;
             for (const Polygon &hole : expoly.holes) {
-                ClipperLib::ClipperOffset co;
+                co.Clear();
                 if (joinType == jtRound)
                     co.ArcTolerance = miterLimit;
                 else
@@ -743,7 +845,8 @@ Slic3r::ExPolygons union_ex(const Slic3r::Surfaces &subject)
 template<typename PathsProvider1, typename PathsProvider2>
 Polylines _clipper_pl_open(ClipperLib::ClipType clipType, PathsProvider1 &&subject, PathsProvider2 &&clip)
 {
-    ClipperLib::Clipper clipper;
+    ClipperLease lease;
+    ClipperLib::Clipper &clipper = *lease;
     clipper.AddPaths(std::forward<PathsProvider1>(subject), ClipperLib::ptSubject, false);
     clipper.AddPaths(std::forward<PathsProvider2>(clip), ClipperLib::ptClip, true);
     ClipperLib::PolyTree retval;
@@ -487,28 +487,57 @@ void ConfigBase::apply_only(const ConfigBase &other, const t_config_option_keys
     }
 }
 
+// Iterate over options present in both configs, in the order of this->keys().
+// If both configs provide their options sorted, the two sorted sequences are merged, otherwise the options are looked up by their keys.
+// Returns true on early exit by fn().
+template<typename Fn>
+static inline bool config_iterate(const ConfigBase &lhs, const ConfigBase &rhs, Fn fn)
+{
+    t_config_option_refs lhs_options;
+    t_config_option_refs rhs_options;
+    if (lhs.sorted_options(lhs_options) && rhs.sorted_options(rhs_options)) {
+        auto i = lhs_options.begin();
+        auto j = rhs_options.begin();
+        while (i != lhs_options.end() && j != rhs_options.end())
+            if (*i->first < *j->first)
+                ++ i;
+            else if (*j->first < *i->first)
+                ++ j;
+            else {
+                if (fn(*i->first, i->second, j->second))
+                    return true;
+                ++ i;
+                ++ j;
+            }
+    } else {
+        for (const t_config_option_key &opt_key : lhs.keys()) {
+            const ConfigOption *lhs_opt = lhs.option(opt_key);
+            const ConfigOption *rhs_opt = rhs.option(opt_key);
+            if (lhs_opt != nullptr && rhs_opt != nullptr && fn(opt_key, lhs_opt, rhs_opt))
+                return true;
+        }
+    }
+    return false;
+}
+
 // Are the two configs equal? Ignoring options not present in both configs.
 bool ConfigBase::equals(const ConfigBase &other) const
 { 
-    for (const t_config_option_key &opt_key : this->keys()) {
-        const ConfigOption *this_opt  = this->option(opt_key);
-        const ConfigOption *other_opt = other.option(opt_key);
-        if (this_opt != nullptr && other_opt != nullptr && *this_opt != *other_opt)
-            return false;
-    }
-    return true;
+    return ! config_iterate(*this, other,
+        [](const t_config_option_key & /* key */, const ConfigOption *l, const ConfigOption *r) { return *l != *r; });
 }
 
 // Returns options differing in the two configs, ignoring options not present in both configs.
 t_config_option_keys ConfigBase::diff(const ConfigBase &other) const
 {
     t_config_option_keys diff;
-    for (const t_config_option_key &opt_key : this->keys()) {
-        const ConfigOption *this_opt  = this->option(opt_key);
-        const ConfigOption *other_opt = other.option(opt_key);
-        if (this_opt != nullptr && other_opt != nullptr && *this_opt != *other_opt)
-            diff.emplace_back(opt_key);
-    }
+    config_iterate(*this, other,
+        [&diff](const t_config_option_key &key, const ConfigOption *l, const ConfigOption *r) {
+            if (*l != *r)
+                diff.emplace_back(key);
+            // Continue iterating.
+            return false;
+        });
     return diff;
 }
 
@@ -516,12 +545,13 @@ t_config_option_keys ConfigBase::diff(const ConfigBase &other) const
 t_config_option_keys ConfigBase::equal(const ConfigBase &other) const
 {
     t_config_option_keys equal;
-    for (const t_config_option_key &opt_key : this->keys()) {
-        const ConfigOption *this_opt  = this->option(opt_key);
-        const ConfigOption *other_opt = other.option(opt_key);
-        if (this_opt != nullptr && other_opt != nullptr && *this_opt == *other_opt)
-            equal.emplace_back(opt_key);
-    }
+    config_iterate(*this, other,
+        [&equal](const t_config_option_key &key, const ConfigOption *l, const ConfigOption *r) {
+            if (*l == *r)
+                equal.emplace_back(key);
+            // Continue iterating.
+            return false;
+        });
     return equal;
 }
 
@@ -1239,6 +1269,15 @@ t_config_option_keys DynamicConfig::keys() const
     return keys;
 }
 
+bool DynamicConfig::sorted_options(t_config_option_refs &out) const
+{
+    out.clear();
+    out.reserve(this->options.size());
+    for (const auto &opt : this->options)
+        out.emplace_back(&opt.first, opt.second.get());
+    return true;
+}
+
 void StaticConfig::set_defaults()
 {
     // use defaults from definition
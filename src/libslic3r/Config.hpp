@@ -2134,6 +2134,9 @@ public:
 
 
 // An abstract configuration store.
+// Keys and options of a configuration store sorted by the keys, see ConfigBase::sorted_options().
+typedef std::vector<std::pair<const t_config_option_key*, const ConfigOption*>> t_config_option_refs;
+
 class ConfigBase : public ConfigOptionResolver
 {
 public:
@@ -2153,6 +2156,9 @@ public:
     virtual ConfigOption*           optptr(const t_config_option_key &opt_key, bool create = false) = 0;
     // Collect names of all configuration values maintained by this configuration store.
     virtual t_config_option_keys    keys() const = 0;
+    // Collect the keys and options of this configuration store sorted by the keys, for a linear merge with another configuration store
+    // instead of looking up the options by their keys. Returns false if not supported, out is not modified then.
+    virtual bool                    sorted_options(t_config_option_refs &/* out */) const { return false; }
 
 protected:
     // Verify whether the opt_key has not been obsoleted or renamed.
@@ -2423,6 +2429,8 @@ public:
     ConfigOption*           optptr(const t_config_option_key &opt_key, bool create = false) override;
     // Overrides ConfigBase::keys(). Collect names of all configuration values maintained by this configuration store.
     t_config_option_keys    keys() const override;
+    // Overrides ConfigBase::sorted_options(). The options are stored sorted by their keys.
+    bool                    sorted_options(t_config_option_refs &out) const override;
     bool                    empty() const { return options.empty(); }
 
     // Set a value for an opt_key. Returns true if the value did not exist yet.
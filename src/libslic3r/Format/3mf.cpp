@@ -8,12 +8,16 @@
 #include "../GCode/ThumbnailData.hpp"
 #include "../Semver.hpp"
 #include "../Time.hpp"
+#include "../ParallelDeflate.hpp"
+#include "../Execution/ExecutionTBB.hpp"
 
 #include "../I18N.hpp"
 
 #include "3mf.hpp"
 
+#include <charconv>
 #include <limits>
+#include <mutex>
 #include <stdexcept>
 #include <optional>
 #include <string_view>
@@ -303,6 +307,223 @@ namespace Slic3r {
 #define L(s) (s)
 #define _(s) Slic3r::I18N::translate(s)
 
+    // Contents of the <vertices> and <triangles> elements of a model file parsed ahead of expat and in parallel
+    // by a non-validating scanner, which accepts just the self closing <vertex/> and <triangle/> elements with plain
+    // attribute values, as written by PrusaSlicer. The contents of the parsed blocks are not passed to expat.
+    // Blocks the scanner does not accept are left to expat.
+    struct MeshBlock
+    {
+        enum class Type { Vertices, Triangles };
+        Type   type;
+        // Offset of the start tag in the model file.
+        size_t tag;
+        // Range of the content of the element in the model file.
+        size_t begin;
+        size_t end;
+        // Offset of the start tag in the data passed to expat.
+        size_t stream_offset { 0 };
+        bool   parsed { false };
+
+        // Vertices not yet scaled by the unit factor.
+        std::vector<Vec3f>       vertices;
+        std::vector<Vec3i>       triangles;
+        std::vector<std::string> custom_supports;
+        std::vector<std::string> custom_seam;
+        std::vector<std::string> mmu_segmentation;
+    };
+
+    using MeshBlockAttributes = std::vector<std::pair<std::string_view, std::string_view>>;
+
+    static inline bool is_xml_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+    // Calls fn(attributes) for each of the self closing elements <element attr="value" .../> separated by white space in [begin, end).
+    // Returns false on anything else, or on attribute values expat would have to normalize.
+    template<typename Fn>
+    static bool scan_mesh_elements(const char *begin, const char *end, const std::string_view element, Fn &&fn)
+    {
+        MeshBlockAttributes attributes;
+        const char         *p = begin;
+        for (;;) {
+            while (p != end && is_xml_space(*p))
+                ++ p;
+            if (p == end)
+                return true;
+            if (size_t(end - p) < element.size() + 3 || *p != '<' || std::string_view(p + 1, element.size()) != element)
+                return false;
+            p += element.size() + 1;
+            attributes.clear();
+            for (;;) {
+                bool space = false;
+                for (; p != end && is_xml_space(*p); ++ p)
+                    space = true;
+                if (p == end)
+                    return false;
+                if (*p == '/') {
+                    if (++ p == end || *p != '>')
+                        return false;
+                    ++ p;
+                    break;
+                }
+                // Attributes are separated from the element name and from each other by white space.
+                if (! space)
+                    return false;
+                const char *name = p;
+                while (p != end && *p != '=' && ! is_xml_space(*p) && *p != '/' && *p != '>' && *p != '<' && *p != '"' && *p != '\'')
+                    ++ p;
+                std::string_view attr_name(name, p - name);
+                while (p != end && is_xml_space(*p))
+                    ++ p;
+                if (attr_name.empty() || p == end || *p != '=')
+                    return false;
+                for (++ p; p != end && is_xml_space(*p); ++ p) ;
+                if (p == end || (*p != '"' && *p != '\''))
+                    return false;
+                const char  quote = *p ++;
+                const char *value = p;
+                for (; p != end && *p != quote; ++ p)
+                    if (*p == '&' || *p == '<' || *p == '\t' || *p == '\r' || *p == '\n')
+                        return false;
+                if (p == end)
+                    return false;
+                std::string_view attr_value(value, p ++ - value);
+                for (const auto &attr : attributes)
+                    if (attr.first == attr_name)
+                        // Duplicate attribute, let expat report the error.
+                        return false;
+                attributes.emplace_back(attr_name, attr_value);
+            }
+            fn(attributes);
+        }
+    }
+
+    static const std::string_view* find_mesh_attribute(const MeshBlockAttributes &attributes, const std::string_view key)
+    {
+        for (const auto &attr : attributes)
+            if (attr.first == key)
+                return &attr.second;
+        return nullptr;
+    }
+
+    // Same as get_attribute_value_float(), get_attribute_value_int() and get_attribute_value_string().
+    static float mesh_attribute_float(const MeshBlockAttributes &attributes, const std::string_view key)
+    {
+        float value = 0.0f;
+        if (const std::string_view *text = find_mesh_attribute(attributes, key); text != nullptr)
+            fast_float::from_chars(text->data(), text->data() + text->size(), value);
+        return value;
+    }
+
+    static int mesh_attribute_int(const MeshBlockAttributes &attributes, const std::string_view key)
+    {
+        int value = 0;
+        if (const std::string_view *text = find_mesh_attribute(attributes, key); text != nullptr) {
+            const char *it = text->data();
+            boost::spirit::qi::parse(it, text->data() + text->size(), boost::spirit::qi::int_, value);
+        }
+        return value;
+    }
+
+    static std::string mesh_attribute_string(const MeshBlockAttributes &attributes, const std::string_view key)
+    {
+        const std::string_view *text = find_mesh_attribute(attributes, key);
+        return text != nullptr ? std::string(*text) : std::string();
+    }
+
+    static bool scan_mesh_block(const char *begin, const char *end, MeshBlock &out)
+    {
+        if (out.type == MeshBlock::Type::Vertices)
+            return scan_mesh_elements(begin, end, VERTEX_TAG, [&out](const MeshBlockAttributes &attributes) {
+                out.vertices.emplace_back(
+                    mesh_attribute_float(attributes, X_ATTR),
+                    mesh_attribute_float(attributes, Y_ATTR),
+                    mesh_attribute_float(attributes, Z_ATTR));
+            });
+        else
+            return scan_mesh_elements(begin, end, TRIANGLE_TAG, [&out](const MeshBlockAttributes &attributes) {
+                out.triangles.emplace_back(
+                    mesh_attribute_int(attributes, V1_ATTR),
+                    mesh_attribute_int(attributes, V2_ATTR),
+                    mesh_attribute_int(attributes, V3_ATTR));
+                out.custom_supports.emplace_back(mesh_attribute_string(attributes, CUSTOM_SUPPORTS_ATTR));
+                out.custom_seam.emplace_back(mesh_attribute_string(attributes, CUSTOM_SEAM_ATTR));
+                out.mmu_segmentation.emplace_back(mesh_attribute_string(attributes, MMU_SEGMENTATION_ATTR));
+            });
+    }
+
+    // Finds the <vertices> and <triangles> blocks of a model file and parses them in parallel,
+    // large blocks split into pieces at element boundaries. Returns the parsed blocks only.
+    static std::vector<MeshBlock> parse_mesh_blocks(const std::string_view data)
+    {
+        static constexpr const std::string_view start_tags[2] = { "<vertices>",  "<triangles>" };
+        static constexpr const std::string_view end_tags[2]   = { "</vertices>", "</triangles>" };
+        static constexpr const size_t           piece_size    = 1024 * 1024;
+
+        std::vector<MeshBlock> blocks;
+        size_t next[2] = { data.find(start_tags[0]), data.find(start_tags[1]) };
+        for (;;) {
+            const int type = next[0] <= next[1] ? 0 : 1;
+            if (next[type] == std::string_view::npos)
+                break;
+            MeshBlock block;
+            block.type  = type == 0 ? MeshBlock::Type::Vertices : MeshBlock::Type::Triangles;
+            block.tag   = next[type];
+            block.begin = next[type] + start_tags[type].size();
+            block.end   = data.find(end_tags[type], block.begin);
+            if (block.end == std::string_view::npos)
+                break;
+            const size_t pos = block.end + end_tags[type].size();
+            blocks.emplace_back(std::move(block));
+            for (int i = 0; i < 2; ++ i)
+                if (next[i] != std::string_view::npos && next[i] < pos)
+                    next[i] = data.find(start_tags[i], pos);
+        }
+
+        // As the accepted blocks contain no '<' but at the start of an element, the blocks are split at '<'.
+        struct Piece
+        {
+            size_t    block;
+            size_t    begin;
+            size_t    end;
+            bool      parsed { false };
+            MeshBlock data;
+        };
+        std::vector<Piece> pieces;
+        for (size_t i = 0; i < blocks.size(); ++ i)
+            for (size_t begin = blocks[i].begin; begin < blocks[i].end;) {
+                size_t end = begin + piece_size;
+                end = end < blocks[i].end ? std::min(blocks[i].end, data.find('<', end)) : blocks[i].end;
+                pieces.push_back({ i, begin, end });
+                pieces.back().data.type = blocks[i].type;
+                begin = end;
+            }
+        execution::for_each(ex_tbb, pieces.begin(), pieces.end(), [&data](Piece &piece) {
+            piece.parsed = scan_mesh_block(data.data() + piece.begin, data.data() + piece.end, piece.data);
+        });
+
+        for (size_t i = 0; i < blocks.size(); ++ i)
+            blocks[i].parsed = true;
+        for (const Piece &piece : pieces)
+            if (! piece.parsed)
+                blocks[piece.block].parsed = false;
+        for (Piece &piece : pieces)
+            if (MeshBlock &block = blocks[piece.block]; block.parsed) {
+                append(block.vertices,         std::move(piece.data.vertices));
+                append(block.triangles,        std::move(piece.data.triangles));
+                append(block.custom_supports,  std::move(piece.data.custom_supports));
+                append(block.custom_seam,      std::move(piece.data.custom_seam));
+                append(block.mmu_segmentation, std::move(piece.data.mmu_segmentation));
+            }
+        blocks.erase(std::remove_if(blocks.begin(), blocks.end(), [](const MeshBlock &block) { return ! block.parsed; }), blocks.end());
+
+        // Offsets of the start tags in the data passed to expat, which skips the contents of the parsed blocks.
+        size_t skipped = 0;
+        for (MeshBlock &block : blocks) {
+            block.stream_offset = block.tag - skipped;
+            skipped += block.end - block.begin;
+        }
+        return blocks;
+    }
+
     // Base class with error messages management
     class _3MF_Base
     {
@@ -493,6 +714,11 @@ namespace Slic3r {
         std::string m_curr_metadata_name;
         std::string m_curr_characters;
         std::string m_name;
+        // Mesh blocks of the model file being parsed, parsed ahead of expat.
+        std::vector<MeshBlock> m_mesh_blocks;
+        size_t m_next_mesh_block { 0 };
+        // Parsed mesh block, whose start tag was passed to expat and whose end tag was not.
+        MeshBlock* m_curr_mesh_block { nullptr };
 
     public:
         _3MF_Importer();
@@ -532,6 +758,8 @@ namespace Slic3r {
         void _handle_start_model_xml_element(const char* name, const char** attributes);
         void _handle_end_model_xml_element(const char* name);
         void _handle_model_xml_characters(const XML_Char* s, int len);
+        // Returns the parsed mesh block starting at the current position of expat, if any.
+        MeshBlock* _find_parsed_mesh_block(MeshBlock::Type type);
 
         // handlers to parse the MODEL_CONFIG_FILE file
         void _handle_start_config_xml_element(const char* name, const char** attributes);
@@ -596,7 +824,10 @@ namespace Slic3r {
         bool _handle_start_config_metadata(const char** attributes, unsigned int num_attributes);
         bool _handle_end_config_metadata();
 
+        // Splits the geometry into the meshes of the volumes. Thread safe, the meshes of independent objects are generated in parallel.
+        bool _generate_meshes(const ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<TriangleMesh>& meshes, std::string& error) const;
         bool _generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, ConfigSubstitutionContext& config_substitutions);
+        bool _generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<TriangleMesh>&& meshes, ConfigSubstitutionContext& config_substitutions);
 
         // callbacks to parse the .model file
         static void XMLCALL _handle_start_model_xml_element(void* userData, const char* name, const char** attributes);
@@ -804,17 +1035,50 @@ namespace Slic3r {
             }
         }
 
+        // Volumes of the objects to be generated, their meshes are generated for all objects in parallel.
+        struct ObjectVolumes
+        {
+            const IdToModelObjectMap::value_type*     object;
+            ModelObject*                              model_object;
+            const Geometry*                           geometry;
+            const ObjectMetadata::VolumeMetadataList* volumes;
+            // the entire geometry as the single volume, if the model was not saved using slic3r pe
+            ObjectMetadata::VolumeMetadataList        default_volumes;
+            std::vector<TriangleMesh>                 meshes;
+            std::string                               error;
+        };
+        std::vector<ObjectVolumes> objects_volumes;
+        objects_volumes.reserve(m_objects.size());
         for (const IdToModelObjectMap::value_type& object : m_objects) {
             if (object.second >= int(m_model->objects.size())) {
                 add_error("Unable to find object");
                 return false;
             }
-            ModelObject* model_object = m_model->objects[object.second];
             IdToGeometryMap::const_iterator obj_geometry = m_geometries.find(object.first);
             if (obj_geometry == m_geometries.end()) {
                 add_error("Unable to find object geometry");
                 return false;
             }
+            ObjectVolumes& object_volumes = objects_volumes.emplace_back();
+            object_volumes.object = &object;
+            object_volumes.model_object = m_model->objects[object.second];
+            object_volumes.geometry = &obj_geometry->second;
+            if (IdToMetadataMap::iterator obj_metadata = m_objects_metadata.find(object.first); obj_metadata != m_objects_metadata.end())
+                object_volumes.volumes = &obj_metadata->second.volumes;
+            else {
+                object_volumes.default_volumes.emplace_back(0, (int)obj_geometry->second.triangles.size() - 1);
+                object_volumes.volumes = &object_volumes.default_volumes;
+            }
+        }
+
+        execution::for_each(ex_tbb, objects_volumes.begin(), objects_volumes.end(), [this](ObjectVolumes& object_volumes) {
+            if (!_generate_meshes(*object_volumes.model_object, *object_volumes.geometry, *object_volumes.volumes, object_volumes.meshes, object_volumes.error))
+                object_volumes.meshes.clear();
+        });
+
+        for (ObjectVolumes& object_volumes : objects_volumes) {
+            const IdToModelObjectMap::value_type& object = *object_volumes.object;
+            ModelObject* model_object = object_volumes.model_object;
 
             // m_layer_heights_profiles are indexed by a 1 based model object index.
             IdToLayerHeightsProfileMap::iterator obj_layer_heights_profile = m_layer_heights_profiles.find(object.second + 1);
@@ -838,9 +1102,6 @@ namespace Slic3r {
                 model_object->sla_drain_holes = std::move(obj_drain_holes->second);
             }
 
-            ObjectMetadata::VolumeMetadataList volumes;
-            ObjectMetadata::VolumeMetadataList* volumes_ptr = nullptr;
-
             IdToMetadataMap::iterator obj_metadata = m_objects_metadata.find(object.first);
             if (obj_metadata != m_objects_metadata.end()) {
                 // config data has been found, this model was saved using slic3r pe
@@ -852,21 +1113,13 @@ namespace Slic3r {
                     else
                         model_object->config.set_deserialize(metadata.key, metadata.value, config_substitutions);
                 }
-
-                // select object's detected volumes
-                volumes_ptr = &obj_metadata->second.volumes;
             }
-            else {
-                // config data not found, this model was not saved using slic3r pe
-
-                // add the entire geometry as the single volume to generate
-                volumes.emplace_back(0, (int)obj_geometry->second.triangles.size() - 1);
 
-                // select as volumes
-                volumes_ptr = &volumes;
+            if (!object_volumes.error.empty()) {
+                add_error(object_volumes.error);
+                return false;
             }
-
-            if (!_generate_volumes(*model_object, obj_geometry->second, *volumes_ptr, config_substitutions))
+            if (!_generate_volumes(*model_object, *object_volumes.geometry, *object_volumes.volumes, std::move(object_volumes.meshes), config_substitutions))
                 return false;
 
             // Apply cut information for object if any was loaded
@@ -962,49 +1215,73 @@ namespace Slic3r {
         XML_SetElementHandler(m_xml_parser, _3MF_Importer::_handle_start_model_xml_element, _3MF_Importer::_handle_end_model_xml_element);
         XML_SetCharacterDataHandler(m_xml_parser, _3MF_Importer::_handle_model_xml_characters);
 
-        struct CallbackData
-        {
-            XML_Parser& parser;
-            _3MF_Importer& importer;
-            const mz_zip_archive_file_stat& stat;
-
-            CallbackData(XML_Parser& parser, _3MF_Importer& importer, const mz_zip_archive_file_stat& stat) : parser(parser), importer(importer), stat(stat) {}
-        };
-
-        CallbackData data(m_xml_parser, *this, stat);
+        // The model file is extracted as a whole to parse the meshes in parallel, which takes most of the time.
+        std::string data;
+        try {
+            data.assign(size_t(stat.m_uncomp_size), '\0');
+        } catch (const std::bad_alloc&) {
+            add_error("Not enough memory to extract model data from zip archive");
+            return false;
+        }
+        if (mz_zip_reader_extract_to_mem(&archive, stat.m_file_index, data.data(), data.size(), 0) == 0) {
+            add_error("Error while extracting model data from zip archive");
+            return false;
+        }
 
-        mz_bool res = 0;
+        m_mesh_blocks = parse_mesh_blocks(data);
+        m_next_mesh_block = 0;
+        m_curr_mesh_block = nullptr;
 
-        try
-        {
-            res = mz_zip_reader_extract_file_to_callback(&archive, stat.m_filename, [](void* pOpaque, mz_uint64 file_ofs, const void* pBuf, size_t n)->size_t {
-                CallbackData* data = (CallbackData*)pOpaque;
-                if (!XML_Parse(data->parser, (const char*)pBuf, (int)n, (file_ofs + n == data->stat.m_uncomp_size) ? 1 : 0) || data->importer.parse_error()) {
+        // Passes data[begin, end) to expat.
+        auto parse = [this, &data, &stat](size_t begin, size_t end, bool is_final) {
+            static constexpr const size_t max_chunk = 64 * 1024 * 1024;
+            do {
+                size_t n = std::min(end - begin, max_chunk);
+                if (!XML_Parse(m_xml_parser, data.data() + begin, (int)n, (is_final && begin + n == end) ? 1 : 0) || parse_error()) {
                     char error_buf[1024];
-                    ::sprintf(error_buf, "Error (%s) while parsing '%s' at line %d", data->importer.parse_error_message(), data->stat.m_filename, (int)XML_GetCurrentLineNumber(data->parser));
+                    ::sprintf(error_buf, "Error (%s) while parsing '%s' at line %d", parse_error_message(), stat.m_filename, (int)XML_GetCurrentLineNumber(m_xml_parser));
                     throw Slic3r::FileIOError(error_buf);
                 }
+                begin += n;
+            } while (begin < end);
+        };
 
-                return n;
-                }, &data, 0);
+        bool res = true;
+        try
+        {
+            // Skip the contents of the parsed mesh blocks.
+            size_t pos = 0;
+            for (const MeshBlock& block : m_mesh_blocks) {
+                parse(pos, block.begin, false);
+                pos = block.end;
+            }
+            parse(pos, data.size(), true);
         }
         catch (const version_error& e)
         {
             // rethrow the exception
+            m_mesh_blocks.clear();
             throw Slic3r::FileIOError(e.what());
         }
         catch (std::exception& e)
         {
             add_error(e.what());
-            return false;
+            res = false;
         }
 
-        if (res == 0) {
-            add_error("Error while extracting model data from zip archive");
-            return false;
-        }
+        m_mesh_blocks.clear();
+        m_curr_mesh_block = nullptr;
+        return res;
+    }
 
-        return true;
+    MeshBlock* _3MF_Importer::_find_parsed_mesh_block(MeshBlock::Type type)
+    {
+        const size_t offset = size_t(XML_GetCurrentByteIndex(m_xml_parser));
+        while (m_next_mesh_block < m_mesh_blocks.size() && m_mesh_blocks[m_next_mesh_block].stream_offset < offset)
+            ++ m_next_mesh_block;
+        if (m_next_mesh_block < m_mesh_blocks.size() && m_mesh_blocks[m_next_mesh_block].stream_offset == offset && m_mesh_blocks[m_next_mesh_block].type == type)
+            return &m_mesh_blocks[m_next_mesh_block ++];
+        return nullptr;
     }
 
     void _3MF_Importer::_extract_cut_information_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat, ConfigSubstitutionContext& config_substitutions)
@@ -1734,12 +2011,21 @@ namespace Slic3r {
     {
         // reset current vertices
         m_curr_object.geometry.vertices.clear();
+        m_curr_mesh_block = _find_parsed_mesh_block(MeshBlock::Type::Vertices);
         return true;
     }
 
     bool _3MF_Importer::_handle_end_vertices()
     {
-        // do nothing
+        if (m_curr_mesh_block != nullptr && m_curr_mesh_block->type == MeshBlock::Type::Vertices) {
+            // the vertices were parsed ahead, their content was not passed to expat
+            std::vector<Vec3f>& vertices = m_curr_object.geometry.vertices;
+            vertices.reserve(vertices.size() + m_curr_mesh_block->vertices.size());
+            for (const Vec3f& v : m_curr_mesh_block->vertices)
+                vertices.emplace_back(m_unit_factor * v.x(), m_unit_factor * v.y(), m_unit_factor * v.z());
+            m_curr_mesh_block->vertices = std::vector<Vec3f>();
+        }
+        m_curr_mesh_block = nullptr;
         return true;
     }
 
@@ -1764,12 +2050,21 @@ namespace Slic3r {
     {
         // reset current triangles
         m_curr_object.geometry.triangles.clear();
+        m_curr_mesh_block = _find_parsed_mesh_block(MeshBlock::Type::Triangles);
         return true;
     }
 
     bool _3MF_Importer::_handle_end_triangles()
     {
-        // do nothing
+        if (m_curr_mesh_block != nullptr && m_curr_mesh_block->type == MeshBlock::Type::Triangles) {
+            // the triangles were parsed ahead, their content was not passed to expat
+            Geometry& geometry = m_curr_object.geometry;
+            append(geometry.triangles, std::move(m_curr_mesh_block->triangles));
+            append(geometry.custom_supports, std::move(m_curr_mesh_block->custom_supports));
+            append(geometry.custom_seam, std::move(m_curr_mesh_block->custom_seam));
+            append(geometry.mmu_segmentation, std::move(m_curr_mesh_block->mmu_segmentation));
+        }
+        m_curr_mesh_block = nullptr;
         return true;
     }
 
@@ -2143,39 +2438,28 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Importer::_generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, ConfigSubstitutionContext& config_substitutions)
+    bool _3MF_Importer::_generate_meshes(const ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<TriangleMesh>& meshes, std::string& error) const
     {
         if (!object.volumes.empty()) {
-            add_error("Found invalid volumes count");
+            error = "Found invalid volumes count";
             return false;
         }
 
         unsigned int geo_tri_count = (unsigned int)geometry.triangles.size();
-        unsigned int renamed_volumes_count = 0;
+        meshes.reserve(volumes.size());
 
         for (const ObjectMetadata::VolumeMetadata& volume_data : volumes) {
             if (geo_tri_count <= volume_data.first_triangle_id || geo_tri_count <= volume_data.last_triangle_id || volume_data.last_triangle_id < volume_data.first_triangle_id) {
-                add_error("Found invalid triangle id");
+                error = "Found invalid triangle id";
                 return false;
             }
 
-            Transform3d volume_matrix_to_object = Transform3d::Identity();
-            bool        has_transform 		    = false;
-            // extract the volume transformation from the volume's metadata, if present
-            for (const Metadata& metadata : volume_data.metadata) {
-                if (metadata.key == MATRIX_KEY) {
-                    volume_matrix_to_object = Slic3r::Geometry::transform3d_from_string(metadata.value);
-                    has_transform 			= ! volume_matrix_to_object.isApprox(Transform3d::Identity(), 1e-10);
-                    break;
-                }
-            }
-
             // splits volume out of imported geometry
             indexed_triangle_set its;
             its.indices.assign(geometry.triangles.begin() + volume_data.first_triangle_id, geometry.triangles.begin() + volume_data.last_triangle_id + 1);
             const size_t triangles_count = its.indices.size();
             if (triangles_count == 0) {
-                add_error("An empty triangle mesh found");
+                error = "An empty triangle mesh found";
                 return false;
             }
 
@@ -2185,7 +2469,7 @@ namespace Slic3r {
                 for (const Vec3i& face : its.indices) {
                     for (const int tri_id : face) {
                         if (tri_id < 0 || tri_id >= int(geometry.vertices.size())) {
-                            add_error("Found invalid vertex id");
+                            error = "Found invalid vertex id";
                             return false;
                         }
                         min_id = std::min(min_id, tri_id);
@@ -2212,17 +2496,64 @@ namespace Slic3r {
             if (m_version == 0) {
                 // if the 3mf was not produced by PrusaSlicer and there is only one instance,
                 // bake the transformation into the geometry to allow the reload from disk command
-                // to work properly
-                if (object.instances.size() == 1) {
+                // to work properly. _generate_volumes() resets the instance transformation,
+                // therefore the transformation is baked into the first volume only.
+                if (object.instances.size() == 1 && meshes.empty()) {
                     triangle_mesh.transform(object.instances.front()->get_transformation().get_matrix(), false);
-                    object.instances.front()->set_transformation(Slic3r::Geometry::Transformation());
                     //FIXME do the mesh fixing?
                 }
             }
             if (triangle_mesh.volume() < 0)
                 triangle_mesh.flip_triangles();
 
-			ModelVolume* volume = object.add_volume(std::move(triangle_mesh));
+            meshes.emplace_back(std::move(triangle_mesh));
+        }
+
+        return true;
+    }
+
+    bool _3MF_Importer::_generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, ConfigSubstitutionContext& config_substitutions)
+    {
+        std::vector<TriangleMesh> meshes;
+        std::string               error;
+        if (!_generate_meshes(object, geometry, volumes, meshes, error)) {
+            add_error(error);
+            return false;
+        }
+        return _generate_volumes(object, geometry, volumes, std::move(meshes), config_substitutions);
+    }
+
+    bool _3MF_Importer::_generate_volumes(ModelObject& object, const Geometry& geometry, const ObjectMetadata::VolumeMetadataList& volumes, std::vector<TriangleMesh>&& meshes, ConfigSubstitutionContext& config_substitutions)
+    {
+        assert(meshes.size() == volumes.size());
+        if (!object.volumes.empty()) {
+            // the meshes were generated before the volumes of another 3MF object were added to the same ModelObject
+            add_error("Found invalid volumes count");
+            return false;
+        }
+
+        if (m_version == 0 && object.instances.size() == 1 && !volumes.empty())
+            // the instance transformation was baked into the geometry by _generate_meshes()
+            object.instances.front()->set_transformation(Slic3r::Geometry::Transformation());
+
+        unsigned int renamed_volumes_count = 0;
+
+        for (size_t volume_idx = 0; volume_idx < volumes.size(); ++ volume_idx) {
+            const ObjectMetadata::VolumeMetadata& volume_data = volumes[volume_idx];
+            const size_t triangles_count = meshes[volume_idx].its.indices.size();
+
+            Transform3d volume_matrix_to_object = Transform3d::Identity();
+            bool        has_transform 		    = false;
+            // extract the volume transformation from the volume's metadata, if present
+            for (const Metadata& metadata : volume_data.metadata) {
+                if (metadata.key == MATRIX_KEY) {
+                    volume_matrix_to_object = Slic3r::Geometry::transform3d_from_string(metadata.value);
+                    has_transform 			= ! volume_matrix_to_object.isApprox(Transform3d::Identity(), 1e-10);
+                    break;
+                }
+            }
+
+			ModelVolume* volume = object.add_volume(std::move(meshes[volume_idx]));
             // stores the volume matrix taken from the metadata, if present
             if (has_transform)
                 volume->source.transform = Slic3r::Geometry::Transformation(volume_matrix_to_object);
@@ -2342,6 +2673,230 @@ namespace Slic3r {
             importer->_handle_end_config_xml_element(name);
     }
 
+#if EXPORT_3MF_USE_SPIRIT_KARMA_FP
+    template <typename Num>
+    struct coordinate_policy_fixed : boost::spirit::karma::real_policies<Num>
+    {
+        static int floatfield(Num n) { return fmtflags::fixed; }
+        // Number of decimal digits to maintain float accuracy when storing into a text file and parsing back.
+        static unsigned precision(Num /* n */) { return std::numeric_limits<Num>::max_digits10 + 1; }
+        // No trailing zeros, thus for fmtflags::fixed usually much less than max_digits10 decimal numbers will be produced.
+        static bool trailing_zeros(Num /* n */) { return false; }
+    };
+    template <typename Num>
+    struct coordinate_policy_scientific : coordinate_policy_fixed<Num>
+    {
+        static int floatfield(Num n) { return fmtflags::scientific; }
+    };
+    // Define a new generator type based on the new coordinate policy.
+    using coordinate_type_fixed      = boost::spirit::karma::real_generator<float, coordinate_policy_fixed<float>>;
+    using coordinate_type_scientific = boost::spirit::karma::real_generator<float, coordinate_policy_scientific<float>>;
+#endif // EXPORT_3MF_USE_SPIRIT_KARMA_FP
+
+    // Formats a float to be parsed back to the same value, returns the end of the string.
+    static char* format_coordinate(float f, char *buf)
+    {
+#if EXPORT_3MF_USE_SPIRIT_KARMA_FP
+        // Slightly faster than sprintf("%.9g"), but there is an issue with the karma floating point formatter,
+        // https://github.com/boostorg/spirit/pull/586
+        // where the exported string is one digit shorter than it should be to guarantee lossless round trip.
+        // The code is left here for the ocasion boost guys improve.
+        coordinate_type_fixed      const coordinate_fixed      = coordinate_type_fixed();
+        coordinate_type_scientific const coordinate_scientific = coordinate_type_scientific();
+        // Format "f" in a fixed format.
+        char *ptr = buf;
+        boost::spirit::karma::generate(ptr, coordinate_fixed, f);
+        // Format "f" in a scientific format.
+        char *ptr2 = ptr;
+        boost::spirit::karma::generate(ptr2, coordinate_scientific, f);
+        // Return end of the shorter string.
+        auto len2 = ptr2 - ptr;
+        if (ptr - buf > len2) {
+            // Move the shorter scientific form to the front.
+            memcpy(buf, ptr, len2);
+            ptr = buf + len2;
+        }
+        // Return pointer to the end.
+        return ptr;
+#elif defined(__cpp_lib_to_chars)
+        // Round-trippable float, shortest possible, independent of the locale.
+        return std::to_chars(buf, buf + 32, f).ptr;
+#else
+        assert(is_decimal_separator_point());
+        // Round-trippable float, shortest possible.
+        return buf + sprintf(buf, "%.9g", f);
+#endif
+    }
+
+    static char* format_index(int i, char *buf)
+    {
+        // Older stdlib on macOS doesn't support std::to_chars, see GCodeFormatter::emit_axis().
+#ifdef __APPLE__
+        boost::spirit::karma::generate(buf, boost::spirit::int_, i);
+        return buf;
+#else
+        return std::to_chars(buf, buf + 16, i).ptr;
+#endif
+    }
+
+    static char* format_literal(const char *literal, char *buf)
+    {
+        size_t len = strlen(literal);
+        memcpy(buf, literal, len);
+        return buf + len;
+    }
+
+    // A range of vertices or triangles of a ModelVolume, a piece of the <mesh> element of a 3MF object.
+    // The pieces of all objects are formatted and compressed independently in parallel.
+    struct MeshXmlPiece
+    {
+        // nullptr for an object without volumes, only the prefix and suffix are stored.
+        const ModelVolume *volume { nullptr };
+        unsigned int       first_vertex_id { 0 };
+        bool               triangles { false };
+        size_t             begin { 0 };
+        size_t             end { 0 };
+        // Text preceding and following the range, the tags enclosing the vertices and triangles.
+        std::string        prefix;
+        std::string        suffix;
+    };
+
+    // Number of vertices or triangles of a single piece, a few megabytes of XML.
+    static constexpr const size_t MESH_XML_PIECE_SIZE = 65536;
+
+    static std::string format_mesh_xml_piece(const MeshXmlPiece &piece)
+    {
+        // Longest <vertex> or <triangle> element, not counting the painting data.
+        static constexpr const size_t MAX_ELEMENT_LENGTH = 80;
+        std::string out;
+        out.reserve(piece.prefix.size() + (piece.end - piece.begin) * MAX_ELEMENT_LENGTH + piece.suffix.size());
+        out += piece.prefix;
+
+        char buf[MAX_ELEMENT_LENGTH + 48];
+        if (piece.volume == nullptr) {
+            // No geometry.
+        } else if (piece.triangles) {
+            const ModelVolume          &volume         = *piece.volume;
+            const indexed_triangle_set &its            = volume.mesh().its;
+            const bool                  is_left_handed = volume.is_left_handed();
+            const char                 *element        = "     <triangle v1=\"";
+            assert(strcmp(TRIANGLE_TAG, "triangle") == 0);
+            for (int i = int(piece.begin); i < int(piece.end); ++ i) {
+                const Vec3i &idx = its.indices[i];
+                char *ptr = format_literal(element, buf);
+                ptr = format_index(idx[is_left_handed ? 2 : 0] + piece.first_vertex_id, ptr);
+                ptr = format_literal("\" v2=\"", ptr);
+                ptr = format_index(idx[1] + piece.first_vertex_id, ptr);
+                ptr = format_literal("\" v3=\"", ptr);
+                ptr = format_index(idx[is_left_handed ? 0 : 2] + piece.first_vertex_id, ptr);
+                *ptr ++ = '"';
+                out.append(buf, ptr);
+
+                auto append_painting = [&out](const char *attr, const std::string &data) {
+                    if (! data.empty()) {
+                        out += " ";
+                        out += attr;
+                        out += "=\"";
+                        out += data;
+                        out += "\"";
+                    }
+                };
+                append_painting(CUSTOM_SUPPORTS_ATTR,  volume.supported_facets.get_triangle_as_string(i));
+                append_painting(CUSTOM_SEAM_ATTR,      volume.seam_facets.get_triangle_as_string(i));
+                append_painting(MMU_SEGMENTATION_ATTR, volume.mmu_segmentation_facets.get_triangle_as_string(i));
+                out += "/>\n";
+            }
+        } else {
+            const indexed_triangle_set &its    = piece.volume->mesh().its;
+            const Transform3d          &matrix = piece.volume->get_matrix();
+            const char                 *element = "     <vertex x=\"";
+            assert(strcmp(VERTEX_TAG, "vertex") == 0);
+            for (size_t i = piece.begin; i < piece.end; ++ i) {
+                Vec3f v = (matrix * its.vertices[i].cast<double>()).cast<float>();
+                char *ptr = format_literal(element, buf);
+                ptr = format_coordinate(v.x(), ptr);
+                ptr = format_literal("\" y=\"", ptr);
+                ptr = format_coordinate(v.y(), ptr);
+                ptr = format_literal("\" z=\"", ptr);
+                ptr = format_coordinate(v.z(), ptr);
+                ptr = format_literal("\"/>\n", ptr);
+                out.append(buf, ptr);
+            }
+        }
+
+        out += piece.suffix;
+        return out;
+    }
+
+    // Compressed <mesh> elements of the objects stored by the last 3MF export, to be reused by the next export
+    // of the same objects: Saving a project repeatedly mostly stores meshes, which did not change since.
+    class MeshXmlCache
+    {
+    public:
+        // Compressed pieces of the <mesh> element of a single object.
+        using Pieces = std::vector<DeflatedData>;
+
+        // Everything the <mesh> element of an object is produced from.
+        struct VolumeKey
+        {
+            ObjectID                          id;
+            // The meshes of ModelVolumes are immutable once shared, a modified mesh is a new object.
+            std::weak_ptr<const TriangleMesh> mesh;
+            // A mesh may still be modified in place right after it was created, see ModelVolume::center_geometry_after_creation().
+            stl_vertex                        min;
+            stl_vertex                        max;
+            Transform3d                       matrix;
+            ObjectBase::Timestamp             supported_facets;
+            ObjectBase::Timestamp             seam_facets;
+            ObjectBase::Timestamp             mmu_segmentation_facets;
+
+            bool operator==(const VolumeKey &rhs) const {
+                return this->id == rhs.id && ! this->mesh.expired() &&
+                    ! this->mesh.owner_before(rhs.mesh) && ! rhs.mesh.owner_before(this->mesh) &&
+                    this->min == rhs.min && this->max == rhs.max && this->matrix.matrix() == rhs.matrix.matrix() &&
+                    this->supported_facets == rhs.supported_facets && this->seam_facets == rhs.seam_facets &&
+                    this->mmu_segmentation_facets == rhs.mmu_segmentation_facets;
+            }
+        };
+        using Key = std::vector<VolumeKey>;
+
+        struct Entry
+        {
+            Key                           key;
+            std::shared_ptr<const Pieces> pieces;
+        };
+
+        static MeshXmlCache& instance() { static MeshXmlCache cache; return cache; }
+
+        static Key make_key(const ModelObject &object) {
+            Key key;
+            for (const ModelVolume *volume : object.volumes)
+                if (volume != nullptr)
+                    key.push_back({ volume->id(), volume->mesh_ptr(), volume->mesh().stats().min, volume->mesh().stats().max, volume->get_matrix(),
+                        volume->supported_facets.timestamp(), volume->seam_facets.timestamp(), volume->mmu_segmentation_facets.timestamp() });
+            return key;
+        }
+
+        // Returns nullptr if the object was not exported last time or if it changed since.
+        std::shared_ptr<const Pieces> find(ObjectID id, const Key &key) const {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            auto it = m_entries.find(id);
+            return it != m_entries.end() && it->second.key == key ? it->second.pieces : nullptr;
+        }
+
+        // Replaces the content of the cache with the objects of the last export, to keep the memory bounded.
+        void reset(std::map<ObjectID, Entry> &&entries) {
+            std::scoped_lock<std::mutex> lock(m_mutex);
+            m_entries = std::move(entries);
+        }
+
+    private:
+        MeshXmlCache() = default;
+
+        mutable std::mutex        m_mutex;
+        std::map<ObjectID, Entry> m_entries;
+    };
+
     class _3MF_Exporter : public _3MF_Base
     {
         struct BuildItem
@@ -2400,8 +2955,8 @@ namespace Slic3r {
         bool _add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data);
         bool _add_relationships_file_to_archive(mz_zip_archive& archive);
         bool _add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data);
-        bool _add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
-        bool _add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);        
+        bool _compress_meshes(const std::vector<ModelObject*>& objects, std::vector<VolumeToOffsetsMap>& volumes_offsets, std::vector<std::shared_ptr<const MeshXmlCache::Pieces>>& meshes);
+        bool _add_object_to_model_stream(ParallelDeflateStagedWriter &writer, unsigned int& object_id, ModelObject& object, const MeshXmlCache::Pieces& mesh, BuildItemsList& build_items);
         bool _add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items);
         bool _add_cut_information_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_layer_height_profile_file_to_archive(mz_zip_archive& archive, Model& model);
@@ -2573,12 +3128,9 @@ namespace Slic3r {
     {
         bool res = false;
 
-        size_t png_size = 0;
-        void* png_data = tdefl_write_image_to_png_file_in_memory_ex((const void*)thumbnail_data.pixels.data(), thumbnail_data.width, thumbnail_data.height, 4, &png_size, MZ_DEFAULT_LEVEL, 1);
-        if (png_data != nullptr) {
-            res = mz_zip_writer_add_mem(&archive, THUMBNAIL_FILE.c_str(), (const void*)png_data, png_size, MZ_DEFAULT_COMPRESSION);
-            mz_free(png_data);
-        }
+        std::vector<uint8_t> png = write_png_to_memory_parallel((const void*)thumbnail_data.pixels.data(), thumbnail_data.width, thumbnail_data.height, 4, MZ_DEFAULT_LEVEL, true);
+        if (!png.empty())
+            res = mz_zip_writer_add_mem(&archive, THUMBNAIL_FILE.c_str(), (const void*)png.data(), png.size(), MZ_DEFAULT_COMPRESSION);
 
         if (!res)
             add_error("Unable to add thumbnail file to archive");
@@ -2631,6 +3183,8 @@ namespace Slic3r {
             add_error("Unable to add model file to archive");
             return false;
         }
+        // The model file is the bulk of a 3MF, compress it on all cores.
+        ParallelDeflateStagedWriter writer(context, MZ_DEFAULT_LEVEL);
 
         {
             std::stringstream stream;
@@ -2663,12 +3217,25 @@ namespace Slic3r {
             stream << " <" << METADATA_TAG << " name=\"Application\">" << SLIC3R_APP_KEY << "-" << SLIC3R_VERSION << "</" << METADATA_TAG << ">\n";
             stream << " <" << RESOURCES_TAG << ">\n";
             std::string buf = stream.str();
-            if (! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) {
+            if (! buf.empty() && ! writer.write(buf.data(), buf.size())) {
                 add_error("Unable to add model file to archive");
                 return false;
             }
         }
 
+        // Geometry of all the objects, formatted and compressed on all cores, or taken from the previous export.
+        std::vector<ModelObject*> objects;
+        for (ModelObject* obj : model.objects)
+            if (obj != nullptr)
+                objects.emplace_back(obj);
+        std::vector<VolumeToOffsetsMap>                           volumes_offsets(objects.size());
+        std::vector<std::shared_ptr<const MeshXmlCache::Pieces>> meshes;
+        if (!_compress_meshes(objects, volumes_offsets, meshes)) {
+            add_error("Unable to add object to archive");
+            mz_zip_writer_add_staged_finish(&context);
+            return false;
+        }
+
         // Instance transformations, indexed by the 3MF object ID (which is a linear serialization of all instances of all ModelObjects).
         BuildItemsList build_items;
 
@@ -2676,17 +3243,15 @@ namespace Slic3r {
         // all the object instances of all ModelObjects are stored and indexed in a 1 based linear fashion.
         // Therefore the list of object_ids here may not be continuous.
         unsigned int object_id = 1;
-        for (ModelObject* obj : model.objects) {
-            if (obj == nullptr)
-                continue;
-
+        for (size_t i = 0; i < objects.size(); ++ i) {
             // Index of an object in the 3MF file corresponding to the 1st instance of a ModelObject.
             unsigned int curr_id = object_id;
-            IdToObjectDataMap::iterator object_it = objects_data.insert({ curr_id, ObjectData(obj) }).first;
-            // Store geometry of all ModelVolumes contained in a single ModelObject into a single 3MF indexed triangle set object.
-            // object_it->second.volumes_offsets will contain the offsets of the ModelVolumes in that single indexed triangle set.
+            IdToObjectDataMap::iterator object_it = objects_data.insert({ curr_id, ObjectData(objects[i]) }).first;
+            // Geometry of all ModelVolumes contained in a single ModelObject is stored into a single 3MF indexed triangle set object.
+            // object_it->second.volumes_offsets contains the offsets of the ModelVolumes in that single indexed triangle set.
+            object_it->second.volumes_offsets = std::move(volumes_offsets[i]);
             // object_id will be increased to point to the 1st instance of the next ModelObject.
-            if (!_add_object_to_model_stream(context, object_id, *obj, build_items, object_it->second.volumes_offsets)) {
+            if (!_add_object_to_model_stream(writer, object_id, *objects[i], *meshes[i], build_items)) {
                 add_error("Unable to add object to archive");
                 mz_zip_writer_add_staged_finish(&context);
                 return false;
@@ -2709,8 +3274,8 @@ namespace Slic3r {
            
             std::string buf = stream.str();
 
-            if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
-                ! mz_zip_writer_add_staged_finish(&context)) {
+            if ((! buf.empty() && ! writer.write(buf.data(), buf.size())) ||
+                ! writer.finish()) {
                 add_error("Unable to add model file to archive");
                 return false;
             }
@@ -2719,7 +3284,96 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Exporter::_add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_compress_meshes(const std::vector<ModelObject*>& objects, std::vector<VolumeToOffsetsMap>& volumes_offsets, std::vector<std::shared_ptr<const MeshXmlCache::Pieces>>& meshes)
+    {
+        MeshXmlCache                        &cache = MeshXmlCache::instance();
+        std::map<ObjectID, MeshXmlCache::Entry> entries;
+        std::vector<MeshXmlPiece>            pieces;
+        // Range of pieces of each object, which was not found in the cache.
+        std::vector<std::pair<size_t, size_t>> object_pieces(objects.size(), { 0, 0 });
+        meshes.assign(objects.size(), nullptr);
+
+        for (size_t i = 0; i < objects.size(); ++ i) {
+            const ModelObject &object = *objects[i];
+            unsigned int vertices_count  = 0;
+            unsigned int triangles_count = 0;
+            for (const ModelVolume* volume : object.volumes) {
+                if (volume == nullptr)
+                    continue;
+                const indexed_triangle_set &its = volume->mesh().its;
+                if (its.vertices.empty()) {
+                    add_error("Found invalid mesh");
+                    return false;
+                }
+                Offsets &offsets = volumes_offsets[i].insert({ volume, Offsets(vertices_count) }).first->second;
+                offsets.first_triangle_id = triangles_count;
+                vertices_count  += (int)its.vertices.size();
+                triangles_count += (int)its.indices.size();
+                offsets.last_triangle_id = triangles_count - 1;
+            }
+
+            MeshXmlCache::Entry &entry = entries[object.id()];
+            entry.key    = MeshXmlCache::make_key(object);
+            entry.pieces = meshes[i] = cache.find(object.id(), entry.key);
+            if (meshes[i])
+                continue;
+
+            const size_t first_piece = pieces.size();
+            for (bool triangles : { false, true })
+                for (const ModelVolume* volume : object.volumes) {
+                    if (volume == nullptr)
+                        continue;
+                    const size_t num_elements = triangles ? volume->mesh().its.indices.size() : volume->mesh().its.vertices.size();
+                    for (size_t begin = 0; begin < num_elements; begin += MESH_XML_PIECE_SIZE) {
+                        MeshXmlPiece piece;
+                        piece.volume          = volume;
+                        piece.first_vertex_id = volumes_offsets[i].find(volume)->second.first_vertex_id;
+                        piece.triangles       = triangles;
+                        piece.begin           = begin;
+                        piece.end             = std::min(num_elements, begin + MESH_XML_PIECE_SIZE);
+                        pieces.emplace_back(std::move(piece));
+                    }
+                }
+            const std::string vertices_begin  = std::string("   <") + MESH_TAG + ">\n    <" + VERTICES_TAG + ">\n";
+            const std::string triangles_begin = std::string("    </") + VERTICES_TAG + ">\n    <" + TRIANGLES_TAG + ">\n";
+            const std::string triangles_end   = std::string("    </") + TRIANGLES_TAG + ">\n   </" + MESH_TAG + ">\n";
+            if (pieces.size() == first_piece) {
+                // An object without volumes.
+                MeshXmlPiece piece;
+                piece.prefix = vertices_begin + triangles_begin;
+                pieces.emplace_back(std::move(piece));
+            } else {
+                // Each volume has some vertices, thus the pieces start with vertices.
+                pieces[first_piece].prefix = vertices_begin;
+                auto it_triangles = std::find_if(pieces.begin() + first_piece, pieces.end(), [](const MeshXmlPiece &piece) { return piece.triangles; });
+                (it_triangles == pieces.end() ? pieces.back().suffix : it_triangles->prefix) = triangles_begin;
+            }
+            pieces.back().suffix += triangles_end;
+            object_pieces[i] = { first_piece, pieces.size() };
+        }
+
+        std::vector<DeflatedData> deflated(pieces.size());
+        std::vector<char>         deflated_ok(pieces.size(), false);
+        execution::for_each(ex_tbb, size_t(0), pieces.size(), [&pieces, &deflated, &deflated_ok](size_t i) {
+            std::string xml = format_mesh_xml_piece(pieces[i]);
+            deflated_ok[i] = deflate_parallel(xml.data(), xml.size(), MZ_DEFAULT_LEVEL, false, deflated[i]);
+        });
+        if (std::find(deflated_ok.begin(), deflated_ok.end(), false) != deflated_ok.end()) {
+            add_error("Error during writing or compression");
+            return false;
+        }
+
+        for (size_t i = 0; i < objects.size(); ++ i)
+            if (! meshes[i]) {
+                auto mesh = std::make_shared<MeshXmlCache::Pieces>(
+                    std::make_move_iterator(deflated.begin() + object_pieces[i].first), std::make_move_iterator(deflated.begin() + object_pieces[i].second));
+                entries[objects[i]->id()].pieces = meshes[i] = std::move(mesh);
+            }
+        cache.reset(std::move(entries));
+        return true;
+    }
+
+    bool _3MF_Exporter::_add_object_to_model_stream(ParallelDeflateStagedWriter &writer, unsigned int& object_id, ModelObject& object, const MeshXmlCache::Pieces& mesh, BuildItemsList& build_items)
     {
         std::stringstream stream;
         reset_stream(stream);
@@ -2735,11 +3389,16 @@ namespace Slic3r {
             if (id == 0) {
                 std::string buf = stream.str();
                 reset_stream(stream);
-                if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
-                    ! _add_mesh_to_object_stream(context, object, volumes_offsets)) {
+                if (! buf.empty() && ! writer.write(buf.data(), buf.size())) {
                     add_error("Unable to add mesh to archive");
                     return false;
                 }
+                for (const DeflatedData &piece : mesh)
+                    if (! writer.write_deflated(piece)) {
+                        add_error("Error during writing or compression");
+                        add_error("Unable to add mesh to archive");
+                        return false;
+                    }
             }
             else {
                 stream << "   <" << COMPONENTS_TAG << ">\n";
@@ -2759,192 +3418,7 @@ namespace Slic3r {
 
         object_id += id;
         std::string buf = stream.str();
-        return buf.empty() || mz_zip_writer_add_staged_data(&context, buf.data(), buf.size());
-    }
-
-#if EXPORT_3MF_USE_SPIRIT_KARMA_FP
-    template <typename Num>
-    struct coordinate_policy_fixed : boost::spirit::karma::real_policies<Num>
-    {
-        static int floatfield(Num n) { return fmtflags::fixed; }
-        // Number of decimal digits to maintain float accuracy when storing into a text file and parsing back.
-        static unsigned precision(Num /* n */) { return std::numeric_limits<Num>::max_digits10 + 1; }
-        // No trailing zeros, thus for fmtflags::fixed usually much less than max_digits10 decimal numbers will be produced.
-        static bool trailing_zeros(Num /* n */) { return false; }
-    };
-    template <typename Num>
-    struct coordinate_policy_scientific : coordinate_policy_fixed<Num>
-    {
-        static int floatfield(Num n) { return fmtflags::scientific; }
-    };
-    // Define a new generator type based on the new coordinate policy.
-    using coordinate_type_fixed      = boost::spirit::karma::real_generator<float, coordinate_policy_fixed<float>>;
-    using coordinate_type_scientific = boost::spirit::karma::real_generator<float, coordinate_policy_scientific<float>>;
-#endif // EXPORT_3MF_USE_SPIRIT_KARMA_FP
-
-    bool _3MF_Exporter::_add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
-    {
-        std::string output_buffer;
-        output_buffer += "   <";
-        output_buffer += MESH_TAG;
-        output_buffer += ">\n    <";
-        output_buffer += VERTICES_TAG;
-        output_buffer += ">\n";
-
-        auto flush = [this, &output_buffer, &context](bool force = false) {
-            if ((force && ! output_buffer.empty()) || output_buffer.size() >= 65536 * 16) {
-                if (! mz_zip_writer_add_staged_data(&context, output_buffer.data(), output_buffer.size())) {
-                    add_error("Error during writing or compression");
-                    return false;
-                }
-                output_buffer.clear();
-            }
-            return true;
-        };
-
-        auto format_coordinate = [](float f, char *buf) -> char* {
-            assert(is_decimal_separator_point());
-#if EXPORT_3MF_USE_SPIRIT_KARMA_FP
-            // Slightly faster than sprintf("%.9g"), but there is an issue with the karma floating point formatter,
-            // https://github.com/boostorg/spirit/pull/586
-            // where the exported string is one digit shorter than it should be to guarantee lossless round trip.
-            // The code is left here for the ocasion boost guys improve.
-            coordinate_type_fixed      const coordinate_fixed      = coordinate_type_fixed();
-            coordinate_type_scientific const coordinate_scientific = coordinate_type_scientific();
-            // Format "f" in a fixed format.
-            char *ptr = buf;
-            boost::spirit::karma::generate(ptr, coordinate_fixed, f);
-            // Format "f" in a scientific format.
-            char *ptr2 = ptr;
-            boost::spirit::karma::generate(ptr2, coordinate_scientific, f);
-            // Return end of the shorter string.
-            auto len2 = ptr2 - ptr;
-            if (ptr - buf > len2) {
-                // Move the shorter scientific form to the front.
-                memcpy(buf, ptr, len2);
-                ptr = buf + len2;
-            }
-            // Return pointer to the end.
-            return ptr;
-#else
-            // Round-trippable float, shortest possible.
-            return buf + sprintf(buf, "%.9g", f);
-#endif
-        };
-
-        char buf[256];
-        unsigned int vertices_count = 0;
-        for (ModelVolume* volume : object.volumes) {
-            if (volume == nullptr)
-                continue;
-
-            volumes_offsets.insert({ volume, Offsets(vertices_count) });
-
-            const indexed_triangle_set &its = volume->mesh().its;
-            if (its.vertices.empty()) {
-                add_error("Found invalid mesh");
-                return false;
-            }
-
-            vertices_count += (int)its.vertices.size();
-
-            const Transform3d& matrix = volume->get_matrix();
-            for (const auto& vertex: its.vertices) {
-                Vec3f v = (matrix * vertex.cast<double>()).cast<float>();
-                char *ptr = buf;
-                boost::spirit::karma::generate(ptr, boost::spirit::lit("     <") << VERTEX_TAG << " x=\"");
-                ptr = format_coordinate(v.x(), ptr);
-                boost::spirit::karma::generate(ptr, "\" y=\"");
-                ptr = format_coordinate(v.y(), ptr);
-                boost::spirit::karma::generate(ptr, "\" z=\"");
-                ptr = format_coordinate(v.z(), ptr);
-                boost::spirit::karma::generate(ptr, "\"/>\n");
-                *ptr = '\0';
-                output_buffer += buf;
-                if (! flush())
-                    return false;
-            }
-        }
-
-        output_buffer += "    </";
-        output_buffer += VERTICES_TAG;
-        output_buffer += ">\n    <";
-        output_buffer += TRIANGLES_TAG;
-        output_buffer += ">\n";
-
-        unsigned int triangles_count = 0;
-        for (ModelVolume* volume : object.volumes) {
-            if (volume == nullptr)
-                continue;
-
-            bool is_left_handed = volume->is_left_handed();
-            VolumeToOffsetsMap::iterator volume_it = volumes_offsets.find(volume);
-            assert(volume_it != volumes_offsets.end());
-
-            const indexed_triangle_set &its = volume->mesh().its;
-
-            // updates triangle offsets
-            volume_it->second.first_triangle_id = triangles_count;
-            triangles_count += (int)its.indices.size();
-            volume_it->second.last_triangle_id = triangles_count - 1;
-
-            for (int i = 0; i < int(its.indices.size()); ++ i) {
-                {
-                    const Vec3i &idx = its.indices[i];
-                    char *ptr = buf;
-                    boost::spirit::karma::generate(ptr, boost::spirit::lit("     <") << TRIANGLE_TAG <<
-                        " v1=\"" << boost::spirit::int_ <<
-                        "\" v2=\"" << boost::spirit::int_ <<
-                        "\" v3=\"" << boost::spirit::int_ << "\"",
-                        idx[is_left_handed ? 2 : 0] + volume_it->second.first_vertex_id,
-                        idx[1] + volume_it->second.first_vertex_id,
-                        idx[is_left_handed ? 0 : 2] + volume_it->second.first_vertex_id);
-                    *ptr = '\0';
-                    output_buffer += buf;
-                }
-
-                std::string custom_supports_data_string = volume->supported_facets.get_triangle_as_string(i);
-                if (! custom_supports_data_string.empty()) {
-                    output_buffer += " ";
-                    output_buffer += CUSTOM_SUPPORTS_ATTR;
-                    output_buffer += "=\"";
-                    output_buffer += custom_supports_data_string;
-                    output_buffer += "\"";
-                }
-
-                std::string custom_seam_data_string = volume->seam_facets.get_triangle_as_string(i);
-                if (! custom_seam_data_string.empty()) {
-                    output_buffer += " ";
-                    output_buffer += CUSTOM_SEAM_ATTR;
-                    output_buffer += "=\"";
-                    output_buffer += custom_seam_data_string;
-                    output_buffer += "\"";
-                }
-
-                std::string mmu_painting_data_string = volume->mmu_segmentation_facets.get_triangle_as_string(i);
-                if (! mmu_painting_data_string.empty()) {
-                    output_buffer += " ";
-                    output_buffer += MMU_SEGMENTATION_ATTR;
-                    output_buffer += "=\"";
-                    output_buffer += mmu_painting_data_string;
-                    output_buffer += "\"";
-                }
-
-                output_buffer += "/>\n";
-
-                if (! flush())
-                    return false;
-            }
-        }
-
-        output_buffer += "    </";
-        output_buffer += TRIANGLES_TAG;
-        output_buffer += ">\n   </";
-        output_buffer += MESH_TAG;
-        output_buffer += ">\n";
-
-        // Force flush.
-        return flush(true);
+        return buf.empty() || writer.write(buf.data(), buf.size());
     }
 
     void _3MF_Exporter::add_transformation(std::stringstream &stream, const Transform3d &tr)
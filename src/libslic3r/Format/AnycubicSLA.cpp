@@ -33,56 +33,60 @@
 
 namespace Slic3r {
 
-static void anycubicsla_get_pixel_span(const std::uint8_t* ptr, const std::uint8_t* end,
-                               std::uint8_t& pixel, size_t& span_len)
+// Run length encoding of the pixels of all the rows one after the other, the spans continue across the rows.
+sla::EncodedRaster AnycubicSLARasterEncoder::operator()(const sla::RasterRows &rows,
+                                                        size_t                 w,
+                                                        size_t                 h,
+                                                        size_t                 num_components)
 {
-    size_t max_len;
-
-    span_len = 0;
-    pixel = (*ptr) & 0xF0;
-    // the maximum length of the span depends on the pixel color
-    max_len = (pixel == 0 || pixel == 0xF0) ? 0xFFF : 0xF;
-    while (ptr < end && span_len < max_len && ((*ptr) & 0xF0) == pixel) {
-        span_len++;
-        ptr++;
-    }
-}
-
-struct AnycubicSLARasterEncoder
-{
-    sla::EncodedRaster operator()(const void *ptr,
-                                  size_t      w,
-                                  size_t      h,
-                                  size_t      num_components)
-    {
-        std::vector<uint8_t> dst;
-        size_t               span_len;
-        std::uint8_t         pixel;
-        auto                 size = w * h * num_components;
-        dst.reserve(size);
-
-        const std::uint8_t *src = reinterpret_cast<const std::uint8_t *>(ptr);
-        const std::uint8_t *src_end = src + size;
-        while (src < src_end) {
-            anycubicsla_get_pixel_span(src, src_end, pixel, span_len);
-            src += span_len;
-            // fully transparent of fully opaque pixel
-            if (pixel == 0 || pixel == 0xF0) {
-                pixel = pixel | (span_len >> 8);
-                std::copy(&pixel, (&pixel) + 1, std::back_inserter(dst));
-                pixel = span_len & 0xFF;
-                std::copy(&pixel, (&pixel) + 1, std::back_inserter(dst));
-            }
-            // antialiased pixel
+    std::vector<uint8_t> dst;
+    dst.reserve(LAYER_SIZE_ESTIMATE);
+
+    std::uint8_t pixel    = 0;
+    size_t       span_len = 0;
+    auto emit_span = [&dst, &pixel, &span_len]() {
+        // fully transparent of fully opaque pixel
+        if (pixel == 0 || pixel == 0xF0) {
+            dst.push_back(pixel | std::uint8_t(span_len >> 8));
+            dst.push_back(std::uint8_t(span_len & 0xFF));
+        }
+        // antialiased pixel
+        else
+            dst.push_back(pixel | std::uint8_t(span_len));
+    };
+
+    const size_t row_size = w * num_components;
+    for (size_t row = 0; row < h; ++ row) {
+        const std::uint8_t *src = rows(row);
+        for (const std::uint8_t *src_end = src + row_size; src < src_end; ++ src) {
+            const std::uint8_t px = (*src) & 0xF0;
+            // the maximum length of the span depends on the pixel color
+            const size_t max_len = (pixel == 0 || pixel == 0xF0) ? 0xFFF : 0xF;
+            if (span_len > 0 && px == pixel && span_len < max_len)
+                ++ span_len;
             else {
-                pixel = pixel | span_len;
-                std::copy(&pixel, (&pixel) + 1, std::back_inserter(dst));
+                if (span_len > 0)
+                    emit_span();
+                pixel    = px;
+                span_len = 1;
             }
         }
-
-        return sla::EncodedRaster(std::move(dst), "pwimg");
     }
-};
+    if (span_len > 0)
+        emit_span();
+
+    return sla::EncodedRaster(std::move(dst), "pwimg");
+}
+
+sla::EncodedRaster AnycubicSLARasterEncoder::operator()(const void *ptr,
+                                                        size_t      w,
+                                                        size_t      h,
+                                                        size_t      num_components)
+{
+    const auto *data = reinterpret_cast<const std::uint8_t *>(ptr);
+    return (*this)([data, row_size = w * num_components](size_t row) { return data + row * row_size; },
+                   w, h, num_components);
+}
 
 using ConfMap = std::map<std::string, std::string>;
 
@@ -395,7 +399,7 @@ std::unique_ptr<sla::RasterBase> AnycubicSLAArchive::create_raster() const
 
     double gamma = m_cfg.gamma_correction.getFloat();
 
-    return sla::create_raster_grayscale_aa(res, pxdim, gamma, tr);
+    return sla::create_raster_grayscale_aa_spans(res, pxdim, gamma, tr);
 }
 
 sla::RasterEncoder AnycubicSLAArchive::get_encoder() const
@@ -403,6 +407,11 @@ sla::RasterEncoder AnycubicSLAArchive::get_encoder() const
     return AnycubicSLARasterEncoder{};
 }
 
+sla::RasterRowEncoder AnycubicSLAArchive::get_row_encoder() const
+{
+    return AnycubicSLARasterEncoder{};
+}
+
 // Endian safe write of little endian 32bit ints
 static void anycubicsla_write_int32(std::ofstream &out, std::uint32_t val)
 {
@@ -45,6 +45,13 @@
 
 namespace Slic3r {
 
+// Encoder of the layer images into the run length encoded "pwimg" format.
+// Produces the same bytes when fed by rows as when fed by the whole frame.
+struct AnycubicSLARasterEncoder {
+    sla::EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
+    sla::EncodedRaster operator()(const sla::RasterRows &rows, size_t w, size_t h, size_t num_components);
+};
+
 class AnycubicSLAArchive: public SLAArchiveWriter {
     SLAPrinterConfig m_cfg;
     uint16_t m_version;
@@ -52,6 +59,7 @@ class AnycubicSLAArchive: public SLAArchiveWriter {
 protected:
     std::unique_ptr<sla::RasterBase> create_raster() const override;
     sla::RasterEncoder get_encoder() const override;
+    sla::RasterRowEncoder get_row_encoder() const override;
 
     SLAPrinterConfig & cfg() { return m_cfg; }
     const SLAPrinterConfig & cfg() const { return m_cfg; }
@@ -13,6 +13,7 @@
 #include "libslic3r/PrintConfig.hpp"
 
 #include "libslic3r/miniz_extension.hpp"
+#include "libslic3r/ParallelDeflate.hpp"
 #include "libslic3r/LocalesUtils.hpp"
 #include "libslic3r/GCode/ThumbnailData.hpp"
 
@@ -156,7 +157,7 @@ std::unique_ptr<sla::RasterBase> SL1Archive::create_raster() const
 
     double gamma = m_cfg.gamma_correction.getFloat();
 
-    return sla::create_raster_grayscale_aa(res, pxdim, gamma, tr);
+    return sla::create_raster_grayscale_aa_spans(res, pxdim, gamma, tr);
 }
 
 sla::RasterEncoder SL1Archive::get_encoder() const
@@ -164,22 +165,21 @@ sla::RasterEncoder SL1Archive::get_encoder() const
     return sla::PNGRasterEncoder{};
 }
 
-static void write_thumbnail(Zipper &zipper, const ThumbnailData &data)
+sla::RasterRowEncoder SL1Archive::get_row_encoder() const
 {
-    size_t png_size = 0;
+    return sla::PNGRasterEncoder{};
+}
 
-    void  *png_data = tdefl_write_image_to_png_file_in_memory_ex(
+static void write_thumbnail(Zipper &zipper, const ThumbnailData &data)
+{
+    std::vector<uint8_t> png = write_png_to_memory_parallel(
          (const void *) data.pixels.data(), data.width, data.height, 4,
-         &png_size, MZ_DEFAULT_LEVEL, 1);
+         MZ_DEFAULT_LEVEL, true);
 
-    if (png_data != nullptr) {
+    if (! png.empty())
         zipper.add_entry("thumbnail/thumbnail" + std::to_string(data.width) +
                              "x" + std::to_string(data.height) + ".png",
-                         static_cast<const std::uint8_t *>(png_data),
-                         png_size);
-
-        mz_free(png_data);
-    }
+                         png.data(), png.size());
 }
 
 void SL1Archive::export_print(Zipper               &zipper,
@@ -205,14 +205,12 @@ void SL1Archive::export_print(Zipper               &zipper,
         zipper.add_entry("prusaslicer.ini");
         zipper << to_ini(slicerconf);
 
-        size_t i = 0;
-        for (const sla::EncodedRaster &rst : m_layers) {
-
-            std::string imgname = project + string_printf("%.5d", i++) + "." +
+        write_layers(print, [&zipper, &project](size_t i, const sla::EncodedRaster &rst) {
+            std::string imgname = project + string_printf("%.5d", i) + "." +
                                   rst.extension();
 
             zipper.add_entry(imgname.c_str(), rst.data(), rst.size());
-        }
+        });
 
         for (const ThumbnailData& data : thumbnails)
             if (data.is_valid())
@@ -259,6 +257,12 @@ template<> struct _RasterTraits<Slic3r::png::ImageGreyscale> {
        // Number of rows and cols of the raster
     static size_t rows(const Rst &rst) { return rst.rows; }
     static size_t cols(const Rst &rst) { return rst.cols; }
+
+       // The rows are stored contiguously
+    static const uint8_t *row(const Rst &rst, size_t row)
+    {
+        return rst.buf.data() + row * rst.cols;
+    }
 };
 
 } // namespace marchsq
@@ -17,6 +17,8 @@ class SL1Archive: public SLAArchiveWriter {
 protected:
     std::unique_ptr<sla::RasterBase> create_raster() const override;
     sla::RasterEncoder get_encoder() const override;
+    sla::RasterRowEncoder get_row_encoder() const override;
+    bool supports_streaming() const override { return true; }
 
     SLAPrinterConfig & cfg() { return m_cfg; }
     const SLAPrinterConfig & cfg() const { return m_cfg; }
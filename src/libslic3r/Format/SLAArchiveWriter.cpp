@@ -5,12 +5,27 @@
 #include "AnycubicSLA.hpp"
 
 #include "libslic3r/libslic3r.h"
+#include "libslic3r/SLAPrint.hpp"
 
 #include <string>
 #include <map>
 #include <memory>
 #include <tuple>
 
+#include <tbb/task_arena.h>
+
+// Intel redesigned some TBB interface considerably when merging TBB with their oneAPI set of libraries, see GH #7332.
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 namespace Slic3r {
 
 using ArchiveFactory = std::function<std::unique_ptr<SLAArchiveWriter>(const SLAPrinterConfig&)>;
@@ -70,4 +85,40 @@ const char *SLAArchiveWriter::get_extension(const char *archtype)
     return DEFAULT_EXT;
 }
 
+void SLAArchiveWriter::write_layers(const SLAPrint &print, const std::function<void(size_t, const sla::EncodedRaster&)> &writefn) const
+{
+    if (! m_streaming) {
+        for (size_t i = 0; i < m_layers.size(); ++ i)
+            writefn(i, m_layers[i]);
+        return;
+    }
+
+    using IndexedLayer = std::pair<size_t, sla::EncodedRaster>;
+
+    const std::vector<SLAPrint::PrintLayer> &layers    = print.print_layers();
+    size_t                                   layer_idx = 0;
+
+    const auto generator = tbb::make_filter<void, size_t>(slic3r_tbb_filtermode::serial_in_order,
+        [&layers, &layer_idx](tbb::flow_control &fc) -> size_t {
+            if (layer_idx == layers.size()) {
+                fc.stop();
+                return 0;
+            }
+            return layer_idx ++;
+        });
+    const auto rasterize = tbb::make_filter<size_t, IndexedLayer>(slic3r_tbb_filtermode::parallel,
+        [this, &layers](size_t idx) -> IndexedLayer {
+            auto rst = create_raster();
+            for (const ExPolygon &poly : layers[idx].transformed_slices())
+                rst->draw(poly);
+            return { idx, encode_raster(*rst) };
+        });
+    const auto output = tbb::make_filter<IndexedLayer, void>(slic3r_tbb_filtermode::serial_in_order,
+        [&writefn](const IndexedLayer &layer) { writefn(layer.first, layer.second); });
+
+    // The number of layers in flight bounds the memory: Encoded layers waiting for their turn to be written
+    // plus the rasters being drawn by the worker threads.
+    tbb::parallel_pipeline(2 * size_t(tbb::this_task_arena::max_concurrency()), generator & rasterize & output);
+}
+
 } // namespace Slic3r
@@ -1,6 +1,7 @@
 #ifndef SLAARCHIVE_HPP
 #define SLAARCHIVE_HPP
 
+#include <functional>
 #include <vector>
 
 #include "libslic3r/SLA/RasterBase.hpp"
@@ -16,12 +17,45 @@ class SLAArchiveWriter {
 protected:
     std::vector<sla::EncodedRaster> m_layers;
 
+    // If set, draw_layers() does not rasterize anything and the layers are rasterized
+    // and encoded while being written by export_print().
+    bool m_streaming = false;
+
     virtual std::unique_ptr<sla::RasterBase> create_raster() const = 0;
     virtual sla::RasterEncoder get_encoder() const = 0;
+    // Encoder consuming the rasters row by row, if the archive format has one.
+    // Preferred over get_encoder(), as the rasters do not need to materialize the whole frame.
+    virtual sla::RasterRowEncoder get_row_encoder() const { return {}; }
+
+    sla::EncodedRaster encode_raster(const sla::RasterBase &raster) const
+    {
+        if (sla::RasterRowEncoder row_encoder = get_row_encoder())
+            return raster.encode_rows(std::move(row_encoder));
+        return raster.encode(get_encoder());
+    }
+
+    // Archive formats writing the layers one after the other without having to know
+    // all of them in advance (for example the sizes of the layers for a layer table).
+    virtual bool supports_streaming() const { return false; }
+
+    // Call writefn(layer_idx, encoded_layer) for all layers of the print in the order of the layers.
+    // If the layers were rasterized by draw_layers(), they are taken from m_layers. In streaming mode
+    // the layers are rasterized and encoded in parallel here and handed over to writefn in order
+    // through a reorder window of a bounded size, thus only a few encoded layers per thread are kept
+    // in memory at any time.
+    void write_layers(const SLAPrint &print, const std::function<void(size_t, const sla::EncodedRaster&)> &writefn) const;
 
 public:
+    // Total number of raster pixels of all layers, above which the streaming mode is recommended.
+    static constexpr const double StreamingPixelsThreshold = 16. * 1024. * 1024. * 1024.;
+
     virtual ~SLAArchiveWriter() = default;
 
+    // Enable or disable the streaming mode. Returns whether the streaming mode is active,
+    // which may not be the case if the archive format does not support it.
+    bool set_streaming(bool streaming) { m_streaming = streaming && this->supports_streaming(); return m_streaming; }
+    bool streaming() const { return m_streaming; }
+
     // Fn have to be thread safe: void(sla::RasterBase& raster, size_t lyrid);
     template<class Fn, class CancelFn, class EP = ExecutionTBB>
     void draw_layers(
@@ -30,6 +64,13 @@ public:
         CancelFn cancelfn = []() { return false; },
         const EP & ep       = {})
     {
+        if (m_streaming) {
+            // Layers will be rasterized by export_print().
+            m_layers.clear();
+            m_layers.shrink_to_fit();
+            return;
+        }
+
         m_layers.resize(layer_num);
         execution::for_each(
             ep, size_t(0), m_layers.size(),
@@ -39,7 +80,7 @@ public:
                 sla::EncodedRaster &enc = m_layers[idx];
                 auto                rst = create_raster();
                 drawfn(*rst, idx);
-                enc = rst->encode(get_encoder());
+                enc = encode_raster(*rst);
             },
             execution::max_concurrency(ep));
     }
@@ -1,5 +1,6 @@
 #include "Thumbnails.hpp"
 #include "../miniz_extension.hpp"
+#include "../ParallelDeflate.hpp"
 
 #include <qoi/qoi.h>
 #include <jpeglib.h>
@@ -11,7 +12,7 @@ using namespace std::literals;
 
 struct CompressedPNG : CompressedImageBuffer 
 {
-    ~CompressedPNG() override { if (data) mz_free(data); }
+    std::vector<uint8_t> png;
     std::string_view tag() const override { return "thumbnail"sv; }
 };
 
@@ -30,7 +31,11 @@ struct CompressedQOI : CompressedImageBuffer
 std::unique_ptr<CompressedImageBuffer> compress_thumbnail_png(const ThumbnailData &data)
 {
     auto out = std::make_unique<CompressedPNG>();
-    out->data = tdefl_write_image_to_png_file_in_memory_ex((const void*)data.pixels.data(), data.width, data.height, 4, &out->size, MZ_DEFAULT_LEVEL, 1);
+    out->png  = write_png_to_memory_parallel((const void*)data.pixels.data(), data.width, data.height, 4, MZ_DEFAULT_LEVEL, true);
+    if (! out->png.empty()) {
+        out->data = out->png.data();
+        out->size = out->png.size();
+    }
     return out;
 }
 
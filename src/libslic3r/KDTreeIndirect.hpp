@@ -33,9 +33,9 @@ public:
     KDTreeIndirect(CoordinateFn coordinate) : coordinate(coordinate) {}
     KDTreeIndirect(CoordinateFn coordinate, std::vector<size_t> indices) : coordinate(coordinate) { this->build(indices); }
     KDTreeIndirect(CoordinateFn coordinate, size_t num_indices) : coordinate(coordinate) { this->build(num_indices); }
-    KDTreeIndirect(KDTreeIndirect &&rhs) : m_nodes(std::move(rhs.m_nodes)), coordinate(std::move(rhs.coordinate)) {}
-    KDTreeIndirect& operator=(KDTreeIndirect &&rhs) { m_nodes = std::move(rhs.m_nodes); coordinate = std::move(rhs.coordinate); return *this; }
-    void clear() { m_nodes.clear(); }
+    KDTreeIndirect(KDTreeIndirect &&rhs) : m_nodes(std::move(rhs.m_nodes)), m_num_present(std::move(rhs.m_num_present)), m_node_of_idx(std::move(rhs.m_node_of_idx)), coordinate(std::move(rhs.coordinate)) {}
+    KDTreeIndirect& operator=(KDTreeIndirect &&rhs) { m_nodes = std::move(rhs.m_nodes); m_num_present = std::move(rhs.m_num_present); m_node_of_idx = std::move(rhs.m_node_of_idx); coordinate = std::move(rhs.coordinate); return *this; }
+    void clear() { m_nodes.clear(); this->restore(); }
 
     void build(size_t num_indices)
     {
@@ -48,6 +48,7 @@ public:
 
     void build(std::vector<size_t> &indices)
     {
+        this->restore();
         if (indices.empty())
             clear();
         else {
@@ -69,6 +70,30 @@ public:
                    (dist > CoordType(0)) ? (unsigned int)(VisitorReturnMask::CONTINUE_RIGHT) : (unsigned int)(VisitorReturnMask::CONTINUE_LEFT);
     }
 
+    // Exclude a point from the searches without rebuilding the tree. Only the subtrees, from which all the points were removed,
+    // are skipped, thus a removed point may still be passed to a visitor and the visitor shall reject it.
+    // The layout of the tree and the order, in which the remaining points are visited, do not change.
+    void remove(size_t idx)
+    {
+        if (m_num_present.empty())
+            this->init_removal();
+        size_t node = m_node_of_idx[idx];
+        if (node == npos)
+            // Already removed.
+            return;
+        m_node_of_idx[idx] = npos;
+        for (;;) {
+            assert(m_num_present[node] > 0);
+            -- m_num_present[node];
+            if (node == 0)
+                break;
+            node = (node - 1) / 2;
+        }
+    }
+
+    // Make the removed points searchable again.
+    void restore() { m_num_present.clear(); m_node_of_idx.clear(); }
+
        // Visitor is supposed to return a bit mask of VisitorReturnMask.
     template<typename Visitor>
     void visit(Visitor &visitor) const
@@ -166,11 +191,31 @@ private:
         }
     }
 
+    // Count the points in each subtree and map the points to their nodes to support remove().
+    void init_removal()
+    {
+        size_t max_idx = 0;
+        for (size_t idx : m_nodes)
+            if (idx != npos)
+                max_idx = std::max(max_idx, idx);
+        m_node_of_idx.assign(max_idx + 1, npos);
+        m_num_present.assign(m_nodes.size(), 0);
+        // Children are stored after their parents, thus the subtrees are counted bottom up.
+        for (size_t node = m_nodes.size(); node -- > 0;)
+            if (size_t idx = m_nodes[node]; idx != npos) {
+                m_node_of_idx[idx] = node;
+                size_t left = node * 2 + 1;
+                m_num_present[node] = 1 +
+                    (left     < m_nodes.size() ? m_num_present[left]     : 0) +
+                    (left + 1 < m_nodes.size() ? m_num_present[left + 1] : 0);
+            }
+    }
+
     template<typename Visitor>
     void visit_recursive(size_t node, size_t dimension, Visitor &visitor) const
     {
         assert(! m_nodes.empty());
-        if (node >= m_nodes.size() || m_nodes[node] == npos)
+        if (node >= m_nodes.size() || m_nodes[node] == npos || (! m_num_present.empty() && m_num_present[node] == 0))
             return;
 
            // Left / right child node index.
@@ -187,6 +232,10 @@ private:
     }
 
     std::vector<size_t> m_nodes;
+    // Number of points not removed in the subtree of each node, empty if no point was removed.
+    std::vector<size_t> m_num_present;
+    // Node of each point, npos if the point was removed.
+    std::vector<size_t> m_node_of_idx;
 };
 
 // Find a closest point using Euclidian metrics.
@@ -238,8 +287,9 @@ std::array<size_t, K> find_closest_points(
                     *it = res;
                 }
             }
+            // Search radius is the distance to the K-th closest point found so far.
             return kdtree.descent_mask(point[dimension],
-                                       results.front().second, idx,
+                                       results.back().second, idx,
                                        dimension);
         }
     } visitor(kdtree, point, filter);
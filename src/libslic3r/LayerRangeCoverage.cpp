@@ -0,0 +1,70 @@
+#include "LayerRangeCoverage.hpp"
+#include "ClipperUtils.hpp"
+
+#include <cassert>
+
+#include <tbb/parallel_for.h>
+
+namespace Slic3r {
+
+// Index of the highest set bit, floor(log2(n)) for n > 0.
+static inline size_t floor_log2(size_t n)
+{
+    assert(n > 0);
+    size_t out = 0;
+    while (n >>= 1)
+        ++ out;
+    return out;
+}
+
+LayerRangeCoverage::LayerRangeCoverage(size_t num_layers, LayerPolygonsFn layer_polygons, Mode mode, size_t max_range, const std::function<void()> &throw_on_cancel) :
+    m_layer_polygons(std::move(layer_polygons)), m_num_layers(num_layers), m_mode(mode)
+{
+    assert(m_layer_polygons);
+    max_range = std::min(max_range, num_layers);
+    if (max_range < 2)
+        return;
+    const size_t num_levels = floor_log2(max_range);
+    m_levels.reserve(num_levels);
+    for (size_t level = 1; level <= num_levels; ++ level) {
+        const size_t half = size_t(1) << (level - 1);
+        // Number of spans of 2^level layers fitting into num_layers.
+        const size_t num_spans = num_layers + 1 - (half << 1);
+        std::vector<Polygons> spans(num_spans);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_spans, std::max(num_spans / 64, size_t(1))),
+            [this, level, half, &spans, &throw_on_cancel](const tbb::blocked_range<size_t> &range) {
+                for (size_t idx = range.begin(); idx < range.end(); ++ idx) {
+                    throw_on_cancel();
+                    spans[idx] = this->merge(this->span(level - 1, idx), this->span(level - 1, idx + half));
+                }
+            });
+        m_levels.emplace_back(std::move(spans));
+    }
+}
+
+Polygons LayerRangeCoverage::merge(const Polygons &a, const Polygons &b) const
+{
+    if (m_mode == Mode::Union) {
+        if (a.empty())
+            return union_(b);
+        if (b.empty())
+            return union_(a);
+        return union_(a, b);
+    }
+    return a.empty() || b.empty() ? Polygons() : intersection(a, b);
+}
+
+Polygons LayerRangeCoverage::query(size_t begin, size_t end) const
+{
+    assert(! this->empty());
+    assert(end <= m_num_layers);
+    if (begin >= end)
+        return {};
+    const size_t len = end - begin;
+    assert(len <= this->max_range());
+    const size_t level = floor_log2(len);
+    const size_t second = end - (size_t(1) << level);
+    return second == begin ? this->span(level, begin) : this->merge(this->span(level, begin), this->span(level, second));
+}
+
+} // namespace Slic3r
@@ -0,0 +1,60 @@
+#ifndef slic3r_LayerRangeCoverage_hpp_
+#define slic3r_LayerRangeCoverage_hpp_
+
+#include "Polygon.hpp"
+
+#include <functional>
+
+namespace Slic3r {
+
+// Sparse table over per layer polygons, answering "union / intersection of layers [begin, end)"
+// with a single Clipper operation over two pre-merged spans of layers.
+// Both union and intersection are idempotent, therefore the two spans may overlap.
+// The index is built in parallel and it is read only after construction, thus it may be queried
+// from multiple threads concurrently.
+// Used by PrintObject::discover_vertical_shells() and PrintObject::bridge_over_infill()
+// to replace the chains of union_() / intersection() over the k layers above and below a layer.
+class LayerRangeCoverage
+{
+public:
+    enum class Mode {
+        Union,
+        Intersection,
+    };
+
+    // Accessor of the source polygons of a layer. The referenced polygons must stay valid and unchanged
+    // for the life time of the index, the source polygons are not copied.
+    using LayerPolygonsFn = std::function<const Polygons&(size_t idx_layer)>;
+
+    LayerRangeCoverage() = default;
+    // Build an index over num_layers layers, which is able to answer queries over ranges of up to max_range layers.
+    // Memory and build time are proportional to num_layers * log2(max_range).
+    LayerRangeCoverage(size_t num_layers, LayerPolygonsFn layer_polygons, Mode mode, size_t max_range,
+        const std::function<void()> &throw_on_cancel = [](){});
+
+    bool        empty()      const { return ! m_layer_polygons; }
+    size_t      num_layers() const { return m_num_layers; }
+    Mode        mode()       const { return m_mode; }
+    // Longest range of layers, which could be queried.
+    size_t      max_range()  const { return this->empty() ? 0 : (size_t(2) << m_levels.size()) - 1; }
+
+    // Union or intersection of layers [begin, end) depending on mode().
+    // Returns an empty set for an empty range.
+    Polygons    query(size_t begin, size_t end) const;
+
+private:
+    // Polygons merged over layers [idx, idx + 2^level).
+    const Polygons& span(size_t level, size_t idx) const 
+        { return level == 0 ? m_layer_polygons(idx) : m_levels[level - 1][idx]; }
+    Polygons        merge(const Polygons &a, const Polygons &b) const;
+
+    LayerPolygonsFn                     m_layer_polygons;
+    size_t                              m_num_layers { 0 };
+    Mode                                m_mode { Mode::Union };
+    // m_levels[k - 1][i] contains layers [i, i + 2^k) merged. Level zero is not stored, it is provided by m_layer_polygons.
+    std::vector<std::vector<Polygons>>  m_levels;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_LayerRangeCoverage_hpp_
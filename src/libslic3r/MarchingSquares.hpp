@@ -37,6 +37,11 @@ template<class T, class Enable = void> struct _RasterTraits {
     // Number of rows and cols of the raster
     static size_t rows(const T &raster);
     static size_t cols(const T &raster);
+
+    // Optional: pointer to the first value of a row if the rows are stored
+    // contiguously. If defined, the grid is tagged row by row directly from
+    // the raster memory.
+    // static const ValueType *row(const T &raster, size_t row);
 };
 
 // Specialize this to use parellel loops within the algorithm
@@ -67,6 +72,12 @@ template<class T> TRasterValue<T> isoval(const T &rst, const Coord &crd)
     return RasterTraits<T>::get(rst, crd.r, crd.c);
 }
 
+template<class T, class = void> struct HasRowAccess : std::false_type {};
+template<class T>
+struct HasRowAccess<T, std::void_t<decltype(RasterTraits<T>::row(
+                           std::declval<const std::decay_t<T> &>(), size_t(0)))>>
+    : std::true_type {};
+
 template<class ExecutionPolicy, class It, class Fn>
 void for_each(ExecutionPolicy&& policy, It from, It to, Fn &&fn)
 {
@@ -145,6 +156,10 @@ template<class Rst> class Grid {
     Coord                  m_cellsize, m_res_1, m_window, m_gridsize, m_grid_1;
     std::vector<uint8_t>   m_tags;     // Assign tags to each square
 
+    // Nonzero for the rows of the grid with at least one square crossed by
+    // a contour. The other rows are skipped when searching for a new ring.
+    std::vector<uint8_t>   m_row_has_contour;
+
     Coord rastercoord(const Coord &crd) const
     {
         return {(crd.r - 1) * m_window.r, (crd.c - 1) * m_window.c};
@@ -208,9 +223,55 @@ template<class Rst> class Grid {
     {
         // Skip ambiguous tags as starting tags due to unknown previous
         // direction.
-        while ((i < m_tags.size()) && (is_visited(i) || is_ambiguous(i))) ++i;
+        while (i < m_tags.size()) {
+            size_t row = i / size_t(m_gridsize.c);
+            if (!m_row_has_contour[row])
+                i = (row + 1) * size_t(m_gridsize.c);
+            else if (is_visited(i) || is_ambiguous(i))
+                ++i;
+            else
+                break;
+        }
         
-        return i;
+        return std::min(i, m_tags.size());
+    }
+
+    // Tag the squares of a grid row with the generic raster access.
+    void tag_row(size_t row, TRasterValue<Rst> v)
+    {
+        uint8_t *tags = m_tags.data() + row * size_t(m_gridsize.c);
+        for (long c = 0; c < m_gridsize.c; ++c)
+            tags[c] = get_tag_for_cell(Coord{long(row), c}, v);
+    }
+
+    // Tag the squares of a grid row reading the rows of the raster directly.
+    // The vertices of the squares are sampled and thresholded into bit
+    // arrays first, which are then combined into the tags in simple loops
+    // over whole rows.
+    void tag_row_direct(size_t row, TRasterValue<Rst> v)
+    {
+        const long R = rows(*m_rst), C = cols(*m_rst), N = m_gridsize.c;
+        const long top = tl(Coord{long(row), 0}).r, bottom = top + m_res_1.r;
+
+        // Thresholded values of the left and right vertices of the squares
+        // in a raster row, zero outside of the raster.
+        auto sample = [this, v, C, N](long r, std::vector<uint8_t> &left,
+                                      std::vector<uint8_t> &right) {
+            const TRasterValue<Rst> *px = RasterTraits<Rst>::row(*m_rst, size_t(r));
+            for (long c = 0; c < N; ++c) {
+                long lc = (c - 1) * m_window.c, rc = lc + m_res_1.c;
+                left[c]  = lc >= 0 && lc < C && px[lc] >= v;
+                right[c] = rc >= 0 && rc < C && px[rc] >= v;
+            }
+        };
+
+        std::vector<uint8_t> tl_(N, 0), tr_(N, 0), bl_(N, 0), br_(N, 0);
+        if (top >= 0 && top < R) sample(top, tl_, tr_);
+        if (bottom >= 0 && bottom < R) sample(bottom, bl_, br_);
+
+        uint8_t *tags = m_tags.data() + row * size_t(N);
+        for (long c = 0; c < N; ++c)
+            tags[c] = uint8_t(bl_[c] | (br_[c] << 1) | (tr_[c] << 2) | (tl_[c] << 3));
     }
     
     SquareTag get_tag(size_t idx) const { return SquareTag(m_tags[idx] & 0x0f); }
@@ -336,6 +397,7 @@ public:
         , m_gridsize{2 + (long(rows(rst)) - overlap.r) / m_window.r,
                      2 + (long(cols(rst)) - overlap.c) / m_window.c}
         , m_tags(m_gridsize.r * m_gridsize.c, 0)
+        , m_row_has_contour(m_gridsize.r, 0)
     {}
     
     // Go through the cells and mark them with the appropriate tag.
@@ -344,9 +406,17 @@ public:
     {        
         // parallel for r
         for_each (std::forward<ExecutionPolicy>(policy),
-                 m_tags.begin(), m_tags.end(),
-                 [this, isoval](uint8_t& tag, size_t idx) {
-            tag = get_tag_for_cell(coord(idx), isoval);
+                 m_row_has_contour.begin(), m_row_has_contour.end(),
+                 [this, isoval](uint8_t &has_contour, size_t row) {
+            if constexpr (HasRowAccess<Rst>::value)
+                tag_row_direct(row, isoval);
+            else
+                tag_row(row, isoval);
+
+            auto from = m_tags.begin() + row * size_t(m_gridsize.c);
+            has_contour = std::any_of(from, from + m_gridsize.c, [](uint8_t t) {
+                return t != _t(SquareTag::none) && t != _t(SquareTag::full);
+            });
         });
     }
     
@@ -616,13 +616,24 @@ ModelObject& ModelObject::assign_copy(const ModelObject &rhs)
 
     this->name                        = rhs.name;
     this->input_file                  = rhs.input_file;
-    // Copies the config's ID
-    this->config                      = rhs.config;
+    // Copies the config's ID. The content is only copied if it was modified since the last copy.
+    if (this->config.id() == rhs.config.id())
+        this->config.assign_config(rhs.config);
+    else
+        this->config                  = rhs.config;
     assert(this->config.id() == rhs.config.id());
     this->sla_support_points          = rhs.sla_support_points;
     this->sla_points_status           = rhs.sla_points_status;
     this->sla_drain_holes             = rhs.sla_drain_holes;
-    this->layer_config_ranges         = rhs.layer_config_ranges;
+    if (this->layer_config_ranges.size() == rhs.layer_config_ranges.size() &&
+        std::equal(this->layer_config_ranges.begin(), this->layer_config_ranges.end(), rhs.layer_config_ranges.begin(), 
+            [](const auto &l, const auto &r) { return l.first == r.first; })) {
+        // Same layer ranges, copy just the modified configs.
+        auto it_src = rhs.layer_config_ranges.begin();
+        for (auto &kvp_dst : this->layer_config_ranges)
+            kvp_dst.second.assign_config((it_src ++)->second);
+    } else
+        this->layer_config_ranges     = rhs.layer_config_ranges;
     this->layer_height_profile        = rhs.layer_height_profile;
     this->printable                   = rhs.printable;
     this->origin_translation          = rhs.origin_translation;
@@ -634,12 +645,30 @@ ModelObject& ModelObject::assign_copy(const ModelObject &rhs)
     m_raw_mesh_bounding_box           = rhs.m_raw_mesh_bounding_box;
     m_raw_mesh_bounding_box_valid     = rhs.m_raw_mesh_bounding_box_valid;
 
-    this->clear_volumes();
+    // Volumes of this object, which are copies of the volumes of rhs, are reused: Their meshes are shared,
+    // their configs and painted facets are only copied if they were modified since the last copy.
+    // Print::apply() synchronizes its private copy of a ModelObject this way.
+    ModelVolumePtrs volumes_old = std::move(this->volumes);
+    this->volumes.clear();
+    this->invalidate_bounding_box();
+    model_volumes_sort_by_id(volumes_old);
+    std::vector<bool> volumes_old_reused(volumes_old.size(), false);
     this->volumes.reserve(rhs.volumes.size());
-    for (ModelVolume *model_volume : rhs.volumes) {
-        this->volumes.emplace_back(new ModelVolume(*model_volume));
-        this->volumes.back()->set_model_object(this);
+    for (const ModelVolume *model_volume : rhs.volumes) {
+        auto it = lower_bound_by_predicate(volumes_old.begin(), volumes_old.end(), [model_volume](const ModelVolume *l) { return l->id() < model_volume->id(); });
+        if (it != volumes_old.end() && (*it)->id() == model_volume->id() && (*it)->assign_copy_if_same_ids(*model_volume)) {
+            assert(! volumes_old_reused[it - volumes_old.begin()]);
+            volumes_old_reused[it - volumes_old.begin()] = true;
+            this->volumes.emplace_back(*it);
+        } else {
+            this->volumes.emplace_back(new ModelVolume(*model_volume));
+            this->volumes.back()->set_model_object(this);
+        }
     }
+    for (size_t i = 0; i < volumes_old.size(); ++ i)
+        if (! volumes_old_reused[i])
+            delete volumes_old[i];
+
     this->clear_instances();
 	this->instances.reserve(rhs.instances.size());
     for (const ModelInstance *model_instance : rhs.instances) {
@@ -2063,6 +2092,29 @@ bool ModelObject::has_solid_mesh() const
     return false;
 }
 
+bool ModelVolume::assign_copy_if_same_ids(const ModelVolume &rhs)
+{
+    if (this->id() != rhs.id() || this->config.id() != rhs.config.id() || this->supported_facets.id() != rhs.supported_facets.id() ||
+        this->seam_facets.id() != rhs.seam_facets.id() || this->mmu_segmentation_facets.id() != rhs.mmu_segmentation_facets.id())
+        return false;
+    this->name               = rhs.name;
+    this->source             = rhs.source;
+    this->cut_info           = rhs.cut_info;
+    this->text_configuration = rhs.text_configuration;
+    // The following are only copied if their timestamps differ.
+    this->config.assign_config(rhs.config);
+    this->supported_facets.assign(rhs.supported_facets);
+    this->seam_facets.assign(rhs.seam_facets);
+    this->mmu_segmentation_facets.assign(rhs.mmu_segmentation_facets);
+    m_mesh                   = rhs.m_mesh;
+    m_type                   = rhs.m_type;
+    m_material_id            = rhs.m_material_id;
+    m_convex_hull            = rhs.m_convex_hull;
+    m_transformation         = rhs.m_transformation;
+    m_is_splittable          = rhs.m_is_splittable;
+    return true;
+}
+
 void ModelVolume::set_material_id(t_model_material_id material_id)
 {
     m_material_id = material_id;
@@ -921,6 +921,10 @@ protected:
 
 	// Copies IDs of both the ModelVolume and its config.
 	explicit ModelVolume(const ModelVolume &rhs) = default;
+    // Copies the content of rhs, if rhs is a copy of this volume with the same IDs of the volume, its config and painted facets.
+    // The meshes are shared, the config and the painted facets are only copied if their timestamps differ.
+    // Returns false and does not modify this volume if the IDs differ.
+    bool     assign_copy_if_same_ids(const ModelVolume &rhs);
     void     set_model_object(ModelObject *model_object) { object = model_object; }
 	void 	 assign_new_unique_ids_recursive() override;
     void     transform_this_mesh(const Transform3d& t, bool fix_left_handed);
@@ -9,8 +9,13 @@
 
 #include <utility>
 #include <cfloat>
+#include <optional>
+#include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 
+#include <boost/container_hash/hash.hpp>
+
 #include <boost/log/trivial.hpp>
 #include <tbb/parallel_for.h>
 #include <mutex>
@@ -1676,7 +1681,68 @@ static bool has_layer_only_one_color(const std::vector<std::vector<ColoredLine>>
     return true;
 }
 
-std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
+struct MMUSegmentationCache::Entry
+{
+    // Hash of the input of the layer segmentation, for a quick rejection.
+    size_t                      hash;
+    // Input of the layer segmentation.
+    ExPolygons                  input_expolygons;
+    std::vector<PaintedLine>    painted_lines;
+    size_t                      num_extruders;
+    // Output of the layer segmentation.
+    std::vector<ExPolygons>     segmented_regions;
+
+    bool matches(size_t hash, const ExPolygons &input_expolygons, const std::vector<PaintedLine> &painted_lines, size_t num_extruders) const {
+        return this->hash == hash && this->num_extruders == num_extruders && this->input_expolygons == input_expolygons &&
+            std::equal(this->painted_lines.begin(), this->painted_lines.end(), painted_lines.begin(), painted_lines.end(),
+                [](const PaintedLine &l, const PaintedLine &r) {
+                    return l.contour_idx == r.contour_idx && l.line_idx == r.line_idx && l.projected_line == r.projected_line && l.color == r.color;
+                });
+    }
+};
+
+MMUSegmentationCache::MMUSegmentationCache() = default;
+MMUSegmentationCache::~MMUSegmentationCache() = default;
+void MMUSegmentationCache::clear() { m_entries.clear(); m_segmented_layers.clear(); }
+bool MMUSegmentationCache::empty() const { return m_entries.empty(); }
+
+// Sort painted lines of a layer by a total order. The painted lines are collected in parallel, thus their order is random.
+static void sort_painted_lines(std::vector<PaintedLine> &painted_lines)
+{
+    std::sort(painted_lines.begin(), painted_lines.end(), [](const PaintedLine &l, const PaintedLine &r) {
+        return std::tie(l.contour_idx, l.line_idx, l.projected_line.a.x(), l.projected_line.a.y(), l.projected_line.b.x(), l.projected_line.b.y(), l.color) <
+               std::tie(r.contour_idx, r.line_idx, r.projected_line.a.x(), r.projected_line.a.y(), r.projected_line.b.x(), r.projected_line.b.y(), r.color);
+    });
+}
+
+static size_t mmu_segmentation_input_hash(const ExPolygons &input_expolygons, const std::vector<PaintedLine> &painted_lines, size_t num_extruders)
+{
+    size_t seed = num_extruders;
+    auto hash_points = [&seed](const Points &pts) {
+        boost::hash_combine(seed, pts.size());
+        for (const Point &pt : pts) {
+            boost::hash_combine(seed, pt.x());
+            boost::hash_combine(seed, pt.y());
+        }
+    };
+    for (const ExPolygon &expoly : input_expolygons) {
+        hash_points(expoly.contour.points);
+        for (const Polygon &hole : expoly.holes)
+            hash_points(hole.points);
+    }
+    for (const PaintedLine &pl : painted_lines) {
+        boost::hash_combine(seed, pl.contour_idx);
+        boost::hash_combine(seed, pl.line_idx);
+        boost::hash_combine(seed, pl.projected_line.a.x());
+        boost::hash_combine(seed, pl.projected_line.a.y());
+        boost::hash_combine(seed, pl.projected_line.b.x());
+        boost::hash_combine(seed, pl.projected_line.b.y());
+        boost::hash_combine(seed, pl.color);
+    }
+    return seed;
+}
+
+std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback, MMUSegmentationCache *cache)
 {
     const size_t                          num_extruders = print_object.print()->config().nozzle_diameter.size();
     const size_t                          num_layers    = print_object.layers().size();
@@ -1829,11 +1895,35 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
     BOOST_LOG_TRIVIAL(debug) << "MMU segmentation - painted layers count: "
                              << std::count_if(painted_lines.begin(), painted_lines.end(), [](const std::vector<PaintedLine> &pl) { return !pl.empty(); });
 
+    // Entries of the cache from the previous run indexed by their hash, and entries collected by this run.
+    std::unordered_multimap<size_t, const MMUSegmentationCache::Entry*> cached_by_hash;
+    std::vector<std::optional<MMUSegmentationCache::Entry>>              new_cache_entries(cache ? num_layers : 0);
+    if (cache)
+        for (const MMUSegmentationCache::Entry &entry : cache->m_entries)
+            cached_by_hash.emplace(entry.hash, &entry);
+    // Not std::vector<bool>, which is not safe to be written by multiple threads.
+    std::vector<uint8_t>                                                 reused_layers(cache ? num_layers : 0, false);
+
     BOOST_LOG_TRIVIAL(debug) << "MMU segmentation - layers segmentation in parallel - begin";
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_extruders, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_extruders, &throw_on_cancel_callback,
+                                                                  cache, &cached_by_hash, &new_cache_entries, &reused_layers](const tbb::blocked_range<size_t> &range) {
         for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
             throw_on_cancel_callback();
             if (!painted_lines[layer_idx].empty()) {
+                if (cache) {
+                    // Reuse the segmentation of a layer with the same slices and the same painting from the previous run.
+                    sort_painted_lines(painted_lines[layer_idx]);
+                    const size_t hash = mmu_segmentation_input_hash(input_expolygons[layer_idx], painted_lines[layer_idx], num_extruders);
+                    auto [it_begin, it_end] = cached_by_hash.equal_range(hash);
+                    auto it = std::find_if(it_begin, it_end, [&](const auto &kvp) { return kvp.second->matches(hash, input_expolygons[layer_idx], painted_lines[layer_idx], num_extruders); });
+                    if (it != it_end) {
+                        segmented_regions[layer_idx] = it->second->segmented_regions;
+                        new_cache_entries[layer_idx] = *it->second;
+                        reused_layers[layer_idx] = true;
+                        continue;
+                    }
+                    new_cache_entries[layer_idx] = MMUSegmentationCache::Entry{ hash, input_expolygons[layer_idx], painted_lines[layer_idx], num_extruders, {} };
+                }
 #ifdef MMU_SEGMENTATION_DEBUG_PAINTED_LINES
                 {
                     static int iRun = 0;
@@ -1885,12 +1975,28 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
                     export_regions_to_svg(debug_out_path("mm-regions-sides-%d-%d.svg", layer_idx, iRun++), segmented_regions[layer_idx], input_expolygons[layer_idx]);
                 }
 #endif // MMU_SEGMENTATION_DEBUG_REGIONS
+                if (cache)
+                    new_cache_entries[layer_idx]->segmented_regions = segmented_regions[layer_idx];
             }
         }
     }); // end of parallel_for
     BOOST_LOG_TRIVIAL(debug) << "MMU segmentation - layers segmentation in parallel - end";
     throw_on_cancel_callback();
 
+    if (cache) {
+        // Only keep the layers of this run, the layers of the previous run are not needed anymore.
+        BOOST_LOG_TRIVIAL(debug) << "MMU segmentation - reused segmentation of " << std::count(reused_layers.begin(), reused_layers.end(), true) << " painted layers";
+        cached_by_hash.clear();
+        cache->m_entries.clear();
+        cache->m_segmented_layers.clear();
+        for (size_t layer_idx = 0; layer_idx < num_layers; ++ layer_idx)
+            if (std::optional<MMUSegmentationCache::Entry> &entry = new_cache_entries[layer_idx]; entry) {
+                if (! reused_layers[layer_idx])
+                    cache->m_segmented_layers.emplace_back(layer_idx);
+                cache->m_entries.emplace_back(std::move(*entry));
+            }
+    }
+
     if (auto w = print_object.config().mmu_segmented_region_max_width; w > 0.f) {
         cut_segmented_layers(input_expolygons, segmented_regions, float(-scale_(w)), throw_on_cancel_callback);
         throw_on_cancel_callback();
@@ -1,6 +1,8 @@
 #ifndef slic3r_MultiMaterialSegmentation_hpp_
 #define slic3r_MultiMaterialSegmentation_hpp_
 
+#include <functional>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -10,8 +12,36 @@ namespace Slic3r {
 class PrintObject;
 class ExPolygon;
 
+// Segmentation of the painted layers produced by the last call of multi_material_segmentation_by_painting(),
+// keyed by the layer's input slices and the painted lines projected onto them.
+// Kept by PrintObject between slicing runs, so that after repainting a part of an object only the layers
+// whose painting changed run the expensive Voronoi based segmentation again.
+class MMUSegmentationCache
+{
+public:
+    MMUSegmentationCache();
+    ~MMUSegmentationCache();
+
+    void clear();
+    bool empty() const;
+
+    // Indices of the painted layers segmented by the last run, the other painted layers were reused.
+    const std::vector<size_t>& segmented_layers() const { return m_segmented_layers; }
+
+private:
+    struct Entry;
+    // Entries of the last segmentation run.
+    std::vector<Entry>  m_entries;
+    std::vector<size_t> m_segmented_layers;
+
+    friend std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(
+        const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback, MMUSegmentationCache *cache);
+};
+
 // Returns MMU segmentation based on painting in MMU segmentation gizmo
-std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
+// If cache is provided, painted layers with unchanged input are reused from the previous run and the cache is updated.
+std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(
+    const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback, MMUSegmentationCache *cache = nullptr);
 
 } // namespace Slic3r
 
@@ -79,6 +79,9 @@ void grid_intersection(VoxelGrid &grid, VoxelGrid &arg);
 
 bool is_grid_empty(const VoxelGrid &grid);
 
+// Memory taken by the grid in bytes.
+size_t grid_memory_usage(const VoxelGrid &grid);
+
 } // namespace Slic3r
 
 #endif // OPENVDBUTILS_HPP
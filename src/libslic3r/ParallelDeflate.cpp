@@ -0,0 +1,259 @@
+#include "ParallelDeflate.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Execution/ExecutionTBB.hpp"
+
+namespace Slic3r {
+
+namespace {
+
+// Collects the output of a tdefl compressor.
+mz_bool put_buf(const void *buf, int len, void *user)
+{
+    auto *out = static_cast<std::vector<uint8_t>*>(user);
+    out->insert(out->end(), static_cast<const uint8_t*>(buf), static_cast<const uint8_t*>(buf) + len);
+    return MZ_TRUE;
+}
+
+struct Chunk
+{
+    std::vector<uint8_t> data;
+    uint32_t             crc32   = 0;
+    uint32_t             adler32 = 1;
+    bool                 ok      = false;
+};
+
+// Compresses a single chunk as a part of a raw deflate stream. All chunks but the last one
+// are terminated by a sync flush to be byte aligned, the last one by a final block if finish is set.
+void deflate_chunk(const uint8_t *data, size_t size, int level, bool last, bool finish, Chunk &chunk)
+{
+    chunk.crc32   = uint32_t(mz_crc32(MZ_CRC32_INIT, data, size));
+    chunk.adler32 = uint32_t(mz_adler32(MZ_ADLER32_INIT, data, size));
+    chunk.data.reserve(size / 2 + 64);
+    tdefl_compressor *compressor = tdefl_compressor_alloc();
+    if (compressor == nullptr)
+        return;
+    if (tdefl_init(compressor, put_buf, &chunk.data, int(tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY))) == TDEFL_STATUS_OKAY) {
+        tdefl_status status = tdefl_compress_buffer(compressor, data, size, last && finish ? TDEFL_FINISH : TDEFL_SYNC_FLUSH);
+        chunk.ok = status == TDEFL_STATUS_OKAY || status == TDEFL_STATUS_DONE;
+    }
+    tdefl_compressor_free(compressor);
+}
+
+uint32_t gf2_matrix_times(const uint32_t *mat, uint32_t vec)
+{
+    uint32_t sum = 0;
+    for (; vec; vec >>= 1, ++ mat)
+        if (vec & 1)
+            sum ^= *mat;
+    return sum;
+}
+
+void gf2_matrix_square(uint32_t *square, const uint32_t *mat)
+{
+    for (int n = 0; n < 32; ++ n)
+        square[n] = gf2_matrix_times(mat, mat[n]);
+}
+
+void append_be32(std::vector<uint8_t> &out, uint32_t v)
+{
+    out.push_back(uint8_t(v >> 24));
+    out.push_back(uint8_t(v >> 16));
+    out.push_back(uint8_t(v >> 8));
+    out.push_back(uint8_t(v));
+}
+
+void append_png_chunk(std::vector<uint8_t> &out, const char *type, const uint8_t *data, size_t size)
+{
+    append_be32(out, uint32_t(size));
+    size_t begin = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    append_be32(out, uint32_t(mz_crc32(MZ_CRC32_INIT, out.data() + begin, out.size() - begin)));
+}
+
+} // namespace
+
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, size_t len2)
+{
+    // The GF(2) matrix method of zlib: Applies len2 zero bytes to crc1 by repeated squaring
+    // of the operator of a single zero bit.
+    if (len2 == 0)
+        return crc1;
+    uint32_t even[32];
+    uint32_t odd[32];
+    odd[0] = 0xedb88320u;
+    for (uint32_t n = 1, row = 1; n < 32; ++ n, row <<= 1)
+        odd[n] = row;
+    // Operators of two and four zero bits.
+    gf2_matrix_square(even, odd);
+    gf2_matrix_square(odd, even);
+    do {
+        gf2_matrix_square(even, odd);
+        if (len2 & 1)
+            crc1 = gf2_matrix_times(even, crc1);
+        len2 >>= 1;
+        if (len2 == 0)
+            break;
+        gf2_matrix_square(odd, even);
+        if (len2 & 1)
+            crc1 = gf2_matrix_times(odd, crc1);
+        len2 >>= 1;
+    } while (len2 != 0);
+    return crc1 ^ crc2;
+}
+
+uint32_t adler32_combine(uint32_t adler1, uint32_t adler2, size_t len2)
+{
+    static constexpr const uint32_t BASE = 65521;
+    uint32_t rem  = uint32_t(len2 % BASE);
+    uint32_t sum1 = adler1 & 0xffff;
+    uint32_t sum2 = uint32_t((uint64_t(rem) * sum1) % BASE);
+    sum1 += (adler2 & 0xffff) + BASE - 1;
+    sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + BASE - rem;
+    if (sum1 >= BASE) sum1 -= BASE;
+    if (sum1 >= BASE) sum1 -= BASE;
+    if (sum2 >= (BASE << 1)) sum2 -= (BASE << 1);
+    if (sum2 >= BASE) sum2 -= BASE;
+    return sum1 | (sum2 << 16);
+}
+
+bool deflate_parallel(const void *data, size_t size, int level, bool finish, DeflatedData &out)
+{
+    if (size == 0 && ! finish)
+        return true;
+
+    // At least one chunk to emit the final block.
+    const size_t       num_chunks = std::max<size_t>(1, (size + DEFLATE_CHUNK_SIZE - 1) / DEFLATE_CHUNK_SIZE);
+    std::vector<Chunk> chunks(num_chunks);
+    auto              *src        = static_cast<const uint8_t*>(data);
+    execution::for_each(ex_tbb, size_t(0), num_chunks, [src, size, level, finish, num_chunks, &chunks](size_t i) {
+        size_t begin = i * DEFLATE_CHUNK_SIZE;
+        size_t end   = std::min(size, begin + DEFLATE_CHUNK_SIZE);
+        deflate_chunk(src + begin, end - begin, level, i + 1 == num_chunks, finish, chunks[i]);
+    });
+
+    size_t compressed_size = 0;
+    for (const Chunk &chunk : chunks) {
+        if (! chunk.ok)
+            return false;
+        compressed_size += chunk.data.size();
+    }
+    out.data.reserve(out.data.size() + compressed_size);
+    for (size_t i = 0; i < num_chunks; ++ i) {
+        const Chunk &chunk      = chunks[i];
+        size_t       chunk_size = std::min(size, (i + 1) * DEFLATE_CHUNK_SIZE) - std::min(size, i * DEFLATE_CHUNK_SIZE);
+        out.data.insert(out.data.end(), chunk.data.begin(), chunk.data.end());
+        out.crc32              = crc32_combine(out.crc32, chunk.crc32, chunk_size);
+        out.adler32            = adler32_combine(out.adler32, chunk.adler32, chunk_size);
+        out.uncompressed_size += chunk_size;
+    }
+    return true;
+}
+
+std::vector<uint8_t> write_png_to_memory_parallel(const void *pixels, int w, int h, int num_chans, int level, bool flip)
+{
+    static const uint8_t color_types[] = { 0, 0, 4, 2, 6 };
+    if (w <= 0 || h <= 0 || num_chans < 1 || num_chans > 4)
+        return {};
+
+    // Scanlines with the filter type 0 (none) prepended, as written by tdefl_write_image_to_png_file_in_memory_ex().
+    const size_t         bpl = size_t(w) * size_t(num_chans);
+    std::vector<uint8_t> scanlines((bpl + 1) * size_t(h));
+    for (size_t y = 0; y < size_t(h); ++ y) {
+        const uint8_t *row = static_cast<const uint8_t*>(pixels) + (flip ? size_t(h) - 1 - y : y) * bpl;
+        scanlines[y * (bpl + 1)] = 0;
+        memcpy(scanlines.data() + y * (bpl + 1) + 1, row, bpl);
+    }
+
+    // zlib stream: header, raw deflate data, adler32 of the uncompressed data.
+    DeflatedData deflated;
+    {
+        const int flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+        uint32_t  header = (0x78u << 8) | uint32_t(flevel << 6);
+        header += 31 - header % 31;
+        deflated.data = { uint8_t(header >> 8), uint8_t(header) };
+    }
+    if (! deflate_parallel(scanlines.data(), scanlines.size(), level, true, deflated))
+        return {};
+    append_be32(deflated.data, deflated.adler32);
+    scanlines = std::vector<uint8_t>();
+
+    std::vector<uint8_t> out;
+    out.reserve(deflated.data.size() + 64);
+    static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    out.insert(out.end(), signature, signature + sizeof(signature));
+    const uint8_t ihdr[] = {
+        uint8_t(w >> 24), uint8_t(w >> 16), uint8_t(w >> 8), uint8_t(w),
+        uint8_t(h >> 24), uint8_t(h >> 16), uint8_t(h >> 8), uint8_t(h),
+        // bit depth, color type, compression, filter, interlace
+        8, color_types[num_chans], 0, 0, 0 };
+    append_png_chunk(out, "IHDR", ihdr, sizeof(ihdr));
+    append_png_chunk(out, "IDAT", deflated.data.data(), deflated.data.size());
+    append_png_chunk(out, "IEND", nullptr, 0);
+    return out;
+}
+
+bool zip_add_mem_parallel(mz_zip_archive &archive, const std::string &name, const void *data, size_t size, int level)
+{
+    DeflatedData deflated;
+    if (! deflate_parallel(data, size, level, true, deflated)) {
+        archive.m_last_error = MZ_ZIP_COMPRESSION_FAILED;
+        return false;
+    }
+    return mz_zip_writer_add_mem_ex(&archive, name.c_str(), deflated.data.data(), deflated.data.size(), nullptr, 0,
+        mz_uint(level) | MZ_ZIP_FLAG_COMPRESSED_DATA, size, deflated.crc32);
+}
+
+ParallelDeflateStagedWriter::ParallelDeflateStagedWriter(mz_zip_writer_staged_context &context, int level)
+    : m_context(context), m_level(level)
+    // Enough data to keep all the cores busy, two chunks per core.
+    , m_batch_size(2 * DEFLATE_CHUNK_SIZE * std::max<size_t>(1, execution::max_concurrency(ex_tbb)))
+{
+    m_buffer.reserve(m_batch_size);
+}
+
+bool ParallelDeflateStagedWriter::write(const char *data, size_t size)
+{
+    while (size > 0) {
+        size_t n = std::min(size, m_batch_size - m_buffer.size());
+        m_buffer.insert(m_buffer.end(), data, data + n);
+        data += n;
+        size -= n;
+        if (m_buffer.size() == m_batch_size && ! this->flush())
+            return false;
+    }
+    return true;
+}
+
+bool ParallelDeflateStagedWriter::flush()
+{
+    m_deflated.data.clear();
+    if (! deflate_parallel(m_buffer.data(), m_buffer.size(), m_level, false, m_deflated)) {
+        m_context.pZip->m_last_error = MZ_ZIP_COMPRESSION_FAILED;
+        return false;
+    }
+    bool ok = mz_zip_writer_add_staged_compressed_data(&m_context, m_deflated.data.data(), m_deflated.data.size(), m_buffer.size(), m_deflated.crc32);
+    m_buffer.clear();
+    return ok;
+}
+
+bool ParallelDeflateStagedWriter::write_deflated(const DeflatedData &deflated)
+{
+    if (! m_buffer.empty() && ! this->flush())
+        return false;
+    // mz_zip_writer_add_staged_compressed_data() expects the checksum of all the data of the file written so far.
+    m_deflated.crc32              = crc32_combine(m_deflated.crc32, deflated.crc32, deflated.uncompressed_size);
+    m_deflated.uncompressed_size += deflated.uncompressed_size;
+    return mz_zip_writer_add_staged_compressed_data(&m_context, deflated.data.data(), deflated.data.size(), deflated.uncompressed_size, m_deflated.crc32);
+}
+
+bool ParallelDeflateStagedWriter::finish()
+{
+    // mz_zip_writer_add_staged_finish() terminates the deflate stream by an empty final block.
+    return (m_buffer.empty() || this->flush()) && mz_zip_writer_add_staged_finish(&m_context);
+}
+
+} // namespace Slic3r
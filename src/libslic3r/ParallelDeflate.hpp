@@ -0,0 +1,80 @@
+#ifndef slic3r_ParallelDeflate_hpp_
+#define slic3r_ParallelDeflate_hpp_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <miniz.h>
+
+namespace Slic3r {
+
+// Deflate compression of large buffers on all cores, in the manner of pigz:
+// The input is split into chunks, which are compressed independently in parallel.
+// Each chunk except for the last one is terminated by an empty stored block (a sync flush),
+// so that the compressed chunks simply concatenated form a single standard deflate stream,
+// which any inflater decompresses. Back references do not cross the chunk boundaries,
+// which costs a fraction of a percent of the compression ratio.
+//
+// The compression levels are those of zlib / miniz: 0 (store) to 9, MZ_UBER_COMPRESSION (10).
+
+// Uncompressed size of a chunk compressed by a single task.
+static constexpr const size_t DEFLATE_CHUNK_SIZE = 256 * 1024;
+
+// Raw deflate stream and the checksums of the uncompressed data.
+struct DeflatedData
+{
+    std::vector<uint8_t> data;
+    size_t               uncompressed_size = 0;
+    uint32_t             crc32             = 0;
+    uint32_t             adler32           = 1;
+};
+
+// Compresses the buffer and appends it to out, the checksums of out are updated.
+// If finish is false, the stream is left open for more data to be appended,
+// otherwise it is terminated by a final block.
+// Returns false if the compressor failed.
+bool deflate_parallel(const void *data, size_t size, int level, bool finish, DeflatedData &out);
+
+// Checksums of two consecutive buffers from the checksums of each of them,
+// len2 being the size of the second buffer. Same as crc32_combine() and adler32_combine() of zlib.
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, size_t len2);
+uint32_t adler32_combine(uint32_t adler1, uint32_t adler2, size_t len2);
+
+// PNG image with the image data compressed by deflate_parallel(). A replacement of
+// tdefl_write_image_to_png_file_in_memory_ex(), empty on failure.
+std::vector<uint8_t> write_png_to_memory_parallel(const void *pixels, int w, int h, int num_chans, int level, bool flip = false);
+
+// Adds a file of a zip archive with the data compressed by deflate_parallel().
+// Returns false on failure, the error is stored in the archive.
+bool zip_add_mem_parallel(mz_zip_archive &archive, const std::string &name, const void *data, size_t size, int level);
+
+// Adds a file to a zip archive piecewise like mz_zip_writer_add_staged_data(), if the size of the file
+// is not known in advance. The data are collected into batches of chunks, each batch
+// is compressed by deflate_parallel() and appended to the file.
+class ParallelDeflateStagedWriter
+{
+public:
+    // The file has to be opened by mz_zip_writer_add_staged_open() and not written yet.
+    ParallelDeflateStagedWriter(mz_zip_writer_staged_context &context, int level);
+
+    bool write(const char *data, size_t size);
+    // Appends a stream compressed by deflate_parallel() with finish = false after the data written so far.
+    bool write_deflated(const DeflatedData &deflated);
+    // Compresses the rest of the data and calls mz_zip_writer_add_staged_finish().
+    bool finish();
+
+private:
+    bool flush();
+
+    mz_zip_writer_staged_context &m_context;
+    int                           m_level;
+    size_t                        m_batch_size;
+    std::vector<char>             m_buffer;
+    DeflatedData                  m_deflated;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_ParallelDeflate_hpp_
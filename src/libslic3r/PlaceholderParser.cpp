@@ -1,6 +1,7 @@
 #include "PlaceholderParser.hpp"
 #include "Exception.hpp"
 #include "Flow.hpp"
+#include <atomic>
 #include <cstring>
 #include <ctime>
 #include <iomanip>
@@ -52,7 +53,12 @@
 #include <boost/phoenix/bind/bind_function.hpp>
 
 #include <iostream>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 // #define USE_CPP11_REGEX
 #ifdef USE_CPP11_REGEX
@@ -1011,6 +1017,15 @@ namespace client
             // skip_over(first, last, skipper);
             if (first == last)
                 return false;
+            if (! skip_utf8_char(first, last))
+                MyContext::throw_exception("Invalid utf8 sequence", boost::iterator_range<Iterator>(first, last));
+            return true;
+        }
+
+        // Skips a single UTF-8 character, returns false on an invalid UTF-8 sequence. first must not be at the end.
+        template <typename Iterator>
+        static bool skip_utf8_char(Iterator &first, Iterator const& last)
+        {
             // Iterator over the UTF-8 sequence.
             auto            it = first;
             // Read the first byte of the UTF-8 sequence.
@@ -1018,7 +1033,7 @@ namespace client
             unsigned int    cnt = 0;
             // UTF-8 sequence must not start with a continuation character:
             if ((c & 0xC0) == 0x80)
-                goto err;
+                return false;
             // Skip high surrogate first if there is one.
             // If the most significant bit with a zero in it is in position
             // 8-N then there are N bytes in this UTF-8 sequence:
@@ -1034,17 +1049,14 @@ namespace client
             // Since we haven't read in a value, we need to validate the code points:
             for (-- cnt; cnt > 0; -- cnt) {
                 if (it == last)
-                    goto err;
+                    return false;
                 c = static_cast<boost::uint8_t>(*it ++);
                 // We must have a continuation byte:
                 if (cnt > 1 && (c & 0xC0) != 0x80)
-                    goto err;
+                    return false;
             }
             first = it;
             return true;
-        err:
-            MyContext::throw_exception("Invalid utf8 sequence", boost::iterator_range<Iterator>(first, last));
-            return false;
         }
 
         // This function is called during error handling to create a human readable string for the error context.
@@ -1380,6 +1392,735 @@ namespace client
 
         qi::symbols<char> keywords;
     };
+
+    ///////////////////////////////////////////////////////////////////////////
+    //  Templates compiled for repeated evaluation
+    ///////////////////////////////////////////////////////////////////////////
+    // Custom G-code templates are processed many times per print (for example for each layer), while the boost::spirit parser
+    // above evaluates the template while parsing it. A template is therefore parsed once by TemplateCompiler into a tree
+    // of CompiledNodes, which is then evaluated by CompiledTemplate::evaluate() against the current configuration.
+    // TemplateCompiler follows the rules of macro_processor exactly, it only accepts templates, which macro_processor
+    // parses into the same structure. The rest of the templates, including all templates with a syntax error, are left
+    // to macro_processor. The values are calculated by the same expr<Iterator> and MyContext methods as by macro_processor,
+    // and if any of them fails, the template is processed by macro_processor again to report the very same error.
+    using CompiledIterator = std::string::const_iterator;
+
+    struct CompiledNode
+    {
+        enum Type : unsigned char {
+            // Nodes of a text block.
+            TEXT,
+            LEGACY_VARIABLE,
+            // Identifier of the vector index in children[0].
+            LEGACY_VARIABLE_INDEXED,
+            // Expression in children[0] converted to string.
+            MACRO,
+            // Pairs of a condition and a BLOCK, optionally followed by the else BLOCK.
+            IF,
+            BLOCK,
+            // Expressions.
+            INT,
+            DOUBLE,
+            BOOL,
+            STRING,
+            VARIABLE,
+            // Index in children[0].
+            VECTOR_VARIABLE,
+            PARENTHESES,
+            UNARY_MINUS,
+            UNARY_PLUS,
+            NOT,
+            MIN,
+            MAX,
+            RANDOM,
+            // Two or three parameters.
+            DIGITS,
+            ZDIGITS,
+            TO_INT,
+            ROUND,
+            ADD,
+            SUBTRACT,
+            MULTIPLY,
+            DIVIDE,
+            MODULO,
+            EQUAL,
+            NOT_EQUAL,
+            LOWER,
+            GREATER,
+            LEQ,
+            GEQ,
+            // Left hand side in children[0].
+            REGEX_MATCHES,
+            REGEX_DOESNT_MATCH,
+            AND,
+            OR,
+            TERNARY,
+        };
+
+        explicit CompiledNode(Type type = BLOCK) : type(type) {}
+        CompiledNode(Type type, CompiledIterator begin, CompiledIterator end) : type(type), begin(begin), end(end) {}
+
+        Type                      type;
+        // Range of the source template, used as expr<Iterator>::it_range.
+        CompiledIterator          begin;
+        CompiledIterator          end;
+        int                       i { 0 };
+        double                    d { 0. };
+        // Value of a string literal or a key of a configuration option.
+        std::string               str;
+        // Compiled regular expression, nullptr if it is invalid.
+        std::shared_ptr<const SLIC3R_REGEX_NAMESPACE::regex> regex;
+        std::vector<CompiledNode> children;
+    };
+
+    class TemplateCompiler
+    {
+    public:
+        // Thrown if macro_processor would not parse the template the same way, most likely due to a syntax error.
+        struct NotCompilable {};
+
+        TemplateCompiler(CompiledIterator begin, CompiledIterator end) : m_it(begin), m_end(end) {}
+
+        // Follows macro_processor::start.
+        void compile(bool just_boolean_expression, std::vector<CompiledNode> &out)
+        {
+            if (just_boolean_expression) {
+                out.emplace_back();
+                this->expect(this->conditional_expression(out.back()));
+            } else {
+                // The leading eps of macro_processor::start skips the white space at the start of the template.
+                this->skip();
+                this->text_block(out);
+            }
+            this->skip();
+            this->expect(m_it == m_end);
+        }
+
+    private:
+        using Node = CompiledNode;
+
+        void expect(bool condition) { if (! condition) throw NotCompilable(); }
+
+        static bool is_alpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+        static bool is_alnum(char c) { return is_alpha(c) || (c >= '0' && c <= '9'); }
+        // Characters above 127 are letters or white spaces of the ISO8859-1 encoding used by macro_processor, though
+        // they are more likely a part of an UTF-8 sequence. Such templates are left to macro_processor.
+        void check_ascii(CompiledIterator it) { this->expect(it == m_end || static_cast<unsigned char>(*it) < 128); }
+
+        void skip()
+        {
+            for (; m_it != m_end && (*m_it == ' ' || (*m_it >= '\t' && *m_it <= '\r')); ++ m_it) ;
+            this->check_ascii(m_it);
+        }
+
+        bool lit(char c)
+        {
+            this->skip();
+            if (m_it == m_end || *m_it != c)
+                return false;
+            ++ m_it;
+            return true;
+        }
+
+        bool lit(const char *str)
+        {
+            this->skip();
+            CompiledIterator it = m_it;
+            for (; *str != 0; ++ str, ++ it)
+                if (it == m_end || *it != *str)
+                    return false;
+            m_it = it;
+            return true;
+        }
+
+        // Keyword not followed by an identifier character, as parsed by distinct().
+        bool keyword(const char *str)
+        {
+            CompiledIterator begin = m_it;
+            if (! this->lit(str))
+                return false;
+            this->check_ascii(m_it);
+            if (m_it != m_end && is_alnum(*m_it)) {
+                m_it = begin;
+                return false;
+            }
+            return true;
+        }
+
+        bool identifier(CompiledIterator &begin, CompiledIterator &end)
+        {
+            static const std::set<std::string, std::less<>> keywords {
+                "and", "digits", "zdigits", "if", "int", "else", "elsif", "endif", "false", "min", "max", "random", "round", "not", "or", "true" };
+            this->skip();
+            if (m_it == m_end || ! is_alpha(*m_it))
+                return false;
+            CompiledIterator it = m_it;
+            for (++ it; it != m_end && is_alnum(*it); ++ it) ;
+            this->check_ascii(it);
+            if (keywords.find(std::string_view(&*m_it, it - m_it)) != keywords.end())
+                return false;
+            begin = m_it;
+            end   = m_it = it;
+            return true;
+        }
+
+        // Follows macro_processor::text_block.
+        void text_block(std::vector<Node> &out)
+        {
+            for (;;) {
+                if (m_it != m_end && *m_it != '[' && *m_it != '{') {
+                    CompiledIterator begin = m_it;
+                    while (m_it != m_end && *m_it != '[' && *m_it != '{')
+                        this->expect(utf8_char_skipper_parser::skip_utf8_char(m_it, m_end));
+                    out.emplace_back(Node::TEXT, begin, m_it);
+                    continue;
+                }
+                CompiledIterator begin = m_it;
+                if (this->lit('{')) {
+                    Node node;
+                    if (this->macro(node)) {
+                        this->expect(this->lit('}'));
+                        out.emplace_back(std::move(node));
+                        continue;
+                    }
+                    // Back track, for example from {else} of an embedded text block.
+                    m_it = begin;
+                }
+                if (this->lit('[')) {
+                    out.emplace_back();
+                    this->legacy_variable_expansion(out.back());
+                    this->expect(this->lit(']'));
+                    continue;
+                }
+                m_it = begin;
+                return;
+            }
+        }
+
+        bool macro(Node &out)
+        {
+            if (this->keyword("if")) {
+                this->if_else_output(out);
+                return true;
+            }
+            out = Node(Node::MACRO);
+            out.children.emplace_back();
+            return this->additive_expression(out.children.back());
+        }
+
+        void if_else_output(Node &out)
+        {
+            out = Node(Node::IF);
+            auto condition_and_block = [this, &out]() {
+                out.children.emplace_back();
+                this->expect(this->conditional_expression(out.children.back()));
+                this->expect(this->lit('}'));
+                out.children.emplace_back(Node::BLOCK);
+                this->text_block(out.children.back().children);
+                this->expect(this->lit('{'));
+            };
+            condition_and_block();
+            while (this->keyword("elsif"))
+                condition_and_block();
+            if (this->keyword("else")) {
+                this->expect(this->lit('}'));
+                out.children.emplace_back(Node::BLOCK);
+                this->text_block(out.children.back().children);
+                this->expect(this->lit('{'));
+            }
+            this->expect(this->keyword("endif"));
+        }
+
+        void legacy_variable_expansion(Node &out)
+        {
+            CompiledIterator begin, end;
+            this->expect(this->identifier(begin, end));
+            CompiledIterator it = m_it;
+            if (this->lit(']')) {
+                // Just a look-ahead.
+                m_it = it;
+                out = Node(Node::LEGACY_VARIABLE, begin, end);
+            } else {
+                out = Node(Node::LEGACY_VARIABLE_INDEXED, begin, end);
+                this->expect(this->lit('['));
+                CompiledIterator index_begin, index_end;
+                this->expect(this->identifier(index_begin, index_end));
+                out.children.emplace_back(Node::VARIABLE, index_begin, index_end);
+                this->expect(this->lit(']'));
+            }
+        }
+
+        bool conditional_expression(Node &out)
+        {
+            if (! this->logical_or_expression(out))
+                return false;
+            if (this->lit('?')) {
+                Node node(Node::TERNARY, out.begin, out.end);
+                node.children.emplace_back(std::move(out));
+                node.children.emplace_back();
+                this->expect(this->conditional_expression(node.children.back()));
+                this->expect(this->lit(':'));
+                node.children.emplace_back();
+                this->expect(this->conditional_expression(node.children.back()));
+                out = std::move(node);
+            }
+            return true;
+        }
+
+        // Parses a left associative binary operation: lhs ((op1 | op2 | ...) rhs)*
+        template<typename OperatorFn, typename OperandFn>
+        bool binary_operation(Node &out, OperatorFn op, OperandFn operand)
+        {
+            if (! (this->*operand)(out))
+                return false;
+            for (Node::Type type; op(type);) {
+                Node node(type, out.begin, out.end);
+                node.children.emplace_back(std::move(out));
+                node.children.emplace_back();
+                this->expect((this->*operand)(node.children.back()));
+                out = std::move(node);
+            }
+            return true;
+        }
+
+        bool logical_or_expression(Node &out)
+        {
+            return this->binary_operation(out, [this](Node::Type &type) { type = Node::OR; return this->keyword("or") || this->lit("||"); },
+                &TemplateCompiler::logical_and_expression);
+        }
+
+        bool logical_and_expression(Node &out)
+        {
+            return this->binary_operation(out, [this](Node::Type &type) { type = Node::AND; return this->keyword("and") || this->lit("&&"); },
+                &TemplateCompiler::equality_expression);
+        }
+
+        bool equality_expression(Node &out)
+        {
+            if (! this->relational_expression(out))
+                return false;
+            for (;;) {
+                Node::Type type;
+                if (this->lit("=="))
+                    type = Node::EQUAL;
+                else if (this->lit("!=") || this->lit("<>"))
+                    type = Node::NOT_EQUAL;
+                else if (this->lit("=~"))
+                    type = Node::REGEX_MATCHES;
+                else if (this->lit("!~"))
+                    type = Node::REGEX_DOESNT_MATCH;
+                else
+                    return true;
+                Node node(type, out.begin, out.end);
+                node.children.emplace_back(std::move(out));
+                if (type == Node::REGEX_MATCHES || type == Node::REGEX_DOESNT_MATCH) {
+                    this->regular_expression(node);
+                } else {
+                    node.children.emplace_back();
+                    this->expect(this->relational_expression(node.children.back()));
+                }
+                out = std::move(node);
+            }
+        }
+
+        bool relational_expression(Node &out)
+        {
+            return this->binary_operation(out, [this](Node::Type &type) {
+                    type = this->lit("<=") ? Node::LEQ : this->lit(">=") ? Node::GEQ : this->lit('<') ? Node::LOWER : this->lit('>') ? Node::GREATER : Node::BLOCK;
+                    return type != Node::BLOCK;
+                }, &TemplateCompiler::additive_expression);
+        }
+
+        bool additive_expression(Node &out)
+        {
+            return this->binary_operation(out, [this](Node::Type &type) {
+                    type = this->lit('+') ? Node::ADD : this->lit('-') ? Node::SUBTRACT : Node::BLOCK;
+                    return type != Node::BLOCK;
+                }, &TemplateCompiler::multiplicative_expression);
+        }
+
+        bool multiplicative_expression(Node &out)
+        {
+            return this->binary_operation(out, [this](Node::Type &type) {
+                    type = this->lit('*') ? Node::MULTIPLY : this->lit('/') ? Node::DIVIDE : this->lit('%') ? Node::MODULO : Node::BLOCK;
+                    return type != Node::BLOCK;
+                }, &TemplateCompiler::unary_expression);
+        }
+
+        // Parses "(" conditional_expression ("," conditional_expression)* into children of out.
+        void function_parameters(Node &out, size_t num_params, bool optional_last)
+        {
+            this->expect(this->lit('('));
+            for (size_t i = 0; i < num_params; ++ i) {
+                if (i > 0)
+                    this->expect(this->lit(','));
+                out.children.emplace_back();
+                this->expect(this->conditional_expression(out.children.back()));
+            }
+            if (optional_last && this->lit(',')) {
+                out.children.emplace_back();
+                this->expect(this->conditional_expression(out.children.back()));
+            }
+            this->expect(this->lit(')'));
+        }
+
+        bool unary_expression(Node &out)
+        {
+            this->skip();
+            const CompiledIterator begin = m_it;
+            CompiledIterator       identifier_begin, identifier_end;
+            // Node with a single operand.
+            auto unary = [this, begin, &out](Node::Type type) {
+                out = Node(type, begin, begin);
+                out.children.emplace_back();
+                this->expect(this->unary_expression(out.children.back()));
+                out.end = out.children.back().end;
+            };
+            auto function = [this, begin, &out](Node::Type type, size_t num_params, bool optional_last = false) {
+                out = Node(type, begin, begin);
+                this->function_parameters(out, num_params, optional_last);
+                out.end = m_it;
+            };
+            if (this->identifier(identifier_begin, identifier_end)) {
+                // Scalar or vector variable reference.
+                out = Node(Node::VARIABLE, identifier_begin, identifier_end);
+                out.str = std::string(identifier_begin, identifier_end);
+                if (this->lit('[')) {
+                    out.type = Node::VECTOR_VARIABLE;
+                    out.children.emplace_back();
+                    this->expect(this->additive_expression(out.children.back()));
+                    this->expect(this->lit(']'));
+                    this->skip();
+                    out.end = m_it;
+                }
+            } else if (this->lit('(')) {
+                out = Node(Node::PARENTHESES, begin, begin);
+                out.children.emplace_back();
+                this->expect(this->conditional_expression(out.children.back()));
+                this->expect(this->lit(')'));
+                this->skip();
+                out.end = m_it;
+            } else if (this->lit('-'))
+                unary(Node::UNARY_MINUS);
+            else if (this->lit('+')) {
+                unary(Node::UNARY_PLUS);
+                this->skip();
+                out.end = m_it;
+            } else if (this->keyword("not") || this->lit('!'))
+                unary(Node::NOT);
+            else if (this->keyword("min"))
+                function(Node::MIN, 2);
+            else if (this->keyword("max"))
+                function(Node::MAX, 2);
+            else if (this->keyword("random"))
+                function(Node::RANDOM, 2);
+            else if (this->keyword("digits"))
+                function(Node::DIGITS, 2, true);
+            else if (this->keyword("zdigits"))
+                function(Node::ZDIGITS, 2, true);
+            else if (this->keyword("int"))
+                function(Node::TO_INT, 1);
+            else if (this->keyword("round"))
+                function(Node::ROUND, 1);
+            else
+                return this->literal(out);
+            return true;
+        }
+
+        bool literal(Node &out)
+        {
+            this->skip();
+            const CompiledIterator begin = m_it;
+            CompiledIterator       it    = m_it;
+            double                 d;
+            int                    i;
+            // The very same number parsers as used by macro_processor.
+            if (qi::parse(it, m_end, qi::real_parser<double, strict_real_policies_without_nan_inf>(), d)) {
+                m_it = it;
+                out = Node(Node::DOUBLE, begin, m_it);
+                out.d = d;
+            } else if (it = m_it; qi::parse(it, m_end, qi::int_, i)) {
+                m_it = it;
+                out = Node(Node::INT, begin, m_it);
+                out.i = i;
+            } else if (this->keyword("true") || this->keyword("false")) {
+                out = Node(Node::BOOL, begin, m_it);
+                out.i = *begin == 't';
+            } else if (m_it != m_end && *m_it == '"') {
+                this->quoted('"');
+                out = Node(Node::STRING, begin, m_it);
+                out.str = std::string(begin + 1, m_it - 1);
+                return true;
+            } else
+                return false;
+            this->skip();
+            out.end = m_it;
+            return true;
+        }
+
+        // String enclosed in delimiters, a backslash escapes the following character.
+        void quoted(char delimiter)
+        {
+            ++ m_it;
+            for (;;) {
+                this->expect(m_it != m_end);
+                if (*m_it == delimiter)
+                    break;
+                if (*m_it == '\\') {
+                    ++ m_it;
+                    this->expect(m_it != m_end);
+                    ++ m_it;
+                } else
+                    this->expect(utf8_char_skipper_parser::skip_utf8_char(m_it, m_end));
+            }
+            ++ m_it;
+        }
+
+        void regular_expression(Node &out)
+        {
+            this->skip();
+            this->expect(m_it != m_end && *m_it == '/');
+            out.begin = m_it;
+            this->quoted('/');
+            out.end = m_it;
+            try {
+                out.regex = std::make_shared<SLIC3R_REGEX_NAMESPACE::regex>(std::string(out.begin + 1, out.end - 1));
+            } catch (SLIC3R_REGEX_NAMESPACE::regex_error &) {
+                // Reported by macro_processor.
+            }
+        }
+
+        CompiledIterator m_it;
+        CompiledIterator m_end;
+    };
+
+    struct CompiledTemplate
+    {
+        explicit CompiledTemplate(const std::string &text) : text(text) {}
+
+        // Returns nullptr if the template is not accepted by TemplateCompiler.
+        static std::shared_ptr<const CompiledTemplate> compile(const std::string &text, bool just_boolean_expression)
+        {
+            auto out = std::make_shared<CompiledTemplate>(text);
+            try {
+                // The nodes point into out->text.
+                TemplateCompiler(out->text.begin(), out->text.end()).compile(just_boolean_expression, out->nodes);
+            } catch (TemplateCompiler::NotCompilable &) {
+                return nullptr;
+            }
+            out->just_boolean_expression = just_boolean_expression;
+            out->uses_random             = out->text.find("random") != std::string::npos;
+            return out;
+        }
+
+        // Throws qi::expectation_failure<CompiledIterator> if the template could not be evaluated.
+        std::string evaluate(const MyContext *ctx) const
+        {
+            // macro_processor will evaluate the template again on error, it shall start with the same random seed.
+            std::optional<std::mt19937> rng;
+            if (this->uses_random && ctx->context_data != nullptr)
+                rng = ctx->context_data->rng;
+            try {
+                std::string out;
+                if (this->just_boolean_expression) {
+                    Expr value = evaluate(ctx, this->nodes.front());
+                    Expr::evaluate_boolean_to_string(value, out);
+                } else
+                    evaluate(ctx, this->nodes, out);
+                return out;
+            } catch (qi::expectation_failure<CompiledIterator> &) {
+                if (rng)
+                    ctx->context_data->rng = *rng;
+                throw;
+            }
+        }
+
+        const std::string         text;
+        std::vector<CompiledNode> nodes;
+        bool                      just_boolean_expression { false };
+        // The template calls random().
+        bool                      uses_random { false };
+
+    private:
+        using Expr = expr<CompiledIterator>;
+        using Node = CompiledNode;
+        using Range = boost::iterator_range<CompiledIterator>;
+
+        // Evaluates a text block in the same order as macro_processor, including all the branches of {if}.
+        static void evaluate(const MyContext *ctx, const std::vector<Node> &nodes, std::string &out)
+        {
+            for (const Node &node : nodes)
+                switch (node.type) {
+                case Node::TEXT:
+                    out.append(node.begin, node.end);
+                    break;
+                case Node::LEGACY_VARIABLE:
+                {
+                    Range       opt_key(node.begin, node.end);
+                    std::string value;
+                    MyContext::legacy_variable_expansion(ctx, opt_key, value);
+                    out += value;
+                    break;
+                }
+                case Node::LEGACY_VARIABLE_INDEXED:
+                {
+                    Range       opt_key(node.begin, node.end);
+                    Range       opt_vector_index(node.children.front().begin, node.children.front().end);
+                    std::string value;
+                    MyContext::legacy_variable_expansion2(ctx, opt_key, opt_vector_index, value);
+                    out += value;
+                    break;
+                }
+                case Node::MACRO:
+                    out += evaluate(ctx, node.children.front()).to_string();
+                    break;
+                case Node::IF:
+                {
+                    std::string value;
+                    bool        not_yet_consumed = true;
+                    size_t      i = 0;
+                    for (; i + 1 < node.children.size(); i += 2) {
+                        Expr expr_condition = evaluate(ctx, node.children[i]);
+                        bool condition;
+                        Expr::evaluate_boolean(expr_condition, condition);
+                        std::string block;
+                        evaluate(ctx, node.children[i + 1].children, block);
+                        Expr::set_if(condition, not_yet_consumed, block, value);
+                    }
+                    if (i < node.children.size()) {
+                        // {else}
+                        std::string block;
+                        evaluate(ctx, node.children[i].children, block);
+                        Expr::set_if(not_yet_consumed, not_yet_consumed, block, value);
+                    }
+                    out += value;
+                    break;
+                }
+                default:
+                    assert(false);
+                }
+        }
+
+        static Expr evaluate(const MyContext *ctx, const Node &node)
+        {
+            auto operand = [ctx, &node](size_t idx) { return evaluate(ctx, node.children[idx]); };
+            switch (node.type) {
+            case Node::INT:         return Expr(node.i, node.begin, node.end);
+            case Node::DOUBLE:      return Expr(node.d, node.begin, node.end);
+            case Node::BOOL:        return Expr(node.i != 0, node.begin, node.end);
+            case Node::STRING:      return Expr(node.str, node.begin, node.end);
+            case Node::VARIABLE:
+            case Node::VECTOR_VARIABLE:
+            {
+                OptWithPos<CompiledIterator> opt(ctx->resolve_symbol(node.str), Range(node.begin, node.begin + node.str.size()));
+                if (opt.opt == nullptr)
+                    MyContext::throw_exception("Not a variable name", opt.it_range);
+                Expr out;
+                if (node.type == Node::VARIABLE)
+                    MyContext::scalar_variable_reference(ctx, opt, out);
+                else {
+                    Expr index_expr = operand(0);
+                    int  index;
+                    MyContext::evaluate_index(index_expr, index);
+                    MyContext::vector_variable_reference(ctx, opt, index, node.end, out);
+                }
+                return out;
+            }
+            case Node::PARENTHESES:
+            case Node::UNARY_PLUS:  return Expr(operand(0), node.begin, node.end);
+            case Node::UNARY_MINUS: return operand(0).unary_minus(node.begin);
+            case Node::NOT:         return operand(0).unary_not(node.begin);
+            case Node::TO_INT:      return operand(0).unary_integer(node.begin);
+            case Node::ROUND:       return operand(0).round(node.begin);
+            case Node::TERNARY:
+            {
+                Expr lhs = operand(0), rhs1 = operand(1), rhs2 = operand(2);
+                Expr::ternary_op(lhs, rhs1, rhs2);
+                return lhs;
+            }
+            case Node::REGEX_MATCHES:
+            case Node::REGEX_DOESNT_MATCH:
+            {
+                Expr lhs = operand(0);
+                if (lhs.type != Expr::TYPE_STRING || node.regex == nullptr)
+                    // Let macro_processor report the error.
+                    lhs.throw_exception("Invalid regular expression match.");
+                bool result = SLIC3R_REGEX_NAMESPACE::regex_match(lhs.s(), *node.regex);
+                lhs.set_b(node.type == Node::REGEX_MATCHES ? result : ! result);
+                return lhs;
+            }
+            case Node::DIGITS:
+            case Node::ZDIGITS:
+            {
+                Expr param1 = operand(0), param2 = operand(1), param3;
+                if (node.children.size() > 2)
+                    param3 = operand(2);
+                if (node.type == Node::DIGITS)
+                    Expr::digits<false>(param1, param2, param3);
+                else
+                    Expr::digits<true>(param1, param2, param3);
+                return param1;
+            }
+            default:
+                break;
+            }
+
+            // Binary operations, the result is stored into lhs.
+            Expr lhs = operand(0), rhs = operand(1);
+            switch (node.type) {
+            case Node::MIN:         Expr::min(lhs, rhs); break;
+            case Node::MAX:         Expr::max(lhs, rhs); break;
+            case Node::RANDOM:      MyContext::random(ctx, lhs, rhs); break;
+            case Node::ADD:         lhs += rhs; break;
+            case Node::SUBTRACT:    lhs -= rhs; break;
+            case Node::MULTIPLY:    lhs *= rhs; break;
+            case Node::DIVIDE:      lhs /= rhs; break;
+            case Node::MODULO:      lhs %= rhs; break;
+            case Node::EQUAL:       Expr::equal(lhs, rhs); break;
+            case Node::NOT_EQUAL:   Expr::not_equal(lhs, rhs); break;
+            case Node::LOWER:       Expr::lower(lhs, rhs); break;
+            case Node::GREATER:     Expr::greater(lhs, rhs); break;
+            case Node::LEQ:         Expr::leq(lhs, rhs); break;
+            case Node::GEQ:         Expr::geq(lhs, rhs); break;
+            case Node::AND:         Expr::logical_and(lhs, rhs); break;
+            case Node::OR:          Expr::logical_or(lhs, rhs); break;
+            default:                assert(false);
+            }
+            return lhs;
+        }
+    };
+}
+
+static std::atomic<bool> s_compiled_templates_enabled { true };
+
+void PlaceholderParser::set_compiled_templates_enabled(bool enabled)
+{
+    s_compiled_templates_enabled = enabled;
+}
+
+// Templates compiled by client::TemplateCompiler, shared by all PlaceholderParser instances.
+// nullptr is stored for the templates, which are left to the boost::spirit parser.
+static std::shared_ptr<const client::CompiledTemplate> compiled_template(const std::string &templ, bool just_boolean_expression)
+{
+    if (! s_compiled_templates_enabled)
+        return nullptr;
+    // Indexed by just_boolean_expression.
+    static std::unordered_map<std::string, std::shared_ptr<const client::CompiledTemplate>> cache[2];
+    static std::mutex                                                                       mutex;
+    auto &templates = cache[just_boolean_expression];
+    {
+        std::scoped_lock<std::mutex> lock(mutex);
+        if (auto it = templates.find(templ); it != templates.end())
+            return it->second;
+    }
+    std::shared_ptr<const client::CompiledTemplate> compiled = client::CompiledTemplate::compile(templ, just_boolean_expression);
+    std::scoped_lock<std::mutex> lock(mutex);
+    // The templates are mostly taken from a handful of configuration options, the limit is just a safety measure
+    // against templates generated on the fly.
+    if (templates.size() >= 4096)
+        templates.clear();
+    templates.emplace(templ, compiled);
+    return compiled;
 }
 
 static std::string process_macro(const std::string &templ, client::MyContext &context)
@@ -1387,6 +2128,14 @@ static std::string process_macro(const std::string &templ, client::MyContext &co
     typedef std::string::const_iterator iterator_type;
     typedef client::macro_processor<iterator_type> macro_processor;
 
+    if (std::shared_ptr<const client::CompiledTemplate> compiled = compiled_template(templ, context.just_boolean_expression)) {
+        try {
+            return compiled->evaluate(&context);
+        } catch (qi::expectation_failure<iterator_type> &) {
+            // Evaluation failed. Run the parser below to report the error exactly as if the template was not compiled.
+        }
+    }
+
     // Our whitespace skipper.
     spirit_encoding::space_type space;
     // Our grammar, statically allocated inside the method, meaning it will be allocated the first time
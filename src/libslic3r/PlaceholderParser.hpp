@@ -63,6 +63,10 @@ public:
     // Update timestamp, year, month, day, hour, minute, second variables at m_config.
     void update_timestamp() { update_timestamp(m_config); }
 
+    // Templates are compiled on their first use, the templates not recognized by the compiler are processed
+    // by the boost::spirit parser. Disabling the compiled templates lets the tests compare the two.
+    static void set_compiled_templates_enabled(bool enabled);
+
 private:
 	// config has a higher priority than external_config when looking up a symbol.
     DynamicConfig 			 m_config;
@@ -7,6 +7,7 @@
 #include "format.hpp"
 
 #include <algorithm>
+#include <functional>
 #include <set>
 #include <fstream>
 #include <unordered_set>
@@ -22,6 +23,13 @@
 #include <boost/locale.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <miniz.h>
+
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/string.hpp>
+#include <cereal/types/utility.hpp>
+#include <cereal/types/vector.hpp>
+
 
 // Store the print/filament/printer presets into a "presets" subdirectory of the Slic3rPE config dir.
 // This breaks compatibility with the upstream Slic3r if the --datadir is used to switch between the two versions.
@@ -1287,6 +1295,104 @@ static void flatten_configbundle_hierarchy(boost::property_tree::ptree &tree, co
     flatten_configbundle_hierarchy(tree, "printer",         preset_bundle ? preset_bundle->printers.system_preset_names()      : std::vector<std::string>());
 }
 
+// Vendor config bundles are large and their inheritance hierarchies deep, parsing and flattening all of them
+// takes a considerable part of the application start up. The flattened sections of a system config bundle are therefore
+// stored into a binary file in the cache directory, from where they are loaded until the config bundle changes.
+#define FLATTENED_CONFIGBUNDLE_CEREAL_VERSION 1
+
+struct FlattenedConfigBundle
+{
+    // Identifies the source .ini file, its content and the application version, which flattened it.
+    std::string                                                                             stamp;
+    // Sections of the flattened config bundle with their key / value pairs in the order of the ptree.
+    std::vector<std::pair<std::string, std::vector<std::pair<std::string, std::string>>>>  sections;
+
+    template<class Archive> void serialize(Archive &ar) { ar(stamp, sections); }
+};
+
+static boost::filesystem::path flattened_configbundle_cache_path(const boost::filesystem::path &path)
+{
+    // Hash of the full path to not mix vendor bundles of the same name, for example installed and downloaded ones.
+    std::string hash = (boost::format("%1$016x") % std::hash<std::string>()(boost::filesystem::absolute(path).generic_string())).str();
+    return (boost::filesystem::path(data_dir()) / "cache" / "flattened" / (path.stem().string() + "." + hash + ".cereal")).make_preferred();
+}
+
+// The stamp contains a checksum of the bundle content, as a bundle updated in place may keep its size and modification time.
+// Throws std::runtime_error if the bundle is not readable.
+static std::string flattened_configbundle_stamp(const boost::filesystem::path &path)
+{
+    std::string data;
+    {
+        boost::nowide::ifstream ifs(path.string(), std::ios::binary);
+        if (! ifs)
+            throw Slic3r::RuntimeError("Cannot open " + path.string());
+        data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    }
+    return (boost::format("%1% %2% %3% %4% %5$08x") % FLATTENED_CONFIGBUNDLE_CEREAL_VERSION % SLIC3R_VERSION %
+        boost::filesystem::absolute(path).generic_string() % data.size() % mz_crc32(MZ_CRC32_INIT, (const unsigned char*)data.data(), data.size())).str();
+}
+
+// Returns false if the cache does not exist or it is out of date.
+static bool load_flattened_configbundle(const std::string &path, boost::property_tree::ptree &tree)
+{
+    try {
+        boost::filesystem::path cache_path = flattened_configbundle_cache_path(path);
+        if (! boost::filesystem::exists(cache_path))
+            return false;
+        FlattenedConfigBundle bundle;
+        {
+            boost::nowide::ifstream ifs(cache_path.string(), std::ios::binary);
+            cereal::BinaryInputArchive archive(ifs);
+            archive(bundle);
+        }
+        if (bundle.stamp != flattened_configbundle_stamp(path))
+            return false;
+        for (auto &section : bundle.sections) {
+            boost::property_tree::ptree &node = tree.push_back(std::make_pair(std::move(section.first), boost::property_tree::ptree()))->second;
+            for (auto &kvp : section.second)
+                node.push_back(std::make_pair(std::move(kvp.first), boost::property_tree::ptree(std::move(kvp.second))));
+        }
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "Failed loading flattened config bundle \"" << path << "\" from cache: " << ex.what();
+        tree.clear();
+        return false;
+    }
+    return true;
+}
+
+static void save_flattened_configbundle(const std::string &path, const boost::property_tree::ptree &tree)
+{
+    try {
+        FlattenedConfigBundle bundle;
+        bundle.stamp = flattened_configbundle_stamp(path);
+        bundle.sections.reserve(tree.size());
+        for (const auto &section : tree) {
+            bundle.sections.emplace_back(section.first, std::vector<std::pair<std::string, std::string>>());
+            bundle.sections.back().second.reserve(section.second.size());
+            for (const auto &kvp : section.second)
+                bundle.sections.back().second.emplace_back(kvp.first, kvp.second.data());
+        }
+        boost::filesystem::path cache_path = flattened_configbundle_cache_path(path);
+        boost::filesystem::create_directories(cache_path.parent_path());
+        // Write into a temporary file first, so that other instances of the application never read a partially written cache.
+        // The temporary file is unique, so that instances of the application storing the same bundle do not overwrite each other's file.
+        boost::filesystem::path tmp_path = cache_path;
+        tmp_path += "." + boost::filesystem::unique_path().string() + ".tmp";
+        {
+            boost::nowide::ofstream ofs(tmp_path.string(), std::ios::binary);
+            cereal::BinaryOutputArchive archive(ofs);
+            archive(bundle);
+        }
+        if (std::error_code ec = rename_file(tmp_path.string(), cache_path.string()); ec) {
+            BOOST_LOG_TRIVIAL(error) << "Failed storing flattened config bundle \"" << path << "\" to cache: " << ec.message();
+            boost::system::error_code ec_remove;
+            boost::filesystem::remove(tmp_path, ec_remove);
+        }
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(error) << "Failed storing flattened config bundle \"" << path << "\" to cache: " << ex.what();
+    }
+}
+
 // Load a config bundle file, into presets and store the loaded presets into separate files
 // of the local configuration directory.
 std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
@@ -1301,9 +1407,11 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
         this->reset(flags.has(LoadConfigBundleAttribute::SaveImported));
 
     // 1) Read the complete config file into a boost::property_tree.
+    // A system config bundle may already be stored flattened in the cache.
     namespace pt = boost::property_tree;
     pt::ptree tree;
-    {
+    const bool flattened = flags.has(LoadConfigBundleAttribute::LoadSystem) && load_flattened_configbundle(path, tree);
+    if (! flattened) {
         boost::nowide::ifstream ifs(path);
         try {
             pt::read_ini(ifs, tree);
@@ -1330,7 +1438,11 @@ std::pair<PresetsConfigSubstitutions, size_t> PresetBundle::load_configbundle(
 
     // 1.5) Flatten the config bundle by applying the inheritance rules. Internal profiles (with names starting with '*') are removed.
     // If loading a user config bundle, do not flatten with the system profiles, but keep the "inherits" flag intact.
-    flatten_configbundle_hierarchy(tree, flags.has(LoadConfigBundleAttribute::LoadSystem) ? nullptr : this);
+    if (! flattened) {
+        flatten_configbundle_hierarchy(tree, flags.has(LoadConfigBundleAttribute::LoadSystem) ? nullptr : this);
+        if (flags.has(LoadConfigBundleAttribute::LoadSystem))
+            save_flattened_configbundle(path, tree);
+    }
 
     // 2) Parse the property_tree, extract the active preset names and the profiles, save them into local config files.
     // Parse the obsolete preset names, to be deleted when upgrading from the old configuration structure.
@@ -218,12 +218,18 @@ public:
 
     std::optional<GeneratedSupportPoints> generated_support_points;
 
+    // Segmentation of the MMU painted layers from the last slicing, reused by the following slicing for the layers with unchanged painting.
+    // Kept here rather than by PrintObject, as the PrintObjects are created again when the painting changes.
+    // PrintObjects sharing the regions but rotated differently replace each other's segmentation.
+    MMUSegmentationCache                  mmu_segmentation_cache;
+
     void ref_cnt_inc() { ++ m_ref_cnt; }
     void ref_cnt_dec() { if (-- m_ref_cnt == 0) delete this; }
     void clear() {
         all_regions.clear();
         layer_ranges.clear();
         cached_volume_ids.clear();
+        mmu_segmentation_cache.clear();
     }
 
 private:
@@ -93,7 +93,7 @@ static inline void layer_height_ranges_copy_configs(t_layer_config_ranges &lr_ds
         assert(std::abs(kvp_dst.first.second - kvp_src.first.second) <= EPSILON);
         // Layer heights are allowed do differ in case the layer height table is being overriden by the smooth profile.
         // assert(std::abs(kvp_dst.second.option("layer_height")->getFloat() - kvp_src.second.option("layer_height")->getFloat()) <= EPSILON);
-        kvp_dst.second = kvp_src.second;
+        kvp_dst.second.assign_config(kvp_src.second);
     }
 }
 
@@ -205,14 +205,22 @@ static t_config_option_keys print_config_diffs(
     const std::vector<std::string> &extruder_retract_keys = print_config_def.extruder_retract_keys();
     const std::string               filament_prefix       = "filament_";
     t_config_option_keys            print_diff;
-    for (const t_config_option_key &opt_key : current_config.keys()) {
-        const ConfigOption *opt_old = current_config.option(opt_key);
+    // Both configs keep their options sorted by key, merge them instead of looking up each key of current_config in new_full_config.
+    t_config_option_refs            old_options;
+    t_config_option_refs            new_options;
+    current_config.sorted_options(old_options);
+    new_full_config.sorted_options(new_options);
+    auto                            it_new = new_options.begin();
+    for (const auto &[opt_key_ptr, opt_old] : old_options) {
+        const t_config_option_key &opt_key = *opt_key_ptr;
         assert(opt_old != nullptr);
-        const ConfigOption *opt_new = new_full_config.option(opt_key);
+        while (it_new != new_options.end() && *it_new->first < opt_key)
+            ++ it_new;
         // assert(opt_new != nullptr);
-        if (opt_new == nullptr)
+        if (it_new == new_options.end() || *it_new->first != opt_key)
             //FIXME This may happen when executing some test cases.
             continue;
+        const ConfigOption *opt_new = it_new->second;
         const ConfigOption *opt_new_filament = std::binary_search(extruder_retract_keys.begin(), extruder_retract_keys.end(), opt_key) ? new_full_config.option(filament_prefix + opt_key) : nullptr;
         if (opt_new_filament != nullptr && ! opt_new_filament->is_nil()) {
             // An extruder retract override is available at some of the filament presets.
@@ -240,11 +248,13 @@ static t_config_option_keys print_config_diffs(
 static t_config_option_keys full_print_config_diffs(const DynamicPrintConfig &current_full_config, const DynamicPrintConfig &new_full_config)
 {
     t_config_option_keys full_config_diff;
-    for (const t_config_option_key &opt_key : new_full_config.keys()) {
-        const ConfigOption *opt_old = current_full_config.option(opt_key);
-        const ConfigOption *opt_new = new_full_config.option(opt_key);
-        if (opt_old == nullptr || *opt_new != *opt_old)
-            full_config_diff.emplace_back(opt_key);
+    // Merge the two configs sorted by key.
+    auto it_old = current_full_config.cbegin();
+    for (auto it_new = new_full_config.cbegin(); it_new != new_full_config.cend(); ++ it_new) {
+        while (it_old != current_full_config.cend() && it_old->first < it_new->first)
+            ++ it_old;
+        if (it_old == current_full_config.cend() || it_old->first != it_new->first || *it_new->second != *it_old->second)
+            full_config_diff.emplace_back(it_new->first);
     }
     return full_config_diff;
 }
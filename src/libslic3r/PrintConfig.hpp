@@ -321,6 +321,15 @@ protected:
         const std::vector<std::string>& keys()      const { return m_keys; }
         const T&                        defaults()  const { return *m_defaults; }
 
+        // Options of owner in the order of keys(), addressed by their offsets without looking up the keys.
+        void                sorted_options(const T *owner, t_config_option_refs &out) const
+        {
+            out.clear();
+            out.reserve(m_keys.size());
+            for (size_t i = 0; i < m_keys.size(); ++ i)
+                out.emplace_back(&m_keys[i], reinterpret_cast<const ConfigOption*>((const char*)owner + m_offsets[i]));
+        }
+
         // To be called during the StaticCache setup.
         // Collect option keys from m_map_name_to_offset,
         // assign default values to m_defaults.
@@ -330,6 +339,8 @@ protected:
             m_defaults = defaults;
             m_keys.clear();
             m_keys.reserve(m_map_name_to_offset.size());
+            m_offsets.clear();
+            m_offsets.reserve(m_map_name_to_offset.size());
             for (const auto &kvp : defs->options) {
                 // Find the option given the option name kvp.first by an offset from (char*)m_defaults.
                 ConfigOption *opt = this->optptr(kvp.first, m_defaults);
@@ -337,6 +348,7 @@ protected:
                     // This option is not defined by the ConfigBase of type T.
                     continue;
                 m_keys.emplace_back(kvp.first);
+                m_offsets.emplace_back((const char*)opt - (const char*)m_defaults);
                 const ConfigOptionDef *def = defs->get(kvp.first);
                 assert(def != nullptr);
                 if (def->default_value)
@@ -346,7 +358,10 @@ protected:
 
     private:
         T                                  *m_defaults;
+        // Keys sorted in the order of ConfigDef::options, thus sorted the same way as the keys of a DynamicConfig.
         std::vector<std::string>            m_keys;
+        // Offsets of the options from the owner, in the order of m_keys.
+        std::vector<ptrdiff_t>              m_offsets;
     };
 };
 
@@ -361,6 +376,8 @@ public: \
     /* Overrides ConfigBase::keys(). Collect names of all configuration values maintained by this configuration store. */ \
     t_config_option_keys     keys() const override { return s_cache_##CLASS_NAME.keys(); } \
     const t_config_option_keys& keys_ref() const override { return s_cache_##CLASS_NAME.keys(); } \
+    /* Overrides ConfigBase::sorted_options(). */ \
+    bool                     sorted_options(t_config_option_refs &out) const override { s_cache_##CLASS_NAME.sorted_options(this, out); return true; } \
     static const CLASS_NAME& defaults() { assert(s_cache_##CLASS_NAME.initialized()); return s_cache_##CLASS_NAME.defaults(); } \
 private: \
     friend int print_config_static_initializer(); \
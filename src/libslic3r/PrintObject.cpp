@@ -8,6 +8,7 @@
 #include "Geometry.hpp"
 #include "I18N.hpp"
 #include "Layer.hpp"
+#include "LayerRangeCoverage.hpp"
 #include "MutablePolygon.hpp"
 #include "PrintBase.hpp"
 #include "SupportMaterial.hpp"
@@ -1157,6 +1158,10 @@ void PrintObject::discover_vertical_shells()
 	    	   num_extra_layers(config.bottom_solid_layers, config.bottom_solid_min_thickness) > 0;
     };
     std::vector<DiscoverVerticalShellsCacheEntry> cache_top_botom_regions(num_layers, DiscoverVerticalShellsCacheEntry());
+    // Range queries over cache_top_botom_regions.
+    LayerRangeCoverage top_surfaces_index;
+    LayerRangeCoverage bottom_surfaces_index;
+    LayerRangeCoverage holes_index;
     bool top_bottom_surfaces_all_regions = this->num_printing_regions() > 1 && ! m_config.interface_shells.value;
     if (top_bottom_surfaces_all_regions) {
         // This is a multi-material print and interface_shells are disabled, meaning that the vertical shell thickness
@@ -1284,10 +1289,57 @@ void PrintObject::discover_vertical_shells()
             BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << region_id << " in parallel - end : cache top / bottom";
         }
 
+        // Ranges of layers [bottom_begin, top_end) projecting their top / bottom surfaces to a layer.
+        std::vector<std::pair<size_t, size_t>> shell_ranges(num_layers);
+        size_t max_top_bottom_range = 0;
+        size_t max_holes_range      = 0;
+        {
+            const PrintRegionConfig &region_config = region.config();
+            for (size_t idx_layer = 0; idx_layer < num_layers; ++ idx_layer) {
+                size_t top_end = idx_layer + 1;
+                if (int n_top_layers = region_config.top_solid_layers.value; n_top_layers > 0) {
+                    coordf_t print_z = m_layers[idx_layer]->print_z;
+                    while (top_end < num_layers &&
+                            (int(top_end) < int(idx_layer) + n_top_layers ||
+                                m_layers[top_end]->print_z - print_z < region_config.top_solid_min_thickness - EPSILON))
+                        ++ top_end;
+                }
+                size_t bottom_begin = idx_layer;
+                if (int n_bottom_layers = region_config.bottom_solid_layers.value; n_bottom_layers > 0) {
+                    coordf_t bottom_z = m_layers[idx_layer]->bottom_z();
+                    while (bottom_begin > 0 &&
+                            (int(bottom_begin) - 1 > int(idx_layer) - n_bottom_layers ||
+                                bottom_z - m_layers[bottom_begin - 1]->bottom_z() < region_config.bottom_solid_min_thickness - EPSILON))
+                        -- bottom_begin;
+                }
+                shell_ranges[idx_layer] = { bottom_begin, top_end };
+                max_top_bottom_range = std::max(max_top_bottom_range, std::max(top_end - idx_layer - 1, idx_layer - bottom_begin));
+                max_holes_range      = std::max(max_holes_range, top_end - bottom_begin);
+            }
+        }
+
+        // Index the cached top / bottom surfaces and holes, so that the union / intersection over the shell range
+        // of each layer is calculated with a single Clipper operation instead of a chain of operations over all the layers.
+        // If the cache is shared by all regions, the indices are only rebuilt if the current region spans more layers.
+        BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << region_id << " in parallel - start : index top / bottom";
+        auto throw_on_cancel = [this](){ m_print->throw_if_canceled(); };
+        if (! top_bottom_surfaces_all_regions || top_surfaces_index.max_range() < max_top_bottom_range) {
+            top_surfaces_index = LayerRangeCoverage(num_layers, [&cache_top_botom_regions](size_t i) -> const Polygons& { return cache_top_botom_regions[i].top_surfaces; },
+                LayerRangeCoverage::Mode::Union, max_top_bottom_range, throw_on_cancel);
+            bottom_surfaces_index = LayerRangeCoverage(num_layers, [&cache_top_botom_regions](size_t i) -> const Polygons& { return cache_top_botom_regions[i].bottom_surfaces; },
+                LayerRangeCoverage::Mode::Union, max_top_bottom_range, throw_on_cancel);
+        }
+        // Holes are the same for all the regions.
+        if (holes_index.max_range() < max_holes_range)
+            holes_index = LayerRangeCoverage(num_layers, [&cache_top_botom_regions](size_t i) -> const Polygons& { return cache_top_botom_regions[i].holes; },
+                LayerRangeCoverage::Mode::Intersection, max_holes_range, throw_on_cancel);
+        m_print->throw_if_canceled();
+        BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << region_id << " in parallel - end : index top / bottom";
+
         BOOST_LOG_TRIVIAL(debug) << "Discovering vertical shells for region " << region_id << " in parallel - start : ensure vertical wall thickness";
         tbb::parallel_for(
             tbb::blocked_range<size_t>(0, num_layers, grain_size),
-            [this, region_id, &cache_top_botom_regions]
+            [this, region_id, &shell_ranges, &top_surfaces_index, &bottom_surfaces_index, &holes_index]
             (const tbb::blocked_range<size_t>& range) {
                 // printf("discover_vertical_shells from %d to %d\n", range.begin(), range.end());
                 for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
@@ -1337,45 +1389,16 @@ void PrintObject::discover_vertical_shells()
                         }
                     }
 #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
-			        polygons_append(holes, cache_top_botom_regions[idx_layer].holes);
-			        if (int n_top_layers = region_config.top_solid_layers.value; n_top_layers > 0) {
-                        // Gather top regions projected to this layer.
-                        coordf_t print_z = layer->print_z;
-	                    for (int i = int(idx_layer) + 1; 
-	                        i < int(cache_top_botom_regions.size()) && 
-	                        	(i < int(idx_layer) + n_top_layers ||
-	                        		m_layers[i]->print_z - print_z < region_config.top_solid_min_thickness - EPSILON);
-	                        ++ i) {
-	                        const DiscoverVerticalShellsCacheEntry &cache = cache_top_botom_regions[i];
-							if (! holes.empty())
-								holes = intersection(holes, cache.holes);
-							if (! cache.top_surfaces.empty()) {
-		                        polygons_append(shell, cache.top_surfaces);
-		                        // Running the union_ using the Clipper library piece by piece is cheaper 
-		                        // than running the union_ all at once.
-	                            shell = union_(shell);
-	                        }
-	                    }
-	                }
-	                if (int n_bottom_layers = region_config.bottom_solid_layers.value; n_bottom_layers > 0) {
-                        // Gather bottom regions projected to this layer.
-                        coordf_t bottom_z = layer->bottom_z();
-	                    for (int i = int(idx_layer) - 1;
-	                        i >= 0 &&
-	                        	(i > int(idx_layer) - n_bottom_layers ||
-	                        		bottom_z - m_layers[i]->bottom_z() < region_config.bottom_solid_min_thickness - EPSILON);
-	                        -- i) {
-	                        const DiscoverVerticalShellsCacheEntry &cache = cache_top_botom_regions[i];
-							if (! holes.empty())
-								holes = intersection(holes, cache.holes);
-							if (! cache.bottom_surfaces.empty()) {
-		                        polygons_append(shell, cache.bottom_surfaces);
-		                        // Running the union_ using the Clipper library piece by piece is cheaper 
-		                        // than running the union_ all at once.
-		                        shell = union_(shell);
-		                    }
-	                    }
-	                }
+                    // Gather top regions projected to this layer, bottom regions projected to this layer
+                    // and the holes common to all the layers of the shell.
+                    auto [bottom_begin, top_end] = shell_ranges[idx_layer];
+                    holes = holes_index.query(bottom_begin, top_end);
+                    {
+                        Polygons top    = top_surfaces_index.query(idx_layer + 1, top_end);
+                        Polygons bottom = bottom_surfaces_index.query(bottom_begin, idx_layer);
+                        if (! top.empty() || ! bottom.empty())
+                            shell = bottom.empty() ? union_(top) : top.empty() ? union_(bottom) : union_(top, bottom);
+                    }
 #ifdef SLIC3R_DEBUG_SLICE_PROCESSING
                     {
         				Slic3r::SVG svg(debug_out_path("discover_vertical_shells-perimeters-before-union-%d.svg", debug_idx), get_extents(shell));
@@ -1544,9 +1567,28 @@ void PrintObject::bridge_over_infill()
         internals.emplace_back(std::move(sum));
     }
 
+    // For each layer and sparse infill region, find the first of the lower layers spanned by the bridge flow.
+    // The lower layers are then queried at once from the intersection index over internals.
+    std::vector<size_t> lower_layers_begin(sparse_infill_regions.size() * (this->layer_count() - 1));
+    size_t              max_lower_layers = 0;
+    for (size_t task_id = 0; task_id < lower_layers_begin.size(); ++ task_id) {
+        const size_t layer_id  = (task_id / sparse_infill_regions.size()) + 1;
+        const size_t region_id = sparse_infill_regions[task_id % sparse_infill_regions.size()];
+        const Layer *layer     = this->get_layer(layer_id);
+        // Stop at the first layer lower than bottom_z.
+        double       bottom_z  = layer->print_z - layer->m_regions[region_id]->bridging_flow(frSolidInfill).height() - EPSILON;
+        size_t       begin     = layer_id;
+        while (begin > 0 && m_layers[begin - 1]->print_z >= bottom_z)
+            -- begin;
+        lower_layers_begin[task_id] = begin;
+        max_lower_layers = std::max(max_lower_layers, layer_id - begin);
+    }
+    LayerRangeCoverage internals_index(internals.size(), [&internals](size_t i) -> const Polygons& { return internals[i]; },
+        LayerRangeCoverage::Mode::Intersection, max_lower_layers, [this](){ m_print->throw_if_canceled(); });
+
     // Process all regions and layers in parallel.
     tbb::parallel_for(tbb::blocked_range<size_t>(0, sparse_infill_regions.size() * (this->layer_count() - 1), sparse_infill_regions.size()),
-        [this, &sparse_infill_regions, &internals]
+        [this, &sparse_infill_regions, &lower_layers_begin, &internals_index]
         (const tbb::blocked_range<size_t> &range) {
         for (size_t task_id = range.begin(); task_id != range.end(); ++ task_id) {
             const size_t layer_id    = (task_id / sparse_infill_regions.size()) + 1;
@@ -1568,15 +1610,9 @@ void PrintObject::bridge_over_infill()
             ExPolygons to_bridge;
             {
                 Polygons to_bridge_pp = to_polygons(internal_solid);
-                // Iterate through lower layers spanned by bridge_flow.
-                double bottom_z = layer->print_z - bridge_flow.height() - EPSILON;
-                for (auto i = int(layer_id) - 1; i >= 0; -- i) {
-                    // Stop iterating if layer is lower than bottom_z.
-                    if (m_layers[i]->print_z < bottom_z)
-                        break;
-                    // Intersect lower sparse infills with the candidate solid surfaces.
-                    to_bridge_pp = intersection(to_bridge_pp, internals[i]);
-                }
+                // Intersect sparse infills of the lower layers spanned by bridge_flow with the candidate solid surfaces.
+                if (size_t begin = lower_layers_begin[task_id]; begin < layer_id)
+                    to_bridge_pp = intersection(to_bridge_pp, internals_index.query(begin, layer_id));
                 // there's no point in bridging too thin/short regions
                 //FIXME Vojtech: The offset2 function is not a geometric offset, 
                 // therefore it may create 1) gaps, and 2) sharp corners, which are outside the original contour.
@@ -6,6 +6,8 @@
 #include "Print.hpp"
 #include "ShortestPath.hpp"
 
+#include <deque>
+
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
@@ -155,6 +157,18 @@ static std::vector<VolumeSlices> slice_volumes_inner(
     const bool   is_mm_painted = num_extruders > 1 && std::any_of(model_volumes.cbegin(), model_volumes.cend(), [](const ModelVolume *mv) { return mv->is_mm_painted(); });
     const auto   extra_offset  = is_mm_painted ? 0.f : std::max(0.f, float(print_object_config.xy_size_compensation.value));
 
+    // Collect the volumes to be sliced together with their slicing parameters first, then slice them all in parallel.
+    // Each slice_mesh_ex() call is parallelized internally over triangles and layers, however objects composed
+    // of many small modifier meshes do not saturate the worker threads if the volumes are sliced one after the other.
+    struct SlicingTask {
+        const ModelVolume                 *model_volume;
+        MeshSlicingParamsEx                params;
+        // Empty if all layers shall be sliced.
+        std::vector<t_layer_height_range>  slicing_ranges;
+    };
+    std::vector<SlicingTask> tasks;
+    tasks.reserve(model_volumes.size());
+
     for (const ModelVolume *model_volume : model_volumes)
         if (model_volume_needs_slicing(*model_volume)) {
             MeshSlicingParamsEx params { params_base };
@@ -173,10 +187,7 @@ static std::vector<VolumeSlices> slice_volumes_inner(
                         for (; params.slicing_mode_normal_below_layer < zs.size() && zs[params.slicing_mode_normal_below_layer] < region_config.bottom_solid_min_thickness - EPSILON;
                             ++ params.slicing_mode_normal_below_layer);
                     }
-                    out.push_back({
-                        model_volume->id(), 
-                        slice_volume(*model_volume, zs, params, throw_on_cancel_callback)
-                    });
+                    tasks.push_back({ model_volume, params, {} });
                 }
             } else {
                 assert(! print_config.spiral_vase);
@@ -185,15 +196,28 @@ static std::vector<VolumeSlices> slice_volumes_inner(
                     if (layer_range.has_volume(model_volume->id()))
                         slicing_ranges.emplace_back(layer_range.layer_height_range);
                 if (! slicing_ranges.empty())
-                    out.push_back({ 
-                        model_volume->id(), 
-                        slice_volume(*model_volume, zs, slicing_ranges, params, throw_on_cancel_callback)
-                    });
+                    tasks.push_back({ model_volume, params, slicing_ranges });
             }
-            if (! out.empty() && out.back().slices.empty())
-                out.pop_back();
         }
 
+    out.assign(tasks.size(), VolumeSlices());
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, tasks.size(), 1),
+        [&tasks, &out, &zs, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+            for (size_t task_idx = range.begin(); task_idx < range.end(); ++ task_idx) {
+                const SlicingTask &task = tasks[task_idx];
+                out[task_idx] = { 
+                    task.model_volume->id(),
+                    task.slicing_ranges.empty() ?
+                        slice_volume(*task.model_volume, zs, task.params, throw_on_cancel_callback) :
+                        slice_volume(*task.model_volume, zs, task.slicing_ranges, task.params, throw_on_cancel_callback)
+                };
+            }
+        });
+
+    // Tasks were created in the order of ModelVolume::id(), thus the output remains sorted by ModelVolume::id().
+    out.erase(std::remove_if(out.begin(), out.end(), [](const VolumeSlices &vs) { return vs.slices.empty(); }), out.end());
+
     return out;
 }
 
@@ -324,7 +348,13 @@ static std::vector<std::vector<ExPolygons>> slices_to_regions(
                         return ! this_empty && (rhs_empty || (this->region_id < rhs.region_id || (this->region_id == rhs.region_id && volume_id < volume_id)));
                     }
                 };
-                std::vector<RegionSlice> temp_slices;
+                std::vector<RegionSlice>        temp_slices;
+                // Raw slices of model parts and negative volumes, indexed by volume_regions, nullptr if not clipping.
+                std::vector<const ExPolygons*>  clipping_slices;
+                std::deque<ExPolygons>          clipping_slices_raw;
+                // Index of the model part region a modifier region was derived from.
+                std::vector<int>                root_region;
+                Polygons                        clip;
                 for (size_t zs_complex_idx = range.begin(); zs_complex_idx < range.end(); ++ zs_complex_idx) {
                     auto [z_idx, z] = zs_complex[zs_complex_idx];
                     it_layer_range = layer_range_next(print_object_regions.layer_ranges, it_layer_range, z);
@@ -339,6 +369,23 @@ static std::vector<std::vector<ExPolygons>> slices_to_regions(
                             temp_slices.push_back({ std::move(slices->slices[z_idx]), volume_region.region ? volume_region.region->print_object_region_id() : -1, volume_region.model_volume->id() });
                         }
                     }
+                    // Regions of model parts and negative volumes clip all the regions preceding them. Instead of clipping the preceding
+                    // regions one part after the other, the raw slices of the clipping volumes are retained and each region is clipped
+                    // just once below by all the clipping volumes following the model part the region was derived from.
+                    // Difference distributes over the intersection / difference applied by the modifiers, thus the result is the same.
+                    clipping_slices.assign(temp_slices.size(), nullptr);
+                    clipping_slices_raw.clear();
+                    root_region.assign(temp_slices.size(), -1);
+                    for (int idx_region = 0; idx_region < int(layer_range.volume_regions.size()); ++ idx_region) {
+                        const PrintObjectRegions::VolumeRegion &region = layer_range.volume_regions[idx_region];
+                        root_region[idx_region] = region.model_volume->is_modifier() ? root_region[region.parent] : idx_region;
+                        if (idx_region > 0 && ! temp_slices[idx_region].expolygons.empty() && 
+                            (region.model_volume->is_model_part() || region.model_volume->is_negative_volume())) {
+                            // Copy of the slices before they are split by the modifiers.
+                            clipping_slices_raw.emplace_back(temp_slices[idx_region].expolygons);
+                            clipping_slices[idx_region] = &clipping_slices_raw.back();
+                        }
+                    }
                     for (int idx_region = 0; idx_region < int(layer_range.volume_regions.size()); ++ idx_region)
                         if (! temp_slices[idx_region].expolygons.empty()) {
                             const PrintObjectRegions::VolumeRegion &region = layer_range.volume_regions[idx_region];
@@ -357,16 +404,21 @@ static std::vector<std::vector<ExPolygons>> slices_to_regions(
                                 if (next_region_same_modifier)
                                     // To be used in the following iteration.
                                     temp_slices[idx_region + 1].expolygons = std::move(source);
-                            } else if (region.model_volume->is_model_part() || region.model_volume->is_negative_volume()) {
-                                // Clip every non-zero region preceding it.
-                                for (int idx_region2 = 0; idx_region2 < idx_region; ++ idx_region2)
-                                    if (! temp_slices[idx_region2].expolygons.empty()) {
-                                        if (const PrintObjectRegions::VolumeRegion &region2 = layer_range.volume_regions[idx_region2];
-                                            ! region2.model_volume->is_negative_volume() && overlap_in_xy(*region.bbox, *region2.bbox))
-                                            temp_slices[idx_region2].expolygons = diff_ex(temp_slices[idx_region2].expolygons, temp_slices[idx_region].expolygons);
-                                    }
                             }
                         }
+                    if (! clipping_slices_raw.empty())
+                        for (int idx_region = 0; idx_region < int(layer_range.volume_regions.size()); ++ idx_region)
+                            if (ExPolygons &expolygons = temp_slices[idx_region].expolygons; ! expolygons.empty()) {
+                                const PrintObjectRegions::VolumeRegion &region = layer_range.volume_regions[idx_region];
+                                if (region.model_volume->is_negative_volume())
+                                    continue;
+                                clip.clear();
+                                for (int idx_region2 = root_region[idx_region] + 1; idx_region2 < int(clipping_slices.size()); ++ idx_region2)
+                                    if (clipping_slices[idx_region2] != nullptr && overlap_in_xy(*region.bbox, *layer_range.volume_regions[idx_region2].bbox))
+                                        polygons_append(clip, *clipping_slices[idx_region2]);
+                                if (! clip.empty())
+                                    expolygons = diff_ex(expolygons, clip);
+                            }
                     // Sort by region_id, push empty slices to the end.
                     std::sort(temp_slices.begin(), temp_slices.end());
                     // Remove the empty slices.
@@ -549,10 +601,10 @@ void PrintObject::slice()
 }
 
 template<typename ThrowOnCancel>
-void apply_mm_segmentation(PrintObject &print_object, ThrowOnCancel throw_on_cancel)
+void apply_mm_segmentation(PrintObject &print_object, MMUSegmentationCache &cache, ThrowOnCancel throw_on_cancel)
 {
     // Returns MMU segmentation based on painting in MMU segmentation gizmo
-    std::vector<std::vector<ExPolygons>> segmentation = multi_material_segmentation_by_painting(print_object, throw_on_cancel);
+    std::vector<std::vector<ExPolygons>> segmentation = multi_material_segmentation_by_painting(print_object, throw_on_cancel, &cache);
     assert(segmentation.size() == print_object.layer_count());
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, segmentation.size(), std::max(segmentation.size() / 128, size_t(1))),
@@ -739,8 +791,10 @@ void PrintObject::slice_volumes()
         }
 
         BOOST_LOG_TRIVIAL(debug) << "Slicing volumes - MMU segmentation";
-        apply_mm_segmentation(*this, [print]() { print->throw_if_canceled(); });
-    }
+        apply_mm_segmentation(*this, m_shared_regions->mmu_segmentation_cache, [print]() { print->throw_if_canceled(); });
+    } else
+        // Not painted anymore, release the segmentation of the previous slicing.
+        m_shared_regions->mmu_segmentation_cache.clear();
 
 
     BOOST_LOG_TRIVIAL(debug) << "Slicing volumes - make_slices in parallel - begin";
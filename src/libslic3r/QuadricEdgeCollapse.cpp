@@ -1,8 +1,13 @@
 #include "QuadricEdgeCollapse.hpp"
 #include <tuple>
 #include <optional>
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include "BoundingBox.hpp"
 #include "MutablePriorityQueue.hpp"
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
 
 using namespace Slic3r;
 
@@ -133,7 +138,15 @@ namespace QuadricEdgeCollapse {
     void change_neighbors(EdgeInfos &e_infos, VertexInfos &v_infos, uint32_t ti0, uint32_t ti1,
                           uint32_t vi0, uint32_t vi1, uint32_t vi_top0,
                           const Triangle &t1, CopyEdgeInfos& infos, EdgeInfos &e_infos1);
-    void compact(const VertexInfos &v_infos, const TriangleInfos &t_infos, const EdgeInfos &e_infos, indexed_triangle_set &its);
+    // kept_vertices: optional output of the original indices of the vertices kept
+    void compact(const VertexInfos &v_infos, const TriangleInfos &t_infos, const EdgeInfos &e_infos, indexed_triangle_set &its,
+                 std::vector<uint32_t> *kept_vertices = nullptr);
+    // Reduce the mesh, return the error of the last collapsed edge.
+    // Edges with a locked vertex are not collapsed, locked may be empty.
+    float collapse(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error, const std::vector<bool> &locked,
+                   ThrowOnCancel &throw_on_cancel, StatusFn &status_fn, std::vector<uint32_t> *kept_vertices = nullptr);
+    // Split triangles into spatially coherent parts of at most max_part_size triangles, returns triangle indices of the parts.
+    std::vector<std::vector<uint32_t>> partition(const indexed_triangle_set &its, size_t max_part_size);
 
 #ifdef EXPENSIVE_DEBUG_CHECKS
     void store_surround(const char *obj_filename, size_t triangle_index, int depth, const indexed_triangle_set &its,
@@ -153,6 +166,13 @@ namespace QuadricEdgeCollapse {
     const int status_set_offsets = 10;
     const int status_calc_errors = 30;
     const int status_create_refs = 10;
+    // parallel simplification
+    // meshes with less triangles are simplified serially
+    const size_t parallel_min_triangle_count = 100000;
+    // triangle count of a part simplified by a single task
+    const size_t parallel_part_size = 50000;
+    // part of the status for simplification of the parts, in percents
+    const int status_parts_size = 60;
     } // namespace QuadricEdgeCollapse
 
 using namespace QuadricEdgeCollapse;
@@ -171,6 +191,13 @@ void Slic3r::its_quadric_edge_collapse(
     if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
     if (status_fn == nullptr) status_fn = [](int) {};
 
+    float last_collapsed_error = collapse(its, triangle_count, maximal_error, {}, throw_on_cancel, status_fn);
+    if (max_error != nullptr) *max_error = last_collapsed_error;
+}
+
+float QuadricEdgeCollapse::collapse(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error, const std::vector<bool> &locked,
+                                    ThrowOnCancel &throw_on_cancel, StatusFn &status_fn, std::vector<uint32_t> *kept_vertices)
+{
     StatusFn init_status_fn = [&](int percent) {
         float n_percent = percent * status_init_size / 100.f;
         status_fn(static_cast<int>(std::round(n_percent)));
@@ -255,7 +282,8 @@ void Slic3r::its_quadric_edge_collapse(
             reorder_edges(e_infos, v_info0, ti0, ti1);
             reorder_edges(e_infos, v_info1, ti0, ti1);
         }
-        if (!ti1_opt.has_value() || // edge has only one triangle
+        if ((! locked.empty() && (locked[vi0] || locked[vi1])) ||
+            !ti1_opt.has_value() || // edge has only one triangle
             degenerate(vi0, ti0, ti1, v_info1, e_infos, its.indices) ||
             degenerate(vi1, ti0, ti1, v_info0, e_infos, its.indices) ||
             create_no_volume(vi0, vi1, ti0, ti1, v_info0, v_info1, e_infos, its.indices) ||
@@ -342,10 +370,187 @@ void Slic3r::its_quadric_edge_collapse(
     }
 
     // compact triangle
-    compact(v_infos, t_infos, e_infos, its);
+    compact(v_infos, t_infos, e_infos, its, kept_vertices);
+    return last_collapsed_error;
+}
+
+void Slic3r::its_quadric_edge_collapse_parallel(
+    indexed_triangle_set &    its,
+    uint32_t                  triangle_count,
+    float *                   max_error,
+    std::function<void(void)> throw_on_cancel,
+    std::function<void(int)>  status_fn)
+{
+    if (its.indices.size() < parallel_min_triangle_count) {
+        its_quadric_edge_collapse(its, triangle_count, max_error, throw_on_cancel, status_fn);
+        return;
+    }
+    // check input
+    if (triangle_count >= its.indices.size()) return;
+    float maximal_error = (max_error == nullptr)? std::numeric_limits<float>::max() : *max_error;
+    if (maximal_error <= 0.f) return;
+    if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
+    if (status_fn == nullptr) status_fn = [](int) {};
+
+    // The partition depends on the mesh only, not on the number of threads, thus the result is deterministic.
+    std::vector<std::vector<uint32_t>> parts = partition(its, parallel_part_size);
+
+    // Vertices shared by triangles of more than one part are locked while the parts are simplified.
+    std::vector<bool> locked(its.vertices.size(), false);
+    {
+        std::vector<uint32_t> vertex_part(its.vertices.size(), std::numeric_limits<uint32_t>::max());
+        for (uint32_t part_idx = 0; part_idx < parts.size(); ++ part_idx)
+            for (uint32_t ti : parts[part_idx])
+                for (int i = 0; i < 3; ++ i) {
+                    uint32_t &vp = vertex_part[its.indices[ti][i]];
+                    if (vp == std::numeric_limits<uint32_t>::max())
+                        vp = part_idx;
+                    else if (vp != part_idx)
+                        locked[its.indices[ti][i]] = true;
+                }
+    }
+    throw_on_cancel();
+
+    // Simplify the parts in parallel, each part to the same ratio of its triangles.
+    struct Part {
+        indexed_triangle_set  its;
+        // Indices of the part vertices into its.vertices, sorted.
+        std::vector<uint32_t> vertices;
+        // Indices of the part vertices kept after the simplification.
+        std::vector<uint32_t> kept_vertices;
+        float                 last_collapsed_error { 0.f };
+    };
+    std::vector<Part> simplified(parts.size());
+    std::atomic<size_t> num_simplified { 0 };
+    std::mutex          status_mutex;
+    const double        ratio = double(triangle_count) / double(its.indices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, parts.size(), 1), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t part_idx = range.begin(); part_idx < range.end(); ++ part_idx) {
+            const std::vector<uint32_t> &triangles = parts[part_idx];
+            Part                         &part      = simplified[part_idx];
+            part.vertices.reserve(triangles.size());
+            for (uint32_t ti : triangles)
+                for (int i = 0; i < 3; ++ i)
+                    part.vertices.emplace_back(its.indices[ti][i]);
+            sort_remove_duplicates(part.vertices);
+            std::vector<bool> part_locked(part.vertices.size());
+            part.its.vertices.reserve(part.vertices.size());
+            for (size_t i = 0; i < part.vertices.size(); ++ i) {
+                part.its.vertices.emplace_back(its.vertices[part.vertices[i]]);
+                part_locked[i] = locked[part.vertices[i]];
+            }
+            part.its.indices.reserve(triangles.size());
+            for (uint32_t ti : triangles) {
+                Triangle t;
+                for (int i = 0; i < 3; ++ i)
+                    t[i] = int(std::lower_bound(part.vertices.begin(), part.vertices.end(), uint32_t(its.indices[ti][i])) - part.vertices.begin());
+                part.its.indices.emplace_back(t);
+            }
+            auto part_triangle_count = uint32_t(std::round(ratio * double(triangles.size())));
+            if (part_triangle_count < part.its.indices.size()) {
+                StatusFn part_status_fn = [](int) {};
+                part.last_collapsed_error = collapse(part.its, part_triangle_count, maximal_error, part_locked, throw_on_cancel, part_status_fn, &part.kept_vertices);
+            } else {
+                part.kept_vertices.resize(part.vertices.size());
+                std::iota(part.kept_vertices.begin(), part.kept_vertices.end(), 0);
+            }
+            size_t n = ++ num_simplified;
+            std::lock_guard<std::mutex> lock(status_mutex);
+            status_fn(int(n * status_parts_size / parts.size()));
+        }
+    });
+
+    // Stitch the parts, the locked vertices keep their position.
+    float last_collapsed_error = 0.f;
+    {
+        indexed_triangle_set  stitched;
+        std::vector<uint32_t> locked_vertex_map(its.vertices.size(), std::numeric_limits<uint32_t>::max());
+        std::vector<uint32_t> vertex_map;
+        for (Part &part : simplified) {
+            vertex_map.clear();
+            for (size_t i = 0; i < part.kept_vertices.size(); ++ i) {
+                uint32_t vi = part.vertices[part.kept_vertices[i]];
+                if (locked[vi]) {
+                    if (locked_vertex_map[vi] == std::numeric_limits<uint32_t>::max()) {
+                        locked_vertex_map[vi] = uint32_t(stitched.vertices.size());
+                        stitched.vertices.emplace_back(its.vertices[vi]);
+                    }
+                    vertex_map.emplace_back(locked_vertex_map[vi]);
+                } else {
+                    vertex_map.emplace_back(uint32_t(stitched.vertices.size()));
+                    stitched.vertices.emplace_back(part.its.vertices[i]);
+                }
+            }
+            for (const Triangle &t : part.its.indices)
+                stitched.indices.emplace_back(int(vertex_map[t[0]]), int(vertex_map[t[1]]), int(vertex_map[t[2]]));
+            last_collapsed_error = std::max(last_collapsed_error, part.last_collapsed_error);
+            part = Part();
+        }
+        its = std::move(stitched);
+    }
+    throw_on_cancel();
+
+    // Simplify the mesh along the borders of the parts and reduce it to the wanted triangle count.
+    if (triangle_count < its.indices.size()) {
+        StatusFn stitched_status_fn = [&status_fn](int percent) {
+            status_fn(status_parts_size + percent * (100 - status_parts_size) / 100);
+        };
+        last_collapsed_error = std::max(last_collapsed_error, collapse(its, triangle_count, maximal_error, {}, throw_on_cancel, stitched_status_fn));
+    } else
+        // Remove the locked vertices not referenced anymore.
+        its_compactify_vertices(its);
+    status_fn(100);
     if (max_error != nullptr) *max_error = last_collapsed_error;
 }
 
+std::vector<std::vector<uint32_t>> QuadricEdgeCollapse::partition(const indexed_triangle_set &its, size_t max_part_size)
+{
+    std::vector<Vec3f>    centroids(its.indices.size());
+    std::vector<uint32_t> order(its.indices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            const Triangle &t = its.indices[i];
+            centroids[i] = (its.vertices[t[0]] + its.vertices[t[1]] + its.vertices[t[2]]) / 3.f;
+            order[i]     = uint32_t(i);
+        }
+    });
+
+    // Median splits along the longest axis of the bounding box of the centroids.
+    // Ties are broken by the triangle index, so that the split does not depend on the order of processing.
+    // The first triangle of each part is marked.
+    std::vector<char> part_begin(its.indices.size() + 1, false);
+    std::function<void(size_t, size_t)> split = [&](size_t begin, size_t end) {
+        if (end - begin <= max_part_size) {
+            part_begin[begin] = true;
+            return;
+        }
+        BoundingBoxf3 bbox;
+        for (size_t i = begin; i < end; ++ i)
+            bbox.merge(centroids[order[i]].cast<double>());
+        Vec3d  size = bbox.size();
+        int    axis = size.x() > size.y() ? (size.x() > size.z() ? 0 : 2) : (size.y() > size.z() ? 1 : 2);
+        size_t mid  = begin + (end - begin) / 2;
+        std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [&centroids, axis](uint32_t l, uint32_t r) {
+            return centroids[l][axis] < centroids[r][axis] || (centroids[l][axis] == centroids[r][axis] && l < r);
+        });
+        tbb::parallel_invoke([&split, begin, mid]() { split(begin, mid); }, [&split, mid, end]() { split(mid, end); });
+    };
+    if (! its.indices.empty())
+        split(0, its.indices.size());
+
+    std::vector<std::vector<uint32_t>> out;
+    for (size_t i = 0; i < order.size();) {
+        size_t j = i + 1;
+        while (j < order.size() && ! part_begin[j])
+            ++ j;
+        out.emplace_back(order.begin() + i, order.begin() + j);
+        // Process triangles of a part in the order of the input mesh.
+        std::sort(out.back().begin(), out.back().end());
+        i = j;
+    }
+    return out;
+}
+
 Vec3d QuadricEdgeCollapse::create_normal(const Triangle &triangle,
                                          const Vertices &vertices)
 {
@@ -836,12 +1041,15 @@ void QuadricEdgeCollapse::change_neighbors(EdgeInfos &     e_infos,
 void QuadricEdgeCollapse::compact(const VertexInfos &   v_infos,
                                   const TriangleInfos & t_infos,
                                   const EdgeInfos &     e_infos,
-                                  indexed_triangle_set &its)
+                                  indexed_triangle_set &its,
+                                  std::vector<uint32_t> *kept_vertices)
 {
+    if (kept_vertices != nullptr) kept_vertices->clear();
     uint32_t vi_new = 0;
     for (uint32_t vi = 0; vi < v_infos.size(); ++vi) {
         const VertexInfo &v_info = v_infos[vi];
         if (v_info.is_deleted()) continue; // deleted
+        if (kept_vertices != nullptr) kept_vertices->emplace_back(vi);
         uint32_t e_info_end = v_info.start + v_info.count;
         for (uint32_t ei = v_info.start; ei < e_info_end; ++ei) { 
             const EdgeInfo &e_info = e_infos[ei];
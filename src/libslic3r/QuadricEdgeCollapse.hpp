@@ -30,6 +30,23 @@ void its_quadric_edge_collapse(
     std::function<void(void)> throw_on_cancel = nullptr,
     std::function<void(int)>  statusfn        = nullptr);
 
+/// <summary>
+/// Simplify large mesh by Quadric metric on all cores.
+/// The mesh is split spatially into parts, which are simplified in parallel
+/// with the vertices on the borders between the parts locked. The parts are then stitched
+/// and the stitched mesh is simplified to the wanted triangle count.
+/// The result does not depend on the number of threads, it differs from
+/// the result of its_quadric_edge_collapse() by the triangles along the borders of the parts.
+/// Small meshes are simplified by its_quadric_edge_collapse().
+/// Same parameters as its_quadric_edge_collapse().
+/// </summary>
+void its_quadric_edge_collapse_parallel(
+    indexed_triangle_set &    its,
+    uint32_t                  triangle_count  = 0,
+    float *                   max_error       = nullptr,
+    std::function<void(void)> throw_on_cancel = nullptr,
+    std::function<void(int)>  statusfn        = nullptr);
+
 } // namespace Slic3r
 #endif // slic3r_quadric_edge_collapse_hpp_
 
@@ -31,6 +31,39 @@ template<class Color> struct Colors {
 template<class Color> const Color Colors<Color>::White = Color{255};
 template<class Color> const Color Colors<Color>::Black = Color{0};
 
+// Convert a closed polygon given by scaled coordinates into an AGG path in the pixel coordinates of a raster
+// of the given resolution. pxdim_scaled is the inverse of the pixel dimensions, scaled by SCALING_FACTOR.
+template<class PointVec>
+agg::path_storage to_agg_path(const PointVec         &v,
+                              const Resolution       &resolution,
+                              const PixelDim         &pxdim_scaled,
+                              const RasterBase::Trafo &trafo)
+{
+    auto getPx = [&pxdim_scaled](const Point &p) { return p(0) * pxdim_scaled.w_mm; };
+    auto getPy = [&pxdim_scaled](const Point &p) { return p(1) * pxdim_scaled.h_mm; };
+
+    agg::path_storage path;
+
+    auto it = v.begin();
+    if (trafo.flipXY) {
+        path.move_to(getPy(*it), getPx(*it));
+        while(++it != v.end()) path.line_to(getPy(*it), getPx(*it));
+        path.line_to(getPy(v.front()), getPx(v.front()));
+    } else {
+        path.move_to(getPx(*it), getPy(*it));
+        while(++it != v.end()) path.line_to(getPx(*it), getPy(*it));
+        path.line_to(getPx(v.front()), getPy(v.front()));
+    }
+
+    path.translate_all_paths(trafo.center_x * pxdim_scaled.w_mm,
+                             trafo.center_y * pxdim_scaled.h_mm);
+
+    if(trafo.mirror_x) path.flip_x(0, double(resolution.width_px));
+    if(trafo.mirror_y) path.flip_y(0, double(resolution.height_px));
+
+    return path;
+}
+
 template<class PixelRenderer,
          template<class /*agg::renderer_base<PixelRenderer>*/> class Renderer,
          class Rasterizer = agg::rasterizer_scanline_aa<>,
@@ -59,55 +92,11 @@ protected:
     Scanline m_scanlines;
     Rasterizer m_rasterizer;
     
-    void flipy(agg::path_storage &path) const
-    {
-        path.flip_y(0, double(m_resolution.height_px));
-    }
-    
-    void flipx(agg::path_storage &path) const
-    {
-        path.flip_x(0, double(m_resolution.width_px));
-    }
-    
-    double getPx(const Point &p) { return p(0) * m_pxdim_scaled.w_mm; }
-    double getPy(const Point &p) { return p(1) * m_pxdim_scaled.h_mm; }
     agg::path_storage to_path(const Polygon &poly) { return to_path(poly.points); }
     
-    template<class PointVec> agg::path_storage _to_path(const PointVec& v)
-    {
-        agg::path_storage path;
-        
-        auto it = v.begin();
-        path.move_to(getPx(*it), getPy(*it));
-        while(++it != v.end()) path.line_to(getPx(*it), getPy(*it));
-        path.line_to(getPx(v.front()), getPy(v.front()));
-        
-        return path;
-    }
-    
-    template<class PointVec> agg::path_storage _to_path_flpxy(const PointVec& v)
-    {
-        agg::path_storage path;
-        
-        auto it = v.begin();
-        path.move_to(getPy(*it), getPx(*it));
-        while(++it != v.end()) path.line_to(getPy(*it), getPx(*it));
-        path.line_to(getPy(v.front()), getPx(v.front()));
-        
-        return path;
-    }
-    
     template<class PointVec> agg::path_storage to_path(const PointVec &v)
     {
-        auto path = m_trafo.flipXY ? _to_path_flpxy(v) : _to_path(v);
-        
-        path.translate_all_paths(m_trafo.center_x * m_pxdim_scaled.w_mm,
-                                 m_trafo.center_y * m_pxdim_scaled.h_mm);
-        
-        if(m_trafo.mirror_x) flipx(path);
-        if(m_trafo.mirror_y) flipy(path);
-        
-        return path;
+        return to_agg_path(v, m_resolution, m_pxdim_scaled, m_trafo);
     }
     
     template<class P> void _draw(const P &poly)
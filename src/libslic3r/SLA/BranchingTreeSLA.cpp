@@ -39,6 +39,8 @@ class BranchingTreeBuilder: public branchingtree::Builder {
 
     std::vector<size_t>  m_unroutable_pinheads;
 
+    GroundConnection search_ground_connection_down(const branchingtree::Node &from) const;
+
     void build_subtree(size_t root)
     {
         traverse(m_cloud, root, [this](const branchingtree::Node &node) {
@@ -147,6 +149,10 @@ public:
     std::optional<Vec3f> suggest_avoidance(const branchingtree::Node &from,
                                            float max_bridge_len) const override;
 
+    // Search the ground connections of the nodes straight down in parallel
+    // and cache them, so that suggest_avoidance() finds them in the cache.
+    void precalculate_ground_connections(const std::vector<branchingtree::Node> &nodes);
+
     void report_unroutable(const branchingtree::Node &j) override
     {
         double glvl = ground_level(m_sm);
@@ -308,17 +314,42 @@ static std::optional<Vec3f> get_avoidance(const GroundConnection &conn,
     return ret;
 }
 
-std::optional<Vec3f> BranchingTreeBuilder::suggest_avoidance(
-    const branchingtree::Node &from, float max_bridge_len) const
+GroundConnection BranchingTreeBuilder::search_ground_connection_down(
+    const branchingtree::Node &from) const
 {
-    std::optional<Vec3f> ret;
-
     double glvl = ground_level(m_sm);
     branchingtree::Node dst = from;
     dst.pos.z() = glvl;
     dst.weight += from.pos.z() - glvl;
     sla::Junction j{from.pos.cast<double>(), get_radius(from)};
 
+    return deepsearch_ground_connection(beam_ex_policy , m_sm, j,
+                                        get_radius(dst), sla::DOWN);
+}
+
+void BranchingTreeBuilder::precalculate_ground_connections(
+    const std::vector<branchingtree::Node> &nodes)
+{
+    // Every node is searched by one task into its own slot, the results are
+    // cached afterwards in the order of the nodes. No locking is needed and
+    // the cache does not depend on the scheduling of the tasks.
+    std::vector<GroundConnection> conns(nodes.size());
+
+    execution::for_each(ex_tbb, size_t(0), nodes.size(),
+                        [this, &nodes, &conns](size_t idx) {
+                            if (!m_builder.ctl().stopcondition())
+                                conns[idx] = search_ground_connection_down(nodes[idx]);
+                        });
+
+    for (size_t idx = 0; idx < nodes.size(); ++idx)
+        m_gnd_connections.emplace(nodes[idx].id, std::move(conns[idx]));
+}
+
+std::optional<Vec3f> BranchingTreeBuilder::suggest_avoidance(
+    const branchingtree::Node &from, float max_bridge_len) const
+{
+    std::optional<Vec3f> ret;
+
     auto found_it = m_gnd_connections.end();
     {
         std::lock_guard lk{m_gnd_connections_mtx};
@@ -328,8 +359,7 @@ std::optional<Vec3f> BranchingTreeBuilder::suggest_avoidance(
     if (found_it != m_gnd_connections.end()) {
         ret = get_avoidance(found_it->second, max_bridge_len);
     } else {
-        auto conn = deepsearch_ground_connection(
-            beam_ex_policy , m_sm, j, get_radius(dst), sla::DOWN);
+        auto conn = search_ground_connection_down(from);
 
         {
             std::lock_guard lk{m_gnd_connections_mtx};
@@ -407,13 +437,7 @@ void create_branching_tree(SupportTreeBuilder &builder, const SupportableMesh &s
 
     BranchingTreeBuilder vbuilder{builder, sm, nodes};
 
-    execution::for_each(ex_tbb,
-                        size_t(0),
-                        nodes.get_leafs().size(),
-                        [&nodes, &vbuilder](size_t leaf_idx) {
-                            vbuilder.suggest_avoidance(nodes.get_leafs()[leaf_idx],
-                                                       nodes.properties().max_branch_length());
-                        });
+    vbuilder.precalculate_ground_connections(nodes.get_leafs());
 
     branchingtree::build_tree(nodes, vbuilder);
 
@@ -322,20 +322,19 @@ bool DefaultSupportTree::connect_to_nearpillar(const Head &head,
        // Cannot insert the bridge. (further search might not worth the hassle)
     if(t < distance(bridgestart, bridgeend)) return false;
 
-    std::lock_guard lk(m_bridge_mutex);
-
-    if (m_builder.bridgecount(nearpillar()) < m_sm.cfg.max_bridges_on_pillar) {
-        // A partial pillar is needed under the starting head.
-        if(zdiff > 0) {
-            m_builder.add_pillar(head.id, headjp.z() - bridgestart.z());
-            m_builder.add_junction(bridgestart, r);
-            m_builder.add_bridge(bridgestart, bridgeend, r);
-        } else {
-            m_builder.add_bridge(head.id, bridgeend);
-        }
+    // Reserve the bridge on the pillar first, other heads may be bridged to
+    // the same pillar concurrently.
+    if (!m_builder.try_increment_bridges(nearpillar(), m_sm.cfg.max_bridges_on_pillar))
+        return false;
 
-        m_builder.increment_bridges(nearpillar());
-    } else return false;
+    // A partial pillar is needed under the starting head.
+    if(zdiff > 0) {
+        m_builder.add_pillar(head.id, headjp.z() - bridgestart.z());
+        m_builder.add_junction(bridgestart, r);
+        m_builder.add_bridge(bridgestart, bridgeend, r);
+    } else {
+        m_builder.add_bridge(head.id, bridgeend);
+    }
 
     return true;
 }
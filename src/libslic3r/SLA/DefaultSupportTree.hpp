@@ -86,9 +86,6 @@ class DefaultSupportTree {
     // A spatial index to easily find strong pillars to connect to.
     PillarIndex m_pillar_index;
 
-    // When bridging heads to pillars... TODO: find a cleaner solution
-    execution::BlockingMutex<ExecutionTBB> m_bridge_mutex;
-
     inline AABBMesh::hit_result ray_mesh_intersect(const Vec3d& s,
                                                       const Vec3d& dir)
     {
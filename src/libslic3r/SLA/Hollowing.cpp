@@ -14,6 +14,8 @@
 #include <libslic3r/QuadricEdgeCollapse.hpp>
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
 #include <libslic3r/Execution/ExecutionSeq.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
+#include <libslic3r/CSGMesh/PerformCSGMeshBooleans.hpp>
 #include <libslic3r/Model.hpp>
 
 #include <libslic3r/MeshBoolean.hpp>
@@ -745,6 +747,25 @@ DrainHoles transformed_drainhole_points(const ModelObject &mo,
     return pts;
 }
 
+const VoxelGrid *HollowingGridCache::find(size_t mesh_hash, double voxel_scale) const
+{
+    // A finer grid serves as well, generate_interior() works at the voxel
+    // scale of the grid it is given.
+    return m_grid && m_mesh_hash == mesh_hash &&
+                   (m_voxel_scale >= voxel_scale || is_approx(m_voxel_scale, voxel_scale)) ?
+               m_grid.get() : nullptr;
+}
+
+void HollowingGridCache::store(size_t mesh_hash, double voxel_scale, VoxelGridPtr &&grid)
+{
+    m_grid.reset();
+    if (grid && grid_memory_usage(*grid) <= m_max_memory) {
+        m_mesh_hash   = mesh_hash;
+        m_voxel_scale = voxel_scale;
+        m_grid        = std::move(grid);
+    }
+}
+
 double get_voxel_scale(double mesh_volume, const HollowingConfig &hc)
 {
     static constexpr double MIN_SAMPLES_IN_WALL = 3.5;
@@ -775,23 +796,22 @@ double get_voxel_scale(double mesh_volume, const HollowingConfig &hc)
     return voxel_scale;
 }
 
-// The same as its_compactify_vertices, but returns a new mesh, doesn't touch
-// the original
+// The same as its_compactify_vertices, but returns a new mesh of the given
+// faces, doesn't touch the original vertices
 static indexed_triangle_set
-remove_unconnected_vertices(const indexed_triangle_set &its)
+remove_unconnected_vertices(const std::vector<stl_vertex>                 &vertices,
+                            const std::vector<stl_triangle_vertex_indices> &indices)
 {
-    if (its.indices.empty()) {};
-
     indexed_triangle_set M;
 
-    std::vector<int> vtransl(its.vertices.size(), -1);
+    std::vector<int> vtransl(vertices.size(), -1);
     int vcnt = 0;
-    for (auto &f : its.indices) {
+    for (auto &f : indices) {
 
         for (int i = 0; i < 3; ++i)
             if (vtransl[size_t(f(i))] < 0) {
 
-                M.vertices.emplace_back(its.vertices[size_t(f(i))]);
+                M.vertices.emplace_back(vertices[size_t(f(i))]);
                 vtransl[size_t(f(i))] = vcnt++;
             }
 
@@ -818,20 +838,27 @@ int hollow_mesh_and_drill(indexed_triangle_set &hollowed_mesh,
         );
 
     std::uniform_real_distribution<float> dist(0., float(EPSILON));
-    auto holes_mesh_cgal = MeshBoolean::cgal::triangle_mesh_to_cgal({}, {});
-    indexed_triangle_set part_to_drill = hollowed_mesh;
 
     std::mt19937 m_rng{std::random_device{}()};
 
+    std::vector<indexed_triangle_set> hole_meshes(drainholes.size());
     for (size_t i = 0; i < drainholes.size(); ++i) {
         sla::DrainHole holept = drainholes[i];
 
         holept.normal += Vec3f{dist(m_rng), dist(m_rng), dist(m_rng)};
         holept.normal.normalize();
         holept.pos += Vec3f{dist(m_rng), dist(m_rng), dist(m_rng)};
-        indexed_triangle_set m = holept.to_mesh();
+        hole_meshes[i] = holept.to_mesh();
+    }
+
+    // The holes are checked against the mesh independently of each other,
+    // the failed ones are null.
+    std::vector<MeshBoolean::cgal::CGALMeshPtr> cgal_holes(drainholes.size());
+    execution::for_each(ex_tbb, size_t(0), drainholes.size(),
+                        [&hollowed_mesh, &tree, &hole_meshes, &cgal_holes](size_t i) {
+        const indexed_triangle_set &m = hole_meshes[i];
 
-        part_to_drill.indices.clear();
+        std::vector<stl_triangle_vertex_indices> part_to_drill;
         auto bb = bounding_box(m);
         Eigen::AlignedBox<float, 3> ebb{bb.min.cast<float>(),
                                         bb.max.cast<float>()};
@@ -841,22 +868,27 @@ int hollow_mesh_and_drill(indexed_triangle_set &hollowed_mesh,
             AABBTreeIndirect::intersecting(ebb),
             [&part_to_drill, &hollowed_mesh](const auto& node)
             {
-                part_to_drill.indices.emplace_back(hollowed_mesh.indices[node.idx]);
+                part_to_drill.emplace_back(hollowed_mesh.indices[node.idx]);
                 // continue traversal
                 return true;
             });
 
         auto cgal_meshpart = MeshBoolean::cgal::triangle_mesh_to_cgal(
-            remove_unconnected_vertices(part_to_drill));
+            remove_unconnected_vertices(hollowed_mesh.vertices, part_to_drill));
+
+        if (!MeshBoolean::cgal::does_self_intersect(*cgal_meshpart))
+            cgal_holes[i] = MeshBoolean::cgal::triangle_mesh_to_cgal(m);
+    });
 
-        if (MeshBoolean::cgal::does_self_intersect(*cgal_meshpart)) {
+    for (size_t i = 0; i < cgal_holes.size(); ++i)
+        if (!cgal_holes[i])
             on_hole_fail(i);
-            continue;
-        }
 
-        auto cgal_hole = MeshBoolean::cgal::triangle_mesh_to_cgal(m);
-        MeshBoolean::cgal::plus(*holes_mesh_cgal, *cgal_hole);
-    }
+    // Union of the holes merged pairwise in parallel.
+    auto holes_mesh_cgal = csg::detail_cgal::perform_csg_reduce(ex_tbb, csg::CSGType::Union,
+                                                                std::move(cgal_holes));
+    if (!holes_mesh_cgal)
+        holes_mesh_cgal = MeshBoolean::cgal::triangle_mesh_to_cgal({}, {});
 
     auto ret = static_cast<int>(HollowMeshResult::Ok);
 
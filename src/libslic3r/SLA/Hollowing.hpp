@@ -7,6 +7,8 @@
 #include <libslic3r/SLA/JobController.hpp>
 #include <libslic3r/CSGMesh/VoxelizeCSGMesh.hpp>
 
+#include <boost/container_hash/hash.hpp>
+
 namespace Slic3r {
 
 class ModelObject;
@@ -126,16 +128,72 @@ template<class Cont> double csgmesh_positive_maxvolume(const Cont &csg)
     return mesh_vol;
 }
 
-template<class It>
-InteriorPtr generate_interior(const Range<It>       &csgparts,
-                              const HollowingConfig &hc  = {},
-                              const JobController   &ctl = {})
+// Hash of the meshes, transformations and operations of the csg parts,
+// identifies the voxel grid of the parts cached for hollowing.
+template<class Cont> size_t csgmesh_hash(const Cont &csg)
 {
-    double mesh_vol = csgmesh_positive_maxvolume(csgparts);
-    double voxsc    = get_voxel_scale(mesh_vol, hc);
+    size_t seed = 0;
+    for (const auto &part : csg) {
+        boost::hash_combine(seed, int(csg::get_operation(part)));
+        boost::hash_combine(seed, int(csg::get_stack_operation(part)));
+
+        Transform3f tr = csg::get_transform(part);
+        boost::hash_combine(seed, boost::hash_range(tr.data(), tr.data() + tr.matrix().size()));
+
+        if (const indexed_triangle_set *its = csg::get_mesh(part); its && !its->vertices.empty()) {
+            const float *v = its->vertices.front().data();
+            boost::hash_combine(seed, boost::hash_range(v, v + 3 * its->vertices.size()));
+            if (!its->indices.empty()) {
+                const int *f = its->indices.front().data();
+                boost::hash_combine(seed, boost::hash_range(f, f + 3 * its->indices.size()));
+            }
+        }
+    }
+
+    return seed;
+}
+
+// Keeps the grid voxelized for hollowing, so that a change of the wall
+// thickness, of the closing distance or of the quality generates the interior
+// again without voxelizing the same parts. The voxel scale depends on the
+// thickness of walls thinner than 3.5mm, so a grid at least as fine as the
+// requested one is reused. A grid taking more memory than the limit is not
+// kept.
+class HollowingGridCache
+{
+    size_t       m_mesh_hash   = 0;
+    double       m_voxel_scale = 0.;
+    VoxelGridPtr m_grid;
+    size_t       m_max_memory;
+
+public:
+    static constexpr size_t DefaultMaxMemory = 256 * 1024 * 1024;
+
+    explicit HollowingGridCache(size_t max_memory = DefaultMaxMemory)
+        : m_max_memory{max_memory}
+    {}
+
+    // The grid of the parts with the given csgmesh_hash() voxelized at the
+    // given or at a finer voxel scale, nullptr if it is not cached.
+    const VoxelGrid *find(size_t mesh_hash, double voxel_scale) const;
 
+    // Replace the cached grid, the grid is dropped if it is over the limit.
+    void store(size_t mesh_hash, double voxel_scale, VoxelGridPtr &&grid);
+
+    void clear() { m_grid.reset(); }
+};
+
+// Voxelize the csg parts into the signed distance grid the interior is
+// generated from. The grid depends only on the parts and the voxel scale, so
+// it can be reused to generate interiors with a different wall thickness or
+// closing distance.
+template<class It>
+VoxelGridPtr voxelize_for_hollowing(const Range<It>     &csgparts,
+                                    double               voxel_scale,
+                                    const JobController &ctl = {})
+{
     auto params = csg::VoxelizeParams{}
-                      .voxel_scale(voxsc)
+                      .voxel_scale(voxel_scale)
                       .exterior_bandwidth(3.f)
                       .interior_bandwidth(3.f)
                       .statusfn([&ctl](int){ return ctl.stopcondition && ctl.stopcondition(); });
@@ -148,7 +206,18 @@ InteriorPtr generate_interior(const Range<It>       &csgparts,
     // TODO: figure out issues without the redistance
 //    if (csgparts.size() > 1 || its_is_splittable(*csg::get_mesh(*csgparts.begin())))
 
-    ptr = redistance_grid(*ptr, 0.0f, 3.f, 3.f);
+    return redistance_grid(*ptr, 0.0f, 3.f, 3.f);
+}
+
+template<class It>
+InteriorPtr generate_interior(const Range<It>       &csgparts,
+                              const HollowingConfig &hc  = {},
+                              const JobController   &ctl = {})
+{
+    double mesh_vol = csgmesh_positive_maxvolume(csgparts);
+    double voxsc    = get_voxel_scale(mesh_vol, hc);
+
+    auto ptr = voxelize_for_hollowing(csgparts, voxsc, ctl);
 
     return ptr ? generate_interior(*ptr, hc, ctl) : InteriorPtr{};
 }
@@ -5,6 +5,7 @@
 
 #include <libslic3r/SLA/RasterBase.hpp>
 #include <libslic3r/SLA/AGGRaster.hpp>
+#include <libslic3r/SLA/SpanRaster.hpp>
 
 // minz image write:
 #include <miniz.h>
@@ -33,6 +34,84 @@ EncodedRaster PNGRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
     return EncodedRaster(std::move(buf), "png");
 }
 
+// Mirrors tdefl_write_image_to_png_file_in_memory(): The same compression level and the same sequence
+// of tdefl_compress_buffer() calls, thus the same bytes are produced.
+EncodedRaster PNGRasterEncoder::operator()(const RasterRows &rows, size_t w, size_t h,
+                                           size_t num_components)
+{
+    static constexpr const size_t  HeaderSize = 41;
+    // Number of probes of the compression level 6, see s_tdefl_png_num_probes in miniz.
+    static constexpr const mz_uint NumProbes  = 128;
+
+    std::vector<uint8_t> buf;
+    buf.reserve(57 + std::max<size_t>(64, (1 + w * num_components) * h / 16));
+    buf.assign(HeaderSize, 0);
+
+    auto putter = [](const void *data, int len, void *user) -> mz_bool {
+        auto *out = static_cast<std::vector<uint8_t>*>(user);
+        auto *ptr = static_cast<const uint8_t*>(data);
+        out->insert(out->end(), ptr, ptr + len);
+        return MZ_TRUE;
+    };
+
+    tdefl_compressor *comp = tdefl_compressor_alloc();
+    if (comp == nullptr)
+        return EncodedRaster({}, "png");
+
+    tdefl_init(comp, putter, &buf, NumProbes | TDEFL_WRITE_ZLIB_HEADER);
+    const size_t  bpl    = w * num_components;
+    const uint8_t filter = 0;
+    for (size_t y = 0; y < h; ++ y) {
+        tdefl_compress_buffer(comp, &filter, 1, TDEFL_NO_FLUSH);
+        tdefl_compress_buffer(comp, rows(y), bpl, TDEFL_NO_FLUSH);
+    }
+    bool ok = tdefl_compress_buffer(comp, nullptr, 0, TDEFL_FINISH) == TDEFL_STATUS_DONE;
+    tdefl_compressor_free(comp);
+    if (! ok)
+        return EncodedRaster({}, "png");
+
+    // Write the real header.
+    const size_t len = buf.size() - HeaderSize;
+    {
+        static const uint8_t chans[] = { 0x00, 0x00, 0x04, 0x02, 0x06 };
+        uint8_t pnghdr[HeaderSize] = { 0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00,
+                                       0x00, 0x0d, 0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x00,
+                                       0x00, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                       0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x49, 0x44, 0x41,
+                                       0x54 };
+        pnghdr[18] = uint8_t(w >> 8);
+        pnghdr[19] = uint8_t(w);
+        pnghdr[22] = uint8_t(h >> 8);
+        pnghdr[23] = uint8_t(h);
+        pnghdr[25] = chans[num_components];
+        pnghdr[33] = uint8_t(len >> 24);
+        pnghdr[34] = uint8_t(len >> 16);
+        pnghdr[35] = uint8_t(len >> 8);
+        pnghdr[36] = uint8_t(len);
+        mz_uint32 c = mz_uint32(mz_crc32(MZ_CRC32_INIT, pnghdr + 12, 17));
+        for (int i = 0; i < 4; ++ i, c <<= 8)
+            pnghdr[29 + i] = uint8_t(c >> 24);
+        memcpy(buf.data(), pnghdr, HeaderSize);
+    }
+    // Write the footer: IDAT CRC-32 followed by the IEND chunk.
+    static const uint8_t footer[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82 };
+    buf.insert(buf.end(), footer, footer + sizeof(footer));
+    mz_uint32 c = mz_uint32(mz_crc32(MZ_CRC32_INIT, buf.data() + HeaderSize - 4, len + 4));
+    for (int i = 0; i < 4; ++ i, c <<= 8)
+        buf[buf.size() - 16 + i] = uint8_t(c >> 24);
+
+    return EncodedRaster(std::move(buf), "png");
+}
+
+EncodedRaster RasterBase::encode_rows(RasterRowEncoder encoder) const
+{
+    return encode([&encoder](const void *ptr, size_t w, size_t h, size_t num_components) {
+        auto data = static_cast<const uint8_t*>(ptr);
+        return encoder([data, w, num_components](size_t row) { return data + row * w * num_components; },
+                       w, h, num_components);
+    });
+}
+
 std::ostream &operator<<(std::ostream &stream, const EncodedRaster &bytes)
 {
     stream.write(reinterpret_cast<const char *>(bytes.data()),
@@ -80,6 +159,22 @@ std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     return rst;
 }
 
+std::unique_ptr<RasterBase> create_raster_grayscale_aa_spans(
+    const Resolution        &res,
+    const PixelDim          &pxdim,
+    double                   gamma,
+    const RasterBase::Trafo &tr)
+{
+    std::unique_ptr<RasterBase> rst;
+
+    if (gamma > 0)
+        rst = std::make_unique<RasterGrayscaleAASpans>(res, pxdim, tr, agg::gamma_power(gamma));
+    else
+        rst = std::make_unique<RasterGrayscaleAASpans>(res, pxdim, tr, agg::gamma_threshold(.5));
+
+    return rst;
+}
+
 } // namespace sla
 } // namespace Slic3r
 
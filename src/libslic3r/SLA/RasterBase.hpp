@@ -7,6 +7,7 @@
 #include <array>
 #include <utility>
 #include <cstdint>
+#include <functional>
 
 #include <libslic3r/ExPolygon.hpp>
 
@@ -54,6 +55,14 @@ struct PixelDim {
 using RasterEncoder =
     std::function<EncodedRaster(const void *ptr, size_t w, size_t h, size_t num_components)>;
 
+// Provides the rows of a raster from top to bottom: Returns a pointer to w * num_components
+// values of the requested row, valid until the next call.
+using RasterRows = std::function<const uint8_t*(size_t row)>;
+
+// Encoder consuming a raster row by row, thus the whole frame does not need to be kept in memory.
+using RasterRowEncoder =
+    std::function<EncodedRaster(const RasterRows &rows, size_t w, size_t h, size_t num_components)>;
+
 class RasterBase {
 public:
     
@@ -94,10 +103,16 @@ public:
     virtual Trafo      trafo() const = 0;
     
     virtual EncodedRaster encode(RasterEncoder encoder) const = 0;
+
+    // Encode row by row. Rasters not keeping a frame buffer override this to produce
+    // the rows on demand, the default implementation reads the rows from the frame passed to encode().
+    virtual EncodedRaster encode_rows(RasterRowEncoder encoder) const;
 };
 
+// Produces the same bytes when fed by rows as when fed by the whole frame.
 struct PNGRasterEncoder {
     EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
+    EncodedRaster operator()(const RasterRows &rows, size_t w, size_t h, size_t num_components);
 };
 
 struct PPMRasterEncoder {
@@ -113,6 +128,15 @@ std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     double                   gamma = 1.0,
     const RasterBase::Trafo &tr    = {});
 
+// Same pixels as create_raster_grayscale_aa(), but the raster keeps just the coverage spans
+// of the drawn polygons instead of a frame buffer. Encode it with encode_rows() to avoid
+// allocating the whole frame.
+std::unique_ptr<RasterBase> create_raster_grayscale_aa_spans(
+    const Resolution        &res,
+    const PixelDim          &pxdim,
+    double                   gamma = 1.0,
+    const RasterBase::Trafo &tr    = {});
+
 }} // namespace Slic3r::sla
 
 #endif // SLARASTERBASE_HPP
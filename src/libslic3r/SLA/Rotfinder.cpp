@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 #include <libslic3r/SLA/Rotfinder.hpp>
@@ -73,6 +75,14 @@ struct Facestats {
     }
 };
 
+// The misalignment score of a face with the given normal and area
+inline float get_misalginment_score(const Vec3f &normal, double area)
+{
+    return area * (std::abs(normal.dot(Vec3f::UnitX()))
+                   + std::abs(normal.dot(Vec3f::UnitY()))
+                   + std::abs(normal.dot(Vec3f::UnitZ())));
+}
+
 // Try to guess the number of support points needed to support a mesh
 double get_misalginment_score(const TriangleMesh &mesh, const Transform3f &tr)
 {
@@ -81,13 +91,8 @@ double get_misalginment_score(const TriangleMesh &mesh, const Transform3f &tr)
     auto accessfn = [&mesh, &tr](size_t fi) {
         Facestats fc{get_transformed_triangle(mesh, tr, fi)};
 
-        float score = fc.area
-                      * (std::abs(fc.normal.dot(Vec3f::UnitX()))
-                         + std::abs(fc.normal.dot(Vec3f::UnitY()))
-                         + std::abs(fc.normal.dot(Vec3f::UnitZ())));
-
         // We should score against the alignment with the reference planes
-        return scaled<int_fast64_t>(score);
+        return scaled<int_fast64_t>(get_misalginment_score(fc.normal, fc.area));
     };
 
     size_t facecount = mesh.its.indices.size();
@@ -97,12 +102,12 @@ double get_misalginment_score(const TriangleMesh &mesh, const Transform3f &tr)
     return S / facecount;
 }
 
-// The score function for a particular face
-inline double get_supportedness_score(const Facestats &fc)
+// The score function for a face with the given normal and square root of area
+inline double get_supportedness_score(const Vec3f &normal, double sqrt_area)
 {
     // Simply get the angle (acos of dot product) between the face normal and
     // the DOWN vector.
-    float cosphi = fc.normal.dot(DOWN);
+    float cosphi = std::clamp(normal.dot(DOWN), -1.f, 1.f);
     float phi = 1.f - std::acos(cosphi) / float(PI);
 
     // Make the huge slopes more significant than the smaller slopes
@@ -111,7 +116,13 @@ inline double get_supportedness_score(const Facestats &fc)
     // Multiply with the square root of face area of the current face,
     // the area is less important as it grows.
     // This makes many smaller overhangs a bigger impact.
-    return std::sqrt(fc.area) * POINTS_PER_UNIT_AREA * phi;
+    return sqrt_area * POINTS_PER_UNIT_AREA * phi;
+}
+
+// The score function for a particular face
+inline double get_supportedness_score(const Facestats &fc)
+{
+    return get_supportedness_score(fc.normal, std::sqrt(fc.area));
 }
 
 // Try to guess the number of support points needed to support a mesh
@@ -131,6 +142,118 @@ double get_supportedness_score(const TriangleMesh &mesh, const Transform3f &tr)
     return S / facecount;
 }
 
+// Area weighted histogram of the face normals of a mesh. The directions are
+// binned on the faces of a cube enclosing the unit sphere. Each bin keeps the
+// summed area and the summed square root of area of its faces together with
+// the mean normals weighted by them. The misalignment and supportedness scores
+// depend only on the face normals and areas, thus a rotation can be scored
+// against the non-empty bins instead of every face of the mesh. The error of
+// such score is bounded by the angular size of a bin.
+class NormalHistogram {
+public:
+    // Number of bins along an edge of a cube face, 6 * Resolution^2 bins in total.
+    static constexpr int Resolution = 16;
+
+    explicit NormalHistogram(const TriangleMesh &mesh)
+        : m_facecount(mesh.its.indices.size())
+    {
+        std::vector<Bin> bins(6 * Resolution * Resolution);
+        for (size_t fi = 0; fi < m_facecount; ++fi) {
+            Facestats fc{get_triangle_vertices(mesh, fi)};
+            if (! (fc.area > 0.) || ! fc.normal.allFinite())
+                continue;
+
+            double sqrt_area = std::sqrt(fc.area);
+            Bin &bin = bins[bin_index(fc.normal)];
+            bin.area_normal      += fc.area * fc.normal.cast<double>();
+            bin.area             += fc.area;
+            bin.sqrt_area_normal += sqrt_area * fc.normal.cast<double>();
+            bin.sqrt_area        += sqrt_area;
+        }
+
+        for (const Bin &bin : bins)
+            if (bin.area > 0.)
+                m_bins.push_back({bin.area_normal.normalized().cast<float>(), bin.area,
+                                  bin.sqrt_area_normal.normalized().cast<float>(), bin.sqrt_area});
+    }
+
+    double misalignment_score(const Transform3f &tr) const
+    {
+        if (m_facecount == 0) return NaNd;
+
+        double S = 0.;
+        for (const MeanNormals &bin : m_bins)
+            S += get_misalginment_score(tr.linear() * bin.area_normal, bin.area);
+
+        return S / m_facecount;
+    }
+
+    double supportedness_score(const Transform3f &tr) const
+    {
+        if (m_facecount == 0) return NaNd;
+
+        double S = 0.;
+        for (const MeanNormals &bin : m_bins)
+            S += get_supportedness_score(tr.linear() * bin.sqrt_area_normal, bin.sqrt_area);
+
+        return S / m_facecount;
+    }
+
+    // Supportedness score of the mesh lying on the floor with the floor_area
+    // of its faces. The faces facing down after the rotation are the ones
+    // lying on the floor: The overhang score of their bins is replaced by
+    // the floor contact score.
+    double supportedness_onfloor_score(const Transform3f &tr, double floor_area) const
+    {
+        if (m_facecount == 0) return NaNd;
+
+        // Normals within the angular size of a bin from DOWN.
+        const float floor_cos = std::cos(2.f / Resolution);
+
+        double S = -2 * floor_area * POINTS_PER_UNIT_AREA;
+        for (const MeanNormals &bin : m_bins) {
+            Vec3f n = tr.linear() * bin.sqrt_area_normal;
+            if (n.dot(DOWN) < floor_cos)
+                S += get_supportedness_score(n, bin.sqrt_area);
+        }
+
+        return S / m_facecount;
+    }
+
+    size_t bins_count() const { return m_bins.size(); }
+
+private:
+    struct Bin {
+        Vec3d  area_normal      = Vec3d::Zero();
+        double area             = 0.;
+        Vec3d  sqrt_area_normal = Vec3d::Zero();
+        double sqrt_area        = 0.;
+    };
+
+    struct MeanNormals {
+        Vec3f  area_normal;
+        double area;
+        Vec3f  sqrt_area_normal;
+        double sqrt_area;
+    };
+
+    static size_t bin_index(const Vec3f &n)
+    {
+        int axis = 0;
+        n.cwiseAbs().maxCoeff(&axis);
+        float d = std::abs(n(axis));
+        auto  coord = [d](float c) {
+            return std::clamp(int((c / d + 1.f) * 0.5f * Resolution), 0, Resolution - 1);
+        };
+        int face = 2 * axis + (n(axis) < 0.f ? 1 : 0);
+        return (size_t(face) * Resolution + coord(n((axis + 1) % 3))) * Resolution
+               + coord(n((axis + 2) % 3));
+    }
+
+    std::vector<MeanNormals> m_bins;
+    size_t                   m_facecount;
+};
+
 // Find transformed mesh ground level without copy and with parallel reduce.
 float find_ground_level(const TriangleMesh &mesh,
                          const Transform3f & tr,
@@ -163,10 +286,11 @@ double get_supportedness_onfloor_score(const TriangleMesh &mesh,
         std::array<Vec3f, 3> tri = get_transformed_triangle(mesh, tr, fi);
         Facestats fc{tri};
 
+        // Summed as fixed point numbers like the other scores, not truncated to integers.
         if (tri[0].z() <= zlvl && tri[1].z() <= zlvl && tri[2].z() <= zlvl)
-            return -2 * fc.area * POINTS_PER_UNIT_AREA;
+            return scaled<int_fast64_t>(-2 * fc.area * POINTS_PER_UNIT_AREA);
 
-        return get_supportedness_score(fc);
+        return scaled<int_fast64_t>(get_supportedness_score(fc));
     };
 
     size_t facecount = mesh.its.indices.size();
@@ -201,8 +325,12 @@ inline bool is_on_floor(const SLAPrintObjectConfig &cfg)
     return opt_elevation < EPSILON || opt_padaround;
 }
 
+// A rotation placing a face of the convex hull onto the floor and the area of
+// the convex hull faces lying in the same plane.
+struct RotArea { XYRotation rot; double area; };
+
 // collect the rotations for each face of the convex hull
-std::vector<XYRotation> get_chull_rotations(const TriangleMesh &mesh, size_t max_count)
+std::vector<RotArea> get_chull_rotations(const TriangleMesh &mesh, size_t max_count)
 {
     TriangleMesh chull = mesh.convex_hull_3d();
     double chull2d_area = chull.convex_hull().area();
@@ -210,8 +338,6 @@ std::vector<XYRotation> get_chull_rotations(const TriangleMesh &mesh, size_t max
 
     size_t facecount = chull.its.indices.size();
 
-    struct RotArea { XYRotation rot; double area; };
-
     auto inputs = reserve_vector<RotArea>(facecount);
 
     auto rotcmp = [](const RotArea &r1, const RotArea &r2) {
@@ -236,20 +362,21 @@ std::vector<XYRotation> get_chull_rotations(const TriangleMesh &mesh, size_t max
 
             if (it == inputs.end() || !eqcmp(it->rot, rot))
                 inputs.insert(it, ra);
+            else
+                it->area += fc.area;
         }
     }
 
-    inputs.shrink_to_fit();
     if (!max_count) max_count = inputs.size();
     std::sort(inputs.begin(), inputs.end(),
               [](const RotArea &ra, const RotArea &rb) {
                   return ra.area > rb.area;
               });
 
-    auto ret = reserve_vector<XYRotation>(std::min(max_count, inputs.size()));
-    for (const RotArea &ra : inputs) ret.emplace_back(ra.rot);
+    inputs.resize(std::min(max_count, inputs.size()));
+    inputs.shrink_to_fit();
 
-    return ret;
+    return inputs;
 }
 
 // Find the best score from a set of function inputs. Evaluate for every point.
@@ -280,6 +407,50 @@ std::array<double, N> find_min_score(Fn &&fn, It from, It to, StopCond &&stopfn)
     return ret;
 }
 
+// Keeps the candidates with the lowest approximate scores (e.g. from the
+// NormalHistogram), which are then scored exactly against the whole mesh.
+class BestCandidates {
+    struct Candidate { XYRotation rot; double score; };
+    std::vector<Candidate> m_candidates;
+    size_t m_count;
+
+public:
+    // Keeps all the candidates if count is zero.
+    explicit BestCandidates(size_t count)
+        : m_count{count == 0 ? std::numeric_limits<size_t>::max() : count}
+    {
+        if (count > 0)
+            m_candidates.reserve(count + 1);
+    }
+
+    void add(const XYRotation &rot, double score)
+    {
+        if (std::isnan(score)) return;
+
+        auto it = std::upper_bound(m_candidates.begin(), m_candidates.end(), score,
+                                   [](double s, const Candidate &c) { return s < c.score; });
+
+        if (size_t(it - m_candidates.begin()) < m_count) {
+            m_candidates.insert(it, {rot, score});
+            if (m_candidates.size() > m_count)
+                m_candidates.pop_back();
+        }
+    }
+
+    bool empty() const { return m_candidates.empty(); }
+
+    // Score the kept candidates exactly and return the one with the lowest score.
+    template<class Fn, class StopCond>
+    XYRotation find_min_exact(Fn &&fn, StopCond &&stopfn) const
+    {
+        auto rotations = reserve_vector<XYRotation>(m_candidates.size());
+        for (const Candidate &c : m_candidates)
+            rotations.emplace_back(c.rot);
+
+        return find_min_score<2>(fn, rotations.begin(), rotations.end(), stopfn);
+    }
+};
+
 } // namespace
 
 
@@ -354,14 +525,30 @@ Vec2d find_best_misalignment_rotation(const ModelObject &      mo,
     // We can specify the bounds for a dimension in the following way:
     auto bounds = opt::bounds({ {-PI, PI}, {-PI, PI} });
 
+    // The grid is scored against the normal histogram, only the best
+    // candidates are scored exactly against the mesh.
+    NormalHistogram histogram{bp.mesh};
+    BestCandidates  candidates{params.exact_candidates()};
+
     auto result = solver.to_max().optimize(
-        [&bp] (const XYRotation &rot)
+        [&bp, &histogram, &candidates] (const XYRotation &rot)
         {
             bp.statusfn();
-            return get_misalginment_score(bp.mesh, to_transform3f(rot));
+            double score = histogram.misalignment_score(to_transform3f(rot));
+            candidates.add(rot, -score);
+            return score;
         }, opt::initvals({0., 0.}), bounds);
 
-    return {result.optimum[0], result.optimum[1]};
+    if (candidates.empty())
+        return {result.optimum[0], result.optimum[1]};
+
+    XYRotation rot = candidates.find_min_exact(
+        [&bp](const XYRotation &rot) {
+            return -get_misalginment_score(bp.mesh, to_transform3f(rot));
+        },
+        [&bp] { return bp.stopcond(); });
+
+    return {rot[0], rot[1]};
 }
 
 Vec2d find_least_supports_rotation(const ModelObject &      mo,
@@ -380,21 +567,31 @@ Vec2d find_least_supports_rotation(const ModelObject &      mo,
     // Different search methods have to be used depending on the model elevation
     if (is_on_floor(pocfg)) {
 
-        std::vector<XYRotation> inputs = get_chull_rotations(bp.mesh, bp.max_tries);
+        std::vector<RotArea> inputs = get_chull_rotations(bp.mesh, bp.max_tries);
         bp.max_tries = inputs.size();
 
         // If the model can be placed on the bed directly, we only need to
         // check the 3D convex hull face rotations.
+        //
+        // The rotations are scored against the normal histogram first. The
+        // height dependent floor contact is estimated by the area of the
+        // convex hull faces in the plane put onto the floor, which bounds
+        // the area of the mesh faces touching the floor. These faces are not
+        // overhangs, thus the histogram bins facing down are not scored.
+        NormalHistogram histogram{bp.mesh};
+        BestCandidates  candidates{params.exact_candidates()};
+        for (const RotArea &ra : inputs) {
+            if (bp.stopcond()) break;
+            bp.statusfn();
+            candidates.add(ra.rot, histogram.supportedness_onfloor_score(to_transform3f(ra.rot), ra.area));
+        }
 
         auto objfn = [&bp](const XYRotation &rot) {
-            bp.statusfn();
             Transform3f tr = to_transform3f(rot);
             return get_supportedness_onfloor_score(bp.mesh, tr);
         };
 
-        rot = find_min_score<2>(objfn, inputs.begin(), inputs.end(), [&bp] {
-            return bp.stopcond();
-        });
+        rot = candidates.find_min_exact(objfn, [&bp] { return bp.stopcond(); });
 
     } else {
         // Preparing the optimizer.
@@ -410,15 +607,26 @@ Vec2d find_least_supports_rotation(const ModelObject &      mo,
         // We can specify the bounds for a dimension in the following way:
         auto bounds = opt::bounds({ {-PI, PI}, {-PI, PI} });
 
+        NormalHistogram histogram{bp.mesh};
+        BestCandidates  candidates{params.exact_candidates()};
+
         auto result = solver.to_min().optimize(
-            [&bp] (const XYRotation &rot)
+            [&bp, &histogram, &candidates] (const XYRotation &rot)
             {
                 bp.statusfn();
-                return get_supportedness_score(bp.mesh, to_transform3f(rot));
+                double score = histogram.supportedness_score(to_transform3f(rot));
+                candidates.add(rot, score);
+                return score;
             }, opt::initvals({0., 0.}), bounds);
 
-        // Save the result
-        rot = result.optimum;
+        // Save the result of the exact scoring of the best candidates
+        rot = candidates.empty() ?
+                  result.optimum :
+                  candidates.find_min_exact(
+                      [&bp](const XYRotation &rot) {
+                          return get_supportedness_score(bp.mesh, to_transform3f(rot));
+                      },
+                      [&bp] { return bp.stopcond(); });
     }
 
     return {rot[0], rot[1]};
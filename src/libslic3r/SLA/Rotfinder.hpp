@@ -19,12 +19,16 @@ using RotOptimizeStatusCB = std::function<bool(int)>;
 
 class RotOptimizeParams {
     float m_accuracy = 1.;
+    // Number of the best rotations found by an approximate score, which are
+    // scored exactly against the mesh. Zero to score all of them exactly.
+    size_t m_exact_candidates = 8;
     const DynamicPrintConfig *m_print_config = nullptr;
     RotOptimizeStatusCB m_statuscb = [](int) { return true; };
 
 public:
 
     RotOptimizeParams &accuracy(float a) { m_accuracy = a; return *this; }
+    RotOptimizeParams &exact_candidates(size_t n) { m_exact_candidates = n; return *this; }
     RotOptimizeParams &print_config(const DynamicPrintConfig *c)
     {
         m_print_config = c;
@@ -37,6 +41,7 @@ public:
     }
 
     float accuracy() const { return m_accuracy; }
+    size_t exact_candidates() const { return m_exact_candidates; }
     const DynamicPrintConfig * print_config() const { return m_print_config; }
     const RotOptimizeStatusCB &statuscb() const { return m_statuscb; }
 };
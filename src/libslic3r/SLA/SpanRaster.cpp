@@ -0,0 +1,116 @@
+#include <libslic3r/SLA/SpanRaster.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Slic3r { namespace sla {
+
+// Receives the scanlines from the AGG rasterizer in place of a scanline renderer,
+// stores their spans instead of blending them into a frame buffer.
+struct RasterGrayscaleAASpans::SpanCollector
+{
+    RasterGrayscaleAASpans &raster;
+
+    void prepare() {}
+
+    template<class Scanline> void render(const Scanline &sl)
+    {
+        int y = sl.y();
+        // Rows outside of the raster would be clipped by agg::renderer_base.
+        if (y < 0 || y >= int(raster.m_resolution.height_px))
+            return;
+        unsigned num_spans = sl.num_spans();
+        typename Scanline::const_iterator span = sl.begin();
+        for (;;) {
+            raster.m_spans.push_back({ span->x, span->len, uint32_t(y), uint32_t(raster.m_covers.size()) });
+            raster.m_covers.insert(raster.m_covers.end(), span->covers, span->covers + (span->len > 0 ? span->len : 1));
+            if (--num_spans == 0)
+                break;
+            ++span;
+        }
+    }
+};
+
+// Composes the rows of the raster from the stored spans, blending them with the same AGG pixel format
+// and in the same order as agg::render_scanline_aa_solid() blends them into a frame buffer.
+class RasterGrayscaleAASpans::RowComposer
+{
+public:
+    using PixelFormat = agg::pixfmt_gray8;
+    using Color       = PixelFormat::color_type;
+
+    explicit RowComposer(const RasterGrayscaleAASpans &raster)
+        : m_raster(raster)
+        , m_row(raster.m_resolution.width_px, 0)
+        , m_rbuf(m_row.data(), unsigned(raster.m_resolution.width_px), 1, int(raster.m_resolution.width_px))
+        , m_pixfmt(m_rbuf)
+        , m_renderer(m_pixfmt)
+    {
+        // Stable counting sort of the spans by rows, keeping the order of the spans
+        // produced by the consecutive draw() calls.
+        const size_t num_rows = raster.m_resolution.height_px;
+        m_row_begin.assign(num_rows + 1, 0);
+        for (const Span &span : raster.m_spans)
+            ++ m_row_begin[span.y + 1];
+        for (size_t i = 1; i <= num_rows; ++ i)
+            m_row_begin[i] += m_row_begin[i - 1];
+        m_sorted.resize(raster.m_spans.size());
+        std::vector<uint32_t> next(m_row_begin.begin(), m_row_begin.end() - 1);
+        for (uint32_t i = 0; i < uint32_t(raster.m_spans.size()); ++ i)
+            m_sorted[next[raster.m_spans[i].y] ++] = i;
+    }
+
+    const uint8_t* row(size_t y)
+    {
+        std::fill(m_row.begin(), m_row.end(), uint8_t(0));
+        const Color &white = Colors<Color>::White;
+        for (uint32_t i = m_row_begin[y]; i < m_row_begin[y + 1]; ++ i) {
+            const Span    &span   = m_raster.m_spans[m_sorted[i]];
+            const uint8_t *covers = m_raster.m_covers.data() + span.covers;
+            if (span.len > 0)
+                m_renderer.blend_solid_hspan(span.x, 0, span.len, white, covers);
+            else
+                m_renderer.blend_hline(span.x, 0, span.x - span.len - 1, white, *covers);
+        }
+        return m_row.data();
+    }
+
+private:
+    const RasterGrayscaleAASpans       &m_raster;
+    std::vector<uint32_t>               m_row_begin;
+    std::vector<uint32_t>               m_sorted;
+    std::vector<uint8_t>                m_row;
+    agg::rendering_buffer               m_rbuf;
+    PixelFormat                         m_pixfmt;
+    agg::renderer_base<PixelFormat>     m_renderer;
+};
+
+void RasterGrayscaleAASpans::draw(const ExPolygon &poly)
+{
+    m_rasterizer.reset();
+
+    m_rasterizer.add_path(to_agg_path(poly.contour.points, m_resolution, m_pxdim_scaled, m_trafo));
+    for (const Polygon &h : poly.holes)
+        m_rasterizer.add_path(to_agg_path(h.points, m_resolution, m_pxdim_scaled, m_trafo));
+
+    SpanCollector collector { *this };
+    agg::render_scanlines(m_rasterizer, m_scanline, collector);
+}
+
+EncodedRaster RasterGrayscaleAASpans::encode(RasterEncoder encoder) const
+{
+    const size_t         w = m_resolution.width_px;
+    std::vector<uint8_t> frame(m_resolution.pixels());
+    RowComposer          composer(*this);
+    for (size_t y = 0; y < m_resolution.height_px; ++ y)
+        memcpy(frame.data() + y * w, composer.row(y), w);
+    return encoder(frame.data(), w, m_resolution.height_px, 1);
+}
+
+EncodedRaster RasterGrayscaleAASpans::encode_rows(RasterRowEncoder encoder) const
+{
+    RowComposer composer(*this);
+    return encoder([&composer](size_t row) { return composer.row(row); }, m_resolution.width_px, m_resolution.height_px, 1);
+}
+
+}} // namespace Slic3r::sla
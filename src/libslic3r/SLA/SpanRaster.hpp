@@ -0,0 +1,80 @@
+#ifndef SLA_SPANRASTER_HPP
+#define SLA_SPANRASTER_HPP
+
+#include <libslic3r/SLA/RasterBase.hpp>
+#include <libslic3r/SLA/AGGRaster.hpp>
+
+namespace Slic3r { namespace sla {
+
+/*
+ * Anti-aliased monochrome raster, white polygons on black background, which does not
+ * keep a frame buffer. The polygons are rasterized by the same AGG rasterizer as
+ * RasterGrayscaleAA, but only the coverage spans produced by the rasterizer are stored.
+ * The rows are composed one by one from the spans when the raster is being encoded.
+ * As the spans are blended by the same AGG pixel format in the same order
+ * as into the frame buffer of RasterGrayscaleAA, the pixels are identical.
+ *
+ * Memory and bandwidth are proportional to the length of the polygon edges and to
+ * the number of rows, not to the number of pixels.
+ */
+class RasterGrayscaleAASpans : public RasterBase {
+public:
+    template<class GammaFn>
+    RasterGrayscaleAASpans(const Resolution &res,
+                           const PixelDim   &pd,
+                           const Trafo      &trafo,
+                           GammaFn         &&gammafn)
+        : m_resolution(res)
+        , m_pxdim_scaled(SCALING_FACTOR, SCALING_FACTOR)
+        , m_trafo(trafo)
+    {
+        assert(pd.w_mm != 0 && pd.h_mm != 0);
+        if (pd.w_mm != 0 && pd.h_mm != 0) {
+            m_pxdim_scaled.w_mm /= pd.w_mm;
+            m_pxdim_scaled.h_mm /= pd.h_mm;
+        }
+        m_rasterizer.gamma(gammafn);
+    }
+
+    void draw(const ExPolygon &poly) override;
+
+    Trafo      trafo() const override { return m_trafo; }
+    Resolution resolution() const { return m_resolution; }
+
+    // Materializes the whole frame for encoders consuming a frame.
+    EncodedRaster encode(RasterEncoder encoder) const override;
+    // Composes the rows from the spans one by one.
+    EncodedRaster encode_rows(RasterRowEncoder encoder) const override;
+
+    size_t num_spans() const { return m_spans.size(); }
+    void   clear() { m_spans.clear(); m_covers.clear(); }
+
+private:
+    struct Span {
+        // First pixel of the span.
+        int32_t  x;
+        // Number of pixels with their own coverage values if positive,
+        // number of pixels sharing a single coverage value if negative (AGG convention).
+        int32_t  len;
+        uint32_t y;
+        // Index of the first coverage value in m_covers.
+        uint32_t covers;
+    };
+    struct SpanCollector;
+    class  RowComposer;
+
+    Resolution              m_resolution;
+    PixelDim                m_pxdim_scaled;    // used for scaled coordinate polygons
+    Trafo                   m_trafo;
+
+    // Spans in the order they were produced by the rasterizer.
+    std::vector<Span>       m_spans;
+    std::vector<uint8_t>    m_covers;
+
+    agg::rasterizer_scanline_aa<> m_rasterizer;
+    agg::scanline_p8              m_scanline;
+};
+
+}} // namespace Slic3r::sla
+
+#endif // SLA_SPANRASTER_HPP
@@ -15,6 +15,8 @@
 #include <iostream>
 #include <random>
 
+#include <boost/log/trivial.hpp>
+
 namespace Slic3r {
 namespace sla {
 
@@ -59,7 +61,7 @@ SupportPointGenerator::SupportPointGenerator(
     : SupportPointGenerator(emesh, config, throw_on_cancel, statusfn)
 {
     std::random_device rd;
-    m_rng.seed(rd());
+    seed(rd());
     execute(slices, heights);
 }
 
@@ -78,8 +80,8 @@ SupportPointGenerator::SupportPointGenerator(
 void SupportPointGenerator::execute(const std::vector<ExPolygons> &slices,
                                     const std::vector<float> &     heights)
 {
-    process(slices, heights);
-    project_onto_mesh(m_output);
+    State state;
+    execute(slices, heights, state);
 }
 
 void SupportPointGenerator::project_onto_mesh(std::vector<sla::SupportPoint>& points) const
@@ -111,6 +113,103 @@ void SupportPointGenerator::project_onto_mesh(std::vector<sla::SupportPoint>& po
     }, gransize);
 }
 
+// Minimal area of an island to be supported.
+//FIXME: calculate actual pixel area from printer config:
+//const float pixel_area = pow(wxGetApp().preset_bundle->project_config.option<ConfigOptionFloat>("display_width") / wxGetApp().preset_bundle->project_config.option<ConfigOptionInt>("display_pixels_x"), 2.f); //
+static const float PIXEL_AREA = pow(0.047f, 2.f);
+
+static void make_islands(SupportPointGenerator::MyLayer &layer,
+                         const ExPolygons &              islands,
+                         const std::vector<float> &      heights)
+{
+    const size_t layer_id = layer.layer_id;
+    // FIXME WTF?
+    const float height = (layer_id > 2 ?
+                              heights[layer_id - 3] :
+                              heights[0] - (heights[1] - heights[0]));
+    layer.islands.clear();
+    layer.islands.reserve(islands.size());
+    for (const ExPolygon &island : islands) {
+        float area = float(island.area() * SCALING_FACTOR * SCALING_FACTOR);
+        if (area >= PIXEL_AREA)
+            // FIXME this is not a correct centroid of a polygon with holes.
+            layer.islands.emplace_back(layer, island, get_extents(island.contour),
+                                       unscaled<float>(island.contour.centroid()), area, height);
+    }
+}
+
+// Link the overlapping islands of two successive layers, calculate the overhangs
+// of the upper layer. Links and overhangs of a previous linking are replaced.
+static void link_layers(SupportPointGenerator::MyLayer &layer_above,
+                        SupportPointGenerator::MyLayer &layer_below,
+                        const std::vector<float> &      heights)
+{
+    const size_t layer_id = layer_above.layer_id;
+    //FIXME WTF?
+    const float layer_height = (layer_id!=0 ? heights[layer_id]-heights[layer_id-1] : heights[0]);
+    const float safe_angle = 35.f * (float(M_PI)/180.f); // smaller number - less supports
+    const float between_layers_offset = scaled<float>(layer_height * std::tan(safe_angle));
+    const float slope_angle = 75.f * (float(M_PI)/180.f); // smaller number - less supports
+    const float slope_offset = scaled<float>(layer_height * std::tan(slope_angle));
+    for (SupportPointGenerator::Structure &bottom : layer_below.islands)
+        bottom.islands_above.clear();
+    //FIXME This has a quadratic time complexity, it will be excessively slow for many tiny islands.
+    for (SupportPointGenerator::Structure &top : layer_above.islands) {
+        top.islands_below.clear();
+        top.dangling_areas.clear();
+        top.overhangs.clear();
+        top.overhangs_slopes.clear();
+        top.overhangs_area = 0.f;
+        for (SupportPointGenerator::Structure &bottom : layer_below.islands) {
+            float overlap_area = top.overlap_area(bottom);
+            if (overlap_area > 0) {
+                top.islands_below.emplace_back(&bottom, overlap_area);
+                bottom.islands_above.emplace_back(&top, overlap_area);
+            }
+        }
+        if (! top.islands_below.empty()) {
+            Polygons bottom_polygons = top.polygons_below();
+            top.overhangs = diff_ex(*top.polygon, bottom_polygons);
+            if (! top.overhangs.empty()) {
+
+                // Produce 2 bands around the island, a safe band for dangling overhangs
+                // and an unsafe band for sloped overhangs.
+                // These masks include the original island
+                auto dangl_mask = expand(bottom_polygons, between_layers_offset, ClipperLib::jtSquare);
+                auto overh_mask = expand(bottom_polygons, slope_offset, ClipperLib::jtSquare);
+
+                // Absolutely hopeless overhangs are those outside the unsafe band
+                top.overhangs = diff_ex(*top.polygon, overh_mask);
+
+                // Now cut out the supported core from the safe band
+                // and cut the safe band from the unsafe band to get distinct
+                // zones.
+                overh_mask = diff(overh_mask, dangl_mask);
+                dangl_mask = diff(dangl_mask, bottom_polygons);
+
+                top.dangling_areas = intersection_ex(*top.polygon, dangl_mask);
+                top.overhangs_slopes = intersection_ex(*top.polygon, overh_mask);
+
+                top.overhangs_area = 0.f;
+                std::vector<std::pair<ExPolygon*, float>> expolys_with_areas;
+                for (ExPolygon &ex : top.overhangs) {
+                    float area = float(ex.area());
+                    expolys_with_areas.emplace_back(&ex, area);
+                    top.overhangs_area += area;
+                }
+                std::sort(expolys_with_areas.begin(), expolys_with_areas.end(),
+                          [](const std::pair<ExPolygon*, float> &p1, const std::pair<ExPolygon*, float> &p2)
+                          { return p1.second > p2.second; });
+                ExPolygons overhangs_sorted;
+                for (auto &p : expolys_with_areas)
+                    overhangs_sorted.emplace_back(std::move(*p.first));
+                top.overhangs = std::move(overhangs_sorted);
+                top.overhangs_area *= float(SCALING_FACTOR * SCALING_FACTOR);
+            }
+        }
+    }
+}
+
 static std::vector<SupportPointGenerator::MyLayer> make_layers(
     const std::vector<ExPolygons>& slices, const std::vector<float>& heights,
     std::function<void(void)> throw_on_cancel)
@@ -123,32 +222,15 @@ static std::vector<SupportPointGenerator::MyLayer> make_layers(
     for (size_t i = 0; i < slices.size(); ++ i)
         layers.emplace_back(i, heights[i]);
 
-    // FIXME: calculate actual pixel area from printer config:
-    //const float pixel_area = pow(wxGetApp().preset_bundle->project_config.option<ConfigOptionFloat>("display_width") / wxGetApp().preset_bundle->project_config.option<ConfigOptionInt>("display_pixels_x"), 2.f); //
-    const float pixel_area = pow(0.047f, 2.f);
-
     execution::for_each(ex_tbb, size_t(0), layers.size(),
-        [&layers, &slices, &heights, pixel_area, throw_on_cancel](size_t layer_id)
+        [&layers, &slices, &heights, throw_on_cancel](size_t layer_id)
     {
         if ((layer_id % 8) == 0)
             // Don't call the following function too often as it flushes
             // CPU write caches due to synchronization primitves.
             throw_on_cancel();
 
-        SupportPointGenerator::MyLayer &layer   = layers[layer_id];
-        const ExPolygons &              islands = slices[layer_id];
-        // FIXME WTF?
-        const float height = (layer_id > 2 ?
-                                  heights[layer_id - 3] :
-                                  heights[0] - (heights[1] - heights[0]));
-        layer.islands.reserve(islands.size());
-        for (const ExPolygon &island : islands) {
-            float area = float(island.area() * SCALING_FACTOR * SCALING_FACTOR);
-            if (area >= pixel_area)
-                // FIXME this is not a correct centroid of a polygon with holes.
-                layer.islands.emplace_back(layer, island, get_extents(island.contour),
-                                           unscaled<float>(island.contour.centroid()), area, height);
-        }
+        make_islands(layers[layer_id], slices[layer_id], heights);
     }, 32 /*gransize*/);
 
     // Calculate overlap of successive layers. Link overlapping islands.
@@ -158,86 +240,157 @@ static std::vector<SupportPointGenerator::MyLayer> make_layers(
       if ((layer_id % 2) == 0)
           // Don't call the following function too often as it flushes CPU write caches due to synchronization primitves.
           throw_on_cancel();
-      SupportPointGenerator::MyLayer &layer_above = layers[layer_id];
-      SupportPointGenerator::MyLayer &layer_below = layers[layer_id - 1];
-      //FIXME WTF?
-      const float layer_height = (layer_id!=0 ? heights[layer_id]-heights[layer_id-1] : heights[0]);
-      const float safe_angle = 35.f * (float(M_PI)/180.f); // smaller number - less supports
-      const float between_layers_offset = scaled<float>(layer_height * std::tan(safe_angle));
-      const float slope_angle = 75.f * (float(M_PI)/180.f); // smaller number - less supports
-      const float slope_offset = scaled<float>(layer_height * std::tan(slope_angle));
-      //FIXME This has a quadratic time complexity, it will be excessively slow for many tiny islands.
-      for (SupportPointGenerator::Structure &top : layer_above.islands) {
-          for (SupportPointGenerator::Structure &bottom : layer_below.islands) {
-              float overlap_area = top.overlap_area(bottom);
-              if (overlap_area > 0) {
-                  top.islands_below.emplace_back(&bottom, overlap_area);
-                  bottom.islands_above.emplace_back(&top, overlap_area);
-              }
-          }
-          if (! top.islands_below.empty()) {
-              Polygons bottom_polygons = top.polygons_below();
-              top.overhangs = diff_ex(*top.polygon, bottom_polygons);
-              if (! top.overhangs.empty()) {
-
-                  // Produce 2 bands around the island, a safe band for dangling overhangs
-                  // and an unsafe band for sloped overhangs.
-                  // These masks include the original island
-                  auto dangl_mask = expand(bottom_polygons, between_layers_offset, ClipperLib::jtSquare);
-                  auto overh_mask = expand(bottom_polygons, slope_offset, ClipperLib::jtSquare);
-
-                  // Absolutely hopeless overhangs are those outside the unsafe band
-                  top.overhangs = diff_ex(*top.polygon, overh_mask);
-
-                  // Now cut out the supported core from the safe band
-                  // and cut the safe band from the unsafe band to get distinct
-                  // zones.
-                  overh_mask = diff(overh_mask, dangl_mask);
-                  dangl_mask = diff(dangl_mask, bottom_polygons);
-
-                  top.dangling_areas = intersection_ex(*top.polygon, dangl_mask);
-                  top.overhangs_slopes = intersection_ex(*top.polygon, overh_mask);
-
-                  top.overhangs_area = 0.f;
-                  std::vector<std::pair<ExPolygon*, float>> expolys_with_areas;
-                  for (ExPolygon &ex : top.overhangs) {
-                      float area = float(ex.area());
-                      expolys_with_areas.emplace_back(&ex, area);
-                      top.overhangs_area += area;
-                  }
-                  std::sort(expolys_with_areas.begin(), expolys_with_areas.end(),
-                            [](const std::pair<ExPolygon*, float> &p1, const std::pair<ExPolygon*, float> &p2)
-                            { return p1.second > p2.second; });
-                  ExPolygons overhangs_sorted;
-                  for (auto &p : expolys_with_areas)
-                      overhangs_sorted.emplace_back(std::move(*p.first));
-                  top.overhangs = std::move(overhangs_sorted);
-                  top.overhangs_area *= float(SCALING_FACTOR * SCALING_FACTOR);
-              }
-          }
-      }
+      link_layers(layers[layer_id], layers[layer_id - 1], heights);
     }, 8 /* gransize */);
 
     return layers;
 }
 
-void SupportPointGenerator::process(const std::vector<ExPolygons>& slices, const std::vector<float>& heights)
+// Replace the islands of the changed layers with the islands of the new slices
+// and link them again with the layers below and above. The other layers keep
+// their islands, overhangs and support forces.
+static void update_layers(SupportPointGenerator::State &  state,
+                          const std::vector<ExPolygons> & slices,
+                          const std::vector<size_t> &     changed,
+                          std::function<void(void)>       throw_on_cancel)
+{
+    std::vector<SupportPointGenerator::MyLayer> &layers = state.layers;
+
+    execution::for_each(ex_tbb, size_t(0), changed.size(),
+        [&state, &layers, &slices, &changed, throw_on_cancel](size_t i)
+    {
+        throw_on_cancel();
+        size_t layer_id = changed[i];
+        state.slices[layer_id] = slices[layer_id];
+        make_islands(layers[layer_id], state.slices[layer_id], state.heights);
+    });
+
+    std::vector<size_t> layers_above;
+    layers_above.reserve(2 * changed.size());
+    for (size_t layer_id : changed) {
+        if (layer_id > 0)
+            layers_above.emplace_back(layer_id);
+        if (layer_id + 1 < layers.size())
+            layers_above.emplace_back(layer_id + 1);
+    }
+    sort_remove_duplicates(layers_above);
+
+    execution::for_each(ex_tbb, size_t(0), layers_above.size(),
+        [&state, &layers, &layers_above, throw_on_cancel](size_t i)
+    {
+        throw_on_cancel();
+        size_t layer_id = layers_above[i];
+        link_layers(layers[layer_id], layers[layer_id - 1], state.heights);
+    });
+}
+
+void SupportPointGenerator::execute(const std::vector<ExPolygons> &slices,
+                                    const std::vector<float> &     heights,
+                                    State &                        state)
+{
+    assert(slices.size() == heights.size());
+
+    size_t first_layer = 0, last_changed_layer = 0;
+    if (state.layers.empty() || state.heights != heights || ! (state.config == m_config)) {
+        state.config  = m_config;
+        state.seed    = m_seed;
+        state.heights = heights;
+        state.slices  = slices;
+        state.layers  = make_layers(state.slices, heights, m_throw_on_cancel);
+        state.points.assign(state.layers.size(), {});
+        last_changed_layer = state.layers.size();
+    } else {
+        std::vector<size_t> changed;
+        for (size_t layer_id = 0; layer_id < slices.size(); ++ layer_id)
+            if (state.slices[layer_id] != slices[layer_id])
+                changed.emplace_back(layer_id);
+
+        BOOST_LOG_TRIVIAL(debug) << "Support points: " << changed.size()
+                                 << " of " << slices.size() << " layers changed";
+
+        if (changed.empty()) {
+            first_layer = state.layers.size();
+        } else {
+            update_layers(state, slices, changed, m_throw_on_cancel);
+            first_layer = changed.front();
+            // The overhangs of the layer above the last changed one were updated as well.
+            last_changed_layer = changed.back() + 1;
+        }
+    }
+
+    process(state, first_layer, last_changed_layer);
+
+    // The mesh may have changed in the layers which were not processed again,
+    // all the points are projected.
+    std::vector<SupportPoint> points;
+    for (const std::vector<LayerPoint> &layer_points : state.points)
+        for (const LayerPoint &lp : layer_points)
+            points.emplace_back(lp.point);
+
+    project_onto_mesh(points);
+    append(m_output, std::move(points));
+}
+
+float SupportPointGenerator::max_point_spacing() const
+{
+    const float density_horizontal = m_config.tear_pressure() / m_config.support_force();
+    return std::max(m_config.minimal_distance, 1.f / (5.f * density_horizontal));
+}
+
+void SupportPointGenerator::process(State &state, size_t first_layer, size_t last_changed_layer)
 {
 #ifdef SLA_SUPPORTPOINTGEN_DEBUG
     std::vector<std::pair<ExPolygon, coord_t>> islands;
 #endif /* SLA_SUPPORTPOINTGEN_DEBUG */
 
-    std::vector<SupportPointGenerator::MyLayer> layers = make_layers(slices, heights, m_throw_on_cancel);
+    std::vector<SupportPointGenerator::MyLayer> &layers = state.layers;
+    if (first_layer >= layers.size())
+        return;
 
     PointGrid3D point_grid;
     point_grid.cell_size = Vec3f(10.f, 10.f, 10.f);
 
+    // The points of the layers below the first processed one are kept.
+    // Only those close enough may collide with the new points.
+    const float spacing = max_point_spacing();
+    for (size_t layer_id = 0; layer_id < first_layer; ++ layer_id)
+        if (layers[layer_id].print_z + spacing > layers[first_layer].print_z)
+            for (const LayerPoint &lp : state.points[layer_id])
+                point_grid.insert(Vec2f(lp.point.pos.x(), lp.point.pos.y()),
+                                  &layers[layer_id].islands[lp.island_idx]);
+
+    // Height of the topmost layer, where the points differ from the previous run.
+    double z_last_difference = layers[first_layer].print_z;
+    // Whether the support forces of the last processed layer are the same
+    // as in the previous run.
+    bool   forces_unchanged  = false;
+
     double increment = 100.0 / layers.size();
-    double status    = 0;
+    double status    = increment * first_layer;
 
-    for (unsigned int layer_id = 0; layer_id < layers.size(); ++ layer_id) {
+    std::vector<std::pair<float, float>> forces_previous;
+    std::vector<LayerPoint>              points_previous;
+
+    for (size_t layer_id = first_layer; layer_id < layers.size(); ++ layer_id) {
         SupportPointGenerator::MyLayer *layer_top     = &layers[layer_id];
         SupportPointGenerator::MyLayer *layer_bottom  = (layer_id > 0) ? &layers[layer_id - 1] : nullptr;
+
+        // Above the changed layers, the rest of the layers are processed the same
+        // way as in the previous run once the support forces of the layer below
+        // are the same and the changed points are too low to collide with new points.
+        if (layer_id > last_changed_layer && forces_unchanged &&
+            layer_top->print_z - z_last_difference >= spacing)
+            break;
+
+        forces_previous.clear();
+        for (Structure &s : layer_top->islands) {
+            forces_previous.emplace_back(s.supports_force_this_layer, s.supports_force_inherited);
+            s.supports_force_this_layer = 0.f;
+            s.supports_force_inherited  = 0.f;
+        }
+        points_previous = std::move(state.points[layer_id]);
+        state.points[layer_id].clear();
+
         std::vector<float>        support_force_bottom;
         if (layer_bottom != nullptr) {
             support_force_bottom.assign(layer_bottom->islands.size(), 0.f);
@@ -268,13 +421,36 @@ void SupportPointGenerator::process(const std::vector<ExPolygons>& slices, const
                     above_link.island->supports_force_inherited += below_support_force * above_link.overlap_area / above_overlap_area;
             }
         }
+        // The points of each layer are generated from their own random
+        // sequence, so that a layer is processed the same way regardless
+        // of the layers processed before.
+        m_rng.seed(state.seed + std::mt19937::result_type(layer_id));
+
         // Now iterate over all polygons and append new points if needed.
+        // The points are moved from the output to the points of the layer.
+        const size_t layer_first_point = m_output.size();
         for (Structure &s : layer_top->islands) {
             // Penalization resulting from large diff from the last layer:
             s.supports_force_inherited /= std::max(1.f, 0.17f * (s.overhangs_area) / s.area);
 
+            size_t first_point = m_output.size();
             add_support_points(s, point_grid);
+            for (size_t i = first_point; i < m_output.size(); ++ i)
+                state.points[layer_id].push_back({size_t(&s - layer_top->islands.data()), m_output[i]});
         }
+        m_output.erase(m_output.begin() + layer_first_point, m_output.end());
+
+        forces_unchanged = forces_previous.size() == layer_top->islands.size() &&
+            std::equal(forces_previous.begin(), forces_previous.end(), layer_top->islands.begin(),
+                       [](const std::pair<float, float> &f, const Structure &s) {
+                           return f.first == s.supports_force_this_layer && f.second == s.supports_force_inherited;
+                       });
+        if (! std::equal(points_previous.begin(), points_previous.end(),
+                         state.points[layer_id].begin(), state.points[layer_id].end(),
+                         [](const LayerPoint &lhs, const LayerPoint &rhs) {
+                             return lhs.island_idx == rhs.island_idx && lhs.point == rhs.point;
+                         }))
+            z_last_difference = layer_top->print_z;
 
         m_throw_on_cancel();
 
@@ -563,9 +739,8 @@ void SupportPointGenerator::uniformly_cover(const ExPolygons& islands, Structure
     // Number of newly added points.
     const size_t poisson_samples_target = size_t(ceil(support_force_deficit / m_config.support_force()));
 
-    const float density_horizontal = m_config.tear_pressure() / m_config.support_force();
     //FIXME why?
-    float poisson_radius		= std::max(m_config.minimal_distance, 1.f / (5.f * density_horizontal));
+    float poisson_radius		= max_point_spacing();
 //    const float poisson_radius     = 1.f / (15.f * density_horizontal);
     const float samples_per_mm2 = 30.f / (float(M_PI) * poisson_radius * poisson_radius);
     // Minimum distance between samples, in 3D space.
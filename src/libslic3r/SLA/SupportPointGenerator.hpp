@@ -26,6 +26,13 @@ public:
         // Originally calibrated to 7.7f, reduced density by Tamas to 70% which is 11.1 (7.7 / 0.7) to adjust for new algorithm changes in tm_suppt_gen_improve
         inline float support_force() const { return 11.1f / density_relative; } // a force one point can support       (arbitrary force unit)
         inline float tear_pressure() const { return 1.f; }  // pressure that the display exerts    (the force unit per mm2)
+
+        bool operator==(const Config &rhs) const
+        {
+            return density_relative == rhs.density_relative &&
+                   minimal_distance == rhs.minimal_distance &&
+                   head_diameter == rhs.head_diameter;
+        }
     };
     
     SupportPointGenerator(const AABBMesh& emesh, const std::vector<ExPolygons>& slices,
@@ -189,16 +196,48 @@ public:
         }
     };
     
+    // A support point generated for an island of a layer, before it is
+    // projected onto the mesh.
+    struct LayerPoint {
+        size_t       island_idx;
+        SupportPoint point;
+    };
+
+    // Slices, layers with their islands and the support points of each layer
+    // kept from the last execution. If executed with the same state again,
+    // only the layers with changed slices and the layers above them are
+    // processed, until the support forces and the points are the same as
+    // in the previous run.
+    struct State {
+        Config                                config;
+        std::mt19937::result_type             seed = 0;
+        std::vector<float>                    heights;
+        std::vector<ExPolygons>               slices;
+        std::vector<MyLayer>                  layers;
+        std::vector<std::vector<LayerPoint>>  points;
+    };
+
     void execute(const std::vector<ExPolygons> &slices,
                  const std::vector<float> &     heights);
+
+    void execute(const std::vector<ExPolygons> &slices,
+                 const std::vector<float> &     heights,
+                 State &                        state);
     
-    void seed(std::mt19937::result_type s) { m_rng.seed(s); }
+    // The random generator is seeded for each layer from this seed.
+    void seed(std::mt19937::result_type s) { m_seed = s; }
 private:
     std::vector<SupportPoint> m_output;
     
     SupportPointGenerator::Config m_config;
     
-    void process(const std::vector<ExPolygons>& slices, const std::vector<float>& heights);
+    // Process the layers starting with first_layer. The layers above
+    // last_changed_layer are only processed until the result settles.
+    void process(State &state, size_t first_layer, size_t last_changed_layer);
+
+    // Upper bound of the distance within which an existing support point
+    // prevents generating a new one.
+    float max_point_spacing() const;
 
 public:
     enum IslandCoverageFlags : uint8_t { icfNone = 0x0, icfIsNew = 0x1, icfWithBoundary = 0x2 };
@@ -221,6 +260,7 @@ private:
     std::function<void(int)>  m_statusfn;
     
     std::mt19937 m_rng;
+    std::mt19937::result_type m_seed = std::mt19937::default_seed;
 };
 
 void remove_bottom_points(std::vector<SupportPoint> &pts, float lvl);
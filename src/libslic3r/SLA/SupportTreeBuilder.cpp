@@ -30,7 +30,7 @@ SupportTreeBuilder::SupportTreeBuilder(SupportTreeBuilder &&o)
     , m_bridges{std::move(o.m_bridges)}
     , m_crossbridges{std::move(o.m_crossbridges)}
     , m_meshcache{std::move(o.m_meshcache)}
-    , m_meshcache_valid{o.m_meshcache_valid}
+    , m_meshcache_valid{o.m_meshcache_valid.load()}
     , m_model_height{o.m_model_height}
 {}
 
@@ -41,7 +41,7 @@ SupportTreeBuilder::SupportTreeBuilder(const SupportTreeBuilder &o)
     , m_bridges{o.m_bridges}
     , m_crossbridges{o.m_crossbridges}
     , m_meshcache{o.m_meshcache}
-    , m_meshcache_valid{o.m_meshcache_valid}
+    , m_meshcache_valid{o.m_meshcache_valid.load()}
     , m_model_height{o.m_model_height}
 {}
 
@@ -53,7 +53,7 @@ SupportTreeBuilder &SupportTreeBuilder::operator=(SupportTreeBuilder &&o)
     m_bridges = std::move(o.m_bridges);
     m_crossbridges = std::move(o.m_crossbridges);
     m_meshcache = std::move(o.m_meshcache);
-    m_meshcache_valid = o.m_meshcache_valid;
+    m_meshcache_valid = o.m_meshcache_valid.load();
     m_model_height = o.m_model_height;
     return *this;
 }
@@ -66,21 +66,17 @@ SupportTreeBuilder &SupportTreeBuilder::operator=(const SupportTreeBuilder &o)
     m_bridges = o.m_bridges;
     m_crossbridges = o.m_crossbridges;
     m_meshcache = o.m_meshcache;
-    m_meshcache_valid = o.m_meshcache_valid;
+    m_meshcache_valid = o.m_meshcache_valid.load();
     m_model_height = o.m_model_height;
     return *this;
 }
 
 void SupportTreeBuilder::add_pillar_base(long pid, double baseheight, double radius)
 {
-    std::lock_guard<Mutex> lk(m_mutex);
     assert(pid >= 0 && size_t(pid) < m_pillars.size());
     Pillar& pll = m_pillars[size_t(pid)];
-    m_pedestals.emplace_back(pll.endpt, std::min(baseheight, pll.height),
-                             std::max(radius, pll.r_start), pll.r_start);
-
-    m_pedestals.back().id = m_pedestals.size() - 1;
-    m_meshcache_valid = false;
+    _add_part(m_pedestals, pll.endpt, std::min(baseheight, pll.height),
+              std::max(radius, pll.r_start), pll.r_start);
 }
 
 const indexed_triangle_set &SupportTreeBuilder::merged_mesh(size_t steps) const
@@ -148,6 +144,15 @@ const indexed_triangle_set &SupportTreeBuilder::merged_mesh(size_t steps) const
     return m_meshcache;
 }
 
+using Slic3r::clear_and_shrink;
+
+template<class T>
+static void clear_and_shrink(tbb::concurrent_vector<T> &parts)
+{
+    tbb::concurrent_vector<T> tmp;
+    parts.swap(tmp);
+}
+
 const indexed_triangle_set &SupportTreeBuilder::merge_and_cleanup()
 {
     // in case the mesh is not generated, it should be...
@@ -7,6 +7,10 @@
 #include <libslic3r/SLA/Pad.hpp>
 #include <libslic3r/MTUtils.hpp>
 
+#include <atomic>
+
+#include <tbb/concurrent_vector.h>
+
 namespace Slic3r {
 namespace sla {
 
@@ -128,6 +132,36 @@ struct Head: public SupportTreeNode {
 // A straight pillar. Only has an endpoint and a height. No explicit starting
 // point is given, as it would allow the pillar to be angled.
 // Some connection info with other primitives can also be tracked.
+// A counter which may be incremented concurrently, while the part holding it
+// stays copyable.
+class AtomicCounter {
+    std::atomic<unsigned> m_value{0};
+
+public:
+    AtomicCounter() = default;
+    AtomicCounter(const AtomicCounter &o) : m_value{o.m_value.load()} {}
+    AtomicCounter &operator=(const AtomicCounter &o)
+    {
+        m_value = o.m_value.load();
+        return *this;
+    }
+
+    operator unsigned() const { return m_value.load(); }
+
+    AtomicCounter &operator++() { ++m_value; return *this; }
+
+    // Increment only if the value is lower than max_value.
+    bool increment_if_less(unsigned max_value)
+    {
+        unsigned v = m_value.load();
+        while (v < max_value)
+            if (m_value.compare_exchange_weak(v, v + 1))
+                return true;
+
+        return false;
+    }
+};
+
 struct Pillar: public SupportTreeNode {
     double height, r_start, r_end;
     Vec3d endpt;
@@ -136,8 +170,9 @@ struct Pillar: public SupportTreeNode {
     bool starts_from_head = true; // Could start from a junction as well
     long start_junction_id = ID_UNSET;
     
-    // How many bridges are connected to this pillar
-    unsigned bridges = 0;
+    // How many bridges are connected to this pillar. Bridges from different
+    // heads are connected concurrently.
+    AtomicCounter bridges;
     
     // How many pillars are cascaded with this one
     unsigned links = 0;
@@ -215,34 +250,41 @@ struct DiffBridge: public Bridge {
 // basically indices into the arrays of the appropriate type (heads, pillars,
 // etc...). One can later query e.g. a pillar for a specific head...
 class SupportTreeBuilder {
+public:
+    // The parts are added concurrently by the routing threads. The
+    // tbb::concurrent_vector grows without a lock and without moving the parts
+    // already added, thus the returned references and the IDs (indices into
+    // these arrays) stay valid while other threads are adding parts.
+    template<class T> using Parts = tbb::concurrent_vector<T>;
+
+private:
     // For heads it is beneficial to use the same IDs as for the support points.
-    std::vector<Head>       m_heads;
+    Parts<Head>             m_heads;
     std::vector<size_t>     m_head_indices;
-    std::vector<Pillar>     m_pillars;
-    std::vector<Junction>   m_junctions;
-    std::vector<Bridge>     m_bridges;
-    std::vector<Bridge>     m_crossbridges;
-    std::vector<DiffBridge> m_diffbridges;
-    std::vector<Pedestal>   m_pedestals;
-    std::vector<Anchor>     m_anchors;
+    Parts<Pillar>           m_pillars;
+    Parts<Junction>         m_junctions;
+    Parts<Bridge>           m_bridges;
+    Parts<Bridge>           m_crossbridges;
+    Parts<DiffBridge>       m_diffbridges;
+    Parts<Pedestal>         m_pedestals;
+    Parts<Anchor>           m_anchors;
 
     JobController m_ctl;
     
     using Mutex = tbb::spin_mutex;
     
     mutable indexed_triangle_set m_meshcache;
-    mutable Mutex m_mutex;
-    mutable bool m_meshcache_valid = false;
+    mutable Mutex m_head_mutex;
+    mutable std::atomic<bool> m_meshcache_valid = false;
     mutable double m_model_height = 0; // the full height of the model
     
-    template<class BridgeT, class...Args>
-    const BridgeT& _add_bridge(std::vector<BridgeT> &br, Args&&... args)
+    template<class T, class...Args>
+    T& _add_part(Parts<T> &parts, Args&&... args)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
-        br.emplace_back(std::forward<Args>(args)...);
-        br.back().id = long(br.size() - 1);
+        auto it = parts.emplace_back(std::forward<Args>(args)...);
+        it->id = long(it - parts.begin());
         m_meshcache_valid = false;
-        return br.back();
+        return *it;
     }
     
 public:
@@ -255,38 +297,33 @@ public:
 
     const JobController &ctl() const { return m_ctl; }
 
+    // The heads are expected to be added before the routing starts, adding
+    // heads is serialized and must not run concurrently with head() queries.
     template<class...Args> Head& add_head(unsigned id, Args&&... args)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
-        m_heads.emplace_back(std::forward<Args>(args)...);
-        m_heads.back().id = id;
+        std::lock_guard<Mutex> lk(m_head_mutex);
+        auto it = m_heads.emplace_back(std::forward<Args>(args)...);
+        it->id = id;
         
         if (id >= m_head_indices.size()) m_head_indices.resize(id + 1);
-        m_head_indices[id] = m_heads.size() - 1;
+        m_head_indices[id] = size_t(it - m_heads.begin());
         
         m_meshcache_valid = false;
-        return m_heads.back();
+        return *it;
     }
     
     long add_pillar(long headid, double length)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
-        if (m_pillars.capacity() < m_heads.size())
-            m_pillars.reserve(m_heads.size() * 10);
-        
         assert(headid >= 0 && size_t(headid) < m_head_indices.size());
         Head &head = m_heads[m_head_indices[size_t(headid)]];
         
         Vec3d hjp = head.junction_point() - Vec3d{0, 0, length};
-        m_pillars.emplace_back(hjp, length, head.r_back_mm);
+        Pillar &pillar = _add_part(m_pillars, hjp, length, head.r_back_mm);
 
-        Pillar& pillar = m_pillars.back();
-        pillar.id = long(m_pillars.size() - 1);
         head.pillar_id = pillar.id;
         pillar.start_junction_id = head.id;
         pillar.starts_from_head = true;
         
-        m_meshcache_valid = false;
         return pillar.id;
     }
     
@@ -294,25 +331,29 @@ public:
 
     template<class...Args> const Anchor& add_anchor(Args&&...args)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
-        m_anchors.emplace_back(std::forward<Args>(args)...);
-        m_anchors.back().id = long(m_junctions.size() - 1);
-        m_meshcache_valid = false;
-        return m_anchors.back();
+        return _add_part(m_anchors, std::forward<Args>(args)...);
     }
     
     void increment_bridges(const Pillar& pillar)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(pillar.id >= 0 && size_t(pillar.id) < m_pillars.size());
         
         if(pillar.id >= 0 && size_t(pillar.id) < m_pillars.size())
-            m_pillars[size_t(pillar.id)].bridges++;
+            ++m_pillars[size_t(pillar.id)].bridges;
+    }
+
+    // Increment the bridge count of the pillar only if it is lower than
+    // max_bridges. Returns false if the pillar can not take another bridge.
+    bool try_increment_bridges(const Pillar& pillar, unsigned max_bridges)
+    {
+        assert(pillar.id >= 0 && size_t(pillar.id) < m_pillars.size());
+        
+        return pillar.id >= 0 && size_t(pillar.id) < m_pillars.size() &&
+               m_pillars[size_t(pillar.id)].bridges.increment_if_less(max_bridges);
     }
     
     void increment_links(const Pillar& pillar)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(pillar.id >= 0 && size_t(pillar.id) < m_pillars.size());
         
         if(pillar.id >= 0 && size_t(pillar.id) < m_pillars.size()) 
@@ -320,66 +361,50 @@ public:
     }
     
     unsigned bridgecount(const Pillar &pillar) const {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(pillar.id >= 0 && size_t(pillar.id) < m_pillars.size());
         return pillar.bridges;
     }
     
     template<class...Args> long add_pillar(Args&&...args)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
-        if (m_pillars.capacity() < m_heads.size())
-            m_pillars.reserve(m_heads.size() * 10);
-        
-        m_pillars.emplace_back(std::forward<Args>(args)...);
-        Pillar& pillar = m_pillars.back();
-        pillar.id = long(m_pillars.size() - 1);
+        Pillar &pillar = _add_part(m_pillars, std::forward<Args>(args)...);
         pillar.starts_from_head = false;
-        m_meshcache_valid = false;
         return pillar.id;
     }
     
     template<class...Args> const Junction& add_junction(Args&&... args)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
-        m_junctions.emplace_back(std::forward<Args>(args)...);
-        m_junctions.back().id = long(m_junctions.size() - 1);
-        m_meshcache_valid = false;
-        return m_junctions.back();
+        return _add_part(m_junctions, std::forward<Args>(args)...);
     }
     
     const Bridge& add_bridge(const Vec3d &s, const Vec3d &e, double r)
     {
-        return _add_bridge(m_bridges, s, e, r);
+        return _add_part(m_bridges, s, e, r);
     }
     
     const Bridge& add_bridge(long headid, const Vec3d &endp)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(headid >= 0 && size_t(headid) < m_head_indices.size());
         
         Head &h = m_heads[m_head_indices[size_t(headid)]];
-        m_bridges.emplace_back(h.junction_point(), endp, h.r_back_mm);
-        m_bridges.back().id = long(m_bridges.size() - 1);
+        const Bridge &bridge = _add_part(m_bridges, h.junction_point(), endp, h.r_back_mm);
         
-        h.bridge_id = m_bridges.back().id;
-        m_meshcache_valid = false;
-        return m_bridges.back();
+        h.bridge_id = bridge.id;
+        return bridge;
     }
     
     template<class...Args> const Bridge& add_crossbridge(Args&&... args)
     {
-        return _add_bridge(m_crossbridges, std::forward<Args>(args)...);
+        return _add_part(m_crossbridges, std::forward<Args>(args)...);
     }
 
     template<class...Args> const DiffBridge& add_diffbridge(Args&&... args)
     {
-        return _add_bridge(m_diffbridges, std::forward<Args>(args)...);
+        return _add_part(m_diffbridges, std::forward<Args>(args)...);
     }
     
     Head &head(unsigned id)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(id < m_head_indices.size());
         
         m_meshcache_valid = false;
@@ -387,18 +412,16 @@ public:
     }
     
     inline size_t pillarcount() const {
-        std::lock_guard<Mutex> lk(m_mutex);
         return m_pillars.size();
     }
     
-    inline const std::vector<Pillar> &pillars() const { return m_pillars; }
-    inline const std::vector<Head>   &heads() const { return m_heads; }
-    inline const std::vector<Bridge> &bridges() const { return m_bridges; }
-    inline const std::vector<Bridge> &crossbridges() const { return m_crossbridges; }
+    inline const Parts<Pillar> &pillars() const { return m_pillars; }
+    inline const Parts<Head>   &heads() const { return m_heads; }
+    inline const Parts<Bridge> &bridges() const { return m_bridges; }
+    inline const Parts<Bridge> &crossbridges() const { return m_crossbridges; }
     
     template<class T> inline IntegerOnly<T, const Pillar&> pillar(T id) const
     {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(id >= 0 && size_t(id) < m_pillars.size() &&
                size_t(id) < std::numeric_limits<size_t>::max());
         
@@ -407,7 +430,6 @@ public:
     
     template<class T> inline IntegerOnly<T, Pillar&> pillar(T id) 
     {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(id >= 0 && size_t(id) < m_pillars.size() &&
                size_t(id) < std::numeric_limits<size_t>::max());
         
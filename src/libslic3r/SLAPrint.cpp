@@ -1155,13 +1155,31 @@ void SLAPrint::StatusReporter::operator()(SLAPrint &         p,
 
 namespace csg {
 
-MeshBoolean::cgal::CGALMeshPtr get_cgalmesh(const CSGPartForStep &part)
+static const MeshBoolean::cgal::CGALMeshPtr &cached_cgalmesh(const CSGPartForStep &part)
 {
     if (!part.cgalcache && csg::get_mesh(part)) {
         part.cgalcache = csg::get_cgalmesh(static_cast<const csg::CSGPart&>(part));
     }
 
-    return part.cgalcache? clone(*part.cgalcache) : nullptr;
+    return part.cgalcache;
+}
+
+MeshBoolean::cgal::CGALMeshPtr get_cgalmesh(const CSGPartForStep &part)
+{
+    const auto &cgalptr = cached_cgalmesh(part);
+
+    return cgalptr? clone(*cgalptr) : nullptr;
+}
+
+// The parts of the previous steps are checked again by each step.
+bool is_cgalmesh_valid(const CSGPartForStep &part)
+{
+    if (!part.cgalvalid) {
+        const auto &cgalptr = cached_cgalmesh(part);
+        part.cgalvalid = cgalptr && check_cgalmesh(*cgalptr);
+    }
+
+    return *part.cgalvalid;
 }
 
 } // namespace csg
@@ -3,10 +3,12 @@
 
 #include <cstdint>
 #include <mutex>
+#include <optional>
 #include <set>
 
 #include "PrintBase.hpp"
 #include "SLA/SupportTree.hpp"
+#include "SLA/SupportPointGenerator.hpp"
 #include "Point.hpp"
 #include "Format/SLAArchiveWriter.hpp"
 #include "GCode/ThumbnailData.hpp"
@@ -62,6 +64,8 @@ struct CSGPartForStep : public csg::CSGPart
 {
     SLAPrintObjectStep key;
     mutable MeshBoolean::cgal::CGALMeshPtr cgalcache;
+    // Result of the (expensive) check whether cgalcache is fit for booleans.
+    mutable std::optional<bool> cgalvalid;
 
     CSGPartForStep(SLAPrintObjectStep k, CSGPart &&p = {})
         : key{k}, CSGPart{std::move(p)}
@@ -71,6 +75,8 @@ struct CSGPartForStep : public csg::CSGPart
     {
         this->its_ptr = std::move(part.its_ptr);
         this->operation = part.operation;
+        this->cgalcache.reset();
+        this->cgalvalid.reset();
 
         return *this;
     }
@@ -81,6 +87,7 @@ struct CSGPartForStep : public csg::CSGPart
 namespace csg {
 
 MeshBoolean::cgal::CGALMeshPtr get_cgalmesh(const CSGPartForStep &part);
+bool is_cgalmesh_valid(const CSGPartForStep &part);
 
 } // namespace csg
 
@@ -389,6 +396,15 @@ private:
     };
     
     std::unique_ptr<HollowingData> m_hollowing_data;
+
+    // The signed distance grid of the object voxelized for hollowing, kept
+    // between the runs of the hollowing step.
+    sla::HollowingGridCache m_hollowing_grid_cache;
+
+    // Layers and islands of the last automatic support point generation. A
+    // local change of the model (a drain hole, a cut) generates the points
+    // again only in the affected layers.
+    sla::SupportPointGenerator::State m_support_points_state;
 };
 
 using PrintObjects = std::vector<SLAPrintObject*>;
@@ -337,6 +337,7 @@ void SLAPrint::Steps::mesh_assembly(SLAPrintObject &po)
     po.m_mesh_to_slice.clear();
     po.m_supportdata.reset();
     po.m_hollowing_data.reset();
+    po.m_hollowing_grid_cache.clear();
 
     csg::model_to_csgmesh(*po.model_object(), po.trafo(),
                           csg_inserter{po.m_mesh_to_slice, slaposAssembly},
@@ -354,6 +355,7 @@ void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
 
     if (! po.m_config.hollowing_enable.getBool()) {
         BOOST_LOG_TRIVIAL(info) << "Skipping hollowing step!";
+        po.m_hollowing_grid_cache.clear();
         return;
     }
 
@@ -367,8 +369,27 @@ void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
     ctl.stopcondition = [this]() { return canceled(); };
     ctl.cancelfn = [this]() { throw_if_canceled(); };
 
-    sla::InteriorPtr interior =
-        generate_interior(po.mesh_to_slice(), hlwcfg, ctl);
+    auto   parts       = po.mesh_to_slice();
+    double voxel_scale = sla::get_voxel_scale(sla::csgmesh_positive_maxvolume(parts), hlwcfg);
+    size_t mesh_hash   = sla::csgmesh_hash(parts);
+
+    VoxelGridPtr     new_grid;
+    const VoxelGrid *grid = po.m_hollowing_grid_cache.find(mesh_hash, voxel_scale);
+    if (grid) {
+        BOOST_LOG_TRIVIAL(info) << "Reusing the voxel grid of the previous hollowing step";
+    } else {
+        // Release the memory of the outdated grid before voxelizing again.
+        po.m_hollowing_grid_cache.clear();
+        new_grid = sla::voxelize_for_hollowing(parts, voxel_scale, ctl);
+        grid     = new_grid.get();
+    }
+
+    throw_if_canceled();
+
+    sla::InteriorPtr interior = grid ? sla::generate_interior(*grid, hlwcfg, ctl) : sla::InteriorPtr{};
+
+    if (new_grid)
+        po.m_hollowing_grid_cache.store(mesh_hash, voxel_scale, std::move(new_grid));
 
     if (!interior || sla::get_mesh(*interior).empty())
         BOOST_LOG_TRIVIAL(warning) << "Hollowed interior is empty!";
@@ -606,7 +627,10 @@ static void filter_support_points_by_modifiers(sla::SupportPoints &pts,
 void SLAPrint::Steps::support_points(SLAPrintObject &po)
 {
     // If supports are disabled, we can skip the model scan.
-    if(!po.m_config.supports_enable.getBool()) return;
+    if(!po.m_config.supports_enable.getBool()) {
+        po.m_support_points_state = {};
+        return;
+    }
 
     if (!po.m_supportdata) {
         auto &meshp = po.get_mesh_to_print();
@@ -651,11 +675,16 @@ void SLAPrint::Steps::support_points(SLAPrintObject &po)
                 report_status(current, OBJ_STEP_LABELS(slaposSupportPoints));
         };
 
-        // Construction of this object does the calculation.
         throw_if_canceled();
         sla::SupportPointGenerator auto_supports(
-            po.m_supportdata->input.emesh, po.get_model_slices(),
-            heights, config, [this]() { throw_if_canceled(); }, statuscb);
+            po.m_supportdata->input.emesh, config,
+            [this]() { throw_if_canceled(); }, statuscb);
+
+        // Only the layers with changed slices are processed again if the
+        // state of the previous run fits.
+        auto_supports.seed(std::random_device{}());
+        auto_supports.execute(po.get_model_slices(), heights,
+                              po.m_support_points_state);
 
         // Now let's extract the result.
         std::vector<sla::SupportPoint>& points = auto_supports.output();
@@ -1173,6 +1202,13 @@ void SLAPrint::Steps::rasterize()
     // last minute escape
     if(canceled()) return;
 
+    // Rasterizing in advance keeps all the encoded layers in memory until the export. For high resolution
+    // displays and tall prints, rasterize and encode the layers while they are being exported instead.
+    const SLAPrinterConfig &printer_config = m_print->m_printer_config;
+    m_print->m_archiver->set_streaming(
+        double(printer_config.display_pixels_x.getInt()) * double(printer_config.display_pixels_y.getInt()) *
+        double(m_print->m_printer_input.size()) > SLAArchiveWriter::StreamingPixelsThreshold);
+
     // Print all the layers in parallel
     m_print->m_archiver->draw_layers(m_print->m_printer_input.size(), lvlfn,
                                     [this]() { return canceled(); }, ex_tbb);
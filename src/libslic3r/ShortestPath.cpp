@@ -10,6 +10,7 @@
 #include "MutablePriorityQueue.hpp"
 #include "Print.hpp"
 
+#include <chrono>
 #include <cmath>
 #include <cassert>
 
@@ -298,6 +299,9 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 				end_point1.chain_id = chain_id;
 				end_point2.chain_id = chain_id;
 				assert(validate_graph_and_queue());
+				// Connected end points will never be connected again, let the KD tree search skip them.
+				kdtree.remove(&end_point1 - &end_points.front());
+				kdtree.remove(&end_point2 - &end_points.front());
 				if (iter == 0) {
 					// Last iteration. There shall be exactly one or two end points waiting to be connected.
 					assert(queue.size() == ((first_point == nullptr) ? 2 : 1));
@@ -339,8 +343,6 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 #endif /* NDEBUG */
 				// Update position of this end point in the queue based on the distance calculated at the line above.
 				queue.update(end_point1.heap_idx);
-		    	//FIXME Remove the other end point from the KD tree.
-		    	// As the KD tree update is expensive, do it only after some larger number of points is removed from the queue.
 				assert(validate_graph_and_queue());
 	    	}
 		}
@@ -389,9 +391,12 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 					} while (first_point != nullptr);
 				}
 			}
-			if (failed)
+			if (failed) {
 				// As a last resort, try a dumb algorithm, which is not sensitive to edge reversal constraints.
+				// Some end points were removed from the KD tree, restore them.
+				kdtree.restore();
 				out = chain_segments_closest_point<EndPoint, decltype(kdtree), CouldReverseFunc>(end_points, kdtree, could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
+			}
 		} else {
 			assert(! failed);
 		}
@@ -891,6 +896,13 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 #endif /* NDEBUG */
 					break;
 				} else {
+					// Segments inside a chain will never be connected again, only the end segments of a chain may be connected or flipped.
+					// Let the KD tree search skip the segments, which just became internal to the chain.
+					for (EndPoint *end_point : { end_point1, end_point2 })
+						if (EndPoint &other = end_point->opposite(end_points); end_point->chain_id > 0 && other.chain_id > 0) {
+							kdtree.remove(end_point - &end_points.front());
+							kdtree.remove(&other     - &end_points.front());
+						}
 					//FIXME update the 2nd end points on the queue.
 					// Update end points of the flipped segments.
 					update_end_point_in_queue(queue, kdtree, chains, end_points, chain.begin->opposite(end_points), first_point_idx, first_point);
@@ -918,8 +930,6 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 //					printf("Warning: taking shorter length than previously is suspicious\n");
 				}
 #endif /* NDEBUG */
-		    	//FIXME Remove the other end point from the KD tree.
-		    	// As the KD tree update is expensive, do it only after some larger number of points is removed from the queue.
 		    }
 			assert(validate_graph_and_queue());
 		}
@@ -968,9 +978,12 @@ std::vector<std::pair<size_t, bool>> chain_segments_greedy_constrained_reversals
 					} while (first_point != nullptr);
 				}
 			}
-			if (failed)
+			if (failed) {
 				// As a last resort, try a dumb algorithm, which is not sensitive to edge reversal constraints.
+				// Some end points were removed from the KD tree, restore them.
+				kdtree.restore();
 				out = chain_segments_closest_point<EndPoint, decltype(kdtree), CouldReverseFunc>(end_points, kdtree, could_reverse_func, (initial_point != nullptr) ? *initial_point : end_points.front());
+			}
 		} else {
 			assert(! failed);
 		}
@@ -1549,22 +1562,55 @@ static inline void do_crossover(const std::vector<FlipEdge> &edges_in, std::vect
 }
 #endif
 
-// Worst time complexity:    O(min(n, 100) * (n * log n + n^2)
-// Expected time complexity: O(min(n, 100) * (n * log n + k * n)
-// where n is the number of edges and k is the number of connection_lengths candidates after the first one
+// Worst time complexity:    O(min(n, m) * (n * log n + n^2)
+// Expected time complexity: O(min(n, m) * (n * log n + k * n)
+// where n is the number of edges, m is params.max_exchanges and k is the number of connection_lengths candidates after the first one
 // is found that improves the total cost.
-//FIXME there are likley better heuristics to lower the time complexity.
-static inline void reorder_by_two_exchanges_with_segment_flipping(std::vector<FlipEdge> &edges)
+// With params.restrict_to_neighbors, the second crossover is only searched for at the connections of the edges with end points
+// closest to the end points of the first crossover, which lowers the time complexity to O(min(n, m) * (n * log n + k * log n)).
+static inline void reorder_by_two_exchanges_with_segment_flipping(std::vector<FlipEdge> &edges, const ChainingParams &params)
 {
 	if (edges.size() < 2)
 		return;
 
+	const auto time_start = std::chrono::steady_clock::now();
+	auto       time_out   = [&params, time_start]() {
+		return params.time_budget > 0. && std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count() > params.time_budget;
+	};
+
+	// Number of closest end points searched for around each of the four end points of the first crossover.
+	static constexpr const size_t num_neighbors = 16;
+	// For a low number of edges, all the connections are tried.
+	const bool 								neighbors_only = params.restrict_to_neighbors && edges.size() > 8 * num_neighbors;
+	// End points of the edges indexed by (2 * source_index) for p1 and (2 * source_index + 1) for p2.
+	// The edges are only moved and flipped, thus the KD tree over their end points is built just once.
+	std::vector<Vec2d> 						end_points;
+	// Current position of an edge in edges, indexed by source_index.
+	std::vector<size_t> 					edge_pos;
+	if (neighbors_only) {
+		end_points.assign(edges.size() * 2, Vec2d::Zero());
+		edge_pos.assign(edges.size(), 0);
+		for (size_t i = 0; i < edges.size(); ++ i) {
+			const FlipEdge &edge = edges[i];
+			assert(edge.source_index < edges.size());
+			end_points[edge.source_index * 2]     = edge.p1;
+			end_points[edge.source_index * 2 + 1] = edge.p2;
+			edge_pos[edge.source_index] = i;
+		}
+	}
+	auto coordinate_fn = [&end_points](size_t idx, size_t dimension) -> double { return end_points[idx][dimension]; };
+	KDTreeIndirect<2, double, decltype(coordinate_fn)> kdtree(coordinate_fn, end_points.size());
+	// Connections to try as the second crossover, deduplicated by connection_stamp.
+	std::vector<size_t> 					candidates;
+	std::vector<size_t> 					connection_stamp(neighbors_only ? edges.size() : 0, 0);
+	size_t 									stamp = 0;
+
 	std::vector<ConnectionCost> 			connections(edges.size());
 	std::vector<FlipEdge> 					edges_tmp(edges);
 	std::vector<std::pair<double, size_t>>	connection_lengths(edges.size() - 1, std::pair<double, size_t>(0., 0));
 	std::vector<char>						connection_tried(edges.size(), false);
-	const size_t 							max_iterations = std::min(edges.size(), size_t(100));
-	for (size_t iter = 0; iter < max_iterations; ++ iter) {
+	const size_t 							max_iterations = std::min(edges.size(), params.max_exchanges);
+	for (size_t iter = 0; iter < max_iterations && ! time_out(); ++ iter) {
 		// Initialize connection costs and connection lengths.
 		for (size_t i = 1; i < edges.size(); ++ i) {
 			const FlipEdge   	 &e1 = edges[i - 1];
@@ -1584,26 +1630,48 @@ static inline void reorder_by_two_exchanges_with_segment_flipping(std::vector<Fl
         for (const std::pair<double, size_t>& first_crossover_candidate : connection_lengths) {
             size_t longest_connection_idx = first_crossover_candidate.second;
 			connection_tried[longest_connection_idx] = true;
+			if (time_out())
+				break;
+			candidates.clear();
+			if (neighbors_only) {
+				// The crossover connects end points of the edges around the first crossover with end points of the edges
+				// around the second crossover. Only try the second crossovers next to the edges with end points close by.
+				++ stamp;
+				const FlipEdge &e1 = edges[longest_connection_idx - 1];
+				const FlipEdge &e2 = edges[longest_connection_idx];
+				for (const Vec2d *pt : { &e1.p1, &e1.p2, &e2.p1, &e2.p2 })
+					for (size_t idx : find_closest_points<num_neighbors>(kdtree, *pt))
+						if (idx != decltype(kdtree)::npos)
+							for (size_t j = edge_pos[idx / 2], j_end = j + 2; j < j_end; ++ j)
+								if (j > 0 && j < connections.size() && ! connection_tried[j] && connection_stamp[j] != stamp) {
+									connection_stamp[j] = stamp;
+									candidates.emplace_back(j);
+								}
+				std::sort(candidates.begin(), candidates.end());
+			} else {
+				for (size_t j = 1; j < connections.size(); ++ j)
+					if (! connection_tried[j])
+						candidates.emplace_back(j);
+			}
 			// Find the second crossover connection with the lowest total chain cost.
 			size_t crossover_pos_min  = std::numeric_limits<size_t>::max();
 			double crossover_cost_min = connections.back().cost;
 			size_t crossover_flip_min = 0;
-			for (size_t j = 1; j < connections.size(); ++ j)
-				if (! connection_tried[j]) {
-					size_t a = j;
-					size_t b = longest_connection_idx;
-					if (a > b)
-						std::swap(a, b);
-					std::pair<double, size_t> cost_and_flip = minimum_crossover_cost(edges, 
-						std::make_pair(size_t(0), a), connections[a - 1], std::make_pair(a, b), connections[b - 1] - connections[a], std::make_pair(b, edges.size()), connections.back() - connections[b],
-						connections.back().cost);
-					if (cost_and_flip.second > 0 && cost_and_flip.first < crossover_cost_min) {
-						crossover_pos_min  = j;
-						crossover_cost_min = cost_and_flip.first;
-						crossover_flip_min = cost_and_flip.second;
-						assert(crossover_cost_min < connections.back().cost + EPSILON);
-					}
+			for (size_t j : candidates) {
+				size_t a = j;
+				size_t b = longest_connection_idx;
+				if (a > b)
+					std::swap(a, b);
+				std::pair<double, size_t> cost_and_flip = minimum_crossover_cost(edges, 
+					std::make_pair(size_t(0), a), connections[a - 1], std::make_pair(a, b), connections[b - 1] - connections[a], std::make_pair(b, edges.size()), connections.back() - connections[b],
+					connections.back().cost);
+				if (cost_and_flip.second > 0 && cost_and_flip.first < crossover_cost_min) {
+					crossover_pos_min  = j;
+					crossover_cost_min = cost_and_flip.first;
+					crossover_flip_min = cost_and_flip.second;
+					assert(crossover_cost_min < connections.back().cost + EPSILON);
 				}
+			}
 			if (crossover_cost_min < connections.back().cost) {
 				// The cost of the chain with the proposed two crossovers has a lower total cost than the current chain. Apply the crossover.
 				crossover1_pos_final = longest_connection_idx;
@@ -1621,6 +1689,9 @@ static inline void reorder_by_two_exchanges_with_segment_flipping(std::vector<Fl
 				std::swap(crossover1_pos_final, crossover2_pos_final);
 			do_crossover(edges, edges_tmp, std::make_pair(size_t(0), crossover1_pos_final), std::make_pair(crossover1_pos_final, crossover2_pos_final), std::make_pair(crossover2_pos_final, edges.size()), crossover_flip_final);
 			edges.swap(edges_tmp);
+			if (neighbors_only)
+				for (size_t i = 0; i < edges.size(); ++ i)
+					edge_pos[edges[i].source_index] = i;
 		} else {
 			// No valid pair of cross over positions was found improving the total cost. Giving up.
 			break;
@@ -1633,7 +1704,7 @@ static inline void reorder_by_two_exchanges_with_segment_flipping(std::vector<Fl
 static inline void reorder_by_three_exchanges_with_segment_flipping(std::vector<FlipEdge> &edges)
 {
 	if (edges.size() < 3) {
-		reorder_by_two_exchanges_with_segment_flipping(edges);
+		reorder_by_two_exchanges_with_segment_flipping(edges, ChainingParams());
 		return;
 	}
 
@@ -1787,7 +1858,7 @@ static inline std::pair<double, size_t> minimum_crossover_cost(
 static inline void reorder_by_three_exchanges_with_segment_flipping2(std::vector<FlipEdge> &edges)
 {
 	if (edges.size() < 3) {
-		reorder_by_two_exchanges_with_segment_flipping(edges);
+		reorder_by_two_exchanges_with_segment_flipping(edges, ChainingParams());
 		return;
 	}
 
@@ -1883,7 +1954,7 @@ static inline void reorder_by_three_exchanges_with_segment_flipping2(std::vector
 // Flip the sequences of polylines to lower the total length of connecting lines.
 // Used by the infill generator if the infill is not connected with perimeter lines
 // and to order the brim lines.
-static inline void improve_ordering_by_two_exchanges_with_segment_flipping(Polylines &polylines, bool fixed_start)
+static inline void improve_ordering_by_two_exchanges_with_segment_flipping(Polylines &polylines, bool fixed_start, const ChainingParams &params)
 {
 #ifndef NDEBUG
 	auto cost = [&polylines]() {
@@ -1906,7 +1977,7 @@ static inline void improve_ordering_by_two_exchanges_with_segment_flipping(Polyl
     std::transform(polylines.begin(), polylines.end(), std::back_inserter(edges), 
     	[&polylines](const Polyline &pl){ return FlipEdge(pl.first_point().cast<double>(), pl.last_point().cast<double>(), &pl - polylines.data()); });
 #if 1
-	reorder_by_two_exchanges_with_segment_flipping(edges);
+	reorder_by_two_exchanges_with_segment_flipping(edges, params);
 #else
 	// reorder_by_three_exchanges_with_segment_flipping(edges);
 	reorder_by_three_exchanges_with_segment_flipping2(edges);
@@ -1915,27 +1986,26 @@ static inline void improve_ordering_by_two_exchanges_with_segment_flipping(Polyl
 	out.reserve(polylines.size());
 	for (const FlipEdge &edge : edges) {
 		Polyline &pl = polylines[edge.source_index];
+		// Is the polyline flipped?
+		bool flipped = edge.p2 == pl.first_point().cast<double>();
+		assert(flipped || edge.p1 == pl.first_point().cast<double>());
 		out.emplace_back(std::move(pl));
-		if (edge.p2 == pl.first_point().cast<double>()) {
-			// Polyline is flipped.
+		if (flipped)
 			out.back().reverse();
-		} else {
-			// Polyline is not flipped.
-			assert(edge.p1 == pl.first_point().cast<double>());
-		}
 	}
+	polylines = std::move(out);
 
 #ifndef NDEBUG
 	double cost_final = cost();
 #ifdef DEBUG_SVG_OUTPUT
-	svg_draw_polyline_chain("improve_ordering_by_two_exchanges_with_segment_flipping-final", iRun, out);
+	svg_draw_polyline_chain("improve_ordering_by_two_exchanges_with_segment_flipping-final", iRun, polylines);
 #endif /* DEBUG_SVG_OUTPUT */
 	assert(cost_final <= cost_initial);
 #endif /* NDEBUG */
 }
 
 // Used to optimize order of infill lines and brim lines.
-Polylines chain_polylines(Polylines &&polylines, const Point *start_near)
+Polylines chain_polylines(Polylines &&polylines, const Point *start_near, const ChainingParams &params)
 {
 #ifdef DEBUG_SVG_OUTPUT
 	static int iRun = 0;
@@ -1953,8 +2023,8 @@ Polylines chain_polylines(Polylines &&polylines, const Point *start_near)
 			if (segment_and_reversal.second)
 				out.back().reverse();
 		}
-		if (out.size() > 1 && start_near == nullptr) {
-			improve_ordering_by_two_exchanges_with_segment_flipping(out, start_near != nullptr);
+		if (out.size() > 1 && start_near == nullptr && params.max_exchanges > 0) {
+			improve_ordering_by_two_exchanges_with_segment_flipping(out, start_near != nullptr, params);
 			//improve_ordering_by_segment_flipping(out, start_near != nullptr);
 		}
 	}
@@ -26,7 +26,24 @@ std::vector<std::pair<size_t, bool>> chain_extrusion_paths(std::vector<Extrusion
 void                                 reorder_extrusion_paths(std::vector<ExtrusionPath> &extrusion_paths, std::vector<std::pair<size_t, bool>> &chain);
 void                                 chain_and_reorder_extrusion_paths(std::vector<ExtrusionPath> &extrusion_paths, const Point *start_near = nullptr);
 
-Polylines 							 chain_polylines(Polylines &&src, const Point *start_near = nullptr);
+// Parameters of the local improvement of a chain of polylines by exchanging pairs of its connections.
+// No slicing step opts in yet, the improvement is exercised by the bench_chaining sandbox and by the tests only.
+// Enabling it for infill or brim changes the order and direction of the extrusions and thus the G-code.
+struct ChainingParams
+{
+    // Maximum number of improving exchanges performed. Zero keeps the chain produced by the greedy algorithm,
+    // the improvement shortens the travel moves, but it reorders and flips the polylines.
+    size_t max_exchanges         = 0;
+    // Only try exchanges with connections starting or ending next to the end points closest to the connection being replaced.
+    // Otherwise all pairs of connections are tried, which is quadratic in the number of polylines.
+    bool   restrict_to_neighbors = true;
+    // Stop improving the chain after this many seconds of wall clock time, zero for no limit.
+    // With a time limit set, the result depends on the speed of the machine.
+    double time_budget           = 0.;
+};
+
+Polylines 							 chain_polylines(Polylines &&src, const Point *start_near, const ChainingParams &params);
+inline Polylines 					 chain_polylines(Polylines &&src, const Point *start_near = nullptr) { return chain_polylines(std::move(src), start_near, ChainingParams()); }
 inline Polylines 					 chain_polylines(const Polylines& src, const Point* start_near = nullptr) { Polylines tmp(src); return chain_polylines(std::move(tmp), start_near); }
 
 std::vector<ClipperLib::PolyNode*>	 chain_clipper_polynodes(const Points &points, const std::vector<ClipperLib::PolyNode*> &items);
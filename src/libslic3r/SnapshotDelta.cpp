@@ -0,0 +1,374 @@
+#include "SnapshotDelta.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include <miniz.h>
+
+namespace Slic3r {
+
+namespace delta {
+
+// Matches are searched for by hashing blocks of the base aligned to block_size.
+static constexpr const size_t block_size = 16;
+
+static inline uint64_t hash_block(const char *p)
+{
+    uint64_t a, b;
+    memcpy(&a, p, 8);
+    memcpy(&b, p + 8, 8);
+    uint64_t h = a * 0x9E3779B97F4A7C15ull + b;
+    h = (h ^ (h >> 33)) * 0xff51afd7ed558ccdull;
+    return h ^ (h >> 33);
+}
+
+void append_varint(std::string &out, size_t v)
+{
+    for (; v >= 0x80; v >>= 7)
+        out += char((v & 0x7f) | 0x80);
+    out += char(v);
+}
+
+size_t read_varint(const std::string &in, size_t &pos)
+{
+    size_t v = 0;
+    for (int shift = 0; pos < in.size(); shift += 7) {
+        unsigned char c = (unsigned char)in[pos ++];
+        v |= size_t(c & 0x7f) << shift;
+        if ((c & 0x80) == 0)
+            break;
+    }
+    return v;
+}
+
+std::string encode(const std::string &base, const std::string &data, size_t max_size)
+{
+    std::string out;
+    if (base.size() < block_size || data.size() < block_size)
+        return out;
+
+    // Open addressing table of the aligned base blocks, the first occurrence of a block wins.
+    size_t num_blocks = base.size() / block_size;
+    size_t table_size = 1;
+    while (table_size < 2 * num_blocks)
+        table_size <<= 1;
+    const size_t          mask = table_size - 1;
+    std::vector<uint32_t> table(table_size, uint32_t(-1));
+    for (size_t i = 0; i < num_blocks; ++ i) {
+        uint32_t &slot = table[hash_block(base.data() + i * block_size) & mask];
+        if (slot == uint32_t(-1))
+            slot = uint32_t(i * block_size);
+    }
+
+    size_t literal_begin = 0;
+    for (size_t i = 0; i + block_size <= data.size();) {
+        uint32_t pos = table[hash_block(data.data() + i) & mask];
+        if (pos == uint32_t(-1) || memcmp(base.data() + pos, data.data() + i, block_size) != 0) {
+            ++ i;
+            continue;
+        }
+        // Extend the match to both sides.
+        size_t begin      = i;
+        size_t base_begin = pos;
+        while (begin > literal_begin && base_begin > 0 && base[base_begin - 1] == data[begin - 1])
+            -- begin, -- base_begin;
+        size_t end = i + block_size;
+        for (size_t base_end = pos + block_size; end < data.size() && base_end < base.size() && base[base_end] == data[end]; ++ base_end)
+            ++ end;
+        append_varint(out, begin - literal_begin);
+        out.append(data, literal_begin, begin - literal_begin);
+        append_varint(out, base_begin);
+        append_varint(out, end - begin);
+        if (out.size() >= max_size)
+            return std::string();
+        i = literal_begin = end;
+    }
+    if (literal_begin < data.size()) {
+        append_varint(out, data.size() - literal_begin);
+        out.append(data, literal_begin, data.size() - literal_begin);
+        append_varint(out, 0);
+        append_varint(out, 0);
+    }
+    if (out.size() >= max_size)
+        out.clear();
+    return out;
+}
+
+std::string decode(const std::string &base, const std::string &delta, size_t size)
+{
+    std::string out;
+    out.reserve(size);
+    for (size_t pos = 0; pos < delta.size();) {
+        size_t literal = read_varint(delta, pos);
+        out.append(delta, pos, literal);
+        pos += literal;
+        size_t offset = read_varint(delta, pos);
+        size_t len    = read_varint(delta, pos);
+        out.append(base, offset, len);
+    }
+    assert(out.size() == size);
+    return out;
+}
+
+} // namespace delta
+
+// Storage of the data of a snapshot chunk, shared with the background encoder, therefore accessed under a mutex.
+// Until encoded, the data are stored plain. The encoder stores them as a delta against the base data if the delta
+// is small enough, and it deflates them if that saves memory. The plain data are then released unless pinned.
+class SnapshotPayload
+{
+public:
+    SnapshotPayload(std::shared_ptr<const std::string> plain, bool encoded) : m_plain(std::move(plain)), m_encoded(encoded) {}
+
+    // Called by the background encoder. base is the plain data of the base chunk, null if there is no base.
+    void encode(const std::shared_ptr<const std::string> &base)
+    {
+        std::shared_ptr<const std::string> plain;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            plain = m_plain;
+        }
+        assert(plain);
+        std::string delta;
+        if (base)
+            delta = delta::encode(*base, *plain, plain->size() / 4);
+        const std::string &data = delta.empty() ? *plain : delta;
+
+        std::vector<unsigned char> stored;
+        bool                       deflated = false;
+        if (data.size() >= SnapshotEncoder::min_size) {
+            stored.assign(mz_compressBound(mz_ulong(data.size())), 0);
+            mz_ulong size = mz_ulong(stored.size());
+            if (mz_compress2(stored.data(), &size, (const unsigned char*)data.data(), mz_ulong(data.size()), MZ_BEST_SPEED) == MZ_OK &&
+                size < data.size()) {
+                stored.resize(size);
+                stored.shrink_to_fit();
+                deflated = true;
+            } else
+                stored.clear();
+        }
+        if (! deflated && ! delta.empty())
+            stored.assign(delta.begin(), delta.end());
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stored      = std::move(stored);
+        m_stored_size = data.size();
+        m_deflated    = deflated;
+        m_delta       = ! delta.empty();
+        m_encoded     = true;
+        if (! m_stored.empty() && ! m_pinned)
+            m_plain.reset();
+    }
+
+    bool encoded() const { std::lock_guard<std::mutex> lock(m_mutex); return m_encoded; }
+    bool is_delta() const { std::lock_guard<std::mutex> lock(m_mutex); return m_delta; }
+
+    // Keep the plain data in memory.
+    void pin(std::shared_ptr<const std::string> plain) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pinned = true;
+        if (! m_plain)
+            m_plain = std::move(plain);
+    }
+    void unpin() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pinned = false;
+        if (! m_stored.empty())
+            m_plain.reset();
+    }
+
+    // Plain data if held in memory, otherwise null.
+    std::shared_ptr<const std::string> cached() const { std::lock_guard<std::mutex> lock(m_mutex); return m_plain; }
+
+    // Stored data inflated, which is either the plain data or a delta.
+    std::string unpack() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        assert(m_encoded && ! m_stored.empty());
+        if (! m_deflated)
+            return std::string(m_stored.begin(), m_stored.end());
+        std::string out(m_stored_size, '\0');
+        mz_ulong size   = mz_ulong(m_stored_size);
+        int      status = mz_uncompress((unsigned char*)out.data(), &size, m_stored.data(), mz_ulong(m_stored.size()));
+        assert(status == MZ_OK && size == m_stored_size);
+        (void)status;
+        return out;
+    }
+
+    size_t memsize() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stored.size() + (m_plain ? m_plain->size() : 0);
+    }
+
+private:
+    mutable std::mutex                  m_mutex;
+    std::shared_ptr<const std::string>  m_plain;
+    // Delta or full data, deflated if m_deflated. Empty if the data are stored plain.
+    std::vector<unsigned char>          m_stored;
+    // Size of m_stored after inflating.
+    size_t                              m_stored_size { 0 };
+    bool                                m_deflated { false };
+    bool                                m_delta { false };
+    bool                                m_encoded;
+    bool                                m_pinned { false };
+};
+
+static std::atomic<uint64_t> s_last_chunk_id { 0 };
+
+SnapshotChunk::SnapshotChunk(std::shared_ptr<const std::string> data, uint64_t hash, SnapshotChunk *base) :
+    m_size(data->size()), m_hash(hash), m_id(++ s_last_chunk_id), m_base(base)
+{
+    if (m_size >= 8)
+        memcpy(&m_head, data->data(), 8);
+    if (m_base != nullptr)
+        ++ m_base->m_num_deltas;
+    m_payload = std::make_shared<SnapshotPayload>(std::move(data), m_size < SnapshotEncoder::min_size);
+}
+
+SnapshotChunk::~SnapshotChunk()
+{
+    if (m_base != nullptr) {
+        -- m_base->m_num_deltas;
+        m_base->release_if_unused();
+    }
+}
+
+void SnapshotChunk::release_if_unused()
+{
+    if (m_refcnt == 0 && m_num_deltas == 0 && ! m_is_base)
+        delete this;
+}
+
+bool SnapshotChunk::is_delta() const
+{
+    return m_payload->is_delta();
+}
+
+size_t SnapshotChunk::memsize() const
+{
+    return sizeof(SnapshotChunk) + m_payload->memsize();
+}
+
+size_t SnapshotChunk::interval_memsize() const
+{
+    assert(m_refcnt > 0);
+    size_t users   = m_refcnt + m_num_deltas;
+    size_t memsize = (this->memsize() + users - 1) / users;
+    if (m_base != nullptr) {
+        size_t base_users = m_base->m_refcnt + m_base->m_num_deltas;
+        memsize += ((m_base->memsize() + base_users - 1) / base_users + m_refcnt - 1) / m_refcnt;
+    }
+    return memsize;
+}
+
+uint64_t SnapshotChunk::hash(const std::string &data)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    size_t   i = 0;
+    for (; i + 8 <= data.size(); i += 8) {
+        uint64_t v;
+        memcpy(&v, data.data() + i, 8);
+        h = (h ^ v) * 0x100000001b3ull;
+        h ^= h >> 29;
+    }
+    for (; i < data.size(); ++ i)
+        h = (h ^ (unsigned char)data[i]) * 0x100000001b3ull;
+    return h;
+}
+
+std::shared_ptr<const std::string> SnapshotChunk::plain() const
+{
+    if (std::shared_ptr<const std::string> data = m_payload->cached(); data)
+        return data;
+    std::string data = m_payload->unpack();
+    if (m_payload->is_delta()) {
+        // The base of a delta is stored in full.
+        assert(m_base != nullptr && m_base->m_base == nullptr);
+        data = delta::decode(*m_base->plain(), data, m_size);
+    }
+    return std::make_shared<const std::string>(std::move(data));
+}
+
+SnapshotChunk* SnapshotWriter::create(std::string &&data, uint64_t hash, SnapshotChunk *prev, SnapshotEncoder &encoder)
+{
+    if (prev != nullptr && prev != m_base && prev->m_payload->encoded() && ! prev->m_payload->is_delta()) {
+        // The previous chunk is stored in full, because it was small, it had no base or its delta was not small enough.
+        // Encode the next deltas against it.
+        if (SnapshotChunk *base = prev->m_base; base != nullptr) {
+            prev->m_base = nullptr;
+            -- base->m_num_deltas;
+            base->release_if_unused();
+        }
+        this->set_base(prev);
+    }
+
+    auto           plain = std::make_shared<const std::string>(std::move(data));
+    bool           small = plain->size() < SnapshotEncoder::min_size;
+    SnapshotChunk *chunk = new SnapshotChunk(plain, hash, small ? nullptr : m_base);
+    if (! small) {
+        std::shared_ptr<const std::string> base_plain;
+        if (chunk->m_base != nullptr) {
+            // The plain data of the base are pinned.
+            base_plain = chunk->m_base->m_payload->cached();
+            assert(base_plain);
+        }
+        encoder.run([payload = chunk->m_payload, base_plain]() { payload->encode(base_plain); });
+    }
+    if (m_base == nullptr)
+        // Stored in full, encode the next deltas against it.
+        this->set_base(chunk);
+
+    m_last_id    = chunk->m_id;
+    m_last_plain = std::move(plain);
+    return chunk;
+}
+
+std::shared_ptr<const std::string> SnapshotWriter::plain(const SnapshotChunk &chunk) const
+{
+    return chunk.m_id == m_last_id ? m_last_plain : chunk.plain();
+}
+
+bool SnapshotWriter::matches(const SnapshotChunk &chunk, const std::string &data, uint64_t hash) const
+{
+    return chunk.m_size == data.size() && chunk.m_hash == hash && *this->plain(chunk) == data;
+}
+
+std::string SnapshotWriter::load(const SnapshotChunk &chunk)
+{
+    m_last_plain = this->plain(chunk);
+    m_last_id    = chunk.m_id;
+    return *m_last_plain;
+}
+
+void SnapshotWriter::release_unreferenced_base()
+{
+    if (m_base != nullptr && m_base->m_refcnt == 0)
+        this->set_base(nullptr);
+}
+
+size_t SnapshotWriter::memsize() const
+{
+    // Count the plain data only if not held by a chunk, too.
+    return m_last_plain && m_last_plain.use_count() == 1 ? m_last_plain->size() : 0;
+}
+
+void SnapshotWriter::set_base(SnapshotChunk *chunk)
+{
+    if (chunk == m_base)
+        return;
+    if (SnapshotChunk *old_base = m_base; old_base != nullptr) {
+        m_base = nullptr;
+        old_base->m_is_base = false;
+        old_base->m_payload->unpin();
+        old_base->release_if_unused();
+    }
+    if (chunk != nullptr) {
+        assert(chunk->m_base == nullptr);
+        chunk->m_is_base = true;
+        chunk->m_payload->pin(this->plain(*chunk));
+        m_base = chunk;
+    }
+}
+
+} // namespace Slic3r
@@ -0,0 +1,136 @@
+#ifndef slic3r_SnapshotDelta_hpp_
+#define slic3r_SnapshotDelta_hpp_
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <tbb/task_group.h>
+
+namespace Slic3r {
+
+// Binary delta of serialized data against an older serialization of the same object.
+// The delta is a sequence of (literal length, literal bytes, copy offset, copy length) records,
+// the copies referencing the base data. The numbers are stored as varints, 7 bits per byte,
+// the lowest bits first, the highest bit of a byte set if more bytes follow.
+namespace delta {
+
+void        append_varint(std::string &out, size_t v);
+// Read a varint starting at pos, advance pos behind it.
+size_t      read_varint(const std::string &in, size_t &pos);
+
+// Returns an empty string if the delta would not be smaller than max_size.
+std::string encode(const std::string &base, const std::string &data, size_t max_size);
+std::string decode(const std::string &base, const std::string &delta, size_t size);
+
+} // namespace delta
+
+// Encodes and compresses the snapshot data at a background thread, so that taking a snapshot does not block the UI.
+class SnapshotEncoder
+{
+public:
+    ~SnapshotEncoder() { this->wait(); }
+
+    // Data smaller than this are neither encoded as a delta nor compressed.
+    static constexpr const size_t min_size = 4096;
+
+    template<typename Fn>
+    void run(Fn &&fn) { m_tasks.run(std::forward<Fn>(fn)); }
+    void wait() { m_tasks.wait(); }
+
+private:
+    tbb::task_group m_tasks;
+};
+
+class SnapshotPayload;
+
+// Serialized data of a snapshot of a mutable object, shared by the Undo / Redo history intervals with the same data.
+// The data are stored either in full or as a delta against a base chunk of the same object, the base being stored in full,
+// thus releasing chunks of a history in any order never breaks a chain of deltas.
+// A chunk is released once it is referenced by no history interval, no delta and it is not the base of its SnapshotWriter.
+class SnapshotChunk
+{
+public:
+    size_t      size() const { return m_size; }
+    uint64_t    hash() const { return m_hash; }
+    // First 8 bytes of the serialized data, which is the timestamp for the objects providing it.
+    uint64_t    head() const { return m_head; }
+    // Number of the history intervals referencing this chunk.
+    size_t      refcnt() const { return m_refcnt; }
+    // Number of the deltas referencing this chunk as their base.
+    size_t      num_deltas() const { return m_num_deltas; }
+    const SnapshotChunk* base() const { return m_base; }
+    // Is the chunk stored as a delta? Known once the background encoding of this chunk finished.
+    bool        is_delta() const;
+
+    // Memory held by this chunk, not counting its base.
+    size_t      memsize() const;
+    // Memory attributed to one history interval referencing this chunk. This chunk and its base are split evenly
+    // among the history intervals and the deltas referencing them, so that the memory is counted just once.
+    size_t      interval_memsize() const;
+
+    void        add_ref() { ++ m_refcnt; }
+    void        release_ref() { assert(m_refcnt > 0); -- m_refcnt; this->release_if_unused(); }
+
+    static uint64_t hash(const std::string &data);
+
+private:
+    SnapshotChunk(std::shared_ptr<const std::string> data, uint64_t hash, SnapshotChunk *base);
+    ~SnapshotChunk();
+
+    std::shared_ptr<const std::string> plain() const;
+    void        release_if_unused();
+
+    size_t                              m_refcnt { 1 };
+    size_t                              m_num_deltas { 0 };
+    size_t                              m_size;
+    uint64_t                            m_hash;
+    uint64_t                            m_head { 0 };
+    // Unique ID of this chunk, to recognize the chunk the plain data were cached for.
+    uint64_t                            m_id;
+    // If not null, the payload may be a delta against the base.
+    SnapshotChunk                      *m_base;
+    bool                                m_is_base { false };
+    std::shared_ptr<SnapshotPayload>    m_payload;
+
+    friend class SnapshotWriter;
+};
+
+// Creates the snapshot chunks of a single mutable object. Keeps the plain data needed to take a snapshot without decompressing
+// anything: The data of the base chunk, against which the deltas are encoded, and the data last saved or loaded,
+// against which the next snapshot is compared.
+class SnapshotWriter
+{
+public:
+    SnapshotWriter() = default;
+    SnapshotWriter(const SnapshotWriter &rhs) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter &rhs) = delete;
+    ~SnapshotWriter() { this->set_base(nullptr); }
+
+    // Create a chunk referenced by a single history interval. prev is the last chunk of the object history, if any.
+    // The chunk is encoded as a delta against the current base and compressed by the encoder in the background.
+    SnapshotChunk*  create(std::string &&data, uint64_t hash, SnapshotChunk *prev, SnapshotEncoder &encoder);
+    // Are the data equal to the data of the chunk?
+    bool            matches(const SnapshotChunk &chunk, const std::string &data, uint64_t hash) const;
+    // Serialized data of the chunk, decompressed and reconstructed from the delta if needed.
+    std::string     load(const SnapshotChunk &chunk);
+    // To be called after history intervals were released: Don't keep a base not referenced by any history interval.
+    void            release_unreferenced_base();
+    // Memory held by the cached plain data, which are not shared with the chunks.
+    size_t          memsize() const;
+
+private:
+    void            set_base(SnapshotChunk *chunk);
+    std::shared_ptr<const std::string> plain(const SnapshotChunk &chunk) const;
+
+    SnapshotChunk                      *m_base { nullptr };
+    // Plain data last saved or loaded and the ID of their chunk.
+    uint64_t                            m_last_id { 0 };
+    std::shared_ptr<const std::string>  m_last_plain;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_SnapshotDelta_hpp_
@@ -520,6 +520,8 @@ bool TriangleSelector::select_triangle(int facet_idx, EnforcerBlockerType type,
     if (! select_triangle_recursive(facet_idx, neighbors, type, triangle_splitting))
         return false;
 
+    touch_source_triangle(m_triangles[facet_idx].source_triangle);
+
     // In case that all children are leafs and have the same state now,
     // they may be removed and substituted by the parent triangle.
     remove_useless_children(facet_idx);
@@ -916,6 +918,7 @@ void TriangleSelector::set_facet(int facet_idx, EnforcerBlockerType state)
     undivide_triangle(facet_idx);
     assert(! m_triangles[facet_idx].is_split());
     m_triangles[facet_idx].set_state(state);
+    touch_source_triangle(facet_idx);
 }
 
 // called by select_patch()->select_triangle()...select_triangle()
@@ -1126,6 +1129,16 @@ void TriangleSelector::remove_useless_children(int facet_idx)
     // If we got here, the children can be removed.
     undivide_triangle(facet_idx);
     tr.set_state(first_child_type);
+    touch_source_triangle(tr.source_triangle);
+}
+
+void TriangleSelector::touch_source_triangle(int source_triangle)
+{
+    assert(source_triangle >= 0 && source_triangle < int(m_serialized_dirty_mask.size()));
+    if (! m_serialized_dirty_mask[source_triangle]) {
+        m_serialized_dirty_mask[source_triangle] = true;
+        m_serialized_dirty.emplace_back(source_triangle);
+    }
 }
 
 void TriangleSelector::garbage_collect()
@@ -1206,6 +1219,11 @@ void TriangleSelector::reset()
     m_orig_size_vertices = int(m_vertices.size());
     m_orig_size_indices  = int(m_triangles.size());
 
+    // Nothing is painted, which serializes to empty data.
+    m_serialized.first.clear();
+    m_serialized.second.clear();
+    m_serialized_dirty.clear();
+    m_serialized_dirty_mask.assign(m_orig_size_indices, false);
 }
 
 void TriangleSelector::set_edge_limit(float edge_limit)
@@ -1585,19 +1603,44 @@ std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> TriangleSelector:
         }
     } out { this };
 
-    out.data.first.reserve(m_orig_size_indices);
-    for (int i=0; i<m_orig_size_indices; ++i)
-        if (const Triangle& tr = m_triangles[i]; tr.is_split() || tr.get_state() != EnforcerBlockerType::NONE) {
-            // Store index of the first bit assigned to ith triangle.
-            out.data.first.emplace_back(i, int(out.data.second.size()));
-            // out the triangle bits.
-            out.serialize(i);
+    if (! m_serialized_dirty.empty()) {
+        // Merge the previous data of the unmodified triangles with the modified triangles encoded again,
+        // both sorted by the triangle index.
+        std::sort(m_serialized_dirty.begin(), m_serialized_dirty.end());
+        const std::vector<std::pair<int, int>> &old_triangles = m_serialized.first;
+        const std::vector<bool>                &old_bits      = m_serialized.second;
+        out.data.first.reserve(old_triangles.size() + m_serialized_dirty.size());
+        out.data.second.reserve(old_bits.size());
+        auto it_dirty = m_serialized_dirty.begin();
+        for (size_t i = 0; i <= old_triangles.size(); ++ i) {
+            int triangle_id = i < old_triangles.size() ? old_triangles[i].first : m_orig_size_indices;
+            for (; it_dirty != m_serialized_dirty.end() && *it_dirty <= triangle_id; ++ it_dirty)
+                if (const Triangle &tr = m_triangles[*it_dirty]; tr.is_split() || tr.get_state() != EnforcerBlockerType::NONE) {
+                    // Store index of the first bit assigned to ith triangle.
+                    out.data.first.emplace_back(*it_dirty, int(out.data.second.size()));
+                    // out the triangle bits.
+                    out.serialize(*it_dirty);
+                }
+            if (i < old_triangles.size() && ! m_serialized_dirty_mask[triangle_id]) {
+                // Copy the bits of an unmodified triangle.
+                auto bits_begin = old_bits.begin() + old_triangles[i].second;
+                auto bits_end   = i + 1 < old_triangles.size() ? old_bits.begin() + old_triangles[i + 1].second : old_bits.end();
+                out.data.first.emplace_back(triangle_id, int(out.data.second.size()));
+                out.data.second.insert(out.data.second.end(), bits_begin, bits_end);
+            }
         }
 
-    // May be stored onto Undo / Redo stack, thus conserve memory.
-    out.data.first.shrink_to_fit();
-    out.data.second.shrink_to_fit();
-    return out.data;
+        for (int triangle_id : m_serialized_dirty)
+            m_serialized_dirty_mask[triangle_id] = false;
+        m_serialized_dirty.clear();
+
+        // May be stored onto Undo / Redo stack, thus conserve memory.
+        out.data.first.shrink_to_fit();
+        out.data.second.shrink_to_fit();
+        m_serialized = std::move(out.data);
+    }
+
+    return m_serialized;
 }
 
 void TriangleSelector::deserialize(const std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> &data, bool needs_reset)
@@ -1699,6 +1742,15 @@ void TriangleSelector::deserialize(const std::pair<std::vector<std::pair<int, in
                 break;
         }
     }
+
+    if (m_serialized.first.empty() && m_serialized_dirty.empty() &&
+        std::adjacent_find(data.first.begin(), data.first.end(),
+                           [](const auto &l, const auto &r) { return l.first >= r.first; }) == data.first.end())
+        // Deserialized into an empty selector, the data are the serialized state.
+        m_serialized = data;
+    else
+        for (const std::pair<int, int> &triangle_id_and_ibit : data.first)
+            touch_source_triangle(triangle_id_and_ibit.first);
 }
 
 // Lightweight variant of deserialization, which only tests whether a face of test_state exists.
@@ -1763,8 +1815,10 @@ void TriangleSelector::seed_fill_unselect_all_triangles()
 void TriangleSelector::seed_fill_apply_on_triangles(EnforcerBlockerType new_state)
 {
     for (Triangle &triangle : m_triangles)
-        if (!triangle.is_split() && triangle.is_selected_by_seed_fill())
+        if (!triangle.is_split() && triangle.is_selected_by_seed_fill()) {
             triangle.set_state(new_state);
+            touch_source_triangle(triangle.source_triangle);
+        }
 
     for (Triangle &triangle : m_triangles)
         if (triangle.is_split() && triangle.valid()) {
@@ -238,6 +238,8 @@ public:
 
     // Store the division trees in compact form (a long stream of bits for each triangle of the original mesh).
     // First vector contains pairs of (triangle index, first bit in the second vector).
+    // Only the triangles of the original mesh modified since the last serialize() / deserialize() are encoded again,
+    // the bits of the others are copied from the previous result.
     std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> serialize() const;
 
     // Load serialized data. Assumes that correct mesh is loaded.
@@ -339,6 +341,12 @@ protected:
     // Zero indicates an uninitialized state.
     float m_old_cursor_radius_sqr = 0;
 
+    // Result of the last serialize() or deserialize(), up to date except for the original triangles
+    // listed in m_serialized_dirty (unsorted, each at most once, flagged in m_serialized_dirty_mask).
+    mutable std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> m_serialized;
+    mutable std::vector<int>  m_serialized_dirty;
+    mutable std::vector<bool> m_serialized_dirty_mask;
+
     // Private functions:
 private:
     bool select_triangle(int facet_idx, EnforcerBlockerType type, bool triangle_splitting);
@@ -346,6 +354,8 @@ private:
     void undivide_triangle(int facet_idx);
     void split_triangle(int facet_idx, const Vec3i &neighbors);
     void remove_useless_children(int facet_idx); // No hidden meaning. Triangles are meant.
+    // Mark the original triangle to be serialized again.
+    void touch_source_triangle(int source_triangle);
     bool is_facet_clipped(int facet_idx, const ClippingPlane &clp) const;
     int  push_triangle(int a, int b, int c, int source_triangle, EnforcerBlockerType state = EnforcerBlockerType{0});
     void perform_split(int facet_idx, const Vec3i &neighbors, EnforcerBlockerType old_state);
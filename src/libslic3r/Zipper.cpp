@@ -3,6 +3,7 @@
 #include "Exception.hpp"
 #include "Zipper.hpp"
 #include "miniz_extension.hpp"
+#include "ParallelDeflate.hpp"
 #include <boost/log/trivial.hpp>
 #include "I18N.hpp"
 
@@ -84,6 +85,23 @@ Zipper &Zipper::operator=(Zipper &&m) {
     return *this;
 }
 
+// Entries large enough to be split into several chunks are compressed on all cores.
+static bool add_mem(mz_zip_archive &arch, const std::string &name,
+                    const void *data, size_t l, Zipper::e_compression compression)
+{
+    int level = MZ_NO_COMPRESSION;
+    switch (compression) {
+    case Zipper::NO_COMPRESSION: level = MZ_NO_COMPRESSION; break;
+    case Zipper::FAST_COMPRESSION: level = MZ_BEST_SPEED; break;
+    case Zipper::TIGHT_COMPRESSION: level = MZ_BEST_COMPRESSION; break;
+    }
+
+    if(level != MZ_NO_COMPRESSION && l >= 2 * DEFLATE_CHUNK_SIZE)
+        return zip_add_mem_parallel(arch, name, data, l, level);
+
+    return mz_zip_writer_add_mem(&arch, name.c_str(), data, l, mz_uint(level));
+}
+
 void Zipper::add_entry(const std::string &name)
 {
     if(!m_impl->is_alive()) return;
@@ -97,14 +115,7 @@ void Zipper::add_entry(const std::string &name, const void *data, size_t l)
     if(!m_impl->is_alive()) return;
 
     finish_entry();
-    mz_uint cmpr = MZ_NO_COMPRESSION;
-    switch (m_compression) {
-    case NO_COMPRESSION: cmpr = MZ_NO_COMPRESSION; break;
-    case FAST_COMPRESSION: cmpr = MZ_BEST_SPEED; break;
-    case TIGHT_COMPRESSION: cmpr = MZ_BEST_COMPRESSION; break;
-    }
-
-    if(!mz_zip_writer_add_mem(&m_impl->arch, name.c_str(), data, l, cmpr))
+    if(!add_mem(m_impl->arch, name, data, l, m_compression))
         m_impl->blow_up();
 
     m_entry.clear();
@@ -116,18 +127,8 @@ void Zipper::finish_entry()
     if(!m_impl->is_alive()) return;
 
     if(!m_data.empty() && !m_entry.empty()) {
-        mz_uint compression = MZ_NO_COMPRESSION;
-
-        switch (m_compression) {
-        case NO_COMPRESSION: compression = MZ_NO_COMPRESSION; break;
-        case FAST_COMPRESSION: compression = MZ_BEST_SPEED; break;
-        case TIGHT_COMPRESSION: compression = MZ_BEST_COMPRESSION; break;
-        }
-
-        if(!mz_zip_writer_add_mem(&m_impl->arch, m_entry.c_str(),
-                                  m_data.c_str(),
-                                  m_data.size(),
-                                  compression)) m_impl->blow_up();
+        if(!add_mem(m_impl->arch, m_entry, m_data.c_str(), m_data.size(),
+                    m_compression)) m_impl->blow_up();
     }
 
     m_data.clear();
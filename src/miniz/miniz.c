@@ -6883,6 +6883,28 @@ mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context *pContext, co
     return MZ_FALSE;
 }
 
+mz_bool mz_zip_writer_add_staged_compressed_data(mz_zip_writer_staged_context *pContext, const void *pComp_buf, size_t comp_n, size_t uncomp_n, mz_uint32 uncomp_crc32)
+{
+    if (pContext->file_ofs + uncomp_n > pContext->max_size || comp_n > 0x7FFFFFFF)
+    {
+        mz_zip_set_error(pContext->pZip, MZ_ZIP_FILE_READ_FAILED);
+        pContext->pZip->m_pFree(pContext->pZip->m_pAlloc_opaque, pContext->pCompressor);
+        pContext->pCompressor = NULL;
+        return MZ_FALSE;
+    }
+
+    pContext->file_ofs += uncomp_n;
+    pContext->uncomp_crc32 = uncomp_crc32;
+
+    if (comp_n == 0 || mz_zip_writer_add_put_buf_callback(pComp_buf, (int)comp_n, &pContext->add_state))
+        return MZ_TRUE;
+
+    mz_zip_set_error(pContext->pZip, MZ_ZIP_FILE_WRITE_FAILED);
+    pContext->pZip->m_pFree(pContext->pZip->m_pAlloc_opaque, pContext->pCompressor);
+    pContext->pCompressor = NULL;
+    return MZ_FALSE;
+}
+
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context *pContext)
 {
     if (! mz_zip_writer_add_staged_data(pContext, NULL, 0) ||
@@ -1353,6 +1353,11 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
     const char* user_extra_data, mz_uint user_extra_data_len, const char* user_extra_data_central, mz_uint user_extra_data_central_len);
 mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context* pContext, const char* pRead_buf, size_t n);
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context* pContext);
+/* Appends raw deflate data compressed by the caller to a file being added piecewise. The deflate data must be byte aligned */
+/* and must not contain a final block, mz_zip_writer_add_staged_finish() terminates the stream. */
+/* uncomp_crc32 is the CRC-32 of all the uncompressed data of the file including this piece. */
+/* Don't mix with mz_zip_writer_add_staged_data() on the same file. */
+mz_bool mz_zip_writer_add_staged_compressed_data(mz_zip_writer_staged_context* pContext, const void* pComp_buf, size_t comp_n, size_t uncomp_n, mz_uint32 uncomp_crc32);
 
 /* Adds a file to an archive by fully cloning the data from another archive. */
 /* This function fully clones the source file's compressed data (no recompression), along with its full filename, extra data (it may add or modify the zip64 local header extra data field), and the optional descriptor following the compressed data. */
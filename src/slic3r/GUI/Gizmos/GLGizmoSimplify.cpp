@@ -511,7 +511,7 @@ void GLGizmoSimplify::process()
         try {
             for (const auto& it : its) {
                 float me = max_error;
-                its_quadric_edge_collapse(*it.second, triangle_count, &me, throw_on_cancel, statusfn);
+                its_quadric_edge_collapse_parallel(*it.second, triangle_count, &me, throw_on_cancel, statusfn);
             }
         } catch (SimplifyCanceledException &) {
             std::lock_guard lk(m_state_mutex);
@@ -180,6 +180,11 @@ void ArrangeJob::process(Ctl &ctl)
     if (count == 0) // Should be taken care of by plater, but doesn't hurt
         return;
 
+    // Large scenes are arranged in the high throughput mode, refining only
+    // the most promising candidate positions of each item.
+    if (count > 100)
+        params.max_candidates = 32;
+
     ctl.update_status(0, arrangestr);
 
     params.stopcondition = [&ctl]() { return ctl.was_canceled(); };
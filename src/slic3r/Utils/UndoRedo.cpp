@@ -19,6 +19,7 @@
 
 #include <libslic3r/PrintConfig.hpp>
 #include <libslic3r/ObjectID.hpp>
+#include <libslic3r/SnapshotDelta.hpp>
 #include <libslic3r/Utils.hpp>
 
 #include "slic3r/GUI/3DScene.hpp"
@@ -339,45 +340,30 @@ private:
 struct MutableHistoryInterval
 {
 private:
-	struct Data
-	{
-		// Reference counter of this data chunk. We may have used shared_ptr, but the shared_ptr is thread safe
-		// with the associated cost of CPU cache invalidation on refcount change.
-		size_t		refcnt;
-		size_t		size;
-		char 		data[1];
-
-		// The serialized data matches the data stored here.
-		bool 		matches(const std::string& rhs) { return this->size == rhs.size() && memcmp(this->data, rhs.data(), this->size) == 0; }
-
-		// The timestamp matches the timestamp serialized in the data stored here.
-		bool 		matches_timestamp(uint64_t timestamp) { assert(timestamp > 0);  assert(this->size > 8); return memcmp(this->data, &timestamp, 8) == 0; }
-	};
-
-	Interval    m_interval;
-	Data	   *m_data;
+	Interval    	m_interval;
+	// Reference counted by the history intervals. The chunk is either stored in full, or as a delta against another chunk.
+	SnapshotChunk  *m_data;
 
 public:
-	MutableHistoryInterval(const Interval &interval, const std::string &input_data) : m_interval(interval), m_data(nullptr) {
-		m_data = (Data*)new char[offsetof(Data, data) + input_data.size()];
-		m_data->refcnt = 1;
-		m_data->size = input_data.size();
-		memcpy(m_data->data, input_data.data(), input_data.size());
+	// Take over the single reference of a newly created chunk.
+	MutableHistoryInterval(const Interval &interval, SnapshotChunk *data) : m_interval(interval), m_data(data) {
+		assert(m_data->refcnt() == 1);
 	}
 
 	MutableHistoryInterval(const Interval &interval, MutableHistoryInterval &other) : m_interval(interval), m_data(other.m_data) {
-		++ m_data->refcnt;
+		m_data->add_ref();
 	}
 
 	// as a key for std::lower_bound
 	MutableHistoryInterval(const size_t begin, const size_t end) : m_interval(begin, end), m_data(nullptr) {}
 
 	MutableHistoryInterval(MutableHistoryInterval&& rhs) : m_interval(rhs.m_interval), m_data(rhs.m_data) { rhs.m_data = nullptr; }
-	MutableHistoryInterval& operator=(MutableHistoryInterval&& rhs) { m_interval = rhs.m_interval; m_data = rhs.m_data; rhs.m_data = nullptr; return *this; }
+	// The data held before are handed over to rhs to be released with it.
+	MutableHistoryInterval& operator=(MutableHistoryInterval&& rhs) { m_interval = rhs.m_interval; std::swap(m_data, rhs.m_data); return *this; }
 
 	~MutableHistoryInterval() {
-		if (m_data != nullptr && -- m_data->refcnt == 0)
-			delete[] (char*)m_data;
+		if (m_data != nullptr)
+			m_data->release_ref();
 	}
 
 	const Interval& interval() const { return m_interval; }
@@ -391,18 +377,13 @@ public:
 	bool		operator<(const MutableHistoryInterval& rhs) const { return m_interval < rhs.m_interval; }
 	bool 		operator==(const MutableHistoryInterval& rhs) const { return m_interval == rhs.m_interval; }
 
-	const char* data() const { return m_data->data; }
-	size_t  	size() const { return m_data->size; }
-	size_t		refcnt() const { return m_data->refcnt; }
-	bool		matches(const std::string& data) { return m_data->matches(data); }
-	bool		matches_timestamp(uint64_t timestamp) { return m_data->matches_timestamp(timestamp); }
-	size_t 		memsize() const {
-		return m_data->refcnt == 1 ?
-			// Count just the size of the snapshot data.
-			m_data->size :
-			// Count the size of the snapshot data divided by the number of references, rounded up.
-			(m_data->size + m_data->refcnt - 1) / m_data->refcnt;
-	}
+	SnapshotChunk* 	chunk() const { return m_data; }
+	size_t  	size() const { return m_data->size(); }
+	size_t		refcnt() const { return m_data->refcnt(); }
+	// The timestamp matches the timestamp serialized in the data stored here.
+	bool		matches_timestamp(uint64_t timestamp) const { assert(timestamp > 0); assert(m_data->size() > 8); return m_data->head() == timestamp; }
+	// The snapshot data and its base are shared by the intervals and deltas referencing them.
+	size_t 		memsize() const { return m_data->interval_memsize(); }
 
 private:
 	MutableHistoryInterval(const MutableHistoryInterval &rhs);
@@ -417,6 +398,8 @@ private:
 // The history of a single mutable object may not be continuous, as an mutable object may
 // be removed from the scene while being kept at the Copy / Paste stack, therefore an object snapshot
 // with the same serialized object data may be shared by multiple history intervals.
+// Large serialized data are stored as a delta against the previous data of the same object if the delta
+// is small enough, and they are compressed in the background.
 template<typename T>
 class MutableObjectHistory : public ObjectHistory<MutableHistoryInterval>
 {
@@ -432,9 +415,27 @@ public:
 		memsize += m_history.size() * sizeof(MutableHistoryInterval);
 		for (const MutableHistoryInterval &interval : m_history)
 			memsize += interval.memsize();
+		memsize += m_writer.memsize();
 		return memsize;
 	}
 
+	// Release the history intervals, then let the writer drop its base if no interval references it anymore.
+	size_t release_before_timestamp(size_t timestamp) override {
+		size_t mem_released = ObjectHistory<MutableHistoryInterval>::release_before_timestamp(timestamp);
+		m_writer.release_unreferenced_base();
+		return mem_released;
+	}
+	size_t release_after_timestamp(size_t timestamp) override {
+		size_t mem_released = ObjectHistory<MutableHistoryInterval>::release_after_timestamp(timestamp);
+		m_writer.release_unreferenced_base();
+		return mem_released;
+	}
+	size_t release_between_timestamps(size_t timestamp_start, size_t timestamp_end) override {
+		size_t mem_released = ObjectHistory<MutableHistoryInterval>::release_between_timestamps(timestamp_start, timestamp_end);
+		m_writer.release_unreferenced_base();
+		return mem_released;
+	}
+
 	// If an object provides a reliable timestamp and the object serializes the timestamp first,
 	// then we may just check the validity of the timestamp against the last snapshot without 
 	// having to serialize the whole object. This reduces the amount of serialization and memcmp 
@@ -456,28 +457,30 @@ public:
 		return false;
 	}
 
-	void save(size_t active_snapshot_time, size_t current_time, const std::string &data) {
+	void save(size_t active_snapshot_time, size_t current_time, std::string &&data, SnapshotEncoder &encoder) {
 		assert(m_history.empty() || m_history.back().end() <= active_snapshot_time);
+		uint64_t data_hash = SnapshotChunk::hash(data);
+		SnapshotChunk *prev = m_history.empty() ? nullptr : m_history.back().chunk();
 		if (m_history.empty() || m_history.back().end() < active_snapshot_time) {
-			if (! m_history.empty() && m_history.back().matches(data))
+			if (prev != nullptr && m_writer.matches(*prev, data, data_hash))
 				// Share the previous data by reference counting.
 				m_history.emplace_back(Interval(current_time, current_time + 1), m_history.back());
 			else
 				// Allocate new data.
-				m_history.emplace_back(Interval(current_time, current_time + 1), data);
+				m_history.emplace_back(Interval(current_time, current_time + 1), m_writer.create(std::move(data), data_hash, prev, encoder));
 		} else {
 			assert(! m_history.empty());
 			assert(m_history.back().end() == active_snapshot_time);
-			if (m_history.back().matches(data))
+			if (m_writer.matches(*prev, data, data_hash))
 				// Just extend the last interval using the old data.
 				m_history.back().extend_end(current_time + 1);
 			else
 				// Allocate new data time continuous with the previous data.
-				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), data);
+				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), m_writer.create(std::move(data), data_hash, prev, encoder));
 		}
 	}
 
-	std::string load(size_t timestamp) const {
+	std::string load(size_t timestamp) {
 		assert(! m_history.empty());
 		auto it = std::lower_bound(m_history.begin(), m_history.end(), MutableHistoryInterval(timestamp, timestamp));
 		if (it == m_history.end() || it->begin() > timestamp) {
@@ -485,7 +488,7 @@ public:
 			-- it;
 		}
 		assert(timestamp >= it->begin() && timestamp < it->end());
-		return std::string(it->data(), it->data() + it->size());
+		return m_writer.load(*it->chunk());
 	}
 
 	// Currently all mutable snapshots are mandatory.
@@ -497,7 +500,7 @@ public:
 	std::string format() override {
 		std::string out = typeid(T).name();
 		for (const MutableHistoryInterval &interval : m_history)
-			out += std::string(", ptr:") + ptr_to_string(interval.data()) + " len:" + std::to_string(interval.size()) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
+			out += std::string(", ptr:") + ptr_to_string(interval.chunk()) + " len:" + std::to_string(interval.size()) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
 		return out;
 	}
 #endif /* SLIC3R_UNDOREDO_DEBUG */
@@ -505,6 +508,10 @@ public:
 #ifndef NDEBUG
 	bool valid() override;
 #endif /* NDEBUG */
+
+private:
+	// Creates the data chunks, keeps the plain data to compare the next snapshot with and to encode the deltas against.
+	SnapshotWriter 	m_writer;
 };
 
 #ifndef NDEBUG
@@ -527,16 +534,16 @@ bool MutableObjectHistory<T>::valid()
 {
 	// Verify that the history intervals are sorted and do not overlap, and that the data reference counters are correct.
 	if (! m_history.empty()) {
-		std::map<const char*, size_t> refcntrs;
-		assert(m_history.front().data() != nullptr);
-		++ refcntrs[m_history.front().data()];
+		std::map<const SnapshotChunk*, size_t> refcntrs;
+		assert(m_history.front().chunk() != nullptr);
+		++ refcntrs[m_history.front().chunk()];
 		for (size_t i = 1; i < m_history.size(); ++ i) {
 			assert(m_history[i - 1].interval().strictly_before(m_history[i].interval()));
-			++ refcntrs[m_history[i].data()];
+			++ refcntrs[m_history[i].chunk()];
 		}
 		for (const auto &hi : m_history) {
-			assert(hi.data() != nullptr);
-			assert(refcntrs[hi.data()] == hi.refcnt());
+			assert(hi.chunk() != nullptr);
+			assert(refcntrs[hi.chunk()] == hi.refcnt());
 		}
 	}
 	return true;
@@ -689,6 +696,8 @@ private:
 	size_t 													m_current_time;
 	// Last selection serialized or deserialized.
 	Selection 												m_selection;
+	// Encodes the mutable object snapshots as deltas and compresses them in the background.
+	SnapshotEncoder 										m_encoder;
 };
 
 using InputArchive  = cereal::UserDataAdapter<StackImpl, cereal::BinaryInputArchive>;
@@ -842,7 +851,7 @@ template<typename T> ObjectID StackImpl::save_mutable_object(const T &object)
 			Slic3r::UndoRedo::OutputArchive archive(*this, oss);
 			archive(object);
 		}
-		object_history->save(m_active_snapshot_time, m_current_time, oss.str());
+		object_history->save(m_active_snapshot_time, m_current_time, oss.str(), m_encoder);
 	}
 	return object.id();
 }
@@ -887,7 +896,7 @@ template<typename T> void StackImpl::load_mutable_object(const Slic3r::ObjectID
 	// First find a history stack for the ObjectID of this object instance.
 	auto it_object_history = m_objects.find(id);
 	assert(it_object_history != m_objects.end());
-	auto *object_history = static_cast<const MutableObjectHistory<T>*>(it_object_history->second.get());
+	auto *object_history = static_cast<MutableObjectHistory<T>*>(it_object_history->second.get());
 	// Then get the data associated with the object history and m_active_snapshot_time.
 	std::istringstream iss(object_history->load(m_active_snapshot_time));
 	Slic3r::UndoRedo::InputArchive archive(*this, iss);
@@ -59,3 +59,52 @@ SCENARIO("Model construction", "[Model]") {
         }
     }
 }
+
+SCENARIO("Private copy of the Model synchronized by Print::apply()", "[Model]") {
+    GIVEN("A ModelObject with three volumes applied to a Print") {
+        Model model;
+        ModelObject *model_object = model.add_object();
+        model_object->add_volume(make_cube(20, 20, 20));
+        model_object->add_volume(make_cube(10, 10, 10), ModelVolumeType::PARAMETER_MODIFIER);
+        model_object->add_volume(make_cube(5, 5, 5), ModelVolumeType::SUPPORT_BLOCKER);
+        model_object->add_instance();
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        Print print;
+        print.set_status_silent();
+        print.apply(model, config);
+        const ModelObject &object_copy  = *print.model().objects.front();
+        const ModelVolume *volume_copy0 = object_copy.volumes[0];
+        const ModelVolume *volume_copy1 = object_copy.volumes[1];
+
+        WHEN("one volume is moved, config of another volume is modified and a volume is added") {
+            model_object->volumes[0]->set_offset(Vec3d(1., 2., 3.));
+            model_object->volumes[1]->config.set("perimeters", 5);
+            model_object->add_volume(make_cube(5, 5, 5), ModelVolumeType::SUPPORT_ENFORCER);
+            print.apply(model, config);
+            THEN("the copies of the existing volumes are reused and updated") {
+                REQUIRE(object_copy.volumes.size() == 4);
+                REQUIRE(object_copy.volumes[0] == volume_copy0);
+                REQUIRE(object_copy.volumes[1] == volume_copy1);
+                REQUIRE(object_copy.volumes[0]->get_offset() == Vec3d(1., 2., 3.));
+                REQUIRE(object_copy.volumes[1]->config.get().opt_int("perimeters") == 5);
+                REQUIRE(object_copy.volumes[1]->config.timestamp_matches(model_object->volumes[1]->config));
+                REQUIRE(object_copy.volumes[3]->is_support_enforcer());
+                for (size_t i = 0; i < object_copy.volumes.size(); ++ i) {
+                    REQUIRE(object_copy.volumes[i]->id() == model_object->volumes[i]->id());
+                    REQUIRE(object_copy.volumes[i]->get_object() == &object_copy);
+                    REQUIRE(object_copy.volumes[i]->mesh_ptr() == model_object->volumes[i]->mesh_ptr());
+                }
+            }
+        }
+        WHEN("one volume is moved and another volume is deleted") {
+            model_object->volumes[0]->set_offset(Vec3d(1., 2., 3.));
+            model_object->delete_volume(2);
+            print.apply(model, config);
+            THEN("the copy of the deleted volume is deleted") {
+                REQUIRE(object_copy.volumes.size() == 2);
+                REQUIRE(object_copy.volumes[0] == volume_copy0);
+                REQUIRE(object_copy.volumes[1] == volume_copy1);
+            }
+        }
+    }
+}
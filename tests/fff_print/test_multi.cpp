@@ -6,7 +6,9 @@
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/Geometry/ConvexHull.hpp"
+#include "libslic3r/Layer.hpp"
 #include "libslic3r/Print.hpp"
+#include "libslic3r/TriangleSelector.hpp"
 #include "libslic3r/libslic3r.h"
 
 #include "test_data.hpp"
@@ -269,3 +271,96 @@ SCENARIO("Stacked cubes", "[Multi]")
         }
     }
 }
+
+// A 20x20x20 box with its side walls split into bands of 4mm, which may be painted separately.
+static TriangleMesh banded_box(int num_bands = 5)
+{
+    indexed_triangle_set its;
+    for (int i = 0; i <= num_bands; ++ i)
+        for (const Vec2f &pt : { Vec2f(0.f, 0.f), Vec2f(20.f, 0.f), Vec2f(20.f, 20.f), Vec2f(0.f, 20.f) })
+            its.vertices.emplace_back(pt.x(), pt.y(), 4.f * i);
+    // Two triangles of each wall of each band, the front wall (y = 0) first.
+    for (int i = 0; i < num_bands; ++ i)
+        for (int j = 0; j < 4; ++ j) {
+            int a = 4 * i + j;
+            int b = 4 * i + (j + 1) % 4;
+            its.indices.emplace_back(a, b, b + 4);
+            its.indices.emplace_back(a, b + 4, a + 4);
+        }
+    const int top = 4 * num_bands;
+    its.indices.emplace_back(0, 2, 1);
+    its.indices.emplace_back(0, 3, 2);
+    its.indices.emplace_back(top, top + 1, top + 2);
+    its.indices.emplace_back(top, top + 2, top + 3);
+    return TriangleMesh(std::move(its));
+}
+
+// Paint the front wall of banded_box() band by band.
+static void paint_front_wall(ModelVolume &volume, const std::vector<EnforcerBlockerType> &band_extruders)
+{
+    TriangleSelector selector(volume.mesh());
+    for (int band = 0; band < int(band_extruders.size()); ++ band) {
+        selector.set_facet(8 * band, band_extruders[band]);
+        selector.set_facet(8 * band + 1, band_extruders[band]);
+    }
+    volume.mmu_segmentation_facets.set(selector);
+}
+
+SCENARIO("MMU segmentation of repainted layers", "[Multi]")
+{
+    using EBT = EnforcerBlockerType;
+    auto config = Slic3r::DynamicPrintConfig::full_print_config_with({
+        { "nozzle_diameter",           "0.4, 0.4, 0.4" },
+        { "layer_height",              0.2 },
+        { "first_layer_height",        0.2 },
+        // The top / bottom projection of the painted regions needs an explicit perimeter width.
+        { "perimeter_extrusion_width", 0.45 }
+    });
+
+    Model        model;
+    ModelObject *object = model.add_object();
+    object->name = "object.stl";
+    ModelVolume *volume = object->add_volume(banded_box());
+    object->add_instance();
+    object->ensure_on_bed();
+
+    auto slice = [&config](Print &print, const Model &model) -> const PrintObject& {
+        print.apply(model, config);
+        print.validate();
+        print.set_status_silent();
+        print.get_object(0)->slice();
+        return *print.get_object(0);
+    };
+
+    Print print;
+    paint_front_wall(*volume, { EBT::Extruder2, EBT::Extruder2, EBT::Extruder2, EBT::Extruder2, EBT::Extruder2 });
+    slice(print, model);
+
+    GIVEN("The band from 8mm to 12mm is repainted") {
+        paint_front_wall(*volume, { EBT::Extruder2, EBT::Extruder2, EBT::Extruder3, EBT::Extruder2, EBT::Extruder2 });
+        const PrintObject &po = slice(print, model);
+
+        THEN("Only the layers sliced inside the band are segmented again") {
+            std::vector<size_t> expected;
+            for (size_t layer_idx = 0; layer_idx < po.layer_count(); ++ layer_idx)
+                if (double z = po.get_layer(int(layer_idx))->slice_z; z > 8. && z < 12.)
+                    expected.emplace_back(layer_idx);
+            REQUIRE(! expected.empty());
+            REQUIRE(po.shared_regions()->mmu_segmentation_cache.segmented_layers() == expected);
+        }
+        THEN("The slices are the same as those of the painting segmented from scratch") {
+            Print              print_full;
+            const PrintObject &po_full = slice(print_full, model);
+            REQUIRE(po_full.shared_regions()->mmu_segmentation_cache.segmented_layers().size() == po_full.layer_count());
+            REQUIRE(po.layer_count() == po_full.layer_count());
+            for (size_t layer_idx = 0; layer_idx < po.layer_count(); ++ layer_idx) {
+                const Layer &layer      = *po.get_layer(int(layer_idx));
+                const Layer &layer_full = *po_full.get_layer(int(layer_idx));
+                REQUIRE(layer.region_count() == layer_full.region_count());
+                for (size_t region_idx = 0; region_idx < layer.region_count(); ++ region_idx)
+                    REQUIRE(to_expolygons(layer.get_region(int(region_idx))->slices().surfaces) ==
+                            to_expolygons(layer_full.get_region(int(region_idx))->slices().surfaces));
+            }
+        }
+    }
+}
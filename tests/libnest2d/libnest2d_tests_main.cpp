@@ -15,6 +15,7 @@
 
 #include "boost/multiprecision/integer.hpp"
 #include "boost/rational.hpp"
+#include "boost/filesystem/operations.hpp"
 
 //#include "../tools/libnfpglue.hpp"
 //#include "../tools/nfp_svgnest_glue.hpp"
@@ -47,6 +48,7 @@ struct NfpImpl<S, NfpLevel::CONVEX_ONLY>
 namespace {
 using namespace libnest2d;
 
+// Writes into the temporary directory, not to pollute the working directory.
 template<int64_t SCALE = 1, class It>
 void exportSVG(const char *loc, It from, It to) {
 
@@ -57,7 +59,7 @@ void exportSVG(const char *loc, It from, It to) {
 )raw";
 
     //    for(auto r : result) {
-    std::fstream out(loc, std::fstream::out);
+    std::fstream out((boost::filesystem::temp_directory_path() / loc).string(), std::fstream::out);
     if(out.is_open()) {
         out << svg_header;
         //        Item rbin( RectangleItem(bin.width(), bin.height()) );
@@ -645,6 +647,41 @@ TEST_CASE("PrusaPartsShouldFitIntoTwoBins", "[Nesting]") {
     }
 }
 
+TEST_CASE("Instances with limited starting points should not overlap", "[Nesting]") {
+    auto bin = Box(250000000, 210000000);
+
+    // Instances of a few shapes, which share their no fit polygons.
+    std::vector<Item> parts = prusaParts();
+    std::vector<Item> input;
+    for (size_t i = 0; i < 60; ++i)
+        input.emplace_back(parts[i % 3]);
+
+    NestConfig<> cfg;
+    cfg.placer_config.max_starting_points = 16;
+
+    size_t bins = libnest2d::nest(input, bin, 0, cfg);
+
+    REQUIRE(bins > 0u);
+    REQUIRE(std::all_of(input.begin(), input.end(), [](const Item &itm) {
+        return itm.binId() != BIN_ID_UNSET;
+    }));
+
+    using Pile = TMultiShape<PolygonImpl>;
+    std::vector<Pile> piles(bins);
+    for (auto &itm : input)
+        piles[size_t(itm.binId())].emplace_back(itm.transformedShape());
+
+    for (auto &pile : piles) {
+        REQUIRE(sl::isInside(sl::boundingBox(pile), bin));
+
+        double area_sum = 0.;
+        for (auto &obj : pile)
+            area_sum += sl::area(obj);
+
+        REQUIRE(area_sum == Approx(sl::area(nfp::merge(pile))));
+    }
+}
+
 TEST_CASE("EmptyItemShouldBeUntouched", "[Nesting]") {
     auto bin = Box(250000000, 210000000); // dummy bin
 
@@ -4,7 +4,10 @@
 #include "libslic3r/Format/3mf.hpp"
 #include "libslic3r/Format/STL.hpp"
 
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/replace.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <miniz.h>
 
 using namespace Slic3r;
 
@@ -131,3 +134,116 @@ SCENARIO("2D convex hull of sinking object", "[3mf]") {
     }
 }
 
+
+// Copies a 3mf archive, inserting a comment into the vertices and triangles blocks of the model file,
+// which makes the mesh scanner leave the blocks to expat.
+static bool copy_3mf_for_expat(const std::string &src, const std::string &dst)
+{
+    mz_zip_archive reader;
+    mz_zip_zero_struct(&reader);
+    if (! mz_zip_reader_init_file(&reader, src.c_str(), 0))
+        return false;
+    mz_zip_archive writer;
+    mz_zip_zero_struct(&writer);
+    bool ok = mz_zip_writer_init_file(&writer, dst.c_str(), 0);
+    for (mz_uint i = 0; ok && i < mz_zip_reader_get_num_files(&reader); ++ i) {
+        mz_zip_archive_file_stat stat;
+        ok = mz_zip_reader_file_stat(&reader, i, &stat);
+        size_t size = 0;
+        void  *data = ok ? mz_zip_reader_extract_to_heap(&reader, i, &size, 0) : nullptr;
+        if (data == nullptr)
+            break;
+        std::string content(static_cast<const char*>(data), size);
+        mz_free(data);
+        if (boost::algorithm::ends_with(std::string(stat.m_filename), ".model")) {
+            boost::algorithm::replace_all(content, "<vertices>", "<vertices><!-- expat -->");
+            boost::algorithm::replace_all(content, "<triangles>", "<triangles><!-- expat -->");
+        }
+        ok = mz_zip_writer_add_mem(&writer, stat.m_filename, content.data(), content.size(), MZ_DEFAULT_COMPRESSION);
+    }
+    ok = ok && mz_zip_writer_finalize_archive(&writer);
+    mz_zip_writer_end(&writer);
+    mz_zip_reader_end(&reader);
+    return ok;
+}
+
+SCENARIO("Meshes parsed ahead of the XML parser", "[3mf]") {
+    GIVEN("model with a small and a large object") {
+        Model src_model;
+        load_stl((std::string(TEST_DATA_DIR) + "/test_3mf/Prusa.stl").c_str(), &src_model);
+        // Large enough to be split into several pieces parsed in parallel.
+        src_model.add_object("sphere", "", TriangleMesh(its_make_sphere(10., 0.01)));
+        src_model.add_default_instances();
+        src_model.objects.back()->instances.front()->set_offset({ 50., 0., 10. });
+
+        WHEN("3mf file is loaded with and without the mesh scanner") {
+            std::string test_file  = std::string(TEST_DATA_DIR) + "/test_3mf/scanned.3mf";
+            std::string expat_file = std::string(TEST_DATA_DIR) + "/test_3mf/expat.3mf";
+            store_3mf(test_file.c_str(), &src_model, nullptr, false);
+            REQUIRE(copy_3mf_for_expat(test_file, expat_file));
+
+            Model scanned_model, expat_model;
+            {
+                DynamicPrintConfig config;
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                REQUIRE(load_3mf(test_file.c_str(), config, ctxt, &scanned_model, false));
+                REQUIRE(load_3mf(expat_file.c_str(), config, ctxt, &expat_model, false));
+            }
+            boost::filesystem::remove(test_file);
+            boost::filesystem::remove(expat_file);
+
+            THEN("the models are identical") {
+                REQUIRE(scanned_model.objects.size() == src_model.objects.size());
+                REQUIRE(expat_model.objects.size() == scanned_model.objects.size());
+                for (size_t i = 0; i < scanned_model.objects.size(); ++ i) {
+                    const ModelObject &scanned = *scanned_model.objects[i];
+                    const ModelObject &expat   = *expat_model.objects[i];
+                    REQUIRE(scanned.name == expat.name);
+                    REQUIRE(scanned.instances.size() == expat.instances.size());
+                    REQUIRE(scanned.instances.front()->get_matrix().matrix() == expat.instances.front()->get_matrix().matrix());
+                    REQUIRE(scanned.volumes.size() == expat.volumes.size());
+                    for (size_t j = 0; j < scanned.volumes.size(); ++ j) {
+                        REQUIRE(scanned.volumes[j]->mesh().its.vertices == expat.volumes[j]->mesh().its.vertices);
+                        REQUIRE(scanned.volumes[j]->mesh().its.indices == expat.volumes[j]->mesh().its.indices);
+                    }
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("Repeated export of a modified model", "[3mf]") {
+    GIVEN("model exported once") {
+        Model model;
+        load_stl((std::string(TEST_DATA_DIR) + "/test_3mf/Prusa.stl").c_str(), &model);
+        model.add_object("sphere", "", TriangleMesh(its_make_sphere(10., 0.01)));
+        model.add_default_instances();
+        std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/repeated.3mf";
+        REQUIRE(store_3mf(test_file.c_str(), &model, nullptr, false));
+
+        WHEN("a volume of one object is moved and the model is exported again") {
+            model.objects.front()->volumes.front()->set_offset({ 10., 20., 30. });
+            REQUIRE(store_3mf(test_file.c_str(), &model, nullptr, false));
+
+            Model loaded;
+            {
+                DynamicPrintConfig config;
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                REQUIRE(load_3mf(test_file.c_str(), config, ctxt, &loaded, false));
+            }
+            boost::filesystem::remove(test_file);
+
+            THEN("both the modified and the unmodified object are loaded as exported the second time") {
+                REQUIRE(loaded.objects.size() == model.objects.size());
+                for (size_t i = 0; i < model.objects.size(); ++ i) {
+                    TriangleMesh src_mesh = model.objects[i]->mesh();
+                    TriangleMesh dst_mesh = loaded.objects[i]->mesh();
+                    REQUIRE(src_mesh.its.vertices.size() == dst_mesh.its.vertices.size());
+                    REQUIRE(src_mesh.its.indices == dst_mesh.its.indices);
+                    for (size_t j = 0; j < src_mesh.its.vertices.size(); ++ j)
+                        REQUIRE(dst_mesh.its.vertices[j].isApprox(src_mesh.its.vertices[j]));
+                }
+            }
+        }
+    }
+}
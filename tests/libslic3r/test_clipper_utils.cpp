@@ -382,3 +382,41 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+TEST_CASE("Reused Clipper engines produce the same results as fresh engines", "[ClipperUtils]") {
+    Polygon square { { 0, 0 }, { 1000, 0 }, { 1000, 1000 }, { 0, 1000 } };
+    Polygon hole   { { 200, 200 }, { 200, 800 }, { 800, 800 }, { 800, 200 } };
+    Polygons shifted { square, hole };
+    for (Polygon &p : shifted)
+        p.translate(500, 300);
+
+    SECTION("ClipperLib::Clipper reused for multiple operations") {
+        auto execute = [&square, &hole, &shifted](ClipperLib::Clipper &clipper) {
+            clipper.Clear();
+            clipper.AddPaths(ClipperUtils::PolygonsProvider(Polygons{ square, hole }), ClipperLib::ptSubject, true);
+            clipper.AddPaths(ClipperUtils::PolygonsProvider(shifted), ClipperLib::ptClip, true);
+            ClipperLib::Paths out;
+            clipper.Execute(ClipperLib::ctXor, out, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+            return out;
+        };
+        ClipperLib::Clipper reused;
+        for (size_t i = 0; i < 5; ++ i) {
+            ClipperLib::Clipper fresh;
+            REQUIRE(execute(reused) == execute(fresh));
+        }
+    }
+
+    SECTION("Pooled engines of ClipperUtils") {
+        const Polygons union1  = union_(Polygons{ square, hole }, shifted);
+        const Polygons diff1   = diff(Polygons{ square, hole }, shifted);
+        const Polygons shrink1 = offset(Polygons{ square, hole }, -50.f);
+        const Polygons expand1 = offset(Polygons{ square, hole }, 50.f);
+        for (size_t i = 0; i < 5; ++ i) {
+            REQUIRE(union_(Polygons{ square, hole }, shifted) == union1);
+            REQUIRE(diff(Polygons{ square, hole }, shifted) == diff1);
+            // Negative offset sets ReverseSolution() on the cleanup Clipper, positive offset shall not inherit it.
+            REQUIRE(offset(Polygons{ square, hole }, -50.f) == shrink1);
+            REQUIRE(offset(Polygons{ square, hole }, 50.f) == expand1);
+        }
+    }
+}
@@ -245,3 +245,41 @@ SCENARIO("DynamicPrintConfig serialization", "[Config]") {
         }
     }
 }
+
+SCENARIO("Diff of static and dynamic configs", "[Config]") {
+    GIVEN("PrintObjectConfig with defaults and a modified full DynamicPrintConfig") {
+        PrintObjectConfig  object_config;
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set("layer_height", 0.1);
+        config.set("support_material", true);
+        // Not a PrintObjectConfig option.
+        config.set("perimeters", 7);
+        config.erase("raft_layers");
+        // Reference result, options looked up by their keys.
+        auto diff_by_keys = [](const ConfigBase &lhs, const ConfigBase &rhs) {
+            t_config_option_keys out;
+            for (const t_config_option_key &opt_key : lhs.keys())
+                if (const ConfigOption *l = lhs.option(opt_key), *r = rhs.option(opt_key); l != nullptr && r != nullptr && *l != *r)
+                    out.emplace_back(opt_key);
+            return out;
+        };
+        WHEN("the static config is compared with the dynamic config") {
+            THEN("the options differing in both configs are reported") {
+                REQUIRE(object_config.diff(config) == t_config_option_keys{ "layer_height", "support_material" });
+                REQUIRE(object_config.diff(config) == diff_by_keys(object_config, config));
+                REQUIRE(static_cast<const ConfigBase&>(config).diff(object_config) == diff_by_keys(config, object_config));
+                REQUIRE(! object_config.equals(config));
+                REQUIRE(object_config.equal(config).size() + 2 + 1 == object_config.keys().size());
+            }
+        }
+        WHEN("the static config is compared with another static config") {
+            FullPrintConfig full_config;
+            full_config.apply(config, true);
+            THEN("the options differing in both configs are reported") {
+                REQUIRE(object_config.diff(full_config) == t_config_option_keys{ "layer_height", "support_material" });
+                REQUIRE(full_config.diff(object_config) == diff_by_keys(full_config, object_config));
+                REQUIRE(PrintObjectConfig().equals(object_config));
+            }
+        }
+    }
+}
@@ -11,7 +11,7 @@
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/ShortestPath.hpp"
 
-//#include <random>
+#include <random>
 //#include "libnest2d/tools/benchmark.h"
 #include "libslic3r/SVG.hpp"
 
@@ -19,6 +19,8 @@
 
 #include <unordered_set>
 
+#include <boost/filesystem/operations.hpp>
+
 using namespace Slic3r;
 
 TEST_CASE("Line::parallel_to", "[Geometry]"){
@@ -375,6 +377,42 @@ SCENARIO("Path chaining", "[Geometry]") {
 			}
 		}
 	}
+	GIVEN("Many short segments") {
+		std::mt19937 rng(0);
+		std::uniform_int_distribution<coord_t> pos(0, scaled<coord_t>(100.)), delta(- scaled<coord_t>(2.), scaled<coord_t>(2.));
+		Polylines polylines;
+		for (size_t i = 0; i < 1000; ++ i) {
+			Point pt(pos(rng), pos(rng));
+			polylines.push_back({ pt, pt + Point(delta(rng), delta(rng)) });
+		}
+		auto travel_length = [](const Polylines &polylines) {
+			double length = 0.;
+			for (size_t i = 1; i < polylines.size(); ++ i)
+				length += (polylines[i].first_point() - polylines[i - 1].last_point()).cast<double>().norm();
+			return length;
+		};
+		ChainingParams neighbors;
+		neighbors.max_exchanges = 100;
+		ChainingParams exhaustive = neighbors;
+		exhaustive.restrict_to_neighbors = false;
+		Polylines chained_greedy     = chain_polylines(polylines);
+		Polylines chained_exhaustive = chain_polylines(Polylines(polylines), nullptr, exhaustive);
+		Polylines chained            = chain_polylines(Polylines(polylines), nullptr, neighbors);
+		THEN("All segments are chained, some of them reversed") {
+			auto sorted = [](Polylines polylines) {
+				for (Polyline &pl : polylines)
+					if (pl.last_point() < pl.first_point())
+						pl.reverse();
+				std::sort(polylines.begin(), polylines.end(), [](const Polyline &l, const Polyline &r) { return l.first_point() < r.first_point(); });
+				return polylines;
+			};
+			REQUIRE(sorted(chained) == sorted(polylines));
+		}
+		THEN("Exchanges of connections between neighbors shorten the travel of the greedy chain") {
+			REQUIRE(travel_length(chained) < 0.9 * travel_length(chained_greedy));
+			REQUIRE(travel_length(chained_exhaustive) < 0.9 * travel_length(chained_greedy));
+		}
+	}
 }
 
 SCENARIO("Line distances", "[Geometry]"){
@@ -586,7 +624,7 @@ TEST_CASE("Convex polygon intersection on two squares touching one vertex", "[Ge
     Polygon B = A;
     B.translate(10 / SCALING_FACTOR, 10 / SCALING_FACTOR);
 
-    SVG svg{std::string("one_vertex_touch") + ".svg"};
+    SVG svg{(boost::filesystem::temp_directory_path() / "one_vertex_touch.svg").string()};
     svg.draw(A, "blue");
     svg.draw(B, "green");
     svg.Close();
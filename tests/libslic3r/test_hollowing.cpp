@@ -19,3 +19,52 @@ TEST_CASE("Hollow two overlapping spheres") {
     sphere1.WriteOBJFile("twospheres.obj");
 }
 
+
+TEST_CASE("Hollowing grid cache hits only for the same parts and a fine enough voxel scale", "[Hollowing]") {
+    using namespace Slic3r;
+
+    indexed_triangle_set cube = its_make_cube(10., 10., 10.);
+    indexed_triangle_set moved_cube = cube;
+    for (Vec3f &v : moved_cube.vertices)
+        v.x() += 1.f;
+
+    auto make_parts = [](const indexed_triangle_set &its, csg::CSGType op) {
+        std::vector<csg::CSGPart> parts;
+        parts.emplace_back(&its, op);
+        return parts;
+    };
+
+    size_t hash = sla::csgmesh_hash(make_parts(cube, csg::CSGType::Union));
+    REQUIRE(sla::csgmesh_hash(make_parts(cube, csg::CSGType::Union)) == hash);
+    REQUIRE(sla::csgmesh_hash(make_parts(moved_cube, csg::CSGType::Union)) != hash);
+    REQUIRE(sla::csgmesh_hash(make_parts(cube, csg::CSGType::Difference)) != hash);
+
+    double voxel_scale = 1.;
+    auto   make_grid   = [&cube, voxel_scale] {
+        return mesh_to_grid(cube, MeshToGridParams{}.voxel_scale(float(voxel_scale)));
+    };
+
+    SECTION("The stored grid is found by its keys only") {
+        sla::HollowingGridCache cache;
+        REQUIRE(cache.find(hash, voxel_scale) == nullptr);
+
+        VoxelGridPtr grid = make_grid();
+        const VoxelGrid *grid_ptr = grid.get();
+        cache.store(hash, voxel_scale, std::move(grid));
+
+        REQUIRE(cache.find(hash, voxel_scale) == grid_ptr);
+        REQUIRE(cache.find(hash + 1, voxel_scale) == nullptr);
+        REQUIRE(cache.find(hash, 2. * voxel_scale) == nullptr);
+        // A wall thicker than before needs a coarser grid only.
+        REQUIRE(cache.find(hash, 0.5 * voxel_scale) == grid_ptr);
+
+        cache.clear();
+        REQUIRE(cache.find(hash, voxel_scale) == nullptr);
+    }
+
+    SECTION("A grid over the memory limit is not kept") {
+        sla::HollowingGridCache cache(0);
+        cache.store(hash, voxel_scale, make_grid());
+        REQUIRE(cache.find(hash, voxel_scale) == nullptr);
+    }
+}
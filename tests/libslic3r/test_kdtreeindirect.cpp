@@ -5,6 +5,8 @@
 #include "libslic3r/BoundingBox.hpp"
 #include "libslic3r/PointGrid.hpp"
 
+#include <numeric>
+
 using namespace Slic3r;
 
 //template<class G>
@@ -85,6 +87,65 @@ TEST_CASE("Test kdtree query for a Box", "[KDTreeIndirect]")
     REQUIRE(call_count < pgrid.point_count());
 }
 
+TEST_CASE("Test kdtree query for K closest points", "[KDTreeIndirect]")
+{
+    auto vol = BoundingBox3Base<Vec3f>{{0.f, 0.f, 0.f}, {10.f, 10.f, 10.f}};
+
+    auto pgrid = point_grid(ex_seq, vol, Vec3f{0.5f, 0.5f, 0.5f});
+
+    auto coordfn = [&pgrid] (size_t i, size_t D) { return pgrid.get(i)(int(D)); };
+    KDTreeIndirect<3, float, decltype(coordfn)> tree{coordfn, pgrid.point_count()};
+
+    Vec3f pt{3.1f, 4.7f, 5.2f};
+    std::array<size_t, 8> out = find_closest_points<8>(tree, pt);
+
+    // Brute force search of the same points, sorted by distance.
+    std::vector<size_t> idx(pgrid.point_count());
+    std::iota(idx.begin(), idx.end(), 0);
+    std::partial_sort(idx.begin(), idx.begin() + out.size(), idx.end(), [&pgrid, &pt](size_t l, size_t r) {
+        return (pgrid.get(l) - pt).squaredNorm() < (pgrid.get(r) - pt).squaredNorm();
+    });
+
+    for (size_t i = 0; i < out.size(); ++i) {
+        REQUIRE(out[i] != decltype(tree)::npos);
+        REQUIRE((pgrid.get(out[i]) - pt).squaredNorm() == Approx((pgrid.get(idx[i]) - pt).squaredNorm()));
+    }
+}
+
+TEST_CASE("Test kdtree query after removal of points", "[KDTreeIndirect]")
+{
+    auto vol = BoundingBox3Base<Vec3f>{{0.f, 0.f, 0.f}, {10.f, 10.f, 10.f}};
+
+    auto pgrid = point_grid(ex_seq, vol, Vec3f{0.5f, 0.5f, 0.5f});
+
+    auto coordfn = [&pgrid] (size_t i, size_t D) { return pgrid.get(i)(int(D)); };
+    KDTreeIndirect<3, float, decltype(coordfn)> tree{coordfn, pgrid.point_count()};
+
+    // Remove the points of the lower half of the volume.
+    std::vector<bool> removed(pgrid.point_count(), false);
+    for (size_t i = 0; i < pgrid.point_count(); ++ i)
+        if (pgrid.get(i).z() < 5.f) {
+            tree.remove(i);
+            removed[i] = true;
+        }
+
+    size_t num_calls = 0;
+    auto   filter    = [&removed, &num_calls](size_t idx) { ++ num_calls; return ! removed[idx]; };
+
+    Vec3f  pt{3.1f, 4.7f, 1.2f};
+    size_t closest = find_closest_point(tree, pt, filter);
+    REQUIRE(closest != decltype(tree)::npos);
+    REQUIRE(! removed[closest]);
+    REQUIRE(pgrid.get(closest).z() == Approx(5.f));
+    size_t num_calls_removed = num_calls;
+
+    // The same query with all the points searchable again finds the same point, but visits more of the tree.
+    tree.restore();
+    num_calls = 0;
+    REQUIRE(find_closest_point(tree, pt, filter) == closest);
+    REQUIRE(num_calls_removed < num_calls);
+}
+
 //TEST_CASE("Test kdtree query for a Sphere", "[KDTreeIndirect]") {
 //    auto vol = BoundingBox3Base<Vec3f>{{0.f, 0.f, 0.f}, {10.f, 10.f, 10.f}};
 
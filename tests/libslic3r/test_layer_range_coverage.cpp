@@ -0,0 +1,48 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/LayerRangeCoverage.hpp"
+#include "libslic3r/ClipperUtils.hpp"
+
+using namespace Slic3r;
+
+// Squares shifted by 10 units per layer, so that each range of layers produces a different union / intersection.
+static std::vector<Polygons> shifted_squares(size_t num_layers)
+{
+    std::vector<Polygons> out;
+    for (size_t i = 0; i < num_layers; ++ i) {
+        coord_t x = coord_t(i) * 10;
+        out.push_back({ Polygon{ { x, 0 }, { x + 100, 0 }, { x + 100, 100 }, { x, 100 } } });
+    }
+    return out;
+}
+
+TEST_CASE("LayerRangeCoverage matches sequential Clipper operations", "[LayerRangeCoverage]") {
+    const size_t          num_layers = 23;
+    std::vector<Polygons> layers     = shifted_squares(num_layers);
+    auto                  layer_fn   = [&layers](size_t i) -> const Polygons& { return layers[i]; };
+    const size_t          max_range  = 11;
+
+    LayerRangeCoverage unions(num_layers, layer_fn, LayerRangeCoverage::Mode::Union, max_range);
+    LayerRangeCoverage intersections(num_layers, layer_fn, LayerRangeCoverage::Mode::Intersection, max_range);
+    REQUIRE(unions.max_range() >= max_range);
+    REQUIRE(intersections.max_range() >= max_range);
+
+    for (size_t begin = 0; begin < num_layers; ++ begin)
+        for (size_t end = begin; end <= std::min(num_layers, begin + max_range); ++ end) {
+            Polygons expected_union;
+            Polygons expected_intersection;
+            for (size_t i = begin; i < end; ++ i) {
+                expected_union        = union_(expected_union, layers[i]);
+                expected_intersection = i == begin ? layers[i] : intersection(expected_intersection, layers[i]);
+            }
+            REQUIRE(area(unions.query(begin, end)) == Approx(area(expected_union)));
+            REQUIRE(area(intersections.query(begin, end)) == Approx(area(expected_intersection)));
+        }
+}
+
+TEST_CASE("LayerRangeCoverage of an empty range is empty", "[LayerRangeCoverage]") {
+    std::vector<Polygons> layers = shifted_squares(4);
+    LayerRangeCoverage    index(layers.size(), [&layers](size_t i) -> const Polygons& { return layers[i]; }, LayerRangeCoverage::Mode::Union, 4);
+    REQUIRE(index.query(2, 2).empty());
+    REQUIRE(LayerRangeCoverage().max_range() == 0);
+}
@@ -4,6 +4,7 @@
 #include <test_utils.hpp>
 
 #include <fstream>
+#include <random>
 
 #include <libslic3r/MarchingSquares.hpp>
 #include <libslic3r/SLA/RasterToPolygons.hpp>
@@ -311,6 +312,68 @@ TEST_CASE("Circle with hole in the middle", "[MarchingSquares]") {
     test_expolys(create_raster({1000, 1000}), circle_with_hole(25.), W2x2, "circle_with_hole");   
 }
 
+// Same pixels, one with contiguous row access, the other with per pixel
+// access only.
+struct TestRasterRows { size_t rows, cols; std::vector<uint8_t> buf; };
+struct TestRasterPixels { TestRasterRows rst; };
+
+namespace marchsq {
+
+template<> struct _RasterTraits<TestRasterRows> {
+    using ValueType = uint8_t;
+    static uint8_t get(const TestRasterRows &r, size_t row, size_t col) { return r.buf[row * r.cols + col]; }
+    static size_t rows(const TestRasterRows &r) { return r.rows; }
+    static size_t cols(const TestRasterRows &r) { return r.cols; }
+    static const uint8_t *row(const TestRasterRows &r, size_t row) { return r.buf.data() + row * r.cols; }
+};
+
+template<> struct _RasterTraits<TestRasterPixels> {
+    using ValueType = uint8_t;
+    static uint8_t get(const TestRasterPixels &r, size_t row, size_t col) { return r.rst.buf[row * r.rst.cols + col]; }
+    static size_t rows(const TestRasterPixels &r) { return r.rst.rows; }
+    static size_t cols(const TestRasterPixels &r) { return r.rst.cols; }
+};
+
+} // namespace marchsq
+
+TEST_CASE("Row access tagging gives the same rings as pixel access", "[MarchingSquares]") {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> px(0, 255);
+
+    auto check = [](const TestRasterRows &rst) {
+        for (marchsq::Coord w : {marchsq::Coord{2, 2}, marchsq::Coord{4, 4}, marchsq::Coord{3, 5}}) {
+            std::vector<marchsq::Ring> a = marchsq::execute(rst, uint8_t(128), w);
+            std::vector<marchsq::Ring> b = marchsq::execute(TestRasterPixels{rst}, uint8_t(128), w);
+            REQUIRE(a.size() == b.size());
+            for (size_t i = 0; i < a.size(); ++i) {
+                REQUIRE(a[i].size() == b[i].size());
+                for (size_t j = 0; j < a[i].size(); ++j) {
+                    REQUIRE(a[i][j].r == b[i][j].r);
+                    REQUIRE(a[i][j].c == b[i][j].c);
+                }
+            }
+        }
+    };
+
+    SECTION("Noise") {
+        TestRasterRows rst{61, 83, std::vector<uint8_t>(61 * 83)};
+        for (uint8_t &v : rst.buf) v = uint8_t(px(rng));
+        check(rst);
+    }
+
+    SECTION("Blobs with empty rows") {
+        TestRasterRows rst{120, 97, std::vector<uint8_t>(120 * 97, 0)};
+        for (size_t r = 0; r < rst.rows; ++r)
+            for (size_t c = 0; c < rst.cols; ++c) {
+                double d1 = std::hypot(double(r) - 30., double(c) - 25.);
+                double d2 = std::hypot(double(r) - 85., double(c) - 70.);
+                if (d1 < 15. || (d2 < 20. && d2 > 8.))
+                    rst.buf[r * rst.cols + c] = 255;
+            }
+        check(rst);
+    }
+}
+
 static void recreate_object_from_rasters(const std::string &objname, float lh) {
     TriangleMesh mesh = load_model(objname);
     
@@ -3,6 +3,7 @@
 
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/MeshBoolean.hpp>
+#include <libslic3r/CSGMesh/PerformCSGMeshBooleans.hpp>
 
 using namespace Slic3r;
 
@@ -49,3 +50,37 @@ TEST_CASE("Add TriangleMeshes", "[MeshBoolean]")
     //its_write_obj(tm1.its, "test_add.obj");
     CHECK(tm1.its.indices.size() > init_size);
 }
+
+TEST_CASE("CSG booleans with a nested frame", "[MeshBoolean][CSGMesh]")
+{
+    auto cube   = std::make_shared<indexed_triangle_set>(its_make_cube(10., 10., 10.));
+    auto sphere = std::make_shared<indexed_triangle_set>(its_make_sphere(3., PI / 20.));
+
+    auto make_part = [](auto mesh, csg::CSGType op, const Vec3f &pos,
+                        csg::CSGStackOp stackop = csg::CSGStackOp::Continue) {
+        csg::CSGPart part{std::move(mesh), op, Transform3f{Eigen::Translation3f{pos}}};
+        part.stack_operation = stackop;
+        return part;
+    };
+
+    std::shared_ptr<indexed_triangle_set> none;
+
+    // The cube without a sphere octant in four of its corners, two of the
+    // spheres being subtracted as a frame of their own.
+    std::vector<csg::CSGPart> parts;
+    parts.emplace_back(make_part(cube, csg::CSGType::Union, Vec3f::Zero()));
+    parts.emplace_back(make_part(none, csg::CSGType::Difference, Vec3f::Zero(), csg::CSGStackOp::Push));
+    parts.emplace_back(make_part(sphere, csg::CSGType::Union, Vec3f{0.f, 0.f, 0.f}));
+    parts.emplace_back(make_part(sphere, csg::CSGType::Union, Vec3f{10.f, 10.f, 10.f}));
+    parts.emplace_back(make_part(none, csg::CSGType::Union, Vec3f::Zero(), csg::CSGStackOp::Pop));
+    parts.emplace_back(make_part(sphere, csg::CSGType::Difference, Vec3f{10.f, 0.f, 0.f}));
+    parts.emplace_back(make_part(sphere, csg::CSGType::Difference, Vec3f{0.f, 10.f, 0.f}));
+
+    REQUIRE(csg::check_csgmesh_booleans(range(parts)) == parts.end());
+
+    MeshBoolean::cgal::CGALMeshPtr cgalmesh = csg::perform_csgmesh_booleans(range(parts));
+    REQUIRE(cgalmesh);
+
+    indexed_triangle_set result = MeshBoolean::cgal::cgal_to_indexed_triangle_set(*cgalmesh);
+    REQUIRE(its_volume(result) == Approx(its_volume(*cube) - its_volume(*sphere) / 2.).epsilon(0.01));
+}
@@ -0,0 +1,123 @@
+#include <catch2/catch.hpp>
+
+#include <cstring>
+#include <random>
+
+#include "libslic3r/ParallelDeflate.hpp"
+#include "libslic3r/PNGReadWrite.hpp"
+
+using namespace Slic3r;
+
+// Compressible data spanning several chunks: runs of random bytes from a small alphabet.
+static std::vector<uint8_t> make_data(size_t size)
+{
+    std::mt19937                       rng(0);
+    std::uniform_int_distribution<int> byte(0, 15), run(1, 64);
+    std::vector<uint8_t>               out;
+    out.reserve(size);
+    while (out.size() < size)
+        out.insert(out.end(), std::min<size_t>(run(rng), size - out.size()), uint8_t('a' + byte(rng)));
+    return out;
+}
+
+static std::vector<uint8_t> inflate(const std::vector<uint8_t> &deflated)
+{
+    size_t  size = 0;
+    void   *data = tinfl_decompress_mem_to_heap(deflated.data(), deflated.size(), &size, 0);
+    std::vector<uint8_t> out;
+    if (data != nullptr) {
+        out.assign(static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + size);
+        mz_free(data);
+    }
+    return out;
+}
+
+TEST_CASE("Checksums of concatenated buffers are combined", "[ParallelDeflate]") {
+    std::vector<uint8_t> data = make_data(100000);
+    const size_t split = 31337;
+    uint32_t crc1   = uint32_t(mz_crc32(MZ_CRC32_INIT, data.data(), split));
+    uint32_t crc2   = uint32_t(mz_crc32(MZ_CRC32_INIT, data.data() + split, data.size() - split));
+    uint32_t adler1 = uint32_t(mz_adler32(MZ_ADLER32_INIT, data.data(), split));
+    uint32_t adler2 = uint32_t(mz_adler32(MZ_ADLER32_INIT, data.data() + split, data.size() - split));
+    REQUIRE(crc32_combine(crc1, crc2, data.size() - split) == uint32_t(mz_crc32(MZ_CRC32_INIT, data.data(), data.size())));
+    REQUIRE(adler32_combine(adler1, adler2, data.size() - split) == uint32_t(mz_adler32(MZ_ADLER32_INIT, data.data(), data.size())));
+}
+
+TEST_CASE("Parallel deflate round trip", "[ParallelDeflate]") {
+    auto check = [](const std::vector<uint8_t> &data, const DeflatedData &deflated) {
+        REQUIRE(deflated.uncompressed_size == data.size());
+        REQUIRE(deflated.crc32 == uint32_t(mz_crc32(MZ_CRC32_INIT, data.data(), data.size())));
+        REQUIRE(inflate(deflated.data) == data);
+    };
+    for (size_t size : { size_t(0), size_t(1000), 3 * DEFLATE_CHUNK_SIZE + 12345 }) {
+        std::vector<uint8_t> data = make_data(size);
+        {
+            // Single call.
+            DeflatedData deflated;
+            REQUIRE(deflate_parallel(data.data(), data.size(), MZ_DEFAULT_LEVEL, true, deflated));
+            check(data, deflated);
+        }
+        {
+            // Appended in two calls.
+            DeflatedData deflated;
+            REQUIRE(deflate_parallel(data.data(), data.size() / 3, MZ_BEST_SPEED, false, deflated));
+            REQUIRE(deflate_parallel(data.data() + data.size() / 3, data.size() - data.size() / 3, MZ_BEST_SPEED, true, deflated));
+            check(data, deflated);
+        }
+    }
+}
+
+TEST_CASE("Parallel PNG encoding decodes to the source image", "[ParallelDeflate][PNG]") {
+    const size_t         w = 1500, h = 1000;
+    std::vector<uint8_t> pixels = make_data(w * h);
+    std::vector<uint8_t> encoded = write_png_to_memory_parallel(pixels.data(), int(w), int(h), 1, MZ_DEFAULT_LEVEL);
+    REQUIRE(png::is_png({ encoded.data(), encoded.size() }));
+
+    png::ImageGreyscale img;
+    REQUIRE(png::decode_png({ encoded.data(), encoded.size() }, img));
+    REQUIRE(img.cols == w);
+    REQUIRE(img.rows == h);
+    REQUIRE(img.buf == pixels);
+}
+
+TEST_CASE("Zip file written by parallel deflate in batches", "[ParallelDeflate]") {
+    std::vector<uint8_t> data = make_data(5 * DEFLATE_CHUNK_SIZE * 16 + 777);
+
+    mz_zip_archive archive;
+    mz_zip_zero_struct(&archive);
+    REQUIRE(mz_zip_writer_init_heap(&archive, 0, 0));
+    mz_zip_writer_staged_context context;
+    REQUIRE(mz_zip_writer_add_staged_open(&archive, &context, "data.bin", uint64_t(1) << 32, nullptr, nullptr, 0, MZ_DEFAULT_COMPRESSION, nullptr, 0, nullptr, 0));
+    {
+        ParallelDeflateStagedWriter writer(context, MZ_DEFAULT_LEVEL);
+        // Odd sized pieces not aligned with the batches, the middle part compressed separately.
+        const size_t deflated_begin = data.size() / 3;
+        const size_t deflated_end   = 2 * data.size() / 3;
+        for (size_t i = 0; i < deflated_begin; i += 100003)
+            REQUIRE(writer.write(reinterpret_cast<const char*>(data.data()) + i, std::min<size_t>(100003, deflated_begin - i)));
+        DeflatedData deflated;
+        REQUIRE(deflate_parallel(data.data() + deflated_begin, deflated_end - deflated_begin, MZ_DEFAULT_LEVEL, false, deflated));
+        REQUIRE(writer.write_deflated(deflated));
+        for (size_t i = deflated_end; i < data.size(); i += 100003)
+            REQUIRE(writer.write(reinterpret_cast<const char*>(data.data()) + i, std::min<size_t>(100003, data.size() - i)));
+        REQUIRE(writer.finish());
+    }
+    REQUIRE(mz_zip_writer_add_mem(&archive, "small.txt", "abc", 3, MZ_DEFAULT_COMPRESSION));
+    void  *zip_data = nullptr;
+    size_t zip_size = 0;
+    REQUIRE(mz_zip_writer_finalize_heap_archive(&archive, &zip_data, &zip_size));
+    mz_zip_writer_end(&archive);
+
+    mz_zip_archive reader;
+    mz_zip_zero_struct(&reader);
+    REQUIRE(mz_zip_reader_init_mem(&reader, zip_data, zip_size, 0));
+    size_t size      = 0;
+    // Verifies the CRC-32 stored in the archive.
+    void  *extracted = mz_zip_reader_extract_file_to_heap(&reader, "data.bin", &size, 0);
+    REQUIRE(extracted != nullptr);
+    REQUIRE(size == data.size());
+    REQUIRE(memcmp(extracted, data.data(), size) == 0);
+    mz_free(extracted);
+    mz_zip_reader_end(&reader);
+    mz_free(zip_data);
+}
@@ -1,5 +1,12 @@
 #include <catch2/catch.hpp>
 
+#include <set>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
 #include "libslic3r/PlaceholderParser.hpp"
 #include "libslic3r/PrintConfig.hpp"
 
@@ -110,4 +117,111 @@ SCENARIO("Placeholder parser scripting", "[PlaceholderParser]") {
     SECTION("complex expression") { REQUIRE(boolean_expression("printer_notes=~/.*PRINTER_VENDOR_PRUSA3D.*/ and printer_notes=~/.*PRINTER_MODEL_MK2.*/ and nozzle_diameter[0]==0.6 and num_extruders>1")); }
     SECTION("complex expression2") { REQUIRE(boolean_expression("printer_notes=~/.*PRINTER_VEwerfNDOR_PRUSA3D.*/ or printer_notes=~/.*PRINTertER_MODEL_MK2.*/ or (nozzle_diameter[0]==0.6 and num_extruders>1)")); }
     SECTION("complex expression3") { REQUIRE(! boolean_expression("printer_notes=~/.*PRINTER_VEwerfNDOR_PRUSA3D.*/ or printer_notes=~/.*PRINTertER_MODEL_MK2.*/ or (nozzle_diameter[0]==0.3 and num_extruders>1)")); }
+
+    // Templates are compiled on the first call and evaluated against the current configuration on the following calls.
+    SECTION("repeated template follows the configuration") {
+        const std::string templ = "G1 Z[bar] F{bar * 60}\n{if foo == 0}zero{elsif bar == 2}two{else}other{endif}";
+        REQUIRE(parser.process(templ) == "G1 Z2 F120\nzero");
+        parser.set("foo", 1);
+        REQUIRE(parser.process(templ) == "G1 Z2 F120\ntwo");
+        parser.set("bar", 3);
+        REQUIRE(parser.process(templ) == "G1 Z3 F180\nother");
+    }
+    SECTION("repeated boolean expression follows the configuration") {
+        REQUIRE(boolean_expression("foo + 2 == bar"));
+        parser.set("bar", 3);
+        REQUIRE(! boolean_expression("foo + 2 == bar"));
+    }
+    SECTION("error in a branch not taken") { REQUIRE_THROWS(parser.process("{if foo == 0}zero{else}{not_a_variable}{endif}")); }
+    SECTION("repeated runtime error") {
+        for (int i = 0; i < 2; ++ i)
+            REQUIRE_THROWS_WITH(parser.process("{foo + not_a_variable}"), Catch::Contains("Not a variable name"));
+    }
+}
+
+// Values of the templates of the system profiles, unescaped.
+static std::vector<std::pair<std::string, std::string>> system_profile_templates()
+{
+    std::set<std::pair<std::string, std::string>> templates;
+    for (const boost::filesystem::directory_entry &entry : boost::filesystem::directory_iterator(std::string(TEST_DATA_DIR) + "/../../resources/profiles"))
+        if (entry.path().extension() == ".ini") {
+            boost::nowide::ifstream ifs(entry.path().string());
+            for (std::string line; std::getline(ifs, line);) {
+                size_t eq = line.find('=');
+                if (eq == std::string::npos || line.front() == '#')
+                    continue;
+                std::string key = boost::trim_copy(line.substr(0, eq));
+                std::string value;
+                if ((boost::ends_with(key, "_gcode") || boost::ends_with(key, "_condition")) &&
+                    unescape_string_cstyle(boost::trim_copy(line.substr(eq + 1)), value) && ! value.empty())
+                    templates.emplace(key, value);
+            }
+        }
+    return { templates.begin(), templates.end() };
+}
+
+TEST_CASE("Compiled templates of the system profiles match the parser", "[PlaceholderParser]") {
+    PlaceholderParser parser;
+    parser.apply_config(DynamicPrintConfig::full_print_config());
+    // Variables set by GCode for the custom G-code blocks.
+    parser.set("num_extruders", 1);
+    parser.set("initial_tool", 0);
+    parser.set("initial_extruder", 0);
+    parser.set("current_extruder", 0);
+    parser.set("current_object_idx", 0);
+    parser.set("total_layer_count", 100);
+    parser.set("total_toolchanges", 0);
+    parser.set("has_wipe_tower", false);
+    parser.set("has_single_extruder_multi_material_priming", false);
+    parser.set("is_extruder_used", new ConfigOptionBools({ true }));
+    parser.set("first_layer_print_min", new ConfigOptionFloats({ 10., 20. }));
+    parser.set("first_layer_print_max", new ConfigOptionFloats({ 110., 120. }));
+    parser.set("first_layer_print_size", new ConfigOptionFloats({ 100., 100. }));
+    parser.set("print_bed_min", new ConfigOptionFloats({ 0., 0. }));
+    parser.set("print_bed_max", new ConfigOptionFloats({ 250., 210. }));
+    parser.set("print_bed_size", new ConfigOptionFloats({ 250., 210. }));
+    parser.update_timestamp();
+    DynamicConfig overrides;
+    overrides.set_key_value("layer_num", new ConfigOptionInt(3));
+    overrides.set_key_value("layer_z", new ConfigOptionFloat(0.8));
+    overrides.set_key_value("max_layer_z", new ConfigOptionFloat(0.8));
+    overrides.set_key_value("previous_extruder", new ConfigOptionInt(0));
+    overrides.set_key_value("next_extruder", new ConfigOptionInt(0));
+    overrides.set_key_value("toolchange_z", new ConfigOptionFloat(0.8));
+    overrides.set_key_value("color_change_extruder", new ConfigOptionInt(0));
+    overrides.set_key_value("filament_extruder_id", new ConfigOptionInt(0));
+
+    // Output or error message, and the state of the random generator after the run.
+    auto run = [&](const std::string &key, const std::string &templ, bool compiled) {
+        PlaceholderParser::set_compiled_templates_enabled(compiled);
+        PlaceholderParser::ContextData context;
+        context.rng.seed(0);
+        std::string out;
+        try {
+            out = boost::ends_with(key, "_condition") ?
+                (PlaceholderParser::evaluate_boolean_expression(templ, parser.config()) ? "true" : "false") :
+                parser.process(templ, 0, &overrides, &context);
+        } catch (const std::exception &ex) {
+            out = std::string("error: ") + ex.what();
+        }
+        return std::make_pair(out, context.rng());
+    };
+
+    std::vector<std::pair<std::string, std::string>> templates = system_profile_templates();
+    REQUIRE(templates.size() > 100);
+    size_t num_processed = 0;
+    for (const auto &[key, templ] : templates) {
+        INFO(key << " = " << templ);
+        auto expected = run(key, templ, false);
+        // Compiled on the first run, evaluated from the cache on the second.
+        for (int i = 0; i < 2; ++ i) {
+            auto compiled = run(key, templ, true);
+            REQUIRE(compiled.first == expected.first);
+            REQUIRE(compiled.second == expected.second);
+        }
+        num_processed += ! boost::starts_with(expected.first, "error: ");
+    }
+    PlaceholderParser::set_compiled_templates_enabled(true);
+    // Most templates are valid in the context set above.
+    REQUIRE(num_processed > templates.size() * 9 / 10);
 }
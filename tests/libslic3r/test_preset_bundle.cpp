@@ -0,0 +1,126 @@
+#include <catch2/catch.hpp>
+
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include "libslic3r/PresetBundle.hpp"
+#include "libslic3r/Utils.hpp"
+
+using namespace Slic3r;
+
+static const char *vendor_bundle = R"(
+[vendor]
+name = Test
+config_version = 1.0.0
+
+[printer_model:TM1]
+name = Test Model
+variants = 0.4
+technology = FFF
+family = Test
+
+[print:*common*]
+perimeters = 2
+layer_height = 0.2
+
+[print:0.20mm TEST]
+inherits = *common*
+fill_density = 25%
+
+[filament:Test PLA]
+filament_type = PLA
+temperature = 210
+
+[printer:*common*]
+printer_technology = FFF
+printer_model = TM1
+printer_variant = 0.4
+bed_shape = 0x0,200x0,200x200,0x200
+
+[printer:Test Printer]
+inherits = *common*
+nozzle_diameter = 0.4
+)";
+
+static void write_file(const boost::filesystem::path &path, const std::string &data)
+{
+    boost::nowide::ofstream ofs(path.string(), std::ios::binary);
+    ofs << data;
+}
+
+static std::vector<boost::filesystem::path> cache_files(const boost::filesystem::path &dir)
+{
+    std::vector<boost::filesystem::path> out;
+    if (boost::filesystem::exists(dir))
+        for (const boost::filesystem::directory_entry &entry : boost::filesystem::directory_iterator(dir))
+            out.emplace_back(entry.path());
+    return out;
+}
+
+static void load_system(PresetBundle &bundle, const boost::filesystem::path &path)
+{
+    bundle.load_configbundle(path.string(), PresetBundle::LoadConfigBundleAttribute::LoadSystem, ForwardCompatibilitySubstitutionRule::Disable);
+}
+
+TEST_CASE("Flattened system config bundle is cached", "[PresetBundle]")
+{
+    namespace fs = boost::filesystem;
+    const std::string old_data_dir = data_dir();
+    const fs::path    dir          = fs::temp_directory_path() / fs::unique_path();
+    const fs::path    bundle_path  = dir / "vendor" / "Test.ini";
+    const fs::path    cache_dir    = dir / "cache" / "flattened";
+    fs::create_directories(bundle_path.parent_path());
+    set_data_dir(dir.string());
+    write_file(bundle_path, vendor_bundle);
+
+    // The first load parses and flattens the bundle, then stores it into the cache.
+    PresetBundle parsed;
+    load_system(parsed, bundle_path);
+    std::vector<fs::path> files = cache_files(cache_dir);
+    REQUIRE(files.size() == 1);
+    REQUIRE(files.front().extension() == ".cereal");
+    const fs::path cache_path = files.front();
+    // Detect the cache being rewritten.
+    const std::time_t old_time = 1000000;
+    fs::last_write_time(cache_path, old_time);
+
+    SECTION("An unchanged bundle is loaded from the cache") {
+        PresetBundle cached;
+        load_system(cached, bundle_path);
+        REQUIRE(fs::last_write_time(cache_path) == old_time);
+        auto compare = [](const PresetCollection &collection, const PresetCollection &cached_collection) {
+            REQUIRE(collection.size() == cached_collection.size());
+            for (const Preset &preset : collection) {
+                const Preset *cached_preset = cached_collection.find_preset(preset.name, false, false);
+                REQUIRE(cached_preset != nullptr);
+                REQUIRE(cached_preset->is_system == preset.is_system);
+                REQUIRE(cached_preset->config == preset.config);
+            }
+        };
+        compare(parsed.prints,    cached.prints);
+        compare(parsed.filaments, cached.filaments);
+        compare(parsed.printers,  cached.printers);
+        REQUIRE(cached.prints.find_preset("0.20mm TEST", false, false)->config.opt_int("perimeters") == 2);
+    }
+
+    SECTION("A bundle modified in place invalidates the cache") {
+        // Same size and modification time, different content.
+        const std::time_t bundle_time = fs::last_write_time(bundle_path);
+        std::string       modified    = vendor_bundle;
+        modified.replace(modified.find("perimeters = 2"), 14, "perimeters = 3");
+        write_file(bundle_path, modified);
+        fs::last_write_time(bundle_path, bundle_time);
+
+        PresetBundle reparsed;
+        load_system(reparsed, bundle_path);
+        REQUIRE(reparsed.prints.find_preset("0.20mm TEST", false, false)->config.opt_int("perimeters") == 3);
+        REQUIRE(fs::last_write_time(cache_path) != old_time);
+        // No temporary file is left behind.
+        REQUIRE(cache_files(cache_dir).size() == 1);
+    }
+
+    set_data_dir(old_data_dir);
+    fs::remove_all(dir);
+}
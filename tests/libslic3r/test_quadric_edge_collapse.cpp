@@ -302,3 +302,33 @@ TEST_CASE("Simplified cube should not be empty.", "[its]")
     its_quadric_edge_collapse(its, wanted_count, &max_error);
     CHECK(!its.indices.empty());
 }
+
+TEST_CASE("Parallel simplification of a large mesh", "[its][quadric_edge_collapse]")
+{
+    indexed_triangle_set sphere = its_make_sphere(10., 0.01);
+    REQUIRE(sphere.indices.size() > 200000);
+    uint32_t wanted_count = sphere.indices.size() * 0.05;
+
+    indexed_triangle_set its_serial = sphere;
+    its_quadric_edge_collapse(its_serial, wanted_count);
+    indexed_triangle_set its_parallel = sphere;
+    float max_error = std::numeric_limits<float>::max();
+    its_quadric_edge_collapse_parallel(its_parallel, wanted_count, &max_error);
+
+    CHECK(its_parallel.indices.size() <= wanted_count);
+    CHECK(!Private::exist_triangle_with_twice_vertices(its_parallel.indices));
+    // The borders of the parts are stitched.
+    CHECK(its_num_open_edges(its_parallel) == 0);
+    CHECK(its_volume(its_parallel) == Approx(its_volume(its_serial)).epsilon(0.01));
+
+    // Quality is comparable to the serial simplification.
+    Private::Similarity serial = Private::get_similarity(sphere, its_serial);
+    Private::is_better_similarity(sphere, its_parallel,
+        Private::Similarity(2.f * serial.max_distance + 0.01f, 2.f * serial.average_distance + 0.001f));
+
+    // The result is deterministic.
+    indexed_triangle_set its_parallel2 = sphere;
+    its_quadric_edge_collapse_parallel(its_parallel2, wanted_count);
+    CHECK(its_parallel2.vertices == its_parallel.vertices);
+    CHECK(its_parallel2.indices == its_parallel.indices);
+}
@@ -0,0 +1,142 @@
+#include <catch2/catch.hpp>
+
+#include <limits>
+#include <random>
+
+#include "libslic3r/SnapshotDelta.hpp"
+
+using namespace Slic3r;
+
+// Random bytes, which do not compress.
+static std::string random_data(size_t size, unsigned int seed)
+{
+    std::mt19937                       rng(seed);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::string                        out(size, '\0');
+    for (char &c : out)
+        c = char(byte(rng));
+    return out;
+}
+
+// A new version of the data with a few bytes changed, a run of bytes inserted and another one removed.
+static std::string edit(std::string data)
+{
+    data[100]  = char(data[100] + 1);
+    data[5000] = char(data[5000] + 1);
+    data.insert(20000, std::string(300, 'x'));
+    data.erase(40000, 500);
+    return data;
+}
+
+TEST_CASE("Delta varint framing", "[SnapshotDelta]")
+{
+    const std::vector<size_t> values { 0, 1, 127, 128, 255, 16383, 16384, size_t(1) << 32, std::numeric_limits<size_t>::max() };
+    const std::vector<size_t> sizes  { 1, 1, 1,   2,   2,   2,     3,     5,               (std::numeric_limits<size_t>::digits + 6) / 7 };
+    std::string out;
+    for (size_t i = 0; i < values.size(); ++ i) {
+        size_t old_size = out.size();
+        delta::append_varint(out, values[i]);
+        REQUIRE(out.size() - old_size == sizes[i]);
+    }
+    size_t pos = 0;
+    for (size_t v : values)
+        REQUIRE(delta::read_varint(out, pos) == v);
+    REQUIRE(pos == out.size());
+}
+
+TEST_CASE("Delta encoding round trip", "[SnapshotDelta]")
+{
+    std::string base = random_data(64 * 1024, 0);
+    std::string data = edit(base);
+
+    SECTION("Similar data are encoded as a small delta") {
+        std::string d = delta::encode(base, data, data.size());
+        REQUIRE(! d.empty());
+        REQUIRE(d.size() < data.size() / 16);
+        REQUIRE(delta::decode(base, d, data.size()) == data);
+    }
+    SECTION("A delta of unrelated data is rejected") {
+        REQUIRE(delta::encode(base, random_data(data.size(), 1), data.size() / 4).empty());
+    }
+    SECTION("A delta of data shorter than a block is rejected") {
+        REQUIRE(delta::encode(base, "short", 100).empty());
+    }
+}
+
+TEST_CASE("Snapshot chunks encoded as deltas", "[SnapshotDelta]")
+{
+    SnapshotEncoder encoder;
+    SnapshotWriter  writer;
+
+    std::string    base_data = random_data(64 * 1024, 0);
+    std::string    data      = edit(base_data);
+    SnapshotChunk *base      = writer.create(std::string(base_data), SnapshotChunk::hash(base_data), nullptr, encoder);
+    SnapshotChunk *chunk     = writer.create(std::string(data), SnapshotChunk::hash(data), base, encoder);
+    encoder.wait();
+
+    REQUIRE(! base->is_delta());
+    REQUIRE(chunk->is_delta());
+    REQUIRE(chunk->base() == base);
+    REQUIRE(base->num_deltas() == 1);
+    REQUIRE(writer.matches(*chunk, data, SnapshotChunk::hash(data)));
+    REQUIRE(! writer.matches(*chunk, base_data, SnapshotChunk::hash(base_data)));
+    REQUIRE(writer.load(*base) == base_data);
+    REQUIRE(writer.load(*chunk) == data);
+
+    SECTION("Memory is accounted once") {
+        REQUIRE(chunk->memsize() < base->memsize() / 16);
+        size_t total = base->memsize() + chunk->memsize();
+        size_t intervals = base->interval_memsize() + chunk->interval_memsize();
+        REQUIRE(intervals >= total);
+        REQUIRE(intervals <= total + 2);
+        // A base shared by another history interval.
+        base->add_ref();
+        REQUIRE(2 * base->interval_memsize() + chunk->interval_memsize() >= total);
+        REQUIRE(2 * base->interval_memsize() + chunk->interval_memsize() <= total + 4);
+        base->release_ref();
+        chunk->release_ref();
+        base->release_ref();
+    }
+
+    SECTION("The base outlives its history intervals while a delta references it") {
+        base->release_ref();
+        writer.release_unreferenced_base();
+        REQUIRE(base->refcnt() == 0);
+        REQUIRE(base->num_deltas() == 1);
+        // The delta is charged with the whole base.
+        REQUIRE(chunk->interval_memsize() == chunk->memsize() + base->memsize());
+
+        // Not having a base anymore, the writer stores new data in full.
+        std::string    data2  = edit(data);
+        SnapshotChunk *chunk2 = writer.create(std::string(data2), SnapshotChunk::hash(data2), chunk, encoder);
+        encoder.wait();
+        REQUIRE(! chunk2->is_delta());
+        REQUIRE(chunk2->base() == nullptr);
+
+        // Reconstructed from the base, which is not cached by the writer anymore.
+        REQUIRE(writer.load(*chunk) == data);
+        REQUIRE(writer.load(*chunk2) == data2);
+        // Releasing the delta releases the base.
+        chunk->release_ref();
+        chunk2->release_ref();
+    }
+
+    SECTION("Data stored in full become the base of the next deltas") {
+        std::string    data2  = random_data(data.size(), 1);
+        SnapshotChunk *chunk2 = writer.create(std::string(data2), SnapshotChunk::hash(data2), chunk, encoder);
+        encoder.wait();
+        REQUIRE(! chunk2->is_delta());
+
+        std::string    data3  = edit(data2);
+        SnapshotChunk *chunk3 = writer.create(std::string(data3), SnapshotChunk::hash(data3), chunk2, encoder);
+        encoder.wait();
+        REQUIRE(chunk2->base() == nullptr);
+        REQUIRE(chunk3->is_delta());
+        REQUIRE(chunk3->base() == chunk2);
+        REQUIRE(base->num_deltas() == 1);
+        REQUIRE(writer.load(*chunk) == data);
+        REQUIRE(writer.load(*chunk3) == data3);
+        for (SnapshotChunk *c : { base, chunk, chunk2, chunk3 })
+            c->release_ref();
+    }
+}
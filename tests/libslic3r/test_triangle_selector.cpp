@@ -0,0 +1,51 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/TriangleSelector.hpp"
+
+using namespace Slic3r;
+
+// Paints a few strokes with a spherical brush, splitting the triangles, and a few whole facets.
+template<class Fn>
+static void paint(TriangleSelector &selector, const TriangleMesh &mesh, Fn &&after_stroke)
+{
+    for (int i = 0; i < 10; ++ i) {
+        int   facet  = (i * 7919) % int(mesh.its.indices.size());
+        Vec3f center = mesh.its.vertices[mesh.its.indices[facet](0)];
+        auto  cursor = TriangleSelector::SinglePointCursor::cursor_factory(center, 10.f * center, 0.5f, TriangleSelector::SPHERE,
+                                                                           Transform3d::Identity(), TriangleSelector::ClippingPlane());
+        // Over-painting some strokes with NONE merges the split triangles back.
+        EnforcerBlockerType state = i % 3 == 2 ? EnforcerBlockerType::NONE : EnforcerBlockerType(1 + i % 5);
+        selector.select_patch(facet, std::move(cursor), state, Transform3d::Identity(), true);
+        after_stroke();
+        selector.set_facet((i * 104729) % int(mesh.its.indices.size()), EnforcerBlockerType(i % 4));
+        after_stroke();
+    }
+}
+
+TEST_CASE("Incremental serialization of painted triangles", "[TriangleSelector]") {
+    TriangleMesh mesh(its_make_sphere(10., PI / 30.));
+
+    // Serialized after each stroke, thus reusing the data of the triangles not painted by the stroke.
+    TriangleSelector incremental(mesh);
+    paint(incremental, mesh, [&incremental]() { incremental.serialize(); });
+    // All the painted triangles serialized at once.
+    TriangleSelector full(mesh);
+    paint(full, mesh, []() {});
+
+    std::pair<std::vector<std::pair<int, int>>, std::vector<bool>> data = full.serialize();
+    REQUIRE(! data.first.empty());
+    REQUIRE(incremental.serialize() == data);
+
+    THEN("the deserialized selector is serialized to the same data") {
+        TriangleSelector loaded(mesh);
+        loaded.deserialize(data, false);
+        REQUIRE(loaded.serialize() == data);
+        for (int state = 0; state < 6; ++ state)
+            REQUIRE(loaded.get_facets(EnforcerBlockerType(state)).indices.size() == full.get_facets(EnforcerBlockerType(state)).indices.size());
+
+        loaded.set_facet(data.first.front().first, EnforcerBlockerType::NONE);
+        data.first.erase(data.first.begin());
+        REQUIRE(loaded.serialize().first.size() == data.first.size());
+    }
+}
@@ -5,6 +5,7 @@
 #include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/Format/SLAArchiveWriter.hpp"
 #include "libslic3r/Format/SLAArchiveReader.hpp"
+#include "libslic3r/Format/ZipperArchiveImport.hpp"
 
 #include <boost/filesystem.hpp>
 
@@ -69,3 +70,42 @@ TEST_CASE("Archive export test", "[sla_archives]") {
         }
     }
 }
+
+TEST_CASE("Streaming archive export writes the same layers", "[sla_archives]") {
+    SLAPrint print;
+    SLAFullPrintConfig fullcfg;
+
+    auto m = Model::read_from_file(TEST_DATA_DIR PATH_SEPARATOR + std::string("20mm_cube.obj"), nullptr);
+
+    fullcfg.printer_technology.setInt(ptSLA);
+    fullcfg.set("sla_archive_format", "SL1");
+    fullcfg.set("supports_enable", false);
+    fullcfg.set("pad_enable", false);
+
+    DynamicPrintConfig cfg;
+    cfg.apply(fullcfg);
+
+    print.set_status_callback([](const PrintBase::SlicingStatus&) {});
+    print.apply(m, cfg);
+    print.process();
+
+    ThumbnailsList thumbnails;
+    const std::string fname_buffered  = "output_buffered.sl1";
+    const std::string fname_streaming = "output_streaming.sl1";
+    print.export_print(fname_buffered, thumbnails, "20mm_cube");
+
+    std::unique_ptr<SLAArchiveWriter> writer = SLAArchiveWriter::create("SL1", print.printer_config());
+    REQUIRE(writer);
+    REQUIRE(writer->set_streaming(true));
+    writer->export_print(fname_streaming, print, thumbnails, "20mm_cube");
+
+    ZipperArchive buffered  = read_zipper_archive(fname_buffered, {}, {});
+    ZipperArchive streaming = read_zipper_archive(fname_streaming, {}, {});
+
+    REQUIRE(! buffered.entries.empty());
+    REQUIRE(buffered.entries.size() == streaming.entries.size());
+    for (size_t i = 0; i < buffered.entries.size(); ++ i) {
+        REQUIRE(buffered.entries[i].fname == streaming.entries[i].fname);
+        REQUIRE(buffered.entries[i].buf == streaming.entries[i].buf);
+    }
+}
@@ -2,10 +2,16 @@
 #include <random>
 #include <numeric>
 #include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+
+#include <tbb/task_arena.h>
 
 #include "sla_test_utils.hpp"
 
 #include <libslic3r/TriangleMeshSlicer.hpp>
+#include <libslic3r/Format/AnycubicSLA.hpp>
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
 #include <libslic3r/BranchingTree/PointCloud.hpp>
 
@@ -252,6 +258,123 @@ TEST_CASE("RasterizedPolygonAreaShouldMatch", "[SLARasterOutput]") {
 }
 
 
+TEST_CASE("Span raster is pixel identical to the AGG raster", "[SLARasterOutput]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::Resolution res{2560, 1440};
+    sla::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+    auto bb = BoundingBox({0, 0}, {scaled(disp_w), scaled(disp_h)});
+
+    // Overlapping polygons, a polygon reaching out of the display.
+    ExPolygons polys;
+    for (double size : { 10., 33., 60. }) {
+        ExPolygon poly = square_with_hole(size);
+        poly.rotate(size * PI / 180.);
+        poly.translate(bb.center().x() + scaled(size / 3.), bb.center().y() - scaled(size / 5.));
+        polys.emplace_back(std::move(poly));
+    }
+    polys.emplace_back(square_with_hole(50.));
+
+    for (double gamma : { 1., 0. })
+        for (auto orientation : { sla::RasterBase::roLandscape, sla::RasterBase::roPortrait })
+            for (auto &mirror : { sla::RasterBase::NoMirror, sla::RasterBase::MirrorXY }) {
+                sla::RasterBase::Trafo trafo(orientation, mirror);
+                trafo.center_x = bb.center().x();
+                trafo.center_y = bb.center().y();
+                sla::Resolution r = orientation == sla::RasterBase::roPortrait ? sla::Resolution{res.height_px, res.width_px} : res;
+                std::unique_ptr<sla::RasterBase> agg   = sla::create_raster_grayscale_aa(r, pixdim, gamma, trafo);
+                std::unique_ptr<sla::RasterBase> spans = sla::create_raster_grayscale_aa_spans(r, pixdim, gamma, trafo);
+                for (const ExPolygon &poly : polys) {
+                    agg->draw(poly);
+                    spans->draw(poly);
+                }
+
+                sla::EncodedRaster agg_ppm   = agg->encode(sla::PPMRasterEncoder{});
+                sla::EncodedRaster spans_ppm = spans->encode(sla::PPMRasterEncoder{});
+                REQUIRE(agg_ppm.size() == spans_ppm.size());
+                REQUIRE(std::memcmp(agg_ppm.data(), spans_ppm.data(), agg_ppm.size()) == 0);
+
+                // The PNG encoder fed by rows produces the same bytes as the one fed by the whole frame.
+                sla::EncodedRaster agg_png   = agg->encode(sla::PNGRasterEncoder{});
+                sla::EncodedRaster spans_png = spans->encode_rows(sla::PNGRasterEncoder{});
+                REQUIRE(agg_png.size() == spans_png.size());
+                REQUIRE(std::memcmp(agg_png.data(), spans_png.data(), agg_png.size()) == 0);
+            }
+}
+
+// The whole frame Anycubic RLE encoder, which was replaced by AnycubicSLARasterEncoder fed by rows.
+static sla::EncodedRaster anycubic_encode_frame(const void *ptr, size_t w, size_t h, size_t num_components)
+{
+    std::vector<uint8_t> dst;
+    const auto *src     = reinterpret_cast<const std::uint8_t *>(ptr);
+    const auto *src_end = src + w * h * num_components;
+    while (src < src_end) {
+        std::uint8_t pixel    = (*src) & 0xF0;
+        // the maximum length of the span depends on the pixel color
+        size_t       max_len  = (pixel == 0 || pixel == 0xF0) ? 0xFFF : 0xF;
+        size_t       span_len = 0;
+        for (; src < src_end && span_len < max_len && ((*src) & 0xF0) == pixel; ++ src)
+            ++ span_len;
+        if (pixel == 0 || pixel == 0xF0) {
+            dst.push_back(pixel | std::uint8_t(span_len >> 8));
+            dst.push_back(std::uint8_t(span_len & 0xFF));
+        } else
+            dst.push_back(pixel | std::uint8_t(span_len));
+    }
+    return sla::EncodedRaster(std::move(dst), "pwimg");
+}
+
+static bool same_bytes(const sla::EncodedRaster &lhs, const sla::EncodedRaster &rhs)
+{
+    return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+TEST_CASE("Anycubic encoder fed by rows matches the whole frame encoder", "[SLARasterOutput]") {
+    SECTION("Synthetic frames") {
+        const size_t w = 3000, h = 4;
+        std::vector<std::uint8_t> frame(w * h, 0);
+        // Opaque run over three rows, longer than the maximum span of 0xFFF.
+        std::fill(frame.begin() + w / 2, frame.begin() + 3 * w, 0xFF);
+        // Antialiased runs longer than the maximum span of 0xF, crossing a row boundary,
+        // with pixel values differing only in the bits dropped by the encoding.
+        for (size_t i = 3 * w - 20; i < 3 * w + 20; ++ i)
+            frame[i] = std::uint8_t(0x80 + i % 16);
+        // Single pixels of all the levels.
+        for (size_t i = 0; i < 256; ++ i)
+            frame[3 * w + 100 + 2 * i] = std::uint8_t(i);
+        // Run ending exactly at the maximum span.
+        std::fill(frame.end() - 0xFFF, frame.end(), 0xF0);
+
+        sla::EncodedRaster expected = anycubic_encode_frame(frame.data(), w, h, 1);
+        REQUIRE(same_bytes(AnycubicSLARasterEncoder{}(frame.data(), w, h, 1), expected));
+        sla::RasterRows rows = [&frame, w](size_t row) { return frame.data() + row * w; };
+        REQUIRE(same_bytes(AnycubicSLARasterEncoder{}(rows, w, h, 1), expected));
+    }
+
+    SECTION("Antialiased polygons") {
+        double disp_w = 120., disp_h = 68.;
+        sla::Resolution res{2560, 1440};
+        sla::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+        auto bb = BoundingBox({0, 0}, {scaled(disp_w), scaled(disp_h)});
+        sla::RasterBase::Trafo trafo(sla::RasterBase::roLandscape, sla::RasterBase::MirrorXY);
+        trafo.center_x = bb.center().x();
+        trafo.center_y = bb.center().y();
+
+        std::unique_ptr<sla::RasterBase> agg   = sla::create_raster_grayscale_aa(res, pixdim, 1., trafo);
+        std::unique_ptr<sla::RasterBase> spans = sla::create_raster_grayscale_aa_spans(res, pixdim, 1., trafo);
+        for (double size : { 10., 33., 60. }) {
+            ExPolygon poly = square_with_hole(size);
+            poly.rotate(size * PI / 180.);
+            poly.translate(bb.center().x() + scaled(size / 3.), bb.center().y() - scaled(size / 5.));
+            agg->draw(poly);
+            spans->draw(poly);
+        }
+
+        sla::EncodedRaster expected = agg->encode(anycubic_encode_frame);
+        REQUIRE(same_bytes(agg->encode(AnycubicSLARasterEncoder{}), expected));
+        REQUIRE(same_bytes(spans->encode_rows(AnycubicSLARasterEncoder{}), expected));
+    }
+}
+
 TEST_CASE("halfcone test", "[halfcone]") {
     sla::DiffBridge br{Vec3d{1., 1., 1.}, Vec3d{10., 10., 10.}, 0.25, 0.5};
 
@@ -271,3 +394,49 @@ TEST_CASE("Test concurrency")
 
     REQUIRE(s == Approx(ref));
 }
+
+// Not run by default. Reports the time of the support tree generation with
+// 1 to N worker threads, run with: sla_print_tests "[Benchmark]"
+TEST_CASE("Support tree generation scaling with the number of threads",
+          "[.][SLASupportGeneration][Benchmark]")
+{
+    TriangleMesh mesh = load_model("extruder_idler.obj");
+    REQUIRE_FALSE(mesh.empty());
+
+    sla::SupportTreeConfig supportcfg;
+    supportcfg.tree_type = GENERATE(sla::SupportTreeType::Default,
+                                    sla::SupportTreeType::Branching);
+
+    auto bb        = mesh.bounding_box();
+    auto slicegrid = grid(float(bb.min.z()), float(bb.max.z()), 0.05f);
+    auto slices    = slice_mesh_ex(mesh.its, slicegrid, CLOSING_RADIUS);
+
+    sla::SupportableMesh sm{mesh.its, {}, supportcfg};
+
+    sla::SupportPointGenerator::Config autogencfg;
+    autogencfg.head_diameter = float(2 * supportcfg.head_front_radius_mm);
+    sla::SupportPointGenerator point_gen{sm.emesh, autogencfg, [] {}, [](int) {}};
+    point_gen.seed(0);
+    point_gen.execute(slices, slicegrid);
+    sm.pts = point_gen.output();
+    REQUIRE_FALSE(sm.pts.empty());
+
+    const int max_threads = tbb::this_task_arena::max_concurrency();
+    for (int threads = 1;; threads = std::min(2 * threads, max_threads)) {
+        tbb::task_arena arena(threads);
+        indexed_triangle_set tree;
+
+        auto start = std::chrono::steady_clock::now();
+        arena.execute([&sm, &tree] { tree = sla::create_support_tree(sm, {}); });
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::cout << (supportcfg.tree_type == sla::SupportTreeType::Default ? "Default" : "Branching")
+                  << " tree of " << sm.pts.size() << " support points, "
+                  << threads << " threads: " << elapsed.count() << " s" << std::endl;
+
+        REQUIRE_FALSE(tree.empty());
+
+        if (threads == max_threads)
+            break;
+    }
+}
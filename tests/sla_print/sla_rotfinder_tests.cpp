@@ -0,0 +1,156 @@
+#include <catch2/catch.hpp>
+#include <test_utils.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <libslic3r/Model.hpp>
+#include <libslic3r/SLA/Rotfinder.hpp>
+
+using namespace Slic3r;
+
+// The rotation returned by the rotation finders, around the x axis first.
+static Transform3f xy_rotation(const Vec2d &rot)
+{
+    Transform3f tr = Transform3f::Identity();
+    tr.rotate(Eigen::AngleAxisf(float(rot.y()), Vec3f::UnitY()));
+    tr.rotate(Eigen::AngleAxisf(float(rot.x()), Vec3f::UnitX()));
+    return tr;
+}
+
+// Exact score of a rotation of an object sitting on the print bed, as minimized
+// by find_least_supports_rotation(): The faces touching the floor are counted
+// with a negative score, the other faces by the steepness of their overhang.
+static double onfloor_score(const indexed_triangle_set &its, const Transform3f &tr)
+{
+    float zmin = std::numeric_limits<float>::max();
+    for (const Vec3f &v : its.vertices)
+        zmin = std::min(zmin, (tr * v).z());
+
+    double score = 0.;
+    for (const Vec3i &face : its.indices) {
+        std::array<Vec3f, 3> tri;
+        for (int i = 0; i < 3; ++ i)
+            tri[i] = tr * its.vertices[face(i)];
+        Vec3f  n    = (tri[1] - tri[0]).cross(tri[2] - tri[0]);
+        double area = 0.5 * n.norm();
+        if (tri[0].z() <= zmin + 0.1f && tri[1].z() <= zmin + 0.1f && tri[2].z() <= zmin + 0.1f)
+            score -= 2 * area;
+        else {
+            float phi = 1.f - std::acos(std::clamp(n.normalized().dot(-Vec3f::UnitZ()), -1.f, 1.f)) / float(PI);
+            score += std::sqrt(area) * phi * phi * phi;
+        }
+    }
+    return score / its.indices.size();
+}
+
+TEST_CASE("Tilted box is rotated to lie on its largest face", "[SLARotfinder]")
+{
+    // A box with its largest face down and a tilted copy of it.
+    indexed_triangle_set box  = its_make_cube(20., 40., 10.);
+    Transform3f          tilt = Transform3f::Identity();
+    tilt.rotate(Eigen::AngleAxisf(0.7f, Vec3f(1.f, 2.f, 3.f).normalized()));
+    indexed_triangle_set tilted = box;
+    its_transform(tilted, tilt);
+
+    Model        model;
+    ModelObject *mo = model.add_object();
+    mo->add_volume(TriangleMesh{tilted});
+    mo->add_instance();
+    // Placed onto the print bed.
+    mo->config.set("support_object_elevation", 0.);
+
+    Vec2d       rot = sla::find_least_supports_rotation(*mo);
+    Transform3f tr  = xy_rotation(rot);
+
+    // Lying on a face.
+    indexed_triangle_set rotated = tilted;
+    its_transform(rotated, tr);
+    bool face_down = false;
+    for (const Vec3i &face : rotated.indices) {
+        Vec3f n = its_face_normal(rotated, face);
+        face_down |= n.dot(-Vec3f::UnitZ()) > 1.f - 1e-4f;
+    }
+    REQUIRE(face_down);
+    // The largest one.
+    REQUIRE(bounding_box(rotated).size().z() == Approx(10.f).margin(1e-3));
+
+    // The exact score of the rotation found is the score of the untilted box,
+    // which is lower than the score of the box lying on its other faces.
+    double score = onfloor_score(tilted, tr);
+    REQUIRE(score == Approx(onfloor_score(box, Transform3f::Identity())).epsilon(1e-4));
+    for (const Vec3f &axis : { Vec3f::UnitX(), Vec3f::UnitY() }) {
+        Transform3f other = Transform3f::Identity();
+        other.rotate(Eigen::AngleAxisf(float(PI / 2.), axis));
+        REQUIRE(score < onfloor_score(box, other));
+    }
+}
+
+// A frustum of a regular pyramid standing on its larger base. The base is
+// split into many small triangles, as in a finely tessellated part.
+static indexed_triangle_set make_frustum_with_fine_base(float r_bottom, float r_top, float h, int sectors, int base_splits)
+{
+    indexed_triangle_set its;
+    for (int i = 0; i < sectors; ++ i) {
+        float a = 2.f * float(PI) * i / sectors;
+        its.vertices.emplace_back(r_bottom * std::cos(a), r_bottom * std::sin(a), 0.f);
+        its.vertices.emplace_back(r_top * std::cos(a), r_top * std::sin(a), h);
+    }
+    const int top_center = int(its.vertices.size());
+    its.vertices.emplace_back(0.f, 0.f, h);
+    const int bottom_center = int(its.vertices.size());
+    its.vertices.emplace_back(0.f, 0.f, 0.f);
+
+    std::vector<Vec3i> base;
+    for (int i = 0; i < sectors; ++ i) {
+        int j = (i + 1) % sectors;
+        its.indices.emplace_back(2 * i, 2 * j, 2 * j + 1);
+        its.indices.emplace_back(2 * i, 2 * j + 1, 2 * i + 1);
+        its.indices.emplace_back(top_center, 2 * i + 1, 2 * j + 1);
+        base.emplace_back(bottom_center, 2 * j, 2 * i);
+    }
+    // Split each triangle of the base into 4 by its edge midpoints.
+    for (int level = 0; level < base_splits; ++ level) {
+        std::vector<Vec3i> split;
+        for (const Vec3i &f : base) {
+            int m[3];
+            for (int k = 0; k < 3; ++ k) {
+                m[k] = int(its.vertices.size());
+                its.vertices.emplace_back(0.5f * (its.vertices[f(k)] + its.vertices[f((k + 1) % 3)]));
+            }
+            split.emplace_back(f(0), m[0], m[2]);
+            split.emplace_back(m[0], f(1), m[1]);
+            split.emplace_back(m[2], m[1], f(2));
+            split.emplace_back(m[0], m[1], m[2]);
+        }
+        base = std::move(split);
+    }
+    its.indices.insert(its.indices.end(), base.begin(), base.end());
+    return its;
+}
+
+TEST_CASE("Pruned search of rotations onto the floor finds the exact optimum", "[SLARotfinder]")
+{
+    // 18 convex hull faces, thus more candidates than scored exactly by default.
+    // The base of 16 * 4^5 faces is the best face to put onto the floor,
+    // while its many small faces would be scored as a large overhang.
+    indexed_triangle_set frustum = make_frustum_with_fine_base(20.f, 12.f, 12.f, 16, 5);
+    REQUIRE(sla::RotOptimizeParams{}.exact_candidates() < 18);
+
+    Model        model;
+    ModelObject *mo = model.add_object();
+    mo->add_volume(TriangleMesh{frustum});
+    mo->add_instance();
+    mo->config.set("support_object_elevation", 0.);
+
+    Vec2d pruned     = sla::find_least_supports_rotation(*mo);
+    Vec2d exhaustive = sla::find_least_supports_rotation(*mo, sla::RotOptimizeParams{}.exact_candidates(0));
+    REQUIRE((pruned - exhaustive).norm() < 1e-6);
+
+    // Standing on the base, which is made of the last faces.
+    indexed_triangle_set rotated = frustum;
+    its_transform(rotated, xy_rotation(pruned));
+    REQUIRE(its_face_normal(rotated, int(rotated.indices.size()) - 1).dot(-Vec3f::UnitZ()) > 1.f - 1e-4f);
+    REQUIRE(onfloor_score(frustum, xy_rotation(pruned)) == Approx(onfloor_score(frustum, Transform3f::Identity())).epsilon(1e-4));
+}
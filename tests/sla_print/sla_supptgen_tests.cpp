@@ -139,4 +139,48 @@ TEST_CASE("Two parallel plates should be supported", "[SupGen][Hollowed]")
     REQUIRE(!pts.empty());
 }
 
+TEST_CASE("Incremental support point update gives the same points as a full run", "[SupGen]")
+{
+    TriangleMesh mesh = load_model("A_upsidedown.obj");
+
+    auto                    bb      = cast<float>(mesh.bounding_box());
+    std::vector<float>      heights = grid(bb.min.z(), bb.max.z(), 0.1f);
+    std::vector<ExPolygons> slices  = slice_mesh_ex(mesh.its, heights, CLOSING_RADIUS);
+
+    AABBMesh emesh{mesh};
+    sla::SupportPointGenerator::Config cfg;
+
+    auto generate = [&emesh, &cfg, &heights](const std::vector<ExPolygons> &slcs,
+                                             sla::SupportPointGenerator::State &state) {
+        sla::SupportPointGenerator spgen{emesh, cfg, []{}, [](int){}};
+        spgen.seed(0);
+        spgen.execute(slcs, heights, state);
+        return spgen.output();
+    };
+
+    sla::SupportPointGenerator::State state;
+    sla::SupportPoints pts = generate(slices, state);
+    REQUIRE(!pts.empty());
+
+    SECTION("Same slices give the same points") {
+        REQUIRE(generate(slices, state) == pts);
+    }
+
+    SECTION("A notch cut into some of the layers") {
+        std::vector<ExPolygons> changed = slices;
+        size_t from = heights.size() / 3, to = std::min(from + 10, heights.size());
+        REQUIRE(!changed[from].empty());
+
+        Point     c     = changed[from].front().contour.points.front();
+        coord_t   a     = scaled(2.);
+        Polygon   notch{{c.x() - a, c.y() - a}, {c.x() + a, c.y() - a},
+                        {c.x() + a, c.y() + a}, {c.x() - a, c.y() + a}};
+        for (size_t i = from; i < to; ++i)
+            changed[i] = diff_ex(changed[i], Polygons{notch});
+
+        sla::SupportPointGenerator::State fresh;
+        REQUIRE(generate(changed, state) == generate(changed, fresh));
+    }
+}
+
 }} // namespace Slic3r::sla